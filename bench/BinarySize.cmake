@@ -0,0 +1,26 @@
+# Print .text of the binary-size benchmarks built with 100 and 200 fields, and
+# its growth per 100 fields.
+#
+# cmake -DSIZE_COMMAND=size -DSMALL=<100 fields> -DLARGE=<200 fields>
+#       -P BinarySize.cmake
+
+function(text_size File Out)
+  execute_process(COMMAND ${SIZE_COMMAND} -A ${File}
+    OUTPUT_VARIABLE Sections
+    RESULT_VARIABLE Result)
+  if(NOT Result EQUAL 0)
+    message(FATAL_ERROR "${SIZE_COMMAND} failed on ${File}")
+  endif()
+  string(REGEX MATCH "\n\\.text[ \t]+([0-9]+)" Match "${Sections}")
+  if(NOT Match)
+    message(FATAL_ERROR "no .text section in ${File}")
+  endif()
+  set(${Out} ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+
+text_size(${SMALL} Small)
+text_size(${LARGE} Large)
+math(EXPR Growth "${Large} - ${Small}")
+message(STATUS ".text with 100 fields: ${Small} bytes")
+message(STATUS ".text with 200 fields: ${Large} bytes")
+message(STATUS ".text growth per 100 fields: ${Growth} bytes")
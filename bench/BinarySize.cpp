@@ -0,0 +1,115 @@
+//===-- bench/BinarySize.cpp - Benchmark of code size of fields -*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a benchmark of the code generated for accesses to the
+/// fields of a large generated schema. It is built with
+/// ORDERED_BIT_FIELD_BENCH_FIELDS fields (100 by default), and the growth of
+/// `.text` between builds with different numbers of fields is the cost of
+/// the fields (see bench/BinarySize.cmake). With GCC 12, in bytes of .text
+/// for 100 fields and its growth per 100 fields, where the baseline is the
+/// library before the operators of proxy objects were shared as kernels:
+///
+///            | -O0 100 fields | -O0 growth | -O2 100 fields | -O2 growth
+///   baseline |        142,868 |    130,628 |         25,702 |     22,928
+///   policy 0 |        152,268 |    121,498 |         25,400 |     22,656
+///   policy 1 |        177,357 |    144,086 |         21,593 |     20,373
+///   policy 2 |        262,043 |    237,834 |         19,201 |     20,313
+///
+/// Sharing the kernels shrinks optimized builds at every inlining policy.
+/// It does not shrink debug builds under the default policy 1: every access
+/// at -O0 expands its forced-inline wrappers in place, which costs more than
+/// the per-field operators of the baseline, so .text grows by 24% and its
+/// growth per 100 fields by 10%. Policy 1 trades this size for the speed of
+/// debug builds (see bench/DebugAccess.cpp). Only policy 0 reduces the growth
+/// per 100 fields at -O0 below the baseline, by 7%.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/OrderedBitField.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+#ifndef ORDERED_BIT_FIELD_BENCH_FIELDS
+#define ORDERED_BIT_FIELD_BENCH_FIELDS 100
+#endif
+
+using namespace OrderedBitField;
+enum class Tag : std::size_t {};
+
+// records of 25 fields with widths varying by record, as generated schemas
+constexpr std::size_t FieldsPerRecord = 25;
+constexpr std::size_t NRecords =
+    ORDERED_BIT_FIELD_BENCH_FIELDS / FieldsPerRecord;
+static_assert(ORDERED_BIT_FIELD_BENCH_FIELDS % FieldsPerRecord == 0,
+              "number of fields must be a multiple of 25");
+
+constexpr std::size_t width(std::size_t S, std::size_t I) {
+  return 1 + (S * 7 + I * 5) % 12;
+}
+
+template <std::size_t S, class Seq> struct SchemaHelper;
+template <std::size_t S, std::size_t... I>
+struct SchemaHelper<S, std::index_sequence<I...>> {
+  using Type = BitField<std::uint32_t,
+                        RefByEnum::Field<static_cast<Tag>(I), width(S, I)>...>;
+};
+template <std::size_t S>
+using Schema =
+    typename SchemaHelper<S,
+                          std::make_index_sequence<FieldsPerRecord>>::Type;
+
+// every operator of the proxy objects on every field
+template <class BitFieldT, std::size_t... I>
+std::uint32_t exercise(BitFieldT &R, std::uint32_t V,
+                       std::index_sequence<I...>) {
+  std::uint32_t Sum = 0;
+  auto touch = [&](auto &&F) {
+    F = V;
+    F += V;
+    F -= 3u;
+    F *= V;
+    F /= 3u;
+    F %= 5u;
+    F &= V;
+    F |= 1u;
+    F ^= V + 1;
+    F <<= 1;
+    F >>= 2;
+    ++F;
+    --F;
+    F++;
+    F--;
+    Sum += F;
+  };
+  (touch(get<static_cast<Tag>(I)>(R)), ...);
+  return Sum;
+}
+
+template <std::size_t... S>
+std::uint32_t exerciseAll(std::uint32_t V, std::index_sequence<S...>) {
+  std::uint32_t Sum = 0;
+  auto one = [&](auto Record) {
+    Sum += exercise(Record, V, std::make_index_sequence<FieldsPerRecord>{});
+  };
+  (one(Schema<S>{}), ...);
+  return Sum;
+}
+
+int main(int Argc, char **) {
+  const std::uint32_t Sum = exerciseAll(static_cast<std::uint32_t>(Argc),
+                                        std::make_index_sequence<NRecords>{});
+  std::printf("fields: %d, checksum: %u\n", ORDERED_BIT_FIELD_BENCH_FIELDS,
+              static_cast<unsigned>(Sum));
+  return EXIT_SUCCESS;
+}
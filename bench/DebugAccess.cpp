@@ -0,0 +1,137 @@
+//===-- bench/DebugAccess.cpp - Accesses in debug builds --------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a benchmark of field accesses built without
+/// optimization (-O0 and -Og), compared with shifts and masks written by
+/// hand. It reports the time per access and the calls made by a write
+/// through get, down to the kernel applied to the storage unit and the guard
+/// policy notified after it, for the inlining policy
+/// ORDERED_BIT_FIELD_FORCE_INLINE it is built with.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/OrderedBitField.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define ORDERED_BIT_FIELD_BENCH_BACKTRACE 1
+#else
+#define ORDERED_BIT_FIELD_BENCH_BACKTRACE 0
+#endif
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, G };
+
+// number of frames on the stack, or 0 if it cannot be taken
+int stackDepth() {
+#if ORDERED_BIT_FIELD_BENCH_BACKTRACE
+  void *Frames[256];
+  return backtrace(Frames, 256);
+#else
+  return 0;
+#endif
+}
+
+// guard policy recording the stack depth at which it is notified
+int GuardDepth = 0;
+struct DepthGuard {
+  template <class BitFieldT, std::size_t I>
+  static constexpr void initialize(std::uint32_t *) {}
+  template <class BitFieldT, std::size_t I, std::size_t Word>
+  static void update(std::uint32_t *, std::uint32_t) {
+    GuardDepth = stackDepth();
+  }
+};
+struct DepthField : RefByEnum::Field<Tag::G, 8, 0, true> {
+  using Guard = DepthGuard;
+};
+
+using Record = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 5>,
+                        RefByEnum::Field<Tag::B, 11>,
+                        RefByEnum::Field<Tag::C, 16>>;
+using Guarded = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 5>,
+                         RefByEnum::Field<Tag::B, 11>, DepthField>;
+
+// shift count recording the stack depth at which the kernel converts it
+int KernelDepth = 0;
+struct DepthProbe {
+  [[gnu::noinline]] operator int() const {
+    KernelDepth = stackDepth();
+    return 1;
+  }
+};
+
+// frames between a statement writing a field and the deepest of the kernel
+// and the guard policy, which are called one after the other
+[[gnu::noinline]] int callDepth() {
+  Guarded R;
+  const int Base = stackDepth();
+  get<Tag::B>(R) <<= DepthProbe{};
+  return std::max(KernelDepth, GuardDepth) - Base - 1;
+}
+
+template <class Fn>
+double measure(std::vector<Record> &Records, std::size_t Rounds, Fn &&Access,
+               std::uint64_t &Sum) {
+  const auto Begin = std::chrono::steady_clock::now();
+  for (std::size_t Round = 0; Round < Rounds; ++Round) {
+    for (Record &R : Records) {
+      Sum += Access(R, static_cast<std::uint32_t>(Round));
+    }
+  }
+  const auto End = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(End - Begin).count() /
+         static_cast<double>(Rounds * Records.size());
+}
+
+int main(int Argc, char **Argv) {
+  const std::size_t Rounds =
+      Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : std::size_t{1} << 12;
+  std::vector<Record> Records(1024);
+
+  // assignment, compound assignment and read of a field in the middle
+  std::uint64_t SumLib = 0;
+  const double TLib = measure(
+      Records, Rounds,
+      [](Record &R, std::uint32_t V) -> std::uint32_t {
+        get<Tag::B>(R) = V;
+        get<Tag::B>(R) += 1u;
+        return get<Tag::B>(R);
+      },
+      SumLib);
+
+  std::uint64_t SumHand = 0;
+  const double THand = measure(
+      Records, Rounds,
+      [](Record &R, std::uint32_t V) -> std::uint32_t {
+        std::uint32_t &W = R.Data[0];
+        constexpr std::uint32_t Mask = 0x7ffu << 5;
+        W = (W & ~Mask) | ((V << 5) & Mask);
+        W = (W & ~Mask) | (((((W & Mask) >> 5) + 1u) << 5) & Mask);
+        return (W & Mask) >> 5;
+      },
+      SumHand);
+
+  std::printf("inlining policy: %d\n", ORDERED_BIT_FIELD_FORCE_INLINE);
+  if (ORDERED_BIT_FIELD_BENCH_BACKTRACE) {
+    std::printf("call depth:  %d\n", callDepth());
+  }
+  std::printf("get:         %.3f ns/access\n", TLib * 1e9 / 3);
+  std::printf("by hand:     %.3f ns/access\n", THand * 1e9 / 3);
+  return SumLib == SumHand ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,199 @@
+//===-- bench/HeaderStack.cpp - Benchmark of header stacks ------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a benchmark of HeaderStack over a synthetic capture,
+/// compared with offsets computed by hand.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/HeaderStack.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace OrderedBitField;
+enum class Hdr {
+  Dst0, Dst1, Dst2, Src0, Src1, Src2, Type,
+  Tci,
+  Ihl, Ver, Tos, TotalLen, Id, Frag, Ttl, Proto, Sum,
+  Addr0, Addr1, Addr2, Addr3,
+  SrcPort, DstPort, Len
+};
+
+using Ethernet =
+    BitField<std::uint16_t, RefByEnum::Field<Hdr::Dst0, 16>,
+             RefByEnum::Field<Hdr::Dst1, 16>, RefByEnum::Field<Hdr::Dst2, 16>,
+             RefByEnum::Field<Hdr::Src0, 16>, RefByEnum::Field<Hdr::Src1, 16>,
+             RefByEnum::Field<Hdr::Src2, 16>, RefByEnum::Field<Hdr::Type, 16>>;
+// the 16-bit units hold the bytes of the wire format in host order, and the
+// pairs of byte fields (e.g. TTL and protocol) are for little-endian hosts
+using Vlan = BitField<std::uint16_t, RefByEnum::Field<Hdr::Tci, 16>,
+                      RefByEnum::Field<Hdr::Type, 16>>;
+using Ipv4 =
+    BitField<std::uint16_t, RefByEnum::Field<Hdr::Ihl, 4, 5>,
+             RefByEnum::Field<Hdr::Ver, 4, 4>, RefByEnum::Field<Hdr::Tos, 8>,
+             RefByEnum::Field<Hdr::TotalLen, 16>, RefByEnum::Field<Hdr::Id, 16>,
+             RefByEnum::Field<Hdr::Frag, 16>, RefByEnum::Field<Hdr::Ttl, 8, 64>,
+             RefByEnum::Field<Hdr::Proto, 8>, RefByEnum::Field<Hdr::Sum, 16>,
+             RefByEnum::Field<Hdr::Addr0, 16>, RefByEnum::Field<Hdr::Addr1, 16>,
+             RefByEnum::Field<Hdr::Addr2, 16>,
+             RefByEnum::Field<Hdr::Addr3, 16>>;
+using Udp = BitField<std::uint16_t, RefByEnum::Field<Hdr::SrcPort, 16>,
+                     RefByEnum::Field<Hdr::DstPort, 16>,
+                     RefByEnum::Field<Hdr::Len, 16>,
+                     RefByEnum::Field<Hdr::Sum, 16>>;
+
+constexpr std::uint16_t VlanType = 0x8100;
+constexpr std::uint16_t Ipv4Type = 0x0800;
+constexpr auto Big = ByteOrder::Big;
+using SizedIpv4 = RefByEnum::SizedLayer<Ipv4, Hdr::Ihl, 4>;
+using Stack =
+    HeaderStack<Ethernet,
+                RefByEnum::OptionalLayer<Vlan, Hdr::Type, VlanType, Big>,
+                RefByEnum::OptionalLayer<SizedIpv4, Hdr::Type, Ipv4Type, Big>,
+                RefByEnum::OptionalLayer<Udp, Hdr::Proto, 17>>;
+
+// value of a 16-bit unit holding V in network byte order
+std::uint16_t wire16(std::uint16_t V) {
+  const unsigned char B[2] = {static_cast<unsigned char>(V >> 8),
+                              static_cast<unsigned char>(V)};
+  std::uint16_t R;
+  std::memcpy(&R, B, 2);
+  return R;
+}
+
+// big-endian 16-bit value at P
+std::uint16_t load16(const unsigned char *P) {
+  return static_cast<std::uint16_t>(P[0] << 8 | P[1]);
+}
+
+// per-packet record header, as in pcap files
+struct RecordHeader {
+  std::uint32_t Sec, USec, CapLen, Len;
+};
+
+// capture of N packets: 70% UDP, 10% VLAN-tagged UDP, 10% TCP, 10% ARP; a
+// fifth of the IPv4 headers carry 8 bytes of options
+std::vector<unsigned char> makeCapture(std::size_t N) {
+  std::vector<unsigned char> Buf;
+  std::mt19937 Rng(42);
+  for (std::size_t P = 0; P < N; ++P) {
+    const unsigned Kind = Rng() % 10;
+    std::vector<unsigned char> Pkt;
+    auto put = [&](const auto &Header) {
+      const auto *B = reinterpret_cast<const unsigned char *>(&Header);
+      Pkt.insert(Pkt.end(), B, B + sizeof(Header));
+    };
+    Ethernet E;
+    get<Hdr::Type>(E) =
+        wire16(Kind == 7 ? VlanType : Kind == 9 ? 0x0806 : Ipv4Type);
+    put(E);
+    if (Kind == 7) {
+      Vlan V;
+      get<Hdr::Tci>(V) = wire16(static_cast<std::uint16_t>(Rng() % 4096));
+      get<Hdr::Type>(V) = wire16(Ipv4Type);
+      put(V);
+    }
+    if (Kind != 9) {
+      const bool Options = Rng() % 5 == 0;
+      Ipv4 I;
+      get<Hdr::Ihl>(I) = Options ? 7 : 5;
+      get<Hdr::Proto>(I) = Kind == 8 ? 6 : 17;
+      put(I);
+      if (Options) {
+        // router alert and padding
+        const unsigned char O[8] = {0x94, 0x04, 0, 0, 1, 1, 1, 0};
+        Pkt.insert(Pkt.end(), O, O + sizeof(O));
+      }
+      Udp U;
+      get<Hdr::DstPort>(U) = static_cast<std::uint16_t>(Rng());
+      put(U);
+    }
+    Pkt.resize(Pkt.size() + Rng() % 64 + 16);
+    // keep the headers aligned to the base type
+    Pkt.resize((Pkt.size() + 1) & ~std::size_t{1});
+    RecordHeader R{0, 0, static_cast<std::uint32_t>(Pkt.size()),
+                   static_cast<std::uint32_t>(Pkt.size())};
+    const auto *B = reinterpret_cast<const unsigned char *>(&R);
+    Buf.insert(Buf.end(), B, B + sizeof(R));
+    Buf.insert(Buf.end(), Pkt.begin(), Pkt.end());
+  }
+  return Buf;
+}
+
+template <class Fn>
+double measure(const std::vector<unsigned char> &Capture, Fn &&Parse,
+               std::uint64_t &Sum) {
+  const auto Begin = std::chrono::steady_clock::now();
+  for (std::size_t Off = 0; Off < Capture.size();) {
+    RecordHeader R;
+    std::memcpy(&R, Capture.data() + Off, sizeof(R));
+    Off += sizeof(R);
+    Sum += Parse(Capture.data() + Off, std::size_t{R.CapLen});
+    Off += R.CapLen;
+  }
+  const auto End = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(End - Begin).count();
+}
+
+int main(int Argc, char **Argv) {
+  const std::size_t N =
+      Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : std::size_t{1} << 22;
+  const std::vector<unsigned char> Capture = makeCapture(N);
+
+  std::uint64_t SumStack = 0;
+  const double TStack = measure(
+      Capture,
+      [](const unsigned char *P, std::size_t Len) -> std::uint64_t {
+        const Stack S(P, Len);
+        const Udp *U = S.get<3>();
+        return U ? wire16(get<Hdr::DstPort>(*U)) : 0;
+      },
+      SumStack);
+
+  std::uint64_t SumHand = 0;
+  const double THand = measure(
+      Capture,
+      [](const unsigned char *P, std::size_t Len) -> std::uint64_t {
+        std::size_t Off = 14;
+        if (Len < Off) {
+          return 0;
+        }
+        std::uint16_t Type = load16(P + 12);
+        if (Type == VlanType) {
+          if (Len < Off + 4) {
+            return 0;
+          }
+          Type = load16(P + Off + 2);
+          Off += 4;
+        }
+        if (Type != Ipv4Type || Len < Off + 20) {
+          return 0;
+        }
+        const std::size_t Ihl = std::size_t{P[Off] & 0x0fu} * 4;
+        if (Ihl < 20 || Len < Off + Ihl || P[Off + 9] != 17 ||
+            Len < Off + Ihl + 8) {
+          return 0;
+        }
+        return load16(P + Off + Ihl + 2);
+      },
+      SumHand);
+
+  std::printf("packets: %zu\n", N);
+  std::printf("HeaderStack: %.3f ns/packet\n", TStack * 1e9 / N);
+  std::printf("by hand:     %.3f ns/packet\n", THand * 1e9 / N);
+  return SumStack == SumHand ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,523 @@
+//===-- Arrow.hpp - Export of record arrays to Apache Arrow -----*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains export of the fields of an array of BitField records
+/// through the Apache Arrow C Data Interface, which needs no Arrow library.
+/// The fields are extracted once into columns owned by the exported array,
+/// and consumers such as pyarrow or DuckDB import them without copies.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_ARROW_HPP
+#define ORDERED_BIT_FIELD_ARROW_HPP
+
+#include "Column.hpp"
+#include "OrderedBitField.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+/// Type of an Arrow array, as defined by the Arrow C Data Interface.
+struct ArrowSchema {
+  const char *format;
+  const char *name;
+  const char *metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema **children;
+  struct ArrowSchema *dictionary;
+  void (*release)(struct ArrowSchema *);
+  void *private_data;
+};
+
+/// Data of an Arrow array, as defined by the Arrow C Data Interface.
+struct ArrowArray {
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void **buffers;
+  struct ArrowArray **children;
+  struct ArrowArray *dictionary;
+  void (*release)(struct ArrowArray *);
+  void *private_data;
+};
+}
+#endif
+
+namespace OrderedBitField {
+/// Names of the enumerators of an enum type, which makes fields of the type
+/// exported as Arrow dictionary arrays. Specialize it with a static member
+/// array `Names`, whose K-th element is the name of the enumerator of value K.
+/// Fields of enum types without names are exported as integers.
+///
+/// \code
+///   enum class Color : std::uint8_t { Red, Green, Blue };
+///   template <> struct ArrowEnumNames<Color> {
+///     static constexpr const char *Names[] = {"red", "green", "blue"};
+///   };
+/// \endcode
+template <class EnumT> struct ArrowEnumNames {};
+
+namespace Util {
+/// Alignment of the buffers of exported arrays, as recommended by Arrow.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t ArrowAlign = 64;
+
+/// Deleter of buffers of exported arrays.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct ArrowDelete {
+  void operator()(unsigned char *P) const noexcept {
+    ::operator delete[](static_cast<void *>(P), std::align_val_t{ArrowAlign});
+  }
+};
+
+/// Buffer of an exported array.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+using ArrowBuffer = std::unique_ptr<unsigned char[], ArrowDelete>;
+
+/// Allocate a zero-filled buffer of an exported array, padded to a multiple
+/// of ArrowAlign bytes.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline ArrowBuffer allocateArrow(std::size_t Bytes) {
+  const std::size_t Padded =
+      std::max<std::size_t>((Bytes + ArrowAlign - 1) / ArrowAlign, 1) *
+      ArrowAlign;
+  ArrowBuffer B(static_cast<unsigned char *>(
+      ::operator new[](Padded, std::align_val_t{ArrowAlign})));
+  std::memset(B.get(), 0, Padded);
+  return B;
+}
+
+/// Resources of an exported array, released by its release callback. The
+/// children are released by their own callbacks unless moved away.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct ArrowArrayData {
+  std::vector<ArrowBuffer> Buffers;
+  std::vector<const void *> BufferPtrs;
+  std::vector<ArrowArray> Children;
+  std::vector<ArrowArray *> ChildPtrs;
+  std::unique_ptr<ArrowArray> Dictionary;
+
+  static void release(ArrowArray *A) {
+    auto *D = static_cast<ArrowArrayData *>(A->private_data);
+    for (ArrowArray &C : D->Children) {
+      if (C.release != nullptr) {
+        C.release(&C);
+      }
+    }
+    if (D->Dictionary && D->Dictionary->release != nullptr) {
+      D->Dictionary->release(D->Dictionary.get());
+    }
+    delete D;
+    A->release = nullptr;
+  }
+
+  /// Fill A with the buffers and children, and pass the ownership to A.
+  static void publish(std::unique_ptr<ArrowArrayData> D, ArrowArray *A,
+                      std::int64_t Length, std::int64_t NullCount) {
+    D->ChildPtrs.clear();
+    for (ArrowArray &C : D->Children) {
+      D->ChildPtrs.push_back(&C);
+    }
+    A->length = Length;
+    A->null_count = NullCount;
+    A->offset = 0;
+    A->n_buffers = static_cast<std::int64_t>(D->BufferPtrs.size());
+    A->n_children = static_cast<std::int64_t>(D->Children.size());
+    A->buffers = D->BufferPtrs.data();
+    A->children = D->ChildPtrs.empty() ? nullptr : D->ChildPtrs.data();
+    A->dictionary = D->Dictionary.get();
+    A->release = &release;
+    A->private_data = D.release();
+  }
+};
+
+/// Resources of an exported schema, released by its release callback.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct ArrowSchemaData {
+  std::string Format;
+  std::string Name;
+  std::vector<ArrowSchema> Children;
+  std::vector<ArrowSchema *> ChildPtrs;
+  std::unique_ptr<ArrowSchema> Dictionary;
+
+  static void release(ArrowSchema *S) {
+    auto *D = static_cast<ArrowSchemaData *>(S->private_data);
+    for (ArrowSchema &C : D->Children) {
+      if (C.release != nullptr) {
+        C.release(&C);
+      }
+    }
+    if (D->Dictionary && D->Dictionary->release != nullptr) {
+      D->Dictionary->release(D->Dictionary.get());
+    }
+    delete D;
+    S->release = nullptr;
+  }
+
+  /// Fill S with the format, name and children, and pass the ownership to S.
+  static void publish(std::unique_ptr<ArrowSchemaData> D, ArrowSchema *S,
+                      std::int64_t Flags) {
+    D->ChildPtrs.clear();
+    for (ArrowSchema &C : D->Children) {
+      D->ChildPtrs.push_back(&C);
+    }
+    S->format = D->Format.c_str();
+    S->name = D->Name.c_str();
+    S->metadata = nullptr;
+    S->flags = Flags;
+    S->n_children = static_cast<std::int64_t>(D->Children.size());
+    S->children = D->ChildPtrs.empty() ? nullptr : D->ChildPtrs.data();
+    S->dictionary = D->Dictionary.get();
+    S->release = &release;
+    S->private_data = D.release();
+  }
+};
+
+/// Helper class to detect names of the enumerators of an enum type.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class EnumT, class = std::void_t<>>
+struct HasArrowEnumNames : std::false_type {};
+
+template <class EnumT>
+struct HasArrowEnumNames<EnumT,
+                         std::void_t<decltype(ArrowEnumNames<EnumT>::Names)>>
+    : std::true_type {};
+
+/// Narrowest integer type which holds W-bit values.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t W, bool Signed>
+using ArrowInt = std::conditional_t<
+    W <= 8, std::conditional_t<Signed, std::int8_t, std::uint8_t>,
+    std::conditional_t<
+        W <= 16, std::conditional_t<Signed, std::int16_t, std::uint16_t>,
+        std::conditional_t<
+            W <= 32, std::conditional_t<Signed, std::int32_t, std::uint32_t>,
+            std::conditional_t<Signed, std::int64_t, std::uint64_t>>>>;
+
+/// Arrow format string of an integer type.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class T> constexpr const char *arrowIntFormat() {
+  constexpr bool Signed = std::is_signed_v<T>;
+  switch (sizeof(T)) {
+  case 1:
+    return Signed ? "c" : "C";
+  case 2:
+    return Signed ? "s" : "S";
+  case 4:
+    return Signed ? "i" : "I";
+  default:
+    return Signed ? "l" : "L";
+  }
+}
+
+/// Whether the I-th field is a padding, which is not exported.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT, std::size_t I> constexpr bool arrowPadding() {
+  using L = Layout<BitFieldT>;
+  using TagT = typename L::TagT;
+  constexpr auto Tag = L::template Descriptor<I>::Tag;
+  if constexpr (std::is_enum_v<TagT>) {
+    return L::template fixed<I>() &&
+           static_cast<std::underlying_type_t<TagT>>(Tag) ==
+               std::numeric_limits<std::underlying_type_t<TagT>>::max();
+  } else {
+    return L::template fixed<I>() && Tag.empty();
+  }
+}
+
+/// Name of the I-th field: the tag if it is a string, Names[tag] if Names is
+/// given, or the decimal value of the tag.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT, std::size_t I>
+std::string arrowName(const char *const *Names) {
+  using L = Layout<BitFieldT>;
+  using TagT = typename L::TagT;
+  constexpr auto Tag = L::template Descriptor<I>::Tag;
+  if constexpr (std::is_enum_v<TagT>) {
+    const auto V = static_cast<std::underlying_type_t<TagT>>(Tag);
+    return Names != nullptr ? Names[static_cast<std::size_t>(V)]
+                            : std::to_string(V);
+  } else {
+    static_assert(sizeof(typename TagT::value_type) == 1,
+                  "names of the fields must be UTF-8 strings");
+    return std::string(Tag.begin(), Tag.end());
+  }
+}
+
+/// Export the I-th field of N records as a child of the struct array.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT>
+void exportArrowField(const BitFieldT *Records, std::size_t N,
+                      const char *const *Names, ArrowArray *Array,
+                      ArrowSchema *Schema) {
+  using L = Layout<BitFieldT>;
+  using RawType = typename L::RawType;
+  using Codec = typename L::template Codec<I>;
+  using FieldType = typename L::FieldType;
+  constexpr std::size_t W = L::template bits<I>();
+
+  auto A = std::make_unique<ArrowArrayData>();
+  auto S = std::make_unique<ArrowSchemaData>();
+  S->Name = arrowName<BitFieldT, I>(Names);
+  std::int64_t NullCount = 0;
+  // validity bitmap, absent without nulls
+  A->BufferPtrs.push_back(nullptr);
+
+  if constexpr (!std::is_void_v<Codec>) {
+    // decoded values, e.g. of fixed-point or half-precision fields
+    using ValueType = typename Codec::ValueType;
+    static_assert(std::is_floating_point_v<ValueType>,
+                  "values of the codec must be floating-point numbers");
+    S->Format = sizeof(ValueType) == 4 ? "f" : "g";
+    A->Buffers.push_back(allocateArrow(N * sizeof(ValueType)));
+    A->BufferPtrs.push_back(A->Buffers.back().get());
+    decodeColumnByIndex<I>(
+        Records, N, reinterpret_cast<ValueType *>(A->Buffers.back().get()));
+  } else if constexpr (HasArrowEnumNames<FieldType>::value) {
+    // indices into the names of the enumerators, and nulls out of range
+    using IndexT = ArrowInt<W + 1, true>;
+    constexpr std::size_t K = std::size(ArrowEnumNames<FieldType>::Names);
+    S->Format = arrowIntFormat<IndexT>();
+    A->Buffers.push_back(allocateArrow(N * sizeof(IndexT)));
+    A->BufferPtrs.push_back(A->Buffers.back().get());
+    auto *Index = reinterpret_cast<IndexT *>(A->Buffers.back().get());
+    ArrowBuffer Valid = allocateArrow((N + 7) / 8);
+    RawType Buf[ColumnTile];
+    for (std::size_t B = 0; B < N; B += ColumnTile) {
+      const std::size_t Len = std::min(ColumnTile, N - B);
+      extractRaw<I>(Records + B, Len, Buf);
+      for (std::size_t J = 0; J < Len; ++J) {
+        const bool In = static_cast<std::uint64_t>(Buf[J]) < K;
+        Index[B + J] = In ? static_cast<IndexT>(Buf[J]) : IndexT{0};
+        Valid[(B + J) / 8] |= static_cast<unsigned char>(In << (B + J) % 8);
+        NullCount += !In;
+      }
+    }
+    if (NullCount != 0) {
+      A->BufferPtrs[0] = Valid.get();
+      A->Buffers.push_back(std::move(Valid));
+    }
+
+    auto DA = std::make_unique<ArrowArrayData>();
+    auto DS = std::make_unique<ArrowSchemaData>();
+    DS->Format = "u";
+    std::size_t Chars = 0;
+    for (const char *Name : ArrowEnumNames<FieldType>::Names) {
+      Chars += std::strlen(Name);
+    }
+    ArrowBuffer Offsets = allocateArrow((K + 1) * sizeof(std::int32_t));
+    ArrowBuffer Data = allocateArrow(Chars);
+    auto *O = reinterpret_cast<std::int32_t *>(Offsets.get());
+    std::size_t Pos = 0;
+    for (std::size_t J = 0; J < K; ++J) {
+      const char *Name = ArrowEnumNames<FieldType>::Names[J];
+      const std::size_t Len = std::strlen(Name);
+      std::memcpy(Data.get() + Pos, Name, Len);
+      O[J] = static_cast<std::int32_t>(Pos);
+      Pos += Len;
+    }
+    O[K] = static_cast<std::int32_t>(Pos);
+    DA->BufferPtrs = {nullptr, Offsets.get(), Data.get()};
+    DA->Buffers.push_back(std::move(Offsets));
+    DA->Buffers.push_back(std::move(Data));
+    A->Dictionary = std::make_unique<ArrowArray>();
+    S->Dictionary = std::make_unique<ArrowSchema>();
+    ArrowArrayData::publish(std::move(DA), A->Dictionary.get(),
+                            static_cast<std::int64_t>(K), 0);
+    ArrowSchemaData::publish(std::move(DS), S->Dictionary.get(),
+                             ARROW_FLAG_NULLABLE);
+  } else if constexpr (W == 1 && !std::is_enum_v<FieldType>) {
+    // bitmap in LSB order
+    S->Format = "b";
+    A->Buffers.push_back(allocateArrow((N + 7) / 8));
+    A->BufferPtrs.push_back(A->Buffers.back().get());
+    unsigned char *Bits = A->Buffers.back().get();
+    RawType Buf[ColumnTile];
+    for (std::size_t B = 0; B < N; B += ColumnTile) {
+      const std::size_t Len = std::min(ColumnTile, N - B);
+      extractRaw<I>(Records + B, Len, Buf);
+      for (std::size_t J = 0; J < Len; ++J) {
+        Bits[(B + J) / 8] |=
+            static_cast<unsigned char>((Buf[J] & 1) << (B + J) % 8);
+      }
+    }
+  } else {
+    using UnderlyingType = typename L::UnderlyingType;
+    using ValueType = ArrowInt<W, std::is_signed_v<UnderlyingType>>;
+    S->Format = arrowIntFormat<ValueType>();
+    A->Buffers.push_back(allocateArrow(N * sizeof(ValueType)));
+    A->BufferPtrs.push_back(A->Buffers.back().get());
+    auto *Out = reinterpret_cast<ValueType *>(A->Buffers.back().get());
+    if constexpr (std::is_enum_v<FieldType>) {
+      RawType Buf[ColumnTile];
+      for (std::size_t B = 0; B < N; B += ColumnTile) {
+        const std::size_t Len = std::min(ColumnTile, N - B);
+        extractRaw<I>(Records + B, Len, Buf);
+        std::copy(Buf, Buf + Len, Out + B);
+      }
+    } else {
+      extractColumnByIndex<I>(Records, N, Out);
+    }
+  }
+  ArrowArrayData::publish(std::move(A), Array, static_cast<std::int64_t>(N),
+                          NullCount);
+  ArrowSchemaData::publish(std::move(S), Schema,
+                           NullCount != 0 ? ARROW_FLAG_NULLABLE : 0);
+}
+
+/// Export N records as a struct array whose children are the fields.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT, std::size_t... I>
+void exportArrowRecords(const BitFieldT *Records, std::size_t N,
+                        const char *const *Names, ArrowArray *Array,
+                        ArrowSchema *Schema, std::index_sequence<I...>) {
+  constexpr std::size_t NChildren =
+      (std::size_t{0} + ... + !arrowPadding<BitFieldT, I>());
+  auto A = std::make_unique<ArrowArrayData>();
+  auto S = std::make_unique<ArrowSchemaData>();
+  A->BufferPtrs.push_back(nullptr);
+  A->Children.resize(NChildren);
+  S->Children.resize(NChildren);
+  S->Format = "+s";
+  std::size_t K = 0;
+  try {
+    (
+        [&] {
+          if constexpr (!arrowPadding<BitFieldT, I>()) {
+            exportArrowField<I>(Records, N, Names, &A->Children[K],
+                                &S->Children[K]);
+            ++K;
+          }
+        }(),
+        ...);
+  } catch (...) {
+    for (std::size_t J = 0; J < K; ++J) {
+      A->Children[J].release(&A->Children[J]);
+      S->Children[J].release(&S->Children[J]);
+    }
+    throw;
+  }
+  ArrowArrayData::publish(std::move(A), Array, static_cast<std::int64_t>(N),
+                          0);
+  ArrowSchemaData::publish(std::move(S), Schema, 0);
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Export N records through the Arrow C Data Interface, as a struct array
+/// whose children are the fields except paddings, named by the tags.
+///
+/// Integer fields are exported as the narrowest Arrow integers, 1-bit fields
+/// as boolean bitmaps, fields with a value codec as floating-point numbers,
+/// and fields of enum types with ArrowEnumNames as dictionary arrays of
+/// strings. The buffers are owned by Array, and released by its release
+/// callback.
+///
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Array Arrow array to be filled.
+/// \param Schema Arrow schema to be filled.
+template <class... Args,
+          std::enable_if_t<!std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void exportArrow(const BitField<Args...> *Records, std::size_t N,
+                 ArrowArray *Array, ArrowSchema *Schema) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::exportArrowRecords(Records, N, nullptr, Array, Schema,
+                           std::make_index_sequence<L::NFields>());
+}
+#endif
+
+/// Export N records through the Arrow C Data Interface, as a struct array
+/// whose children are the fields except paddings.
+///
+/// Integer fields are exported as the narrowest Arrow integers, 1-bit fields
+/// as boolean bitmaps, fields with a value codec as floating-point numbers,
+/// and fields of enum types with ArrowEnumNames as dictionary arrays of
+/// strings. The buffers are owned by Array, and released by its release
+/// callback.
+///
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Array Arrow array to be filled.
+/// \param Schema Arrow schema to be filled.
+/// \param Names Names of the fields indexed by the values of the tags, or
+/// nullptr to name the fields by the decimal values of the tags.
+///
+/// \code
+///   enum class Tag { Len, Flag };
+///   using R = BitField<std::uint32_t, Field<Tag::Len, 12>,
+///                      Field<Tag::Flag, 1>>;
+///   const char *Names[] = {"len", "flag"};
+///   ArrowArray Array;
+///   ArrowSchema Schema;
+///   exportArrow(Records.data(), Records.size(), &Array, &Schema, Names);
+///   // hand over, e.g. pyarrow.RecordBatch._import_from_c(...)
+/// \endcode
+template <class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void exportArrow(const BitField<Args...> *Records, std::size_t N,
+                 ArrowArray *Array, ArrowSchema *Schema,
+                 const char *const *Names = nullptr) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::exportArrowRecords(Records, N, Names, Array, Schema,
+                           std::make_index_sequence<L::NFields>());
+}
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,606 @@
+//===-- Bitwise.hpp - Bitwise operations on whole records -------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains bitwise operations between whole BitField records and
+/// between arrays of them. The operations work on storage units at once and
+/// keep the results canonical: bits out of the fields and padding bits are
+/// zero, const-qualified fields hold their default values, and the guarded
+/// field, if any, is recomputed. Records from elsewhere are brought into the
+/// same canonical form by canonicalize.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_BITWISE_HPP
+#define ORDERED_BIT_FIELD_BITWISE_HPP
+
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Masks of the storage units of records.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class BitFieldT> struct UnitMasks {
+  using L = Layout<BitFieldT>;
+  using RawType = typename L::RawType;
+  using Units = std::array<RawType, L::DataSize>;
+
+  template <std::size_t... I>
+  static constexpr Units valueMask(std::index_sequence<I...>) {
+    Units M{};
+    ((M[L::template word<I>()] |=
+      L::template fixed<I>() ? RawType{} : L::template mask<I>()),
+     ...);
+    return M;
+  }
+
+  template <std::size_t... I>
+  static constexpr Units fixedMask(std::index_sequence<I...>) {
+    Units M{};
+    ((M[L::template word<I>()] |= L::template fixed<I>() && I != L::GuardIndex
+                                      ? L::template mask<I>()
+                                      : RawType{}),
+     ...);
+    return M;
+  }
+
+  static constexpr Units guardMask() {
+    Units M{};
+    if constexpr (L::GuardIndex < L::NFields) {
+      M[L::template word<L::GuardIndex>()] = L::template mask<L::GuardIndex>();
+    }
+    return M;
+  }
+
+  static constexpr Units fixedImage() {
+    constexpr Units M = fixedMask(std::make_index_sequence<L::NFields>());
+    Units F{};
+    for (std::size_t W = 0; W < L::DataSize; ++W) {
+      F[W] = static_cast<RawType>(
+          static_cast<RawType>(
+              static_cast<typename L::UnderlyingType>(L::DefaultData[W])) &
+          M[W]);
+    }
+    return F;
+  }
+
+  static constexpr Units canonicalMask() {
+    Units M{};
+    for (std::size_t W = 0; W < L::DataSize; ++W) {
+      M[W] = static_cast<RawType>(Value[W] | Guarded[W]);
+    }
+    return M;
+  }
+
+  /// Bits of the fields which are not const-qualified.
+  static constexpr Units Value =
+      valueMask(std::make_index_sequence<L::NFields>());
+
+  /// Bits of the guarded field.
+  static constexpr Units Guarded = guardMask();
+
+  /// Default bits of the const-qualified fields except the guarded field.
+  static constexpr Units Fixed = fixedImage();
+
+  /// Bits kept by canonicalization: the fields which are not
+  /// const-qualified and the guarded field.
+  static constexpr Units Canonical = canonicalMask();
+};
+
+/// Repeat the units of a record over P bytes.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t P, class UnitsT>
+void repeatUnits(const UnitsT &Units, unsigned char *Out) {
+  for (std::size_t K = 0; K < P; K += sizeof(UnitsT)) {
+    std::memcpy(Out + K, Units.data(), sizeof(UnitsT));
+  }
+}
+
+/// Size in bytes of the period of unit masks of the records, which is
+/// processed by 256-bit vectors.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT> constexpr std::size_t maskPeriod() {
+  constexpr std::size_t Size = sizeof(BitFieldT);
+  static_assert(Size == sizeof(typename UnitMasks<BitFieldT>::Units),
+                "records must not have padding");
+  return Size / std::gcd(Size, std::size_t{32}) * 32;
+}
+
+/// Bitwise AND.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct AndOp {
+  static constexpr BitwiseKind Kind = BitwiseKind::And;
+  template <class T> static constexpr T apply(T A, T B) {
+    return static_cast<T>(A & B);
+  }
+#if defined(__AVX2__)
+  static __m256i apply(__m256i A, __m256i B) { return _mm256_and_si256(A, B); }
+#endif
+};
+
+/// Bitwise OR.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct OrOp {
+  static constexpr BitwiseKind Kind = BitwiseKind::Or;
+  template <class T> static constexpr T apply(T A, T B) {
+    return static_cast<T>(A | B);
+  }
+#if defined(__AVX2__)
+  static __m256i apply(__m256i A, __m256i B) { return _mm256_or_si256(A, B); }
+#endif
+};
+
+/// Bitwise XOR.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct XorOp {
+  static constexpr BitwiseKind Kind = BitwiseKind::Xor;
+  template <class T> static constexpr T apply(T A, T B) {
+    return static_cast<T>(A ^ B);
+  }
+#if defined(__AVX2__)
+  static __m256i apply(__m256i A, __m256i B) { return _mm256_xor_si256(A, B); }
+#endif
+};
+
+/// A & ~B.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct AndNotOp {
+  static constexpr BitwiseKind Kind = BitwiseKind::AndNot;
+  template <class T> static constexpr T apply(T A, T B) {
+    return static_cast<T>(A & ~B);
+  }
+#if defined(__AVX2__)
+  static __m256i apply(__m256i A, __m256i B) {
+    return _mm256_andnot_si256(B, A);
+  }
+#endif
+};
+
+/// The first operand.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct FirstOp {
+  static constexpr BitwiseKind Kind = BitwiseKind::First;
+  template <class T> static constexpr T apply(T A, T) { return A; }
+};
+
+/// Bitwise NOT of the first operand.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct NotOp {
+  static constexpr BitwiseKind Kind = BitwiseKind::Not;
+  template <class T> static constexpr T apply(T A, T) {
+    return static_cast<T>(~A);
+  }
+#if defined(__AVX2__)
+  static __m256i apply(__m256i A, __m256i) {
+    return _mm256_xor_si256(A, _mm256_set1_epi32(-1));
+  }
+#endif
+};
+
+/// Out = (Op(A, B) & Keep) | Set for the storage units of a record. Out may
+/// be A or B.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class Op, class BitFieldT, class UnitsT>
+constexpr void maskedRecord(const BitFieldT &A, const BitFieldT &B,
+                            BitFieldT &Out, const UnitsT &Keep,
+                            const UnitsT &Set) {
+  using L = Layout<BitFieldT>;
+  using RawType = typename L::RawType;
+  using UnderlyingType = typename L::UnderlyingType;
+  for (std::size_t W = 0; W < L::DataSize; ++W) {
+    const auto V =
+        Op::apply(static_cast<RawType>(static_cast<UnderlyingType>(A.Data[W])),
+                  static_cast<RawType>(static_cast<UnderlyingType>(B.Data[W])));
+    Out.Data[W] = static_cast<typename L::FieldType>(static_cast<UnderlyingType>(
+        static_cast<RawType>((V & Keep[W]) | Set[W])));
+  }
+}
+
+/// Out = (Op(A, B) & Keep) | Set for the storage units of N records. The
+/// masks repeat every lcm(sizeof(record), 32) bytes, so that the units are
+/// processed by 256-bit vectors regardless of the record boundaries.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class Op, class BitFieldT, class UnitsT>
+void maskedArray(const BitFieldT *A, const BitFieldT *B, BitFieldT *Out,
+                 std::size_t N, const UnitsT &Keep, const UnitsT &Set) {
+  std::size_t I = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+  constexpr std::size_t P = maskPeriod<BitFieldT>();
+  if constexpr (P <= 256) {
+    alignas(32) unsigned char KeepBytes[P];
+    alignas(32) unsigned char SetBytes[P];
+    repeatUnits<P>(Keep, KeepBytes);
+    repeatUnits<P>(Set, SetBytes);
+    constexpr std::size_t Step = P / sizeof(BitFieldT);
+    I = N / Step * Step;
+    kernels().MaskedBytes(Op::Kind, reinterpret_cast<const unsigned char *>(A),
+                          reinterpret_cast<const unsigned char *>(B),
+                          reinterpret_cast<unsigned char *>(Out),
+                          I * sizeof(BitFieldT), P, KeepBytes, SetBytes);
+  }
+#elif defined(__AVX2__)
+  constexpr std::size_t P = maskPeriod<BitFieldT>();
+  if constexpr (P <= 256) {
+    alignas(32) unsigned char KeepBytes[P];
+    alignas(32) unsigned char SetBytes[P];
+    repeatUnits<P>(Keep, KeepBytes);
+    repeatUnits<P>(Set, SetBytes);
+    __m256i KM[P / 32];
+    __m256i SM[P / 32];
+    for (std::size_t J = 0; J < P / 32; ++J) {
+      KM[J] =
+          _mm256_load_si256(reinterpret_cast<const __m256i *>(KeepBytes) + J);
+      SM[J] = _mm256_load_si256(reinterpret_cast<const __m256i *>(SetBytes) + J);
+    }
+    const auto *X = reinterpret_cast<const unsigned char *>(A);
+    const auto *Y = reinterpret_cast<const unsigned char *>(B);
+    auto *Z = reinterpret_cast<unsigned char *>(Out);
+    constexpr std::size_t Step = P / sizeof(BitFieldT);
+    for (; I + Step <= N; I += Step) {
+      const std::size_t K = I * sizeof(BitFieldT);
+      for (std::size_t J = 0; J < P / 32; ++J) {
+        const __m256i V = Op::apply(
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(X + K + J * 32)),
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(Y + K + J * 32)));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(Z + K + J * 32),
+            _mm256_or_si256(_mm256_and_si256(V, KM[J]), SM[J]));
+      }
+    }
+  }
+#endif
+
+  for (; I < N; ++I) {
+    maskedRecord<Op>(A[I], B[I], Out[I], Keep, Set);
+  }
+}
+
+/// Apply Op to the storage units of A and B and canonicalize the result into
+/// Out, which may be A or B. The guarded field is recomputed.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class Op, class BitFieldT>
+constexpr void bitwiseRecord(const BitFieldT &A, const BitFieldT &B,
+                             BitFieldT &Out) {
+  using L = Layout<BitFieldT>;
+  using M = UnitMasks<BitFieldT>;
+  maskedRecord<Op>(A, B, Out, M::Value, M::Fixed);
+  if constexpr (L::GuardIndex < L::NFields) {
+    L::Guard::template initialize<BitFieldT, L::GuardIndex>(Out.Data.data());
+  }
+}
+
+/// Apply Op to N pairs of records and canonicalize the results. The guarded
+/// field is recomputed.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class Op, class BitFieldT>
+void bitwiseArray(const BitFieldT *A, const BitFieldT *B, BitFieldT *Out,
+                  std::size_t N) {
+  using L = Layout<BitFieldT>;
+  using M = UnitMasks<BitFieldT>;
+  maskedArray<Op>(A, B, Out, N, M::Value, M::Fixed);
+  if constexpr (L::GuardIndex < L::NFields) {
+    for (std::size_t I = 0; I < N; ++I) {
+      L::Guard::template initialize<BitFieldT, L::GuardIndex>(
+          Out[I].Data.data());
+    }
+  }
+}
+
+/// Whether the storage units of a record are canonical or not.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT>
+constexpr bool isCanonicalRecord(const BitFieldT &BF) {
+  using L = Layout<BitFieldT>;
+  using M = UnitMasks<BitFieldT>;
+  using RawType = typename L::RawType;
+  for (std::size_t W = 0; W < L::DataSize; ++W) {
+    const auto U =
+        static_cast<RawType>(static_cast<typename L::UnderlyingType>(BF.Data[W]));
+    if (static_cast<RawType>(U & ~M::Canonical[W]) != M::Fixed[W]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Whether the storage units of N records are canonical or not.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT>
+bool isCanonicalArray(const BitFieldT *Records, std::size_t N) {
+  std::size_t I = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+  using M = UnitMasks<BitFieldT>;
+  constexpr std::size_t P = maskPeriod<BitFieldT>();
+  if constexpr (P <= 256) {
+    alignas(32) unsigned char KeepBytes[P];
+    alignas(32) unsigned char SetBytes[P];
+    repeatUnits<P>(M::Canonical, KeepBytes);
+    repeatUnits<P>(M::Fixed, SetBytes);
+    constexpr std::size_t Step = P / sizeof(BitFieldT);
+    I = N / Step * Step;
+    if (!kernels().MatchBytes(reinterpret_cast<const unsigned char *>(Records),
+                              I * sizeof(BitFieldT), P, KeepBytes,
+                              SetBytes)) {
+      return false;
+    }
+  }
+#elif defined(__AVX2__)
+  using M = UnitMasks<BitFieldT>;
+  constexpr std::size_t P = maskPeriod<BitFieldT>();
+  if constexpr (P <= 256) {
+    alignas(32) unsigned char KeepBytes[P];
+    alignas(32) unsigned char SetBytes[P];
+    repeatUnits<P>(M::Canonical, KeepBytes);
+    repeatUnits<P>(M::Fixed, SetBytes);
+    __m256i KM[P / 32];
+    __m256i SM[P / 32];
+    for (std::size_t J = 0; J < P / 32; ++J) {
+      KM[J] =
+          _mm256_load_si256(reinterpret_cast<const __m256i *>(KeepBytes) + J);
+      SM[J] = _mm256_load_si256(reinterpret_cast<const __m256i *>(SetBytes) + J);
+    }
+    const auto *X = reinterpret_cast<const unsigned char *>(Records);
+    constexpr std::size_t Step = P / sizeof(BitFieldT);
+    for (; I + Step <= N; I += Step) {
+      const std::size_t K = I * sizeof(BitFieldT);
+      __m256i Diff = _mm256_setzero_si256();
+      for (std::size_t J = 0; J < P / 32; ++J) {
+        const __m256i V = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(X + K + J * 32));
+        Diff = _mm256_or_si256(
+            Diff, _mm256_xor_si256(_mm256_andnot_si256(KM[J], V), SM[J]));
+      }
+      if (!_mm256_testz_si256(Diff, Diff)) {
+        return false;
+      }
+    }
+  }
+#endif
+
+  for (; I < N; ++I) {
+    if (!isCanonicalRecord(Records[I])) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace Util
+
+/// Bitwise AND of two records. Bits out of the fields and padding bits are
+/// zero, const-qualified fields hold their default values, and the guarded
+/// field is recomputed.
+template <class... Args>
+constexpr BitField<Args...> operator&(const BitField<Args...> &Lhs,
+                                      const BitField<Args...> &Rhs) {
+  BitField<Args...> R = Lhs;
+  Util::bitwiseRecord<Util::AndOp>(R, Rhs, R);
+  return R;
+}
+
+/// Bitwise OR of two records. Bits out of the fields and padding bits are
+/// zero, const-qualified fields hold their default values, and the guarded
+/// field is recomputed.
+template <class... Args>
+constexpr BitField<Args...> operator|(const BitField<Args...> &Lhs,
+                                      const BitField<Args...> &Rhs) {
+  BitField<Args...> R = Lhs;
+  Util::bitwiseRecord<Util::OrOp>(R, Rhs, R);
+  return R;
+}
+
+/// Bitwise XOR of two records. Bits out of the fields and padding bits are
+/// zero, const-qualified fields hold their default values, and the guarded
+/// field is recomputed.
+template <class... Args>
+constexpr BitField<Args...> operator^(const BitField<Args...> &Lhs,
+                                      const BitField<Args...> &Rhs) {
+  BitField<Args...> R = Lhs;
+  Util::bitwiseRecord<Util::XorOp>(R, Rhs, R);
+  return R;
+}
+
+/// Bitwise NOT of the fields of a record which are not const-qualified. Bits
+/// out of the fields and padding bits are zero, const-qualified fields hold
+/// their default values, and the guarded field is recomputed.
+template <class... Args>
+constexpr BitField<Args...> operator~(const BitField<Args...> &BF) {
+  BitField<Args...> R = BF;
+  Util::bitwiseRecord<Util::NotOp>(R, BF, R);
+  return R;
+}
+
+/// Lhs & ~Rhs of two records, e.g. revocation of permission bits. Bits out
+/// of the fields and padding bits are zero, const-qualified fields hold their
+/// default values, and the guarded field is recomputed.
+template <class... Args>
+constexpr BitField<Args...> andNot(const BitField<Args...> &Lhs,
+                                   const BitField<Args...> &Rhs) {
+  BitField<Args...> R = Lhs;
+  Util::bitwiseRecord<Util::AndNotOp>(R, Rhs, R);
+  return R;
+}
+
+/// Bitwise AND assignment of records.
+template <class... Args>
+constexpr BitField<Args...> &operator&=(BitField<Args...> &Lhs,
+                                        const BitField<Args...> &Rhs) {
+  Util::bitwiseRecord<Util::AndOp>(Lhs, Rhs, Lhs);
+  return Lhs;
+}
+
+/// Bitwise OR assignment of records.
+template <class... Args>
+constexpr BitField<Args...> &operator|=(BitField<Args...> &Lhs,
+                                        const BitField<Args...> &Rhs) {
+  Util::bitwiseRecord<Util::OrOp>(Lhs, Rhs, Lhs);
+  return Lhs;
+}
+
+/// Bitwise XOR assignment of records.
+template <class... Args>
+constexpr BitField<Args...> &operator^=(BitField<Args...> &Lhs,
+                                        const BitField<Args...> &Rhs) {
+  Util::bitwiseRecord<Util::XorOp>(Lhs, Rhs, Lhs);
+  return Lhs;
+}
+
+/// Out[i] = A[i] & B[i] for N records. Out may be A or B.
+///
+/// \param A Pointer to the first record of the left operands.
+/// \param B Pointer to the first record of the right operands.
+/// \param Out Pointer to the first record of the results.
+/// \param N Number of records.
+template <class... Args>
+void bitwiseAnd(const BitField<Args...> *A, const BitField<Args...> *B,
+                BitField<Args...> *Out, std::size_t N) {
+  Util::bitwiseArray<Util::AndOp>(A, B, Out, N);
+}
+
+/// Out[i] = A[i] | B[i] for N records. Out may be A or B.
+///
+/// \param A Pointer to the first record of the left operands.
+/// \param B Pointer to the first record of the right operands.
+/// \param Out Pointer to the first record of the results.
+/// \param N Number of records.
+template <class... Args>
+void bitwiseOr(const BitField<Args...> *A, const BitField<Args...> *B,
+               BitField<Args...> *Out, std::size_t N) {
+  Util::bitwiseArray<Util::OrOp>(A, B, Out, N);
+}
+
+/// Out[i] = A[i] ^ B[i] for N records. Out may be A or B.
+///
+/// \param A Pointer to the first record of the left operands.
+/// \param B Pointer to the first record of the right operands.
+/// \param Out Pointer to the first record of the results.
+/// \param N Number of records.
+template <class... Args>
+void bitwiseXor(const BitField<Args...> *A, const BitField<Args...> *B,
+                BitField<Args...> *Out, std::size_t N) {
+  Util::bitwiseArray<Util::XorOp>(A, B, Out, N);
+}
+
+/// Out[i] = ~A[i] for N records. Out may be A.
+///
+/// \param A Pointer to the first record of the operands.
+/// \param Out Pointer to the first record of the results.
+/// \param N Number of records.
+template <class... Args>
+void bitwiseNot(const BitField<Args...> *A, BitField<Args...> *Out,
+                std::size_t N) {
+  Util::bitwiseArray<Util::NotOp>(A, A, Out, N);
+}
+
+/// Out[i] = A[i] & ~B[i] for N records. Out may be A or B.
+///
+/// \param A Pointer to the first record of the left operands.
+/// \param B Pointer to the first record of the right operands.
+/// \param Out Pointer to the first record of the results.
+/// \param N Number of records.
+///
+/// \code
+///   // revoke the permissions of Revoked[i] from Users[i]
+///   andNot(Users.data(), Revoked.data(), Users.data(), Users.size());
+/// \endcode
+template <class... Args>
+void andNot(const BitField<Args...> *A, const BitField<Args...> *B,
+            BitField<Args...> *Out, std::size_t N) {
+  Util::bitwiseArray<Util::AndNotOp>(A, B, Out, N);
+}
+
+/// Canonicalize a record, e.g. one received from another system, so that
+/// records can be compared, hashed and deduplicated by their raw bytes. Bits
+/// out of the fields and padding bits are cleared, and const-qualified fields
+/// are reset to their default values. The guarded field is kept as it is.
+///
+/// \code
+///   std::fread(&Record, sizeof(Record), 1, File);
+///   canonicalize(Record);
+///   bool Same = std::memcmp(&Record, &Known, sizeof(Record)) == 0;
+/// \endcode
+template <class... Args> constexpr void canonicalize(BitField<Args...> &BF) {
+  using M = Util::UnitMasks<BitField<Args...>>;
+  Util::maskedRecord<Util::FirstOp>(BF, BF, BF, M::Canonical, M::Fixed);
+}
+
+/// Canonicalize N records.
+///
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+template <class... Args>
+void canonicalize(BitField<Args...> *Records, std::size_t N) {
+  using M = Util::UnitMasks<BitField<Args...>>;
+  Util::maskedArray<Util::FirstOp>(Records, Records, Records, N, M::Canonical,
+                                   M::Fixed);
+}
+
+/// Whether a record is canonical or not, i.e. canonicalize would not change
+/// it. Records built through proxy objects are always canonical.
+template <class... Args>
+constexpr bool isCanonical(const BitField<Args...> &BF) {
+  return Util::isCanonicalRecord(BF);
+}
+
+/// Whether all of N records are canonical or not.
+///
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+template <class... Args>
+bool isCanonical(const BitField<Args...> *Records, std::size_t N) {
+  return Util::isCanonicalArray(Records, N);
+}
+} // namespace OrderedBitField
+
+#endif
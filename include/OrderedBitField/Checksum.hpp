@@ -0,0 +1,332 @@
+//===-- Checksum.hpp - Ones' complement checksum field ----------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a checksum field descriptor, whose value is the 16-bit
+/// ones' complement checksum (RFC 1071) of the whole record. Writes through
+/// proxy objects update the checksum incrementally (RFC 1624).
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_CHECKSUM_HPP
+#define ORDERED_BIT_FIELD_CHECKSUM_HPP
+
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Fold a sum of 16-bit words into 16 bits with end-around carry.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint16_t foldSum(std::uint64_t S) {
+  while (S >> 16) {
+    S = (S & 0xffff) + (S >> 16);
+  }
+  return static_cast<std::uint16_t>(S);
+}
+
+/// Sum of the 16-bit words of a storage unit (not folded).
+///
+/// Since the ones' complement sum does not depend on the order of the words,
+/// the result agrees with the sum over the 16-bit words in memory regardless
+/// of the byte order.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class RawT> constexpr std::uint64_t wordSum(RawT V) {
+  std::uint64_t S = 0;
+  for (std::size_t B = 0; B < sizeof(RawT) * 8; B += 16) {
+    S += static_cast<std::uint64_t>(V) >> B & 0xffff;
+  }
+  return S;
+}
+
+#if defined(__AVX2__)
+/// Sums of the 16-bit halves of 32-bit words at P, in lanes of 32 bits.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline __m256i halfSums(const char *P) {
+  const __m256i V = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(P));
+  return _mm256_add_epi32(_mm256_and_si256(V, _mm256_set1_epi32(0xffff)),
+                          _mm256_srli_epi32(V, 16));
+}
+
+/// Sums of the 16-bit halves of 8 contiguous records of W 32-bit words each
+/// (not folded), one lane per record.
+///
+/// Records whose words fill whole vectors (W is 1, 2, 4 or a multiple of 8)
+/// are read by contiguous loads and reduced with horizontal additions. The
+/// others straddle vectors, so that the words are gathered with the stride of
+/// the records instead.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t W> __m256i recordSums8(const char *P) {
+  if constexpr (W == 1) {
+    return halfSums(P);
+  } else if constexpr (W == 2) {
+    // [r0 r1 r4 r5 | r2 r3 r6 r7] in 64-bit pairs
+    const __m256i S = _mm256_hadd_epi32(halfSums(P), halfSums(P + 32));
+    return _mm256_permute4x64_epi64(S, 0b11'01'10'00);
+  } else if constexpr (W == 4) {
+    // [r0 r2 r4 r6 | r1 r3 r5 r7]
+    const __m256i A = _mm256_hadd_epi32(halfSums(P), halfSums(P + 32));
+    const __m256i B = _mm256_hadd_epi32(halfSums(P + 64), halfSums(P + 96));
+    return _mm256_permutevar8x32_epi32(
+        _mm256_hadd_epi32(A, B), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+  } else if constexpr (W % 8 == 0) {
+    __m256i H[8];
+    for (std::size_t R = 0; R < 8; ++R) {
+      H[R] = _mm256_setzero_si256();
+      for (std::size_t B = 0; B < W * 4; B += 32) {
+        H[R] = _mm256_add_epi32(H[R], halfSums(P + R * W * 4 + B));
+      }
+    }
+    // low and high 128-bit halves of r0..r3 and r4..r7
+    const __m256i E = _mm256_hadd_epi32(_mm256_hadd_epi32(H[0], H[1]),
+                                        _mm256_hadd_epi32(H[2], H[3]));
+    const __m256i F = _mm256_hadd_epi32(_mm256_hadd_epi32(H[4], H[5]),
+                                        _mm256_hadd_epi32(H[6], H[7]));
+    return _mm256_add_epi32(_mm256_permute2x128_si256(E, F, 0x20),
+                            _mm256_permute2x128_si256(E, F, 0x31));
+  } else {
+    const auto Size = static_cast<int>(W * 4);
+    const __m256i Index =
+        _mm256_setr_epi32(0, Size, 2 * Size, 3 * Size, 4 * Size, 5 * Size,
+                          6 * Size, 7 * Size);
+    const __m256i Low = _mm256_set1_epi32(0xffff);
+    __m256i S = _mm256_setzero_si256();
+    for (std::size_t B = 0; B < W * 4; B += 4) {
+      const __m256i V = _mm256_i32gather_epi32(
+          reinterpret_cast<const int *>(P + B), Index, 1);
+      S = _mm256_add_epi32(S, _mm256_and_si256(V, Low));
+      S = _mm256_add_epi32(S, _mm256_srli_epi32(V, 16));
+    }
+    return S;
+  }
+}
+#endif
+
+/// Guard policy for a 16-bit ones' complement checksum over the record.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct OnesComplementChecksum {
+  template <class BitFieldT, std::size_t I> static constexpr void check() {
+    using L = Layout<BitFieldT>;
+    static_assert(L::FieldTypeBits % 16 == 0,
+                  "checksum needs a base type of a multiple of 16 bits");
+    static_assert(L::template shift<I>() % 16 == 0,
+                  "checksum field must be aligned to 16 bits");
+  }
+
+  /// Checksum of the record, regarding the checksum field as zero.
+  template <class BitFieldT, std::size_t I>
+  static constexpr std::uint16_t
+  compute(const typename Layout<BitFieldT>::FieldType *Units) {
+    using L = Layout<BitFieldT>;
+    using RawType = typename L::RawType;
+    check<BitFieldT, I>();
+    std::uint64_t S = 0;
+    for (std::size_t W = 0; W < L::DataSize; ++W) {
+      auto V = static_cast<RawType>(
+          static_cast<typename L::UnderlyingType>(Units[W]));
+      if (W == L::template word<I>()) {
+        V &= static_cast<RawType>(~L::template mask<I>());
+      }
+      S += wordSum(V);
+    }
+    return static_cast<std::uint16_t>(~foldSum(S));
+  }
+
+  template <class BitFieldT, std::size_t I>
+  static constexpr void
+  initialize(typename Layout<BitFieldT>::FieldType *Units) {
+    store<BitFieldT, I>(Units, compute<BitFieldT, I>(Units));
+  }
+
+  template <class BitFieldT, std::size_t I, std::size_t Word>
+  static constexpr void update(typename Layout<BitFieldT>::FieldType *Units,
+                               typename Layout<BitFieldT>::FieldType Old) {
+    using L = Layout<BitFieldT>;
+    using RawType = typename L::RawType;
+    check<BitFieldT, I>();
+    const auto M = static_cast<RawType>(
+        static_cast<typename L::UnderlyingType>(Old));
+    const auto N = static_cast<RawType>(
+        static_cast<typename L::UnderlyingType>(Units[Word]));
+    // RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m')
+    const std::uint64_t S =
+        static_cast<std::uint16_t>(~load<BitFieldT, I>(Units)) +
+        wordSum(static_cast<RawType>(~M)) + wordSum(N);
+    const std::uint16_t F = foldSum(S);
+    // The sum folds to -0 (0xffff) either if the other words sum to -0 or if
+    // they are all +0, whose checksum must be 0xffff. Resolve it from scratch.
+    store<BitFieldT, I>(Units, F == 0xffff
+                                   ? compute<BitFieldT, I>(Units)
+                                   : static_cast<std::uint16_t>(~F));
+  }
+
+private:
+  template <class BitFieldT, std::size_t I>
+  static constexpr std::uint16_t
+  load(const typename Layout<BitFieldT>::FieldType *Units) {
+    using L = Layout<BitFieldT>;
+    return static_cast<std::uint16_t>(
+        (static_cast<typename L::RawType>(
+             static_cast<typename L::UnderlyingType>(
+                 Units[L::template word<I>()])) &
+         L::template mask<I>()) >>
+        L::template shift<I>());
+  }
+
+  template <class BitFieldT, std::size_t I>
+  static constexpr void store(typename Layout<BitFieldT>::FieldType *Units,
+                              std::uint16_t V) {
+    using L = Layout<BitFieldT>;
+    using RawType = typename L::RawType;
+    auto &U = Units[L::template word<I>()];
+    U = static_cast<typename L::FieldType>(
+        static_cast<typename L::UnderlyingType>(
+            (static_cast<RawType>(static_cast<typename L::UnderlyingType>(U)) &
+             static_cast<RawType>(~L::template mask<I>())) |
+            static_cast<RawType>(static_cast<RawType>(V)
+                                 << L::template shift<I>())));
+  }
+};
+
+/// Ensure that the record has a checksum field.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT> constexpr void requireChecksum() {
+  static_assert(
+      std::is_same_v<typename Layout<BitFieldT>::Guard, OnesComplementChecksum>,
+      "record has no checksum field");
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+inline namespace RefByStr {
+/// Bit field descriptor for 16-bit ones' complement checksum of the record.
+///
+/// The field is const-qualified. It is recomputed incrementally on every
+/// write through proxy objects to the other fields.
+///
+/// \tparam T Name of the field.
+template <Util::CharArray T>
+struct ChecksumField : Field<T, 16, 0, true> {
+  /// Guard policy which maintains the field.
+  using Guard = Util::OnesComplementChecksum;
+};
+} // namespace RefByStr
+#endif
+
+#if !ORDERED_BIT_FIELD_REF_BY_STR
+inline
+#endif
+    namespace RefByEnum {
+/// Bit field descriptor for 16-bit ones' complement checksum of the record.
+///
+/// The field is const-qualified. It is recomputed incrementally on every
+/// write through proxy objects to the other fields.
+///
+/// \tparam T Tag of the field.
+template <auto T> struct ChecksumField : Field<T, 16, 0, true> {
+  /// Guard policy which maintains the field.
+  using Guard = Util::OnesComplementChecksum;
+};
+} // namespace RefByEnum
+
+/// Recompute the checksum field from scratch, e.g. after writing to Data
+/// directly.
+template <class... Args> constexpr void updateChecksum(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::requireChecksum<BitField<Args...>>();
+  Util::OnesComplementChecksum::initialize<BitField<Args...>, L::GuardIndex>(
+      BF.Data.data());
+}
+
+/// Verify the checksum field.
+///
+/// \returns true if the checksum matches the record.
+template <class... Args>
+constexpr bool verifyChecksum(const BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::requireChecksum<BitField<Args...>>();
+  std::uint64_t S = 0;
+  for (const auto &U : BF.Data) {
+    S += Util::wordSum(static_cast<typename L::RawType>(
+        static_cast<typename L::UnderlyingType>(U)));
+  }
+  return Util::foldSum(S) == 0xffff;
+}
+
+/// Verify the checksum fields of N records.
+///
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Ok If not null, Ok[i] is set to the result for Records[i].
+/// \returns Number of records whose checksum does not match.
+template <class... Args>
+std::size_t verifyChecksums(const BitField<Args...> *Records, std::size_t N,
+                            bool *Ok = nullptr) {
+  using RecordT = BitField<Args...>;
+  Util::requireChecksum<RecordT>();
+  std::size_t Bad = 0;
+  std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+  return Util::kernels().VerifySums(
+      reinterpret_cast<const unsigned char *>(Records), sizeof(RecordT), N,
+      Ok);
+#elif defined(__AVX2__)
+  if constexpr (sizeof(RecordT) % 4 == 0) {
+    const __m256i Low = _mm256_set1_epi32(0xffff);
+    for (; K + 8 <= N; K += 8) {
+      __m256i S = Util::recordSums8<sizeof(RecordT) / 4>(
+          reinterpret_cast<const char *>(Records + K));
+      S = _mm256_add_epi32(_mm256_and_si256(S, Low), _mm256_srli_epi32(S, 16));
+      S = _mm256_add_epi32(_mm256_and_si256(S, Low), _mm256_srli_epi32(S, 16));
+      const auto Match = static_cast<unsigned>(_mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpeq_epi32(S, Low))));
+      for (unsigned J = 0; J < 8; ++J) {
+        const bool R = Match >> J & 1;
+        Bad += !R;
+        if (Ok) {
+          Ok[K + J] = R;
+        }
+      }
+    }
+  }
+#endif
+
+  for (; K < N; ++K) {
+    const bool R = verifyChecksum(Records[K]);
+    Bad += !R;
+    if (Ok) {
+      Ok[K] = R;
+    }
+  }
+  return Bad;
+}
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,346 @@
+//===-- Column.hpp - Field columns of BitField record arrays ----*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains bulk conversion between a field of an array of BitField
+/// records and a plain array (column) of the field values, and of the values
+/// converted by the value codec of the field.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_COLUMN_HPP
+#define ORDERED_BIT_FIELD_COLUMN_HPP
+
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Number of records processed at once by the column operations.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t ColumnTile = 256;
+
+/// Extract raw bits of the I-th field of N records.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT>
+void extractRaw(const BitFieldT *Records, std::size_t N,
+                typename Layout<BitFieldT>::RawType *Out) {
+  using L = Layout<BitFieldT>;
+  std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+  using RawType = typename L::RawType;
+  if constexpr (sizeof(BitFieldT) % sizeof(RawType) == 0 &&
+                (sizeof(RawType) == 4 || sizeof(RawType) == 8)) {
+    if (N == 0) {
+      // Records may be null
+      return;
+    }
+    constexpr std::size_t Word = L::template word<I>();
+    constexpr std::size_t Shift = L::template shift<I>();
+    constexpr RawType Mask =
+        static_cast<RawType>(L::template mask<I>() >> Shift);
+    kernels().GatherBits(
+        reinterpret_cast<const unsigned char *>(Records[0].Data.data() + Word),
+        sizeof(BitFieldT), sizeof(RawType), nullptr, N,
+        static_cast<unsigned>(Shift), Mask,
+        reinterpret_cast<unsigned char *>(Out));
+    K = N;
+  }
+#elif defined(__AVX2__)
+  using RawType = typename L::RawType;
+  constexpr std::size_t Word = L::template word<I>();
+  constexpr std::size_t Shift = L::template shift<I>();
+  constexpr RawType Mask = static_cast<RawType>(L::template mask<I>() >> Shift);
+  if constexpr (sizeof(RawType) == 4 && sizeof(BitFieldT) % 4 == 0) {
+    constexpr int Stride = static_cast<int>(sizeof(BitFieldT) / 4);
+    const __m256i Index = _mm256_setr_epi32(0, Stride, 2 * Stride, 3 * Stride,
+                                            4 * Stride, 5 * Stride,
+                                            6 * Stride, 7 * Stride);
+    const __m256i M = _mm256_set1_epi32(static_cast<int>(Mask));
+    for (; K + 8 <= N; K += 8) {
+      const auto *P =
+          reinterpret_cast<const int *>(Records[K].Data.data() + Word);
+      __m256i V;
+      if constexpr (Stride == 1) {
+        V = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(P));
+      } else {
+        V = _mm256_i32gather_epi32(P, Index, 4);
+      }
+      V = _mm256_and_si256(_mm256_srli_epi32(V, static_cast<int>(Shift)), M);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(Out + K), V);
+    }
+  } else if constexpr (sizeof(RawType) == 8 && sizeof(BitFieldT) % 8 == 0) {
+    constexpr long long Stride = static_cast<long long>(sizeof(BitFieldT) / 8);
+    const __m256i Index =
+        _mm256_setr_epi64x(0, Stride, 2 * Stride, 3 * Stride);
+    const __m256i M = _mm256_set1_epi64x(static_cast<long long>(Mask));
+    for (; K + 4 <= N; K += 4) {
+      const auto *P =
+          reinterpret_cast<const long long *>(Records[K].Data.data() + Word);
+      __m256i V;
+      if constexpr (Stride == 1) {
+        V = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(P));
+      } else {
+        V = _mm256_i64gather_epi64(P, Index, 8);
+      }
+      V = _mm256_and_si256(_mm256_srli_epi64(V, static_cast<int>(Shift)), M);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(Out + K), V);
+    }
+  }
+#endif
+
+  for (; K < N; ++K) {
+    Out[K] = L::template load<I>(Records[K]);
+  }
+}
+
+/// Extract values of the I-th field of N records into Out.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT, class OutT>
+void extractColumnByIndex(const BitFieldT *Records, std::size_t N,
+                          OutT *Out) {
+  using L = Layout<BitFieldT>;
+  using RawType = typename L::RawType;
+  if constexpr (std::is_same_v<OutT, RawType> &&
+                std::is_unsigned_v<typename L::UnderlyingType>) {
+    extractRaw<I>(Records, N, Out);
+  } else {
+    RawType Buf[ColumnTile];
+    for (std::size_t B = 0; B < N; B += ColumnTile) {
+      const std::size_t Len = std::min(ColumnTile, N - B);
+      extractRaw<I>(Records + B, Len, Buf);
+      for (std::size_t K = 0; K < Len; ++K) {
+        Out[B + K] = static_cast<OutT>(L::template value<I>(Buf[K]));
+      }
+    }
+  }
+}
+
+/// Store values in In into the I-th field of N records.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT, class InT>
+void storeColumnByIndex(BitFieldT *Records, std::size_t N, const InT *In) {
+  using L = Layout<BitFieldT>;
+  static_assert(!L::template fixed<I>(),
+                "assignment of read-only memeber is not allowed");
+  for (std::size_t K = 0; K < N; ++K) {
+    L::template store<I>(
+        Records[K],
+        static_cast<typename L::RawType>(
+            static_cast<typename L::UnderlyingType>(
+                static_cast<typename L::FieldType>(In[K]))));
+  }
+}
+
+/// Decode the I-th field of N records with its value codec into Out.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT, class OutT>
+void decodeColumnByIndex(const BitFieldT *Records, std::size_t N, OutT *Out) {
+  using L = Layout<BitFieldT>;
+  using RawType = typename L::RawType;
+  using Codec = typename L::template Codec<I>;
+  static_assert(!std::is_void_v<Codec>, "field has no value codec");
+  std::uint32_t Bits[ColumnTile];
+  for (std::size_t B = 0; B < N; B += ColumnTile) {
+    const std::size_t Len = std::min(ColumnTile, N - B);
+    if constexpr (std::is_same_v<RawType, std::uint32_t>) {
+      extractRaw<I>(Records + B, Len, Bits);
+    } else {
+      RawType Buf[ColumnTile];
+      extractRaw<I>(Records + B, Len, Buf);
+      for (std::size_t K = 0; K < Len; ++K) {
+        Bits[K] = static_cast<std::uint32_t>(Buf[K]);
+      }
+    }
+    Codec::decode(static_cast<const std::uint32_t *>(Bits), Len, Out + B);
+  }
+}
+
+/// Encode values in In with the value codec of the I-th field and store them
+/// into the field of N records.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT, class InT>
+void encodeColumnByIndex(BitFieldT *Records, std::size_t N, const InT *In) {
+  using L = Layout<BitFieldT>;
+  using Codec = typename L::template Codec<I>;
+  static_assert(!std::is_void_v<Codec>, "field has no value codec");
+  static_assert(!L::template fixed<I>(),
+                "assignment of read-only memeber is not allowed");
+  std::uint32_t Bits[ColumnTile];
+  for (std::size_t B = 0; B < N; B += ColumnTile) {
+    const std::size_t Len = std::min(ColumnTile, N - B);
+    Codec::encode(In + B, Len, static_cast<std::uint32_t *>(Bits));
+    for (std::size_t K = 0; K < Len; ++K) {
+      L::template store<I>(Records[B + K],
+                           static_cast<typename L::RawType>(Bits[K]));
+    }
+  }
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Extract values of a field of N records into a column.
+///
+/// \tparam Query Name of the field.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Out Pointer to the first element of the column (N elements).
+template <Util::CharArray Query, class... Args, class OutT,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+void extractColumn(const BitField<Args...> *Records, std::size_t N,
+                   OutT *Out) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::extractColumnByIndex<L::template index<Query>()>(Records, N, Out);
+}
+
+/// Store a column of values into a field of N records.
+///
+/// \tparam Query Name of the field.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param In Pointer to the first element of the column (N elements).
+template <Util::CharArray Query, class... Args, class InT,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+void storeColumn(BitField<Args...> *Records, std::size_t N, const InT *In) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::storeColumnByIndex<L::template index<Query>()>(Records, N, In);
+}
+
+/// Decode a field of N records with its value codec into a column.
+///
+/// \tparam Query Name of the field.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Out Pointer to the first element of the column (N elements).
+template <Util::CharArray Query, class... Args, class OutT,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+void decodeColumn(const BitField<Args...> *Records, std::size_t N, OutT *Out) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::decodeColumnByIndex<L::template index<Query>()>(Records, N, Out);
+}
+
+/// Encode a column of values with the value codec of a field and store them
+/// into the field of N records.
+///
+/// \tparam Query Name of the field.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param In Pointer to the first element of the column (N elements).
+template <Util::CharArray Query, class... Args, class InT,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+void encodeColumn(BitField<Args...> *Records, std::size_t N, const InT *In) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::encodeColumnByIndex<L::template index<Query>()>(Records, N, In);
+}
+#endif
+
+/// Extract values of a field of N records into a column.
+///
+/// \tparam Query Tag of the field.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Out Pointer to the first element of the column (N elements).
+///
+/// \code
+///   enum class Tag { Len, Flag };
+///   using R = BitField<std::uint32_t, Field<Tag::Len, 12>,
+///                      Field<Tag::Flag, 1>>;
+///   std::vector<R> Records(N);
+///   std::vector<std::uint32_t> Len(N);
+///   extractColumn<Tag::Len>(Records.data(), N, Len.data());
+/// \endcode
+template <auto Query, class... Args, class OutT,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void extractColumn(const BitField<Args...> *Records, std::size_t N,
+                   OutT *Out) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::extractColumnByIndex<L::template index<Query>()>(Records, N, Out);
+}
+
+/// Store a column of values into a field of N records.
+///
+/// \tparam Query Tag of the field.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param In Pointer to the first element of the column (N elements).
+template <auto Query, class... Args, class InT,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void storeColumn(BitField<Args...> *Records, std::size_t N, const InT *In) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::storeColumnByIndex<L::template index<Query>()>(Records, N, In);
+}
+
+/// Decode a field of N records with its value codec into a column.
+///
+/// \tparam Query Tag of the field.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Out Pointer to the first element of the column (N elements).
+///
+/// \code
+///   enum class Tag { Temp, Id };
+///   using R = BitField<std::uint32_t, FixedField<Tag::Temp, 12, 4>,
+///                      Field<Tag::Id, 20>>;
+///   std::vector<R> Records(N);
+///   std::vector<float> Temp(N);
+///   decodeColumn<Tag::Temp>(Records.data(), N, Temp.data());
+/// \endcode
+template <auto Query, class... Args, class OutT,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void decodeColumn(const BitField<Args...> *Records, std::size_t N, OutT *Out) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::decodeColumnByIndex<L::template index<Query>()>(Records, N, Out);
+}
+
+/// Encode a column of values with the value codec of a field and store them
+/// into the field of N records.
+///
+/// \tparam Query Tag of the field.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param In Pointer to the first element of the column (N elements).
+template <auto Query, class... Args, class InT,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void encodeColumn(BitField<Args...> *Records, std::size_t N, const InT *In) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::encodeColumnByIndex<L::template index<Query>()>(Records, N, In);
+}
+} // namespace OrderedBitField
+
+#endif
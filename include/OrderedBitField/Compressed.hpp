@@ -0,0 +1,362 @@
+//===-- Compressed.hpp - Compressed chunks of BitField records --*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a compressed form of arrays of BitField records for
+/// rarely read data. Each field is stored by frame of reference: the minimum
+/// of the field in the chunk, and the differences from it packed in as few
+/// bits as they need. Chunks are decompressed into arrays, or read record by
+/// record in place.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_COMPRESSED_HPP
+#define ORDERED_BIT_FIELD_COMPRESSED_HPP
+
+#include "Bitwise.hpp"
+#include "Column.hpp"
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Mask of the lowest B bits.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint64_t packMask(std::size_t B) {
+  return B >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << B) - 1;
+}
+
+/// K-th value of B bits packed in Stream.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline std::uint64_t unpackOne(const std::uint64_t *Stream, std::size_t B,
+                               std::size_t K) {
+  const std::size_t P = K * B;
+  const std::size_t Off = P % 64;
+  std::uint64_t V = Stream[P / 64] >> Off;
+  if (Off + B > 64) {
+    V |= Stream[P / 64 + 1] << (64 - Off);
+  }
+  return V & packMask(B);
+}
+
+/// Unpack N values of B bits from the Begin-th value in Stream. Stream must
+/// have a word after the last value.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline void unpackValues(const std::uint64_t *Stream, std::size_t B,
+                         std::size_t Begin, std::size_t N,
+                         std::uint64_t *Out) {
+#if ORDERED_BIT_FIELD_KERNELS
+  kernels().UnpackBits(Stream, B, Begin, N, Out);
+  return;
+#endif
+  std::size_t K = 0;
+  if (B == 0) {
+    std::fill(Out, Out + N, std::uint64_t{0});
+    return;
+  }
+  if (B <= 56) {
+    // one unaligned load per value, from the byte of its first bit
+    const auto *Bytes = reinterpret_cast<const unsigned char *>(Stream);
+    const std::uint64_t Mask = packMask(B);
+#if defined(__AVX2__)
+    const __m256i Step = _mm256_setr_epi64x(
+        0, static_cast<long long>(B), static_cast<long long>(2 * B),
+        static_cast<long long>(3 * B));
+    const __m256i VMask = _mm256_set1_epi64x(static_cast<long long>(Mask));
+    const __m256i Seven = _mm256_set1_epi64x(7);
+    for (; K + 4 <= N; K += 4) {
+      const __m256i P = _mm256_add_epi64(
+          _mm256_set1_epi64x(static_cast<long long>((Begin + K) * B)), Step);
+      const __m256i V = _mm256_i64gather_epi64(
+          reinterpret_cast<const long long *>(Bytes), _mm256_srli_epi64(P, 3),
+          1);
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i *>(Out + K),
+          _mm256_and_si256(
+              _mm256_srlv_epi64(V, _mm256_and_si256(P, Seven)), VMask));
+    }
+#endif
+    for (; K < N; ++K) {
+      const std::size_t P = (Begin + K) * B;
+      std::uint64_t V;
+      std::memcpy(&V, Bytes + P / 8, sizeof(V));
+      Out[K] = (V >> P % 8) & Mask;
+    }
+    return;
+  }
+  for (; K < N; ++K) {
+    Out[K] = unpackOne(Stream, B, Begin + K);
+  }
+}
+} // namespace Util
+
+/// Chunk of BitField records compressed field by field.
+///
+/// Each field which is not const-qualified, and the guarded field, is stored
+/// as the minimum of the field over the chunk and the differences from it,
+/// packed in the bit width of the largest difference. Fields of signed types
+/// are compared as signed values. Const-qualified fields and paddings take
+/// no space, so the records are restored in canonical form (see
+/// canonicalize()).
+///
+/// \tparam BitFieldT Type of the records.
+///
+/// \code
+///   enum class Tag { Time, Sensor, Value };
+///   using R = BitField<std::uint64_t, Field<Tag::Time, 32>,
+///                      Field<Tag::Sensor, 12>, Field<Tag::Value, 20>>;
+///   CompressedChunk<R> Chunk(History.data(), 65536);
+///   History.clear();
+///   // a single record without decompressing the chunk
+///   const R Rec = Chunk.load(123);
+///   auto Value = get<Tag::Value>(Rec);
+///   // all the records, left for decompress() to overwrite (Memory.hpp)
+///   auto Hot = makeForOverwrite<R>(Chunk.size());
+///   Chunk.decompress(Hot.get());
+/// \endcode
+template <class BitFieldT> class CompressedChunk {
+  using L = Util::Layout<BitFieldT>;
+  using M = Util::UnitMasks<BitFieldT>;
+  using RawType = typename L::RawType;
+
+  /// Frame of a field.
+  struct Frame {
+    /// Minimum of the field, as a sign-extended value for signed types.
+    std::uint64_t Min = 0;
+    /// Bit width of the differences.
+    std::size_t Bits = 0;
+    /// Index of the first word of the packed differences.
+    std::size_t Offset = 0;
+  };
+
+  template <std::size_t I> static constexpr bool packed() {
+    return !L::template fixed<I>() || I == L::GuardIndex;
+  }
+
+  /// Value of raw bits of the I-th field, ordered as the field.
+  template <std::size_t I> static std::uint64_t key(RawType Raw) {
+    constexpr std::size_t W = L::template bits<I>();
+    const auto V = static_cast<std::uint64_t>(Raw);
+    if constexpr (std::is_signed_v<typename L::UnderlyingType> && W < 64) {
+      constexpr std::uint64_t Sign = std::uint64_t{1} << (W - 1);
+      return (V ^ Sign) - Sign;
+    } else {
+      return V;
+    }
+  }
+
+  /// Whether key A is less than key B.
+  static bool less(std::uint64_t A, std::uint64_t B) {
+    if constexpr (std::is_signed_v<typename L::UnderlyingType>) {
+      return static_cast<std::int64_t>(A) < static_cast<std::int64_t>(B);
+    } else {
+      return A < B;
+    }
+  }
+
+public:
+  /// Empty chunk.
+  CompressedChunk() = default;
+
+  /// Compress N records.
+  ///
+  /// \param Records Pointer to the first record.
+  /// \param N Number of records.
+  CompressedChunk(const BitFieldT *Records, std::size_t N) : N(N) {
+    compress(Records, std::make_index_sequence<L::NFields>());
+  }
+
+  /// Number of records.
+  std::size_t size() const { return N; }
+
+  /// Whether the chunk has no records.
+  bool empty() const { return N == 0; }
+
+  /// Size in bytes of the compressed records.
+  std::size_t bytes() const {
+    return Words.size() * sizeof(std::uint64_t) + sizeof(Frames);
+  }
+
+  /// Bit width of the packed differences of the I-th field in the order of
+  /// the descriptors, or 0 for const-qualified fields.
+  std::size_t packedBits(std::size_t I) const { return Frames[I].Bits; }
+
+  /// K-th record, without decompressing the others.
+  BitFieldT load(std::size_t K) const {
+    BitFieldT R;
+    std::memcpy(R.Data.data(), M::Fixed.data(), sizeof(R.Data));
+    loadFields(R, K, std::make_index_sequence<L::NFields>());
+    return R;
+  }
+
+  /// Decompress all the records.
+  ///
+  /// \param Out Pointer to the first element of the output (size() records).
+  void decompress(BitFieldT *Out) const { decompress(0, N, Out); }
+
+  /// Decompress Len records from the Begin-th record.
+  ///
+  /// \param Begin Index of the first record.
+  /// \param Len Number of records.
+  /// \param Out Pointer to the first element of the output (Len records).
+  void decompress(std::size_t Begin, std::size_t Len, BitFieldT *Out) const {
+    for (std::size_t B = 0; B < Len; B += Util::ColumnTile) {
+      const std::size_t T = std::min(Util::ColumnTile, Len - B);
+      for (std::size_t K = 0; K < T; ++K) {
+        std::memcpy(Out[B + K].Data.data(), M::Fixed.data(),
+                    sizeof(Out[B + K].Data));
+      }
+      decompressTile(Begin + B, T, Out + B,
+                     std::make_index_sequence<L::NFields>());
+    }
+  }
+
+private:
+  template <std::size_t... I>
+  void compress(const BitFieldT *Records, std::index_sequence<I...>) {
+    std::size_t Total = 0;
+    (
+        [&] {
+          if constexpr (packed<I>()) {
+            Frames[I] = frame<I>(Records, Total);
+          }
+        }(),
+        ...);
+    // a word after the last value for two-word reads
+    Words.assign(Total + 1, 0);
+    (
+        [&] {
+          if constexpr (packed<I>()) {
+            pack<I>(Records);
+          }
+        }(),
+        ...);
+  }
+
+  template <std::size_t I>
+  Frame frame(const BitFieldT *Records, std::size_t &Total) const {
+    Frame F;
+    if (N == 0) {
+      return F;
+    }
+    RawType Buf[Util::ColumnTile];
+    std::uint64_t Min = key<I>(L::template load<I>(Records[0]));
+    std::uint64_t Max = Min;
+    for (std::size_t B = 0; B < N; B += Util::ColumnTile) {
+      const std::size_t T = std::min(Util::ColumnTile, N - B);
+      Util::extractRaw<I>(Records + B, T, Buf);
+      for (std::size_t K = 0; K < T; ++K) {
+        const std::uint64_t V = key<I>(Buf[K]);
+        Min = less(V, Min) ? V : Min;
+        Max = less(Max, V) ? V : Max;
+      }
+    }
+    while (F.Bits < 64 && ((Max - Min) >> F.Bits) != 0) {
+      ++F.Bits;
+    }
+    F.Min = Min;
+    F.Offset = Total;
+    Total += (N * F.Bits + 63) / 64;
+    return F;
+  }
+
+  template <std::size_t I> void pack(const BitFieldT *Records) {
+    const Frame &F = Frames[I];
+    if (F.Bits == 0) {
+      return;
+    }
+    std::uint64_t *Stream = Words.data() + F.Offset;
+    RawType Buf[Util::ColumnTile];
+    for (std::size_t B = 0; B < N; B += Util::ColumnTile) {
+      const std::size_t T = std::min(Util::ColumnTile, N - B);
+      Util::extractRaw<I>(Records + B, T, Buf);
+      for (std::size_t K = 0; K < T; ++K) {
+        const std::uint64_t D = key<I>(Buf[K]) - F.Min;
+        const std::size_t P = (B + K) * F.Bits;
+        const std::size_t Off = P % 64;
+        Stream[P / 64] |= D << Off;
+        if (Off + F.Bits > 64) {
+          Stream[P / 64 + 1] |= D >> (64 - Off);
+        }
+      }
+    }
+  }
+
+  template <std::size_t... I>
+  void loadFields(BitFieldT &R, std::size_t K,
+                  std::index_sequence<I...>) const {
+    (
+        [&] {
+          if constexpr (packed<I>()) {
+            orRaw<I>(R, raw<I>(Util::unpackOne(Words.data() + Frames[I].Offset,
+                                               Frames[I].Bits, K)));
+          }
+        }(),
+        ...);
+  }
+
+  /// OR raw bits of the I-th field into its storage unit of R. The units may
+  /// be std::byte or enums, so that the OR is done on RawType.
+  template <std::size_t I> static void orRaw(BitFieldT &R, RawType Bits) {
+    using UnderlyingType = typename L::UnderlyingType;
+    auto &U = R.Data[L::template word<I>()];
+    U = static_cast<typename L::FieldType>(static_cast<UnderlyingType>(
+        static_cast<RawType>(static_cast<UnderlyingType>(U)) | Bits));
+  }
+
+  /// Raw bits of the I-th field in place from a packed difference.
+  template <std::size_t I> RawType raw(std::uint64_t D) const {
+    return static_cast<RawType>(
+        ((Frames[I].Min + D) & Util::packMask(L::template bits<I>()))
+        << L::template shift<I>());
+  }
+
+  template <std::size_t... I>
+  void decompressTile(std::size_t Begin, std::size_t T, BitFieldT *Out,
+                      std::index_sequence<I...>) const {
+    std::uint64_t Buf[Util::ColumnTile];
+    (
+        [&] {
+          if constexpr (packed<I>()) {
+            Util::unpackValues(Words.data() + Frames[I].Offset,
+                               Frames[I].Bits, Begin, T, Buf);
+            for (std::size_t K = 0; K < T; ++K) {
+              orRaw<I>(Out[K], raw<I>(Buf[K]));
+            }
+          }
+        }(),
+        ...);
+  }
+
+  std::size_t N = 0;
+  std::array<Frame, L::NFields> Frames{};
+  std::vector<std::uint64_t> Words;
+};
+} // namespace OrderedBitField
+
+#endif
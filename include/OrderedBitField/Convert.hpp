@@ -0,0 +1,435 @@
+//===-- Convert.hpp - Conversion between record layouts ---------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains conversion of records between two layouts of the same
+/// tags, e.g. versions of a stored schema. Fields are matched by tag at
+/// compile time and moved by a fixed program of masks and shifts.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_CONVERT_HPP
+#define ORDERED_BIT_FIELD_CONVERT_HPP
+
+#include "Memory.hpp"
+#include "OrderedBitField.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__) || (defined(__BMI2__) && defined(__x86_64__))
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Conversion program from OldT records to NewT records.
+///
+/// The I-th field of NewT takes the value of the field of OldT with the same
+/// tag, sign-extended or truncated to its width. Unmatched fields and
+/// const-qualified fields of NewT hold their default values, and the guarded
+/// field is recomputed. Bits are moved by one mask and shift per triple of
+/// source unit, destination unit and shift, or by one pext (and pdep) per
+/// pair of units where BMI2 is available and the fields keep their order.
+/// Arrays of records of one 32-bit or 64-bit unit run the shift steps on
+/// AVX2 vectors.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class NewT, class OldT> struct Conversion {
+  using NL = Layout<NewT>;
+  using OL = Layout<OldT>;
+  using NewRaw = typename NL::RawType;
+  using OldRaw = typename OL::RawType;
+
+  static_assert(std::is_same_v<typename NL::TagT, typename OL::TagT>,
+                "layouts must have the same type of tags");
+
+  /// Position of a field.
+  struct FieldInfo {
+    std::size_t Word;
+    std::size_t Shift;
+    std::size_t Bits;
+    bool Fixed;
+  };
+
+  /// Step of the conversion: Out[DstWord] |= move(In[SrcWord] & SrcMask).
+  struct Op {
+    std::size_t SrcWord;
+    std::size_t DstWord;
+    std::uint64_t SrcMask;
+    std::uint64_t DstMask;
+    /// Left shift (negative for right shift) of a shift step, or of the
+    /// result of pext if DstMask is contiguous.
+    int Delta;
+    /// Whether the bits are gathered by pext.
+    bool Extract;
+    /// Whether the gathered bits are scattered by pdep.
+    bool Deposit;
+  };
+
+  /// Sign extension: Out[DstWord] |= DstMask if the bit is set in
+  /// In[SrcWord].
+  struct Extension {
+    std::size_t SrcWord;
+    std::size_t SrcBit;
+    std::size_t DstWord;
+    std::uint64_t DstMask;
+  };
+
+  struct Program {
+    std::array<NewRaw, NL::DataSize> Base;
+    std::array<Op, NL::NFields> Ops;
+    std::size_t NOps;
+    std::array<Extension, NL::NFields> Exts;
+    std::size_t NExts;
+  };
+
+  template <class L, std::size_t... I>
+  static constexpr std::array<FieldInfo, sizeof...(I)>
+  info(std::index_sequence<I...>) {
+    return {{FieldInfo{L::template word<I>(), L::template shift<I>(),
+                       L::template bits<I>(), L::template fixed<I>()}...}};
+  }
+
+  template <class L, std::size_t... I>
+  static constexpr std::array<typename L::TagT, sizeof...(I)>
+  tags(std::index_sequence<I...>) {
+    return {{L::template Descriptor<I>::Tag...}};
+  }
+
+  static constexpr std::uint64_t lowMask(std::size_t Bits) {
+    return Bits >= 64 ? ~std::uint64_t{0}
+                      : (std::uint64_t{1} << Bits) - std::uint64_t{1};
+  }
+
+  static constexpr bool UseExtract =
+#if defined(__BMI2__) && defined(__x86_64__)
+      true;
+#else
+      false;
+#endif
+
+  static constexpr auto NewInfo =
+      info<NL>(std::make_index_sequence<NL::NFields>());
+  static constexpr auto OldInfo =
+      info<OL>(std::make_index_sequence<OL::NFields>());
+
+  /// Index of the field of OldT which the I-th field of NewT takes its value
+  /// from, or OL::NFields.
+  static constexpr std::array<std::size_t, NL::NFields> Source = [] {
+    constexpr auto NewTags = tags<NL>(std::make_index_sequence<NL::NFields>());
+    constexpr auto OldTags = tags<OL>(std::make_index_sequence<OL::NFields>());
+    std::array<std::size_t, NL::NFields> S{};
+    for (std::size_t I = 0; I < NL::NFields; ++I) {
+      S[I] = OL::NFields;
+      // const-qualified fields, e.g. paddings, keep their values
+      for (std::size_t J = 0; J < OL::NFields && !NewInfo[I].Fixed; ++J) {
+        if (NewTags[I] == OldTags[J]) {
+          S[I] = J;
+          break;
+        }
+      }
+    }
+    return S;
+  }();
+
+  static constexpr Program program(bool Extract) {
+    Program P{};
+    for (std::size_t W = 0; W < NL::DataSize; ++W) {
+      P.Base[W] = static_cast<NewRaw>(
+          static_cast<typename NL::UnderlyingType>(NL::DefaultData[W]));
+    }
+    for (std::size_t I = 0; I < NL::NFields; ++I) {
+      if (Source[I] == OL::NFields) {
+        continue;
+      }
+      const FieldInfo &N = NewInfo[I];
+      const FieldInfo &O = OldInfo[Source[I]];
+      P.Base[N.Word] &= static_cast<NewRaw>(~(lowMask(N.Bits) << N.Shift));
+
+      const std::size_t B = std::min(N.Bits, O.Bits);
+      const int Delta = static_cast<int>(N.Shift) - static_cast<int>(O.Shift);
+      std::size_t K = 0;
+      while (K < P.NOps && !(P.Ops[K].SrcWord == O.Word &&
+                             P.Ops[K].DstWord == N.Word &&
+                             P.Ops[K].Delta == Delta)) {
+        ++K;
+      }
+      if (K == P.NOps) {
+        P.Ops[P.NOps++] = Op{O.Word, N.Word, 0, 0, Delta, false, false};
+      }
+      P.Ops[K].SrcMask |= lowMask(B) << O.Shift;
+      P.Ops[K].DstMask |= lowMask(B) << N.Shift;
+
+      if (std::is_signed_v<typename OL::UnderlyingType> && N.Bits > O.Bits) {
+        P.Exts[P.NExts++] =
+            Extension{O.Word, O.Shift + O.Bits - 1, N.Word,
+                      lowMask(N.Bits - O.Bits) << (N.Shift + O.Bits)};
+      }
+    }
+    if (Extract) {
+      mergeExtract(P);
+    }
+    return P;
+  }
+
+  /// Merge the shift steps between a pair of units into a pext step if the
+  /// fields keep their order.
+  static constexpr void mergeExtract(Program &P) {
+    for (std::size_t K = 0; K < P.NOps; ++K) {
+      std::size_t Count = 0;
+      for (std::size_t L = K; L < P.NOps; ++L) {
+        Count += P.Ops[L].SrcWord == P.Ops[K].SrcWord &&
+                 P.Ops[L].DstWord == P.Ops[K].DstWord;
+      }
+      if (Count < 2 || !ordered(P.Ops[K].SrcWord, P.Ops[K].DstWord)) {
+        continue;
+      }
+      Op &M = P.Ops[K];
+      std::size_t Kept = K + 1;
+      for (std::size_t L = K + 1; L < P.NOps; ++L) {
+        if (P.Ops[L].SrcWord == M.SrcWord && P.Ops[L].DstWord == M.DstWord) {
+          M.SrcMask |= P.Ops[L].SrcMask;
+          M.DstMask |= P.Ops[L].DstMask;
+        } else {
+          P.Ops[Kept++] = P.Ops[L];
+        }
+      }
+      P.NOps = Kept;
+      M.Extract = true;
+      // a contiguous run is placed by a shift instead of pdep
+      std::size_t Low = 0;
+      while (((M.DstMask >> Low) & 1) == 0) {
+        ++Low;
+      }
+      M.Deposit = ((M.DstMask >> Low) & ((M.DstMask >> Low) + 1)) != 0;
+      M.Delta = static_cast<int>(Low);
+    }
+  }
+
+  /// Whether the fields moved from unit SrcWord to unit DstWord are in the
+  /// same order in both.
+  static constexpr bool ordered(std::size_t SrcWord, std::size_t DstWord) {
+    for (std::size_t I = 0; I < NL::NFields; ++I) {
+      for (std::size_t J = 0; J < NL::NFields; ++J) {
+        if (Source[I] == OL::NFields || Source[J] == OL::NFields ||
+            NewInfo[I].Word != DstWord || NewInfo[J].Word != DstWord ||
+            OldInfo[Source[I]].Word != SrcWord ||
+            OldInfo[Source[J]].Word != SrcWord) {
+          continue;
+        }
+        if ((NewInfo[I].Shift < NewInfo[J].Shift) !=
+            (OldInfo[Source[I]].Shift < OldInfo[Source[J]].Shift)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /// Program for single records.
+  static constexpr Program Prog = program(UseExtract);
+
+  /// Program of shift steps only, for vectors.
+  static constexpr Program ShiftProg = program(false);
+
+  template <std::size_t K>
+  static void runOp(const OldT &In, std::array<NewRaw, NL::DataSize> &D) {
+    constexpr Op O = Prog.Ops[K];
+    const std::uint64_t S = OL::template unit<O.SrcWord>(In);
+    std::uint64_t V;
+    if constexpr (O.Extract) {
+#if defined(__BMI2__) && defined(__x86_64__)
+      V = _pext_u64(S, O.SrcMask);
+      V = O.Deposit ? _pdep_u64(V, O.DstMask) : V << O.Delta;
+#endif
+    } else if constexpr (O.Delta >= 0) {
+      V = (S & O.SrcMask) << O.Delta;
+    } else {
+      V = (S & O.SrcMask) >> -O.Delta;
+    }
+    D[O.DstWord] |= static_cast<NewRaw>(V);
+  }
+
+  template <std::size_t K>
+  static void runExt(const OldT &In, std::array<NewRaw, NL::DataSize> &D) {
+    constexpr Extension E = Prog.Exts[K];
+    const std::uint64_t S = OL::template unit<E.SrcWord>(In);
+    D[E.DstWord] |=
+        static_cast<NewRaw>(E.DstMask & (0 - ((S >> E.SrcBit) & 1)));
+  }
+
+  template <std::size_t... K, std::size_t... E>
+  static void run(const OldT &In, NewT &Out, std::index_sequence<K...>,
+                  std::index_sequence<E...>) {
+    std::array<NewRaw, NL::DataSize> D = Prog.Base;
+    (runOp<K>(In, D), ...);
+    (runExt<E>(In, D), ...);
+    for (std::size_t W = 0; W < NL::DataSize; ++W) {
+      Out.Data[W] = static_cast<typename NL::FieldType>(
+          static_cast<typename NL::UnderlyingType>(D[W]));
+    }
+    if constexpr (NL::GuardIndex < NL::NFields) {
+      NL::Guard::template initialize<NewT, NL::GuardIndex>(Out.Data.data());
+    }
+  }
+
+  /// Convert a record.
+  static void convert(const OldT &In, NewT &Out) {
+    run(In, Out, std::make_index_sequence<Prog.NOps>(),
+        std::make_index_sequence<Prog.NExts>());
+  }
+
+#if defined(__AVX2__)
+  static constexpr bool Vectorizable =
+      NL::DataSize == 1 && OL::DataSize == 1 &&
+      sizeof(NewRaw) == sizeof(OldRaw) &&
+      (sizeof(NewRaw) == 4 || sizeof(NewRaw) == 8) &&
+      sizeof(NewT) == sizeof(NewRaw) && sizeof(OldT) == sizeof(OldRaw) &&
+      NL::GuardIndex == NL::NFields;
+
+  static __m256i broadcast(std::uint64_t V) {
+    if constexpr (sizeof(NewRaw) == 8) {
+      return _mm256_set1_epi64x(static_cast<long long>(V));
+    } else {
+      return _mm256_set1_epi32(static_cast<int>(V));
+    }
+  }
+
+  template <int Delta> static __m256i shiftLanes(__m256i V) {
+    if constexpr (Delta > 0 && sizeof(NewRaw) == 8) {
+      return _mm256_slli_epi64(V, Delta);
+    } else if constexpr (Delta > 0) {
+      return _mm256_slli_epi32(V, Delta);
+    } else if constexpr (Delta < 0 && sizeof(NewRaw) == 8) {
+      return _mm256_srli_epi64(V, -Delta);
+    } else if constexpr (Delta < 0) {
+      return _mm256_srli_epi32(V, -Delta);
+    } else {
+      return V;
+    }
+  }
+
+  /// All-ones lanes where the bit of S is set.
+  template <std::size_t Bit> static __m256i spreadBit(__m256i S) {
+    const __m256i Low = _mm256_and_si256(
+        shiftLanes<-static_cast<int>(Bit)>(S), broadcast(1));
+    if constexpr (sizeof(NewRaw) == 8) {
+      return _mm256_sub_epi64(_mm256_setzero_si256(), Low);
+    } else {
+      return _mm256_sub_epi32(_mm256_setzero_si256(), Low);
+    }
+  }
+
+  template <std::size_t... K, std::size_t... E>
+  static __m256i runLanes(__m256i S, std::index_sequence<K...>,
+                          std::index_sequence<E...>) {
+    __m256i D = broadcast(ShiftProg.Base[0]);
+    ((D = _mm256_or_si256(
+          D, shiftLanes<ShiftProg.Ops[K].Delta>(_mm256_and_si256(
+                 S, broadcast(ShiftProg.Ops[K].SrcMask))))),
+     ...);
+    ((D = _mm256_or_si256(
+          D, _mm256_and_si256(spreadBit<ShiftProg.Exts[E].SrcBit>(S),
+                              broadcast(ShiftProg.Exts[E].DstMask)))),
+     ...);
+    return D;
+  }
+#endif
+
+  /// Convert N records on the calling thread.
+  static void convertRange(const OldT *In, std::size_t N, NewT *Out) {
+    std::size_t I = 0;
+#if defined(__AVX2__)
+    if constexpr (Vectorizable) {
+      constexpr std::size_t Lanes = 32 / sizeof(NewT);
+      // large outputs bypass the caches
+      const bool Stream = N * sizeof(NewT) >= NonTemporalBytes;
+      for (; Stream && I < N &&
+             reinterpret_cast<std::uintptr_t>(Out + I) % 32 != 0;
+           ++I) {
+        convert(In[I], Out[I]);
+      }
+      for (; I + Lanes <= N; I += Lanes) {
+        const __m256i D = runLanes(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(In + I)),
+            std::make_index_sequence<ShiftProg.NOps>(),
+            std::make_index_sequence<ShiftProg.NExts>());
+        if (Stream) {
+          _mm256_stream_si256(reinterpret_cast<__m256i *>(Out + I), D);
+        } else {
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(Out + I), D);
+        }
+      }
+      if (Stream) {
+        _mm_sfence();
+      }
+    }
+#endif
+    for (; I < N; ++I) {
+      convert(In[I], Out[I]);
+    }
+  }
+};
+} // namespace Util
+
+/// Convert a record into another layout.
+///
+/// Fields are matched by tag at compile time. A field takes the value of
+/// the field of the same tag, sign-extended for signed base types or
+/// truncated to its width. Fields without a match and const-qualified fields
+/// hold their default values, and the guarded field is recomputed.
+///
+/// \tparam NewT Type of the converted record.
+/// \param Old Record to convert.
+/// \returns Converted record.
+///
+/// \code
+///   enum class Tag { Id, Kind, Flags };
+///   using V1 = BitField<std::uint32_t, Field<Tag::Id, 20>,
+///                       Field<Tag::Kind, 4>>;
+///   using V2 = BitField<std::uint32_t, Field<Tag::Kind, 6>,
+///                       Field<Tag::Id, 24>, Field<Tag::Flags, 2, 1>>;
+///   V2 New = convert<V2>(Old);
+/// \endcode
+template <class NewT, class... Args>
+NewT convert(const BitField<Args...> &Old) {
+  NewT Out;
+  Util::Conversion<NewT, BitField<Args...>>::convert(Old, Out);
+  return Out;
+}
+
+/// Convert N records into another layout, on several threads for large
+/// arrays.
+///
+/// \param In Pointer to the first record to convert.
+/// \param N Number of records.
+/// \param Out Pointer to the first converted record.
+/// \param NThreads Maximum number of threads. 0 means
+/// std::thread::hardware_concurrency().
+template <class NewT, class... Args>
+void convert(const BitField<Args...> *In, std::size_t N, NewT *Out,
+             unsigned NThreads = 0) {
+  using C = Util::Conversion<NewT, BitField<Args...>>;
+  const unsigned NBlocks = Util::threadCount(N, NThreads);
+  Util::parallelFor(NBlocks, [&](unsigned Block) {
+    const std::size_t Begin = Util::blockBegin(N, NBlocks, Block);
+    const std::size_t End = Util::blockBegin(N, NBlocks, Block + 1);
+    C::convertRange(In + Begin, End - Begin, Out + Begin);
+  });
+}
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,234 @@
+//===-- Dispatch.hpp - Runtime selection of SIMD kernels --------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains detection of the SIMD instruction sets of the running
+/// CPU and the table of bulk kernels selected by it.
+///
+/// Header-only users get the kernels chosen at compile time by the target
+/// flags (e.g. `-mavx2`). Programs linked with the compiled kernels library
+/// (the `OrderedBitField::Kernels` CMake target, which defines
+/// ORDERED_BIT_FIELD_KERNELS) route the bulk operations through the table
+/// instead, so that one binary uses AVX2 or AVX-512 wherever available.
+///
+/// Conversions between layouts (Convert.hpp) keep the paths selected at
+/// compile time even then: their vector code runs a shift program unrolled
+/// for the pair of record types, which the table cannot hold.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_DISPATCH_HPP
+#define ORDERED_BIT_FIELD_DISPATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) &&                              \
+    (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace OrderedBitField {
+/// SIMD instruction sets used by the kernels, in increasing order.
+enum class SimdLevel { Scalar, Avx2, Avx512 };
+
+namespace Util {
+/// SIMD level supported by the CPU and the OS.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline SimdLevel detectSimdLevel() {
+  std::uint32_t Leaf1[4] = {};
+  std::uint32_t Leaf7[4] = {};
+#if (defined(__GNUC__) || defined(__clang__)) &&                              \
+    (defined(__x86_64__) || defined(__i386__))
+  if (__get_cpuid(1, &Leaf1[0], &Leaf1[1], &Leaf1[2], &Leaf1[3]) == 0 ||
+      __get_cpuid_count(7, 0, &Leaf7[0], &Leaf7[1], &Leaf7[2], &Leaf7[3]) ==
+          0) {
+    return SimdLevel::Scalar;
+  }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int Regs[4];
+  __cpuid(Regs, 0);
+  if (Regs[0] < 7) {
+    return SimdLevel::Scalar;
+  }
+  __cpuid(Regs, 1);
+  std::memcpy(Leaf1, Regs, sizeof(Regs));
+  __cpuidex(Regs, 7, 0);
+  std::memcpy(Leaf7, Regs, sizeof(Regs));
+#else
+  return SimdLevel::Scalar;
+#endif
+  // the OS must save the vector registers (OSXSAVE, then XCR0)
+  if ((Leaf1[2] & (1u << 27)) == 0) {
+    return SimdLevel::Scalar;
+  }
+#if defined(_MSC_VER) && !defined(__clang__)
+  const std::uint64_t Xcr0 = _xgetbv(0);
+#elif defined(__x86_64__) || defined(__i386__)
+  std::uint32_t Lo;
+  std::uint32_t Hi;
+  __asm__("xgetbv" : "=a"(Lo), "=d"(Hi) : "c"(0));
+  const std::uint64_t Xcr0 = (std::uint64_t{Hi} << 32) | Lo;
+#else
+  const std::uint64_t Xcr0 = 0;
+#endif
+  const bool Ymm = (Xcr0 & 0x6) == 0x6;
+  const bool Zmm = (Xcr0 & 0xe6) == 0xe6;
+  // the AVX2 kernels also convert binary16 by F16C
+  const bool Avx2 =
+      (Leaf7[1] & (1u << 5)) != 0 && (Leaf1[2] & (1u << 29)) != 0;
+  const bool Avx512F = (Leaf7[1] & (1u << 16)) != 0;
+  if (Avx2 && Avx512F && Zmm) {
+    return SimdLevel::Avx512;
+  }
+  return Avx2 && Ymm ? SimdLevel::Avx2 : SimdLevel::Scalar;
+}
+
+/// Detected SIMD level, lowered by the environment variable
+/// ORDERED_BIT_FIELD_SIMD (`scalar`, `avx2` or `avx512`) if set.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline SimdLevel selectSimdLevel() {
+  const SimdLevel Detected = detectSimdLevel();
+  const char *Env = std::getenv("ORDERED_BIT_FIELD_SIMD");
+  if (Env == nullptr) {
+    return Detected;
+  }
+  SimdLevel Wanted = Detected;
+  if (std::strcmp(Env, "scalar") == 0) {
+    Wanted = SimdLevel::Scalar;
+  } else if (std::strcmp(Env, "avx2") == 0) {
+    Wanted = SimdLevel::Avx2;
+  }
+  return Wanted < Detected ? Wanted : Detected;
+}
+
+/// Bitwise operation of the masked kernel.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+enum class BitwiseKind { And, Or, Xor, AndNot, First, Not };
+
+/// Table of the bulk kernels for a SIMD level.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct KernelTable {
+  /// Level of the kernels.
+  SimdLevel Level;
+  /// Z = (Op(X, Y) & Keep) | Set over Bytes bytes, where Keep and Set are
+  /// repeated every P bytes (a multiple of 32 up to 256) and Bytes is a
+  /// multiple of P. Z may be X or Y.
+  void (*MaskedBytes)(BitwiseKind Op, const unsigned char *X,
+                      const unsigned char *Y, unsigned char *Z,
+                      std::size_t Bytes, std::size_t P,
+                      const unsigned char *Keep, const unsigned char *Set);
+  /// Fill Bytes bytes from Dst, which is aligned to 64 bytes, by repeating
+  /// the pattern of P bytes (a multiple of 64), also aligned to 64 bytes.
+  /// Large fills use non-temporal stores.
+  void (*FillPattern)(unsigned char *Dst, std::size_t Bytes,
+                      const unsigned char *Pattern, std::size_t P);
+  /// Unpack N values of B bits from the Begin-th value in Stream, which has
+  /// a word after the last value.
+  void (*UnpackBits)(const std::uint64_t *Stream, std::size_t B,
+                     std::size_t Begin, std::size_t N, std::uint64_t *Out);
+  /// Whether (X & ~Ignore) == Expect over Bytes bytes, where Ignore and
+  /// Expect are repeated every P bytes (a multiple of 32 up to 256) and Bytes
+  /// is a multiple of P.
+  bool (*MatchBytes)(const unsigned char *X, std::size_t Bytes, std::size_t P,
+                     const unsigned char *Ignore,
+                     const unsigned char *Expect);
+  /// Load the word of Width bytes (4 or 8) at Base + Indices[K] * Stride, or
+  /// at Base + K * Stride if Indices is null, for K < N, and store
+  /// (Word >> Shift) & Mask to Out as words of Width bytes.
+  void (*GatherBits)(const unsigned char *Base, std::size_t Stride,
+                     std::size_t Width, const std::uint64_t *Indices,
+                     std::size_t N, unsigned Shift, std::uint64_t Mask,
+                     unsigned char *Out);
+  /// Verify N records of Size bytes (a multiple of 2) from Records, whose
+  /// 16-bit words must sum to 0xffff in ones' complement. Sets Ok[K] unless
+  /// Ok is null, and returns the number of mismatches.
+  std::size_t (*VerifySums)(const unsigned char *Records, std::size_t Size,
+                            std::size_t N, bool *Ok);
+  /// Mask of the records among N (at most 64) records of Units words of
+  /// Width bytes (4 or 8), Stride bytes apart from Records, in which any of
+  /// E equations has odd parity. Equation[J * Units + U] masks the U-th word
+  /// in the J-th equation.
+  std::uint64_t (*OddParity)(const unsigned char *Records, std::size_t Stride,
+                             std::size_t Width, std::size_t Units,
+                             std::size_t N, const std::uint64_t *Equation,
+                             std::size_t E);
+  /// Convert N binary16 values held in the low halves of Bits to float.
+  void (*DecodeHalf)(const std::uint32_t *Bits, std::size_t N, float *Out);
+  /// Convert N floats to binary16, rounding to the nearest even.
+  void (*EncodeHalf)(const float *In, std::size_t N, std::uint32_t *Bits);
+  /// Convert N bfloat16 values held in the low halves of Bits to float.
+  void (*DecodeBFloat16)(const std::uint32_t *Bits, std::size_t N,
+                         float *Out);
+  /// Convert N floats to bfloat16, rounding to the nearest even and quieting
+  /// NaNs.
+  void (*EncodeBFloat16)(const float *In, std::size_t N, std::uint32_t *Bits);
+  /// Out[K] = (sext(Bits[K] & Mask) + Bias) * Scale for N values, where sext
+  /// extends the sign bit 31 - Ext. Raw values plus Bias must fit in
+  /// std::int32_t.
+  void (*DecodeFixed)(const std::uint32_t *Bits, std::size_t N,
+                      std::uint32_t Mask, int Ext, std::int32_t Bias,
+                      double Scale, float *Out);
+  /// As DecodeFixed, into doubles.
+  void (*DecodeFixedDouble)(const std::uint32_t *Bits, std::size_t N,
+                            std::uint32_t Mask, int Ext, std::int32_t Bias,
+                            double Scale, double *Out);
+  /// Bits[K] = round(clamp(In[K] * Scale - Bias, Lo, Hi)) & Mask for N
+  /// values, rounding to the nearest even and mapping NaN to Lo. Lo and Hi
+  /// must be integers of at most 24 bits.
+  void (*EncodeFixed)(const float *In, std::size_t N, float Scale, float Bias,
+                      float Lo, float Hi, std::uint32_t Mask,
+                      std::uint32_t *Bits);
+};
+
+#if ORDERED_BIT_FIELD_KERNELS
+/// Kernels of the given level, which the CPU must support. Defined in the
+/// kernels library.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+const KernelTable &kernelsFor(SimdLevel Level);
+
+/// Kernels of simdLevel(). Defined in the kernels library.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+const KernelTable &kernels();
+#endif
+} // namespace Util
+
+/// SIMD level of the running CPU, detected by `cpuid` on the first call and
+/// cached. The environment variable ORDERED_BIT_FIELD_SIMD (`scalar`, `avx2`
+/// or `avx512`) lowers it, e.g. to compare kernels.
+///
+/// \code
+///   if (simdLevel() == SimdLevel::Avx512) {
+///     std::puts("AVX-512 kernels");
+///   }
+/// \endcode
+inline SimdLevel simdLevel() {
+  static const SimdLevel Level = Util::selectSimdLevel();
+  return Level;
+}
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,622 @@
+//===-- Ecc.hpp - Parity and SECDED protection fields -----------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains field descriptors for check bits protecting the other
+/// bits of the record: per-unit parity and SECDED (single error correction,
+/// double error detection) Hamming code. The check bits are maintained
+/// incrementally on every write through proxy objects.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_ECC_HPP
+#define ORDERED_BIT_FIELD_ECC_HPP
+
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+/// Result of ECC verification of a record.
+enum class EccStatus {
+  Clean,        ///< No error was found.
+  Corrected,    ///< A single-bit error was found and corrected.
+  Uncorrectable ///< An error was found but could not be corrected.
+};
+
+/// Summary of scrubbing an array of records.
+struct ScrubResult {
+  /// Number of records whose single-bit error was corrected.
+  std::size_t Corrected = 0;
+  /// Number of records with uncorrectable errors.
+  std::size_t Uncorrectable = 0;
+};
+
+namespace Util {
+/// Parity of V.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class RawT> constexpr bool parity(RawT V) {
+#if defined(__GNUC__)
+  return __builtin_parityll(static_cast<unsigned long long>(V));
+#else
+  auto X = static_cast<unsigned long long>(V);
+  for (std::size_t S = 32; S > 0; S /= 2) {
+    X ^= X >> S;
+  }
+  return X & 1;
+#endif
+}
+
+/// Storage geometry shared by the check bit policies.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class BitFieldT, std::size_t I, std::size_t Used>
+struct EccGeometry {
+  using L = Layout<BitFieldT>;
+  using FieldType = typename L::FieldType;
+  using RawType = typename L::RawType;
+
+  static constexpr std::size_t Units = L::DataSize;
+  static constexpr std::size_t UnitBits = L::FieldTypeBits;
+  static constexpr std::size_t CheckWord = L::template word<I>();
+  static constexpr std::size_t CheckShift = L::template shift<I>();
+  static_assert(Used <= L::template bits<I>(),
+                "check field is too narrow for the record");
+
+  /// Bits of the field used as check bits.
+  static constexpr RawType UsedMask = static_cast<RawType>(
+      (Used < UnitBits ? (RawType{1} << Used) - 1 : ~RawType{}) << CheckShift);
+
+  /// Bits of each unit protected by the check bits (all but the used check
+  /// bits).
+  static constexpr std::array<RawType, Units> DataMask = [] {
+    std::array<RawType, Units> M{};
+    for (std::size_t K = 0; K < Units; ++K) {
+      M[K] = static_cast<RawType>(~RawType{});
+    }
+    M[CheckWord] = static_cast<RawType>(M[CheckWord] & ~UsedMask);
+    return M;
+  }();
+
+  static constexpr RawType raw(FieldType U) {
+    return static_cast<RawType>(static_cast<typename L::UnderlyingType>(U));
+  }
+
+  /// Bit of the J-th check bit in the check unit.
+  static constexpr RawType checkBit(std::size_t J) {
+    return static_cast<RawType>(RawType{1} << (CheckShift + J));
+  }
+
+  static constexpr RawType loadCheck(const FieldType *U) {
+    return static_cast<RawType>((raw(U[CheckWord]) & UsedMask) >> CheckShift);
+  }
+
+  static constexpr void storeCheck(FieldType *U, RawType V) {
+    U[CheckWord] = static_cast<FieldType>(
+        static_cast<typename L::UnderlyingType>(static_cast<RawType>(
+            (raw(U[CheckWord]) & ~UsedMask) |
+            (static_cast<RawType>(V << CheckShift) & UsedMask))));
+  }
+};
+
+/// Whether the all parity equations hold, i.e. for every equation E, the
+/// parity of the masked units is even.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class RawT, std::size_t E, std::size_t Units, class FieldT>
+constexpr bool
+equationsHold(const std::array<std::array<RawT, Units>, E> &Equation,
+              const FieldT *U) {
+  for (std::size_t J = 0; J < E; ++J) {
+    RawT Acc{};
+    for (std::size_t K = 0; K < Units; ++K) {
+      Acc ^= static_cast<RawT>(
+                 static_cast<Util::UnderlyingType<FieldT>>(U[K])) &
+             Equation[J][K];
+    }
+    if (parity(Acc)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Masks of the equations widened to 64 bits, one equation after another,
+/// for the compiled kernels.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class RawT, std::size_t E, std::size_t Units>
+constexpr std::array<std::uint64_t, E * Units>
+flattenEquation(const std::array<std::array<RawT, Units>, E> &Equation) {
+  std::array<std::uint64_t, E * Units> F{};
+  for (std::size_t J = 0; J < E; ++J) {
+    for (std::size_t K = 0; K < Units; ++K) {
+      F[J * Units + K] = Equation[J][K];
+    }
+  }
+  return F;
+}
+
+/// Guard policy for one parity bit per storage unit.
+///
+/// The K-th bit of the field is the parity of the K-th unit (excluding the
+/// parity bits). Remaining bits of the field are protected as the other bits.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct UnitParity {
+  template <class BitFieldT, std::size_t I>
+  struct Tables
+      : EccGeometry<BitFieldT, I, Layout<BitFieldT>::DataSize> {
+    using G = EccGeometry<BitFieldT, I, Layout<BitFieldT>::DataSize>;
+
+    /// The K-th equation covers the K-th unit and its parity bit.
+    static constexpr std::array<std::array<typename G::RawType, G::Units>,
+                                G::Units>
+        Equation = [] {
+          std::array<std::array<typename G::RawType, G::Units>, G::Units> E{};
+          for (std::size_t K = 0; K < G::Units; ++K) {
+            E[K][K] = G::DataMask[K];
+            E[K][G::CheckWord] |= G::checkBit(K);
+          }
+          return E;
+        }();
+  };
+
+  template <class BitFieldT, std::size_t I>
+  static constexpr void
+  initialize(typename Layout<BitFieldT>::FieldType *Units) {
+    using T = Tables<BitFieldT, I>;
+    typename T::RawType C{};
+    for (std::size_t K = 0; K < T::Units; ++K) {
+      C |= static_cast<typename T::RawType>(
+          typename T::RawType{parity(T::raw(Units[K]) & T::DataMask[K])} << K);
+    }
+    T::storeCheck(Units, C);
+  }
+
+  template <class BitFieldT, std::size_t I, std::size_t Word>
+  static constexpr void update(typename Layout<BitFieldT>::FieldType *Units,
+                               typename Layout<BitFieldT>::FieldType Old) {
+    using T = Tables<BitFieldT, I>;
+    if (parity((T::raw(Old) ^ T::raw(Units[Word])) & T::DataMask[Word])) {
+      T::storeCheck(Units, static_cast<typename T::RawType>(
+                               T::loadCheck(Units) ^
+                               (typename T::RawType{1} << Word)));
+    }
+  }
+
+  template <class BitFieldT, std::size_t I>
+  static constexpr EccStatus
+  repair(typename Layout<BitFieldT>::FieldType *Units) {
+    using T = Tables<BitFieldT, I>;
+    return equationsHold(T::Equation, Units) ? EccStatus::Clean
+                                             : EccStatus::Uncorrectable;
+  }
+};
+
+/// Guard policy for SECDED Hamming code over the whole record.
+///
+/// For a record of N bits, R = ceil(log2(N)) check bits and an overall parity
+/// bit are stored in the lowest R + 1 bits of the field. The other bits are
+/// numbered from the least significant bit of the first unit, skipping the
+/// check bits, and placed on the Hamming positions which are not powers of
+/// two. Bit J (< R) of the field is the parity of the bits whose position has
+/// bit J set, and bit R is the overall parity.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct Secded {
+  /// Number of Hamming check bits (without the overall parity) for a record
+  /// of N bits.
+  static constexpr std::size_t checkBits(std::size_t N) {
+    std::size_t R = 0;
+    while ((std::size_t{1} << R) < N) {
+      ++R;
+    }
+    return R;
+  }
+
+  template <class BitFieldT, std::size_t I>
+  struct Tables
+      : EccGeometry<BitFieldT, I,
+                    checkBits(Layout<BitFieldT>::DataSize *
+                              Layout<BitFieldT>::FieldTypeBits) +
+                        1> {
+    using G = EccGeometry<BitFieldT, I,
+                          checkBits(Layout<BitFieldT>::DataSize *
+                                    Layout<BitFieldT>::FieldTypeBits) +
+                              1>;
+    using RawType = typename G::RawType;
+
+    /// Number of Hamming check bits (without the overall parity).
+    static constexpr std::size_t R = checkBits(G::Units * G::UnitBits);
+
+    /// Hamming position of each bit of each unit. 0 for the check bits.
+    static constexpr std::array<std::array<std::size_t, G::UnitBits>, G::Units>
+        Position = [] {
+          std::array<std::array<std::size_t, G::UnitBits>, G::Units> P{};
+          std::size_t Pos = 1;
+          for (std::size_t K = 0; K < G::Units; ++K) {
+            for (std::size_t B = 0; B < G::UnitBits; ++B) {
+              if (G::DataMask[K] >> B & 1) {
+                while ((Pos & (Pos - 1)) == 0) {
+                  ++Pos;
+                }
+                P[K][B] = Pos++;
+              }
+            }
+          }
+          return P;
+        }();
+
+    /// Bits of each unit which the J-th check bit covers.
+    static constexpr std::array<std::array<RawType, G::Units>, R> CheckMask =
+        [] {
+          std::array<std::array<RawType, G::Units>, R> M{};
+          for (std::size_t J = 0; J < R; ++J) {
+            for (std::size_t K = 0; K < G::Units; ++K) {
+              for (std::size_t B = 0; B < G::UnitBits; ++B) {
+                if (Position[K][B] >> J & 1) {
+                  M[J][K] |= static_cast<RawType>(RawType{1} << B);
+                }
+              }
+            }
+          }
+          return M;
+        }();
+
+    /// Parity equations: one per check bit, and the overall parity.
+    static constexpr std::array<std::array<RawType, G::Units>, R + 1>
+        Equation = [] {
+          std::array<std::array<RawType, G::Units>, R + 1> E{};
+          for (std::size_t J = 0; J < R; ++J) {
+            E[J] = CheckMask[J];
+            E[J][G::CheckWord] |= G::checkBit(J);
+          }
+          E[R] = G::DataMask;
+          for (std::size_t J = 0; J <= R; ++J) {
+            E[R][G::CheckWord] |= G::checkBit(J);
+          }
+          return E;
+        }();
+
+    /// Check bits for the given difference D of the Word-th unit.
+    static constexpr RawType checkOf(std::size_t Word, RawType D) {
+      RawType C{};
+      for (std::size_t J = 0; J < R; ++J) {
+        C |= static_cast<RawType>(RawType{parity(D & CheckMask[J][Word])}
+                                  << J);
+      }
+      return static_cast<RawType>(
+          C | RawType{static_cast<bool>(parity(D) ^ parity(C))} << R);
+    }
+  };
+
+  template <class BitFieldT, std::size_t I>
+  static constexpr void
+  initialize(typename Layout<BitFieldT>::FieldType *Units) {
+    using T = Tables<BitFieldT, I>;
+    typename T::RawType C{};
+    for (std::size_t K = 0; K < T::Units; ++K) {
+      C ^= T::checkOf(K, T::raw(Units[K]) & T::DataMask[K]);
+    }
+    T::storeCheck(Units, C);
+  }
+
+  template <class BitFieldT, std::size_t I, std::size_t Word>
+  static constexpr void update(typename Layout<BitFieldT>::FieldType *Units,
+                               typename Layout<BitFieldT>::FieldType Old) {
+    using T = Tables<BitFieldT, I>;
+    const auto D = static_cast<typename T::RawType>(
+        (T::raw(Old) ^ T::raw(Units[Word])) & T::DataMask[Word]);
+    if (D) {
+      T::storeCheck(Units, static_cast<typename T::RawType>(
+                               T::loadCheck(Units) ^ T::checkOf(Word, D)));
+    }
+  }
+
+  template <class BitFieldT, std::size_t I>
+  static constexpr EccStatus
+  repair(typename Layout<BitFieldT>::FieldType *Units) {
+    using T = Tables<BitFieldT, I>;
+    using RawType = typename T::RawType;
+    std::size_t Syndrome = 0;
+    for (std::size_t J = 0; J <= T::R; ++J) {
+      RawType Acc{};
+      for (std::size_t K = 0; K < T::Units; ++K) {
+        Acc ^= T::raw(Units[K]) & T::Equation[J][K];
+      }
+      Syndrome |= std::size_t{parity(Acc)} << J;
+    }
+    if (Syndrome == 0) {
+      return EccStatus::Clean;
+    }
+    const bool Overall = Syndrome >> T::R & 1;
+    Syndrome &= (std::size_t{1} << T::R) - 1;
+    if (!Overall) {
+      // even number of errors
+      return EccStatus::Uncorrectable;
+    }
+    if (Syndrome == 0 || (Syndrome & (Syndrome - 1)) == 0) {
+      // error in a check bit
+      std::size_t J = T::R;
+      for (std::size_t B = 0; B < T::R; ++B) {
+        if (Syndrome == std::size_t{1} << B) {
+          J = B;
+        }
+      }
+      T::storeCheck(Units, static_cast<RawType>(T::loadCheck(Units) ^
+                                                (RawType{1} << J)));
+      return EccStatus::Corrected;
+    }
+    for (std::size_t K = 0; K < T::Units; ++K) {
+      for (std::size_t B = 0; B < T::UnitBits; ++B) {
+        if (T::Position[K][B] == Syndrome) {
+          Units[K] = static_cast<typename T::FieldType>(
+              static_cast<typename T::L::UnderlyingType>(
+                  static_cast<RawType>(T::raw(Units[K]) ^ (RawType{1} << B))));
+          return EccStatus::Corrected;
+        }
+      }
+    }
+    // syndrome points outside of the record
+    return EccStatus::Uncorrectable;
+  }
+};
+
+/// Ensure that the record has a parity or SECDED field.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT> constexpr void requireEcc() {
+  using Guard = typename Layout<BitFieldT>::Guard;
+  static_assert(std::is_same_v<Guard, UnitParity> ||
+                    std::is_same_v<Guard, Secded>,
+                "record has no parity or SECDED field");
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+inline namespace RefByStr {
+/// Bit field descriptor for per-unit parity bits.
+///
+/// The K-th bit of the field is the parity of the K-th storage unit. The field
+/// is const-qualified and maintained on every write through proxy objects.
+///
+/// \tparam T Name of the field.
+/// \tparam W Width of the field. Must not be less than the number of units.
+template <Util::CharArray T, std::size_t W>
+struct ParityField : Field<T, W, 0, true> {
+  /// Guard policy which maintains the field.
+  using Guard = Util::UnitParity;
+};
+
+/// Bit field descriptor for SECDED check bits of the record.
+///
+/// The field is const-qualified and maintained on every write through proxy
+/// objects.
+///
+/// \tparam T Name of the field.
+/// \tparam W Width of the field. Needs ceil(log2(N)) + 1 bits for records of
+/// N bits (e.g. 7 bits for 64-bit records).
+template <Util::CharArray T, std::size_t W>
+struct SecdedField : Field<T, W, 0, true> {
+  /// Guard policy which maintains the field.
+  using Guard = Util::Secded;
+};
+} // namespace RefByStr
+#endif
+
+#if !ORDERED_BIT_FIELD_REF_BY_STR
+inline
+#endif
+    namespace RefByEnum {
+/// Bit field descriptor for per-unit parity bits.
+///
+/// The K-th bit of the field is the parity of the K-th storage unit. The field
+/// is const-qualified and maintained on every write through proxy objects.
+///
+/// \tparam T Tag of the field.
+/// \tparam W Width of the field. Must not be less than the number of units.
+template <auto T, std::size_t W> struct ParityField : Field<T, W, 0, true> {
+  /// Guard policy which maintains the field.
+  using Guard = Util::UnitParity;
+};
+
+/// Bit field descriptor for SECDED check bits of the record.
+///
+/// The field is const-qualified and maintained on every write through proxy
+/// objects.
+///
+/// \tparam T Tag of the field.
+/// \tparam W Width of the field. Needs ceil(log2(N)) + 1 bits for records of
+/// N bits (e.g. 7 bits for 64-bit records).
+template <auto T, std::size_t W> struct SecdedField : Field<T, W, 0, true> {
+  /// Guard policy which maintains the field.
+  using Guard = Util::Secded;
+};
+} // namespace RefByEnum
+
+/// Recompute the check bits from scratch, e.g. after writing to Data directly.
+template <class... Args> constexpr void updateEcc(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::requireEcc<BitField<Args...>>();
+  L::Guard::template initialize<BitField<Args...>, L::GuardIndex>(
+      BF.Data.data());
+}
+
+/// Verify the check bits.
+///
+/// \returns true if no error is found.
+template <class... Args>
+constexpr bool verifyEcc(const BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::requireEcc<BitField<Args...>>();
+  using T = typename L::Guard::template Tables<BitField<Args...>, L::GuardIndex>;
+  return Util::equationsHold(T::Equation, BF.Data.data());
+}
+
+/// Verify the check bits and correct a single-bit error if possible.
+///
+/// \returns Result of the verification.
+template <class... Args> constexpr EccStatus repairEcc(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::requireEcc<BitField<Args...>>();
+  return L::Guard::template repair<BitField<Args...>, L::GuardIndex>(
+      BF.Data.data());
+}
+
+/// Verify N records, correcting single-bit errors if the records have SECDED
+/// fields.
+///
+/// With AVX2, records of 32-bit units are verified eight at a time and
+/// records of 64-bit units four at a time by gathers, and only the records
+/// found dirty are repaired one by one. Records of 8-bit and 16-bit units are
+/// always verified one at a time. With the compiled kernels, the vectors are
+/// those of the running CPU.
+///
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \returns Numbers of corrected and uncorrectable records.
+template <class... Args>
+ScrubResult scrub(BitField<Args...> *Records, std::size_t N) {
+  using RecordT = BitField<Args...>;
+  using L = Util::Layout<RecordT>;
+  Util::requireEcc<RecordT>();
+  using T = typename L::Guard::template Tables<RecordT, L::GuardIndex>;
+  ScrubResult Result;
+  auto repairOne = [&Result](RecordT &BF) {
+    switch (repairEcc(BF)) {
+    case EccStatus::Clean:
+      break;
+    case EccStatus::Corrected:
+      ++Result.Corrected;
+      break;
+    case EccStatus::Uncorrectable:
+      ++Result.Uncorrectable;
+      break;
+    }
+  };
+  std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+  if constexpr (sizeof(typename L::RawType) == 4 ||
+                sizeof(typename L::RawType) == 8) {
+    static constexpr auto Equation = Util::flattenEquation(T::Equation);
+    while (K < N) {
+      const std::size_t Len = N - K < 64 ? N - K : 64;
+      const std::uint64_t Dirty = Util::kernels().OddParity(
+          reinterpret_cast<const unsigned char *>(Records[K].Data.data()),
+          sizeof(RecordT), sizeof(typename L::RawType), T::Units, Len,
+          Equation.data(), T::Equation.size());
+      for (std::size_t J = 0; J < Len; ++J) {
+        if (Dirty >> J & 1) {
+          repairOne(Records[K + J]);
+        }
+      }
+      K += Len;
+    }
+  }
+#elif defined(__AVX2__)
+  if constexpr (sizeof(typename L::RawType) == 4) {
+    // eight records at once: accumulate the masked units of every equation
+    // and reduce them to parity bits by xor-folding
+    constexpr auto Stride = static_cast<int>(sizeof(RecordT) / 4);
+    const __m256i Index =
+        _mm256_setr_epi32(0, Stride, 2 * Stride, 3 * Stride, 4 * Stride,
+                          5 * Stride, 6 * Stride, 7 * Stride);
+    for (; K + 8 <= N; K += 8) {
+      const auto *P = reinterpret_cast<const int *>(Records[K].Data.data());
+      __m256i Dirty = _mm256_setzero_si256();
+      for (std::size_t J = 0; J < T::Equation.size(); ++J) {
+        __m256i Acc = _mm256_setzero_si256();
+        for (std::size_t U = 0; U < T::Units; ++U) {
+          if (T::Equation[J][U] != 0) {
+            const __m256i V = _mm256_i32gather_epi32(
+                P + U, Index, 4);
+            Acc = _mm256_xor_si256(
+                Acc, _mm256_and_si256(V, _mm256_set1_epi32(static_cast<int>(
+                                             T::Equation[J][U]))));
+          }
+        }
+        for (int S = 16; S > 0; S /= 2) {
+          Acc = _mm256_xor_si256(Acc, _mm256_srl_epi32(
+                                          Acc, _mm_cvtsi32_si128(S)));
+        }
+        Dirty = _mm256_or_si256(Dirty, Acc);
+      }
+      const auto Mask = static_cast<unsigned>(_mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_slli_epi32(Dirty, 31))));
+      for (unsigned J = 0; J < 8; ++J) {
+        if (Mask >> J & 1) {
+          repairOne(Records[K + J]);
+        }
+      }
+    }
+  } else if constexpr (sizeof(typename L::RawType) == 8) {
+    // four records at once, as above with 64-bit lanes
+    constexpr auto Stride = static_cast<long long>(sizeof(RecordT) / 8);
+    const __m256i Index =
+        _mm256_setr_epi64x(0, Stride, 2 * Stride, 3 * Stride);
+    for (; K + 4 <= N; K += 4) {
+      const auto *P =
+          reinterpret_cast<const long long *>(Records[K].Data.data());
+      __m256i Dirty = _mm256_setzero_si256();
+      for (std::size_t J = 0; J < T::Equation.size(); ++J) {
+        __m256i Acc = _mm256_setzero_si256();
+        for (std::size_t U = 0; U < T::Units; ++U) {
+          if (T::Equation[J][U] != 0) {
+            const __m256i V = _mm256_i64gather_epi64(P + U, Index, 8);
+            Acc = _mm256_xor_si256(
+                Acc, _mm256_and_si256(V, _mm256_set1_epi64x(
+                                             static_cast<long long>(
+                                                 T::Equation[J][U]))));
+          }
+        }
+        for (int S = 32; S > 0; S /= 2) {
+          Acc = _mm256_xor_si256(Acc, _mm256_srl_epi64(
+                                          Acc, _mm_cvtsi32_si128(S)));
+        }
+        Dirty = _mm256_or_si256(Dirty, Acc);
+      }
+      const auto Mask = static_cast<unsigned>(_mm256_movemask_pd(
+          _mm256_castsi256_pd(_mm256_slli_epi64(Dirty, 63))));
+      for (unsigned J = 0; J < 4; ++J) {
+        if (Mask >> J & 1) {
+          repairOne(Records[K + J]);
+        }
+      }
+    }
+  }
+#endif
+
+  for (; K < N; ++K) {
+    if (!Util::equationsHold(T::Equation, Records[K].Data.data())) {
+      repairOne(Records[K]);
+    }
+  }
+  return Result;
+}
+} // namespace OrderedBitField
+
+#endif
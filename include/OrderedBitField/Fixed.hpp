@@ -0,0 +1,306 @@
+//===-- Fixed.hpp - Fixed-point number fields -------------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains field descriptors for fixed-point (Q-format) numbers,
+/// whose proxy objects convert the raw bits to and from floating-point
+/// numbers with compile-time scale and bias.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_FIXED_HPP
+#define ORDERED_BIT_FIELD_FIXED_HPP
+
+#include "Column.hpp"
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// 2^E, computed exactly.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class T> constexpr T exp2i(int E) {
+  T R = 1;
+  for (; E > 0; --E) {
+    R *= 2;
+  }
+  for (; E < 0; ++E) {
+    R /= 2;
+  }
+  return R;
+}
+
+/// Value codec for fixed-point numbers: value = (raw + Bias) * 2^-Frac.
+///
+/// Encoding rounds to the nearest (ties to even) and saturates to the range
+/// of the field. NaN is encoded as the minimum.
+///
+/// \tparam W Width of the field.
+/// \tparam Frac Number of fractional bits. May be negative.
+/// \tparam Bias Bias added to the raw value before scaling.
+/// \tparam Signed Whether the raw value is two's complement or not.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <std::size_t W, int Frac, long long Bias, bool Signed>
+struct FixedPoint {
+  static_assert(W > 0 && W <= 32, "fixed-point field must be 1 to 32 bits");
+  static_assert(Frac > -64 && Frac < 64, "too many fractional bits");
+
+  using ValueType = double;
+
+  /// Range of the raw value.
+  static constexpr long long MinRaw = Signed ? -(1LL << (W - 1)) : 0;
+  static constexpr long long MaxRaw =
+      Signed ? (1LL << (W - 1)) - 1 : (1LL << W) - 1;
+  static constexpr std::uint32_t RawMask =
+      W < 32 ? (std::uint32_t{1} << W) - 1 : ~std::uint32_t{};
+
+  /// Whether raw + Bias always fits in std::int32_t.
+  static constexpr bool BiasedFitsInt32 =
+      MinRaw + Bias >= std::numeric_limits<std::int32_t>::min() &&
+      MaxRaw + Bias <= std::numeric_limits<std::int32_t>::max();
+
+  /// Raw value of the raw bits.
+  static constexpr long long toInt(std::uint32_t Bits) {
+    const auto V = static_cast<long long>(Bits & RawMask);
+    if constexpr (Signed) {
+      return V > MaxRaw ? V - (1LL << W) : V;
+    } else {
+      return V;
+    }
+  }
+
+  template <class T> static constexpr T decodeAs(std::uint32_t Bits) {
+    static_assert(std::is_floating_point_v<T>,
+                  "fixed-point field converts only to floating-point types");
+    return static_cast<T>(toInt(Bits) + Bias) * exp2i<T>(-Frac);
+  }
+
+  template <class T> static constexpr std::uint32_t encodeAs(T V) {
+    static_assert(std::is_floating_point_v<T>,
+                  "fixed-point field converts only from floating-point types");
+    constexpr auto Lo = static_cast<T>(MinRaw);
+    constexpr auto Hi = static_cast<T>(MaxRaw);
+    T S = V * exp2i<T>(Frac) - static_cast<T>(Bias);
+    // same as maxps/minps, which map NaN to the second operand
+    S = S > Lo ? S : Lo;
+    S = S < Hi ? S : Hi;
+    long long I = static_cast<long long>(S);
+    const T R = S - static_cast<T>(I);
+    if (R > T(0.5) || (R == T(0.5) && (I & 1))) {
+      ++I;
+    } else if (R < T(-0.5) || (R == T(-0.5) && (I & 1))) {
+      --I;
+    }
+    I = I < MinRaw ? MinRaw : I > MaxRaw ? MaxRaw : I;
+    return static_cast<std::uint32_t>(I) & RawMask;
+  }
+
+  static constexpr ValueType decode(std::uint32_t Bits) {
+    return decodeAs<ValueType>(Bits);
+  }
+
+  static constexpr std::uint32_t encode(ValueType V) { return encodeAs(V); }
+
+  template <class OutT>
+  static void decode(const std::uint32_t *Bits, std::size_t N, OutT *Out) {
+    std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+    if constexpr (BiasedFitsInt32 && (std::is_same_v<OutT, float> ||
+                                      std::is_same_v<OutT, double>)) {
+      constexpr int Ext = Signed ? static_cast<int>(32 - W) : 0;
+      constexpr auto B = static_cast<std::int32_t>(Bias);
+      if constexpr (std::is_same_v<OutT, float>) {
+        kernels().DecodeFixed(Bits, N, RawMask, Ext, B, exp2i<double>(-Frac),
+                              Out);
+      } else {
+        kernels().DecodeFixedDouble(Bits, N, RawMask, Ext, B,
+                                    exp2i<double>(-Frac), Out);
+      }
+      K = N;
+    }
+#elif defined(__AVX2__)
+    if constexpr (BiasedFitsInt32 && (std::is_same_v<OutT, float> ||
+                                      std::is_same_v<OutT, double>)) {
+      constexpr int Ext = static_cast<int>(32 - W);
+      if constexpr (std::is_same_v<OutT, float>) {
+        const __m256i B = _mm256_set1_epi32(static_cast<int>(Bias));
+        const __m256i M = _mm256_set1_epi32(static_cast<int>(RawMask));
+        const __m256 Scale = _mm256_set1_ps(exp2i<float>(-Frac));
+        for (; K + 8 <= N; K += 8) {
+          __m256i V = _mm256_and_si256(
+              _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Bits + K)),
+              M);
+          if constexpr (Signed) {
+            V = _mm256_srai_epi32(_mm256_slli_epi32(V, Ext), Ext);
+          }
+          V = _mm256_add_epi32(V, B);
+          _mm256_storeu_ps(Out + K,
+                           _mm256_mul_ps(_mm256_cvtepi32_ps(V), Scale));
+        }
+      } else {
+        const __m128i B = _mm_set1_epi32(static_cast<int>(Bias));
+        const __m128i M = _mm_set1_epi32(static_cast<int>(RawMask));
+        const __m256d Scale = _mm256_set1_pd(exp2i<double>(-Frac));
+        for (; K + 4 <= N; K += 4) {
+          __m128i V = _mm_and_si128(
+              _mm_loadu_si128(reinterpret_cast<const __m128i *>(Bits + K)), M);
+          if constexpr (Signed) {
+            V = _mm_srai_epi32(_mm_slli_epi32(V, Ext), Ext);
+          }
+          V = _mm_add_epi32(V, B);
+          _mm256_storeu_pd(Out + K,
+                           _mm256_mul_pd(_mm256_cvtepi32_pd(V), Scale));
+        }
+      }
+    }
+#endif
+
+    for (; K < N; ++K) {
+      Out[K] = decodeAs<OutT>(Bits[K]);
+    }
+  }
+
+  template <class InT>
+  static void encode(const InT *In, std::size_t N, std::uint32_t *Bits) {
+    std::size_t K = 0;
+
+    // the range of the raw value must be exact in float
+#if ORDERED_BIT_FIELD_KERNELS
+    if constexpr (std::is_same_v<InT, float> && W <= 24) {
+      kernels().EncodeFixed(In, N, exp2i<float>(Frac), static_cast<float>(Bias),
+                            static_cast<float>(MinRaw),
+                            static_cast<float>(MaxRaw), RawMask, Bits);
+      K = N;
+    }
+#elif defined(__AVX2__)
+    if constexpr (std::is_same_v<InT, float> && W <= 24) {
+      const __m256 Scale = _mm256_set1_ps(exp2i<float>(Frac));
+      const __m256 B = _mm256_set1_ps(static_cast<float>(Bias));
+      const __m256 Lo = _mm256_set1_ps(static_cast<float>(MinRaw));
+      const __m256 Hi = _mm256_set1_ps(static_cast<float>(MaxRaw));
+      const __m256i M = _mm256_set1_epi32(static_cast<int>(RawMask));
+      for (; K + 8 <= N; K += 8) {
+        __m256 S = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(In + K), Scale),
+                                 B);
+        S = _mm256_min_ps(_mm256_max_ps(S, Lo), Hi);
+        // rounds to the nearest even under the default rounding mode
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(Bits + K),
+                            _mm256_and_si256(_mm256_cvtps_epi32(S), M));
+      }
+    }
+#endif
+
+    for (; K < N; ++K) {
+      Bits[K] = encodeAs<InT>(In[K]);
+    }
+  }
+};
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+inline namespace RefByStr {
+/// Bit field descriptor for unsigned fixed-point numbers.
+///
+/// Proxy objects to the field convert from and to `double` as
+/// (raw + Bias) * 2^-Frac. Assignments round to the nearest and saturate.
+///
+/// \tparam T Name of the field.
+/// \tparam W Width of the field (at most 32).
+/// \tparam Frac Number of fractional bits. May be negative.
+/// \tparam Bias Bias added to the raw value before scaling.
+/// \tparam D Default raw value of the field.
+template <Util::CharArray T, std::size_t W, int Frac, long long Bias = 0,
+          auto D = 0>
+struct FixedField : Field<T, W, D> {
+  /// Value codec of the field.
+  using Codec = Util::FixedPoint<W, Frac, Bias, false>;
+};
+
+/// Bit field descriptor for signed (two's complement) fixed-point numbers.
+///
+/// Proxy objects to the field convert from and to `double` as
+/// (raw + Bias) * 2^-Frac. Assignments round to the nearest and saturate.
+///
+/// \tparam T Name of the field.
+/// \tparam W Width of the field (at most 32).
+/// \tparam Frac Number of fractional bits. May be negative.
+/// \tparam Bias Bias added to the raw value before scaling.
+/// \tparam D Default raw value of the field.
+template <Util::CharArray T, std::size_t W, int Frac, long long Bias = 0,
+          auto D = 0>
+struct SignedFixedField : Field<T, W, D> {
+  /// Value codec of the field.
+  using Codec = Util::FixedPoint<W, Frac, Bias, true>;
+};
+} // namespace RefByStr
+#endif
+
+#if !ORDERED_BIT_FIELD_REF_BY_STR
+inline
+#endif
+    namespace RefByEnum {
+/// Bit field descriptor for unsigned fixed-point numbers.
+///
+/// Proxy objects to the field convert from and to `double` as
+/// (raw + Bias) * 2^-Frac. Assignments round to the nearest and saturate.
+///
+/// \tparam T Tag of the field.
+/// \tparam W Width of the field (at most 32).
+/// \tparam Frac Number of fractional bits. May be negative.
+/// \tparam Bias Bias added to the raw value before scaling.
+/// \tparam D Default raw value of the field.
+///
+/// \code
+///   enum class Tag { Temp, Id };
+///   // -40.0 to 87.9375 in steps of 1/16
+///   using R = BitField<std::uint32_t, FixedField<Tag::Temp, 11, 4, -640>,
+///                      Field<Tag::Id, 21>>;
+///   R Record;
+///   get<Tag::Temp>(Record) = 21.5;
+///   double Temp = get<Tag::Temp>(Record);
+/// \endcode
+template <auto T, std::size_t W, int Frac, long long Bias = 0, auto D = 0>
+struct FixedField : Field<T, W, D> {
+  /// Value codec of the field.
+  using Codec = Util::FixedPoint<W, Frac, Bias, false>;
+};
+
+/// Bit field descriptor for signed (two's complement) fixed-point numbers.
+///
+/// Proxy objects to the field convert from and to `double` as
+/// (raw + Bias) * 2^-Frac. Assignments round to the nearest and saturate.
+///
+/// \tparam T Tag of the field.
+/// \tparam W Width of the field (at most 32).
+/// \tparam Frac Number of fractional bits. May be negative.
+/// \tparam Bias Bias added to the raw value before scaling.
+/// \tparam D Default raw value of the field.
+template <auto T, std::size_t W, int Frac, long long Bias = 0, auto D = 0>
+struct SignedFixedField : Field<T, W, D> {
+  /// Value codec of the field.
+  using Codec = Util::FixedPoint<W, Frac, Bias, true>;
+};
+} // namespace RefByEnum
+} // namespace OrderedBitField
+
+#endif
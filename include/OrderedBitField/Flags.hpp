@@ -0,0 +1,354 @@
+//===-- Flags.hpp - Groups of named 1-bit flags -----------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a field descriptor for a group of named 1-bit flags in
+/// one storage unit, and operations on several flags at once with a single
+/// masked operation.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_FLAGS_HPP
+#define ORDERED_BIT_FIELD_FLAGS_HPP
+
+#include "OrderedBitField.hpp"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+#include <string_view>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Helper class to detect flag group descriptors.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class F, class = std::void_t<>>
+struct IsFlagGroup : std::false_type {};
+
+template <class F>
+struct IsFlagGroup<F, std::void_t<decltype(F::FlagTags)>> : std::true_type {};
+
+/// Find the bit of the flag in the flag group.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class GroupT, auto Flag> constexpr std::size_t flagIndex() {
+  constexpr std::size_t Index = [] {
+    for (std::size_t K = 0; K < GroupT::FlagTags.size(); ++K) {
+      if (Flag == GroupT::FlagTags[K]) {
+        return K;
+      }
+    }
+    return GroupT::FlagTags.size();
+  }();
+  static_assert(Index < GroupT::FlagTags.size(), "flag not found");
+  return Index;
+}
+
+/// Mask of the flags of the I-th field (a flag group) in its storage unit.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT, std::size_t I, auto... Flags>
+constexpr typename Layout<BitFieldT>::RawType flagMask() {
+  using L = Layout<BitFieldT>;
+  using RawType = typename L::RawType;
+  using GroupT = typename L::template Descriptor<I>;
+  static_assert(IsFlagGroup<GroupT>::value, "field is not a flag group");
+  static_assert(GroupT::FlagTags.size() <= L::FieldTypeBits,
+                "flag group must fit in a storage unit");
+  return static_cast<RawType>(
+      ((RawType{1} << flagIndex<GroupT, Flags>()) | ... | RawType{})
+      << L::template shift<I>());
+}
+
+/// Whether any of the flags of the I-th field is set.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, auto... Flags, class BitFieldT>
+constexpr bool testAnyByIndex(const BitFieldT &BF) {
+  using L = Layout<BitFieldT>;
+  constexpr auto M = flagMask<BitFieldT, I, Flags...>();
+  return (L::template unit<L::template word<I>()>(BF) & M) != 0;
+}
+
+/// Whether all the flags of the I-th field are set.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, auto... Flags, class BitFieldT>
+constexpr bool testAllByIndex(const BitFieldT &BF) {
+  using L = Layout<BitFieldT>;
+  constexpr auto M = flagMask<BitFieldT, I, Flags...>();
+  return (L::template unit<L::template word<I>()>(BF) & M) == M;
+}
+
+/// Apply (unit & And) ^ Xor to the storage unit of the I-th field.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT>
+constexpr void modifyFlagsByIndex(BitFieldT &BF,
+                                  typename Layout<BitFieldT>::RawType And,
+                                  typename Layout<BitFieldT>::RawType Xor) {
+  using L = Layout<BitFieldT>;
+  static_assert(!L::template fixed<I>(),
+                "assignment of read-only memeber is not allowed");
+  constexpr std::size_t W = L::template word<I>();
+  L::template storeUnit<W>(
+      BF, static_cast<typename L::RawType>(
+              (L::template unit<W>(BF) & And) ^ Xor));
+}
+
+/// Call F with the tag of each set flag of the I-th field, in the order of
+/// the declaration.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT, class FuncT>
+constexpr void forEachSetByIndex(const BitFieldT &BF, FuncT &&F) {
+  using L = Layout<BitFieldT>;
+  using GroupT = typename L::template Descriptor<I>;
+  static_assert(IsFlagGroup<GroupT>::value, "field is not a flag group");
+  auto Bits = static_cast<unsigned long long>(L::template load<I>(BF));
+  while (Bits) {
+#if defined(__GNUC__)
+    const auto K = static_cast<std::size_t>(__builtin_ctzll(Bits));
+#else
+    std::size_t K = 0;
+    while (!(Bits >> K & 1)) {
+      ++K;
+    }
+#endif
+    F(GroupT::FlagTags[K]);
+    Bits &= Bits - 1;
+  }
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+inline namespace RefByStr {
+/// Bit field descriptor for a group of named 1-bit flags.
+///
+/// The K-th flag is the K-th bit of the field. The group must fit in one
+/// storage unit, so that operations on several flags are single masked
+/// operations.
+///
+/// \tparam T Name of the field.
+/// \tparam Flags Names of the flags.
+template <Util::CharArray T, Util::CharArray... Flags>
+struct FlagGroup : Field<T, sizeof...(Flags)> {
+  /// Names of the flags.
+  static constexpr std::array<std::string_view, sizeof...(Flags)> FlagTags = {
+      Flags.asStringView()...};
+};
+} // namespace RefByStr
+#endif
+
+#if !ORDERED_BIT_FIELD_REF_BY_STR
+inline
+#endif
+    namespace RefByEnum {
+/// Bit field descriptor for a group of named 1-bit flags.
+///
+/// The K-th flag is the K-th bit of the field. The group must fit in one
+/// storage unit, so that operations on several flags are single masked
+/// operations.
+///
+/// \tparam T Tag of the field.
+/// \tparam FirstFlag Tag of the first flag.
+/// \tparam Flags Tags of the other flags, of the same type as FirstFlag.
+///
+/// \code
+///   enum class Tag { Perm, Owner };
+///   enum class Perm { Read, Write, Exec };
+///   using R = BitField<std::uint32_t,
+///                      FlagGroup<Tag::Perm, Perm::Read, Perm::Write,
+///                                Perm::Exec>,
+///                      Field<Tag::Owner, 29>>;
+///   R Record;
+///   setFlags<Tag::Perm, Perm::Read, Perm::Write>(Record);
+///   assert((testAll<Tag::Perm, Perm::Read, Perm::Write>(Record)));
+/// \endcode
+template <auto T, auto FirstFlag, decltype(FirstFlag)... Flags>
+struct FlagGroup : Field<T, sizeof...(Flags) + 1> {
+  /// Tags of the flags.
+  static constexpr std::array<decltype(FirstFlag), sizeof...(Flags) + 1>
+      FlagTags = {FirstFlag, Flags...};
+};
+} // namespace RefByEnum
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Whether any of the flags is set.
+///
+/// \tparam Group Name of the flag group.
+/// \tparam Flags Names of the flags.
+template <Util::CharArray Group, Util::CharArray... Flags, class... Args,
+          decltype(Group == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+constexpr bool testAny(const BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::testAnyByIndex<L::template index<Group>(), Flags...>(BF);
+}
+
+/// Whether all the flags are set.
+///
+/// \tparam Group Name of the flag group.
+/// \tparam Flags Names of the flags.
+template <Util::CharArray Group, Util::CharArray... Flags, class... Args,
+          decltype(Group == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+constexpr bool testAll(const BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::testAllByIndex<L::template index<Group>(), Flags...>(BF);
+}
+
+/// Set the flags.
+///
+/// \tparam Group Name of the flag group.
+/// \tparam Flags Names of the flags.
+template <Util::CharArray Group, Util::CharArray... Flags, class... Args,
+          decltype(Group == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+constexpr void setFlags(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  constexpr std::size_t I = L::template index<Group>();
+  constexpr auto M = Util::flagMask<BitField<Args...>, I, Flags...>();
+  Util::modifyFlagsByIndex<I>(BF, static_cast<typename L::RawType>(~M), M);
+}
+
+/// Clear the flags.
+///
+/// \tparam Group Name of the flag group.
+/// \tparam Flags Names of the flags.
+template <Util::CharArray Group, Util::CharArray... Flags, class... Args,
+          decltype(Group == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+constexpr void clearFlags(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  constexpr std::size_t I = L::template index<Group>();
+  constexpr auto M = Util::flagMask<BitField<Args...>, I, Flags...>();
+  Util::modifyFlagsByIndex<I>(BF, static_cast<typename L::RawType>(~M), 0);
+}
+
+/// Toggle the flags.
+///
+/// \tparam Group Name of the flag group.
+/// \tparam Flags Names of the flags.
+template <Util::CharArray Group, Util::CharArray... Flags, class... Args,
+          decltype(Group == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+constexpr void toggleFlags(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  constexpr std::size_t I = L::template index<Group>();
+  constexpr auto M = Util::flagMask<BitField<Args...>, I, Flags...>();
+  Util::modifyFlagsByIndex<I>(BF, static_cast<typename L::RawType>(~0ULL), M);
+}
+
+/// Call F with the name (std::string_view) of each set flag.
+///
+/// \tparam Group Name of the flag group.
+template <Util::CharArray Group, class... Args, class FuncT,
+          decltype(Group == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+constexpr void forEachSet(const BitField<Args...> &BF, FuncT &&F) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::forEachSetByIndex<L::template index<Group>()>(BF, F);
+}
+#endif
+
+/// Whether any of the flags is set.
+///
+/// \tparam Group Tag of the flag group.
+/// \tparam Flags Tags of the flags.
+template <auto Group, auto... Flags, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+constexpr bool testAny(const BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::testAnyByIndex<L::template index<Group>(), Flags...>(BF);
+}
+
+/// Whether all the flags are set.
+///
+/// \tparam Group Tag of the flag group.
+/// \tparam Flags Tags of the flags.
+template <auto Group, auto... Flags, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+constexpr bool testAll(const BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::testAllByIndex<L::template index<Group>(), Flags...>(BF);
+}
+
+/// Set the flags.
+///
+/// \tparam Group Tag of the flag group.
+/// \tparam Flags Tags of the flags.
+template <auto Group, auto... Flags, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+constexpr void setFlags(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  constexpr std::size_t I = L::template index<Group>();
+  constexpr auto M = Util::flagMask<BitField<Args...>, I, Flags...>();
+  Util::modifyFlagsByIndex<I>(BF, static_cast<typename L::RawType>(~M), M);
+}
+
+/// Clear the flags.
+///
+/// \tparam Group Tag of the flag group.
+/// \tparam Flags Tags of the flags.
+template <auto Group, auto... Flags, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+constexpr void clearFlags(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  constexpr std::size_t I = L::template index<Group>();
+  constexpr auto M = Util::flagMask<BitField<Args...>, I, Flags...>();
+  Util::modifyFlagsByIndex<I>(BF, static_cast<typename L::RawType>(~M), 0);
+}
+
+/// Toggle the flags.
+///
+/// \tparam Group Tag of the flag group.
+/// \tparam Flags Tags of the flags.
+template <auto Group, auto... Flags, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+constexpr void toggleFlags(BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  constexpr std::size_t I = L::template index<Group>();
+  constexpr auto M = Util::flagMask<BitField<Args...>, I, Flags...>();
+  Util::modifyFlagsByIndex<I>(BF, static_cast<typename L::RawType>(~0ULL), M);
+}
+
+/// Call F with the tag of each set flag, in the order of the declaration.
+///
+/// \tparam Group Tag of the flag group.
+///
+/// \code
+///   forEachSet<Tag::Perm>(Record, [](Perm P) { std::cout << int(P); });
+/// \endcode
+template <auto Group, class... Args, class FuncT,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+constexpr void forEachSet(const BitField<Args...> &BF, FuncT &&F) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::forEachSetByIndex<L::template index<Group>()>(BF, F);
+}
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,315 @@
+//===-- Gather.hpp - Batched random-access reads of records -----*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains batched reads of a field, or of whole records, at random
+/// indices of an array of BitField records. The lookups are pipelined with
+/// software prefetches so that the cache misses overlap.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_GATHER_HPP
+#define ORDERED_BIT_FIELD_GATHER_HPP
+
+#include "Column.hpp"
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Default number of lookups the prefetches run ahead of the loads.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t PrefetchDistance = 16;
+
+/// Prefetch the cache line holding P for reading.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline void prefetchRead(const void *P) {
+#if defined(__GNUC__)
+  __builtin_prefetch(P, 0, 3);
+#else
+  static_cast<void>(P);
+#endif
+}
+
+/// Prefetch the cache line holding P for writing.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline void prefetchWrite(void *P) {
+#if defined(__GNUC__)
+  __builtin_prefetch(P, 1, 3);
+#else
+  static_cast<void>(P);
+#endif
+}
+
+/// Prefetch the I-th field of the records at Indices[Begin, End).
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT, class IndexT>
+void prefetchField(const BitFieldT *Records, const IndexT *Indices,
+                   std::size_t Begin, std::size_t End) {
+  constexpr std::size_t Word = Layout<BitFieldT>::template word<I>();
+  for (std::size_t K = Begin; K < End; ++K) {
+    prefetchRead(Records[Indices[K]].Data.data() + Word);
+  }
+}
+
+/// Load raw bits of the I-th field of the records at N indices. Prefetches
+/// look up to Limit (>= N) indices.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT, class IndexT>
+void gatherRaw(const BitFieldT *Records, const IndexT *Indices, std::size_t N,
+               typename Layout<BitFieldT>::RawType *Out, std::size_t Distance,
+               std::size_t Limit) {
+  using L = Layout<BitFieldT>;
+  std::size_t K = 0;
+  if (N == 0) {
+    // Records may be null
+    return;
+  }
+
+  // offsets are 64-bit so that arrays beyond 4 GiB are reachable
+#if ORDERED_BIT_FIELD_KERNELS
+  using RawType = typename L::RawType;
+  if constexpr (sizeof(BitFieldT) % sizeof(RawType) == 0 &&
+                (sizeof(RawType) == 4 || sizeof(RawType) == 8)) {
+    constexpr std::size_t Word = L::template word<I>();
+    constexpr std::size_t Shift = L::template shift<I>();
+    constexpr RawType Mask =
+        static_cast<RawType>(L::template mask<I>() >> Shift);
+    const auto *Base =
+        reinterpret_cast<const unsigned char *>(Records[0].Data.data() + Word);
+    std::uint64_t Index[ColumnTile];
+    while (K < N) {
+      const std::size_t Len = std::min(ColumnTile, N - K);
+      for (std::size_t J = 0; J < Len; ++J) {
+        if (Distance && K + J + Distance < Limit) {
+          prefetchField<I>(Records, Indices, K + J + Distance,
+                           K + J + Distance + 1);
+        }
+        Index[J] = static_cast<std::uint64_t>(Indices[K + J]);
+      }
+      kernels().GatherBits(Base, sizeof(BitFieldT), sizeof(RawType), Index,
+                           Len, static_cast<unsigned>(Shift), Mask,
+                           reinterpret_cast<unsigned char *>(Out + K));
+      K += Len;
+    }
+  }
+#elif defined(__AVX512F__)
+  using RawType = typename L::RawType;
+  if constexpr (sizeof(BitFieldT) % sizeof(RawType) == 0 &&
+                (sizeof(RawType) == 4 || sizeof(RawType) == 8)) {
+    constexpr std::size_t Word = L::template word<I>();
+    constexpr std::size_t Shift = L::template shift<I>();
+    constexpr RawType Mask =
+        static_cast<RawType>(L::template mask<I>() >> Shift);
+    constexpr std::size_t Stride = sizeof(BitFieldT) / sizeof(RawType);
+    const auto *Base = Records[0].Data.data() + Word;
+    for (; K + 8 <= N; K += 8) {
+      if (Distance) {
+        prefetchField<I>(Records, Indices, std::min(Limit, K + Distance),
+                         std::min(Limit, K + Distance + 8));
+      }
+      alignas(64) long long Off[8];
+      for (std::size_t J = 0; J < 8; ++J) {
+        Off[J] = static_cast<long long>(Indices[K + J] * Stride);
+      }
+      const __m512i Index = _mm512_load_si512(Off);
+      // masked forms keep GCC from warning about undefined pass-through
+      if constexpr (sizeof(RawType) == 8) {
+        __m512i V = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(),
+                                                __mmask8{0xff}, Index, Base, 8);
+        V = _mm512_and_si512(
+            _mm512_maskz_srli_epi64(__mmask8{0xff}, V,
+                                    static_cast<unsigned>(Shift)),
+            _mm512_set1_epi64(static_cast<long long>(Mask)));
+        _mm512_storeu_si512(Out + K, V);
+      } else {
+        __m256i V = _mm512_mask_i64gather_epi32(_mm256_setzero_si256(),
+                                                __mmask8{0xff}, Index, Base, 4);
+        V = _mm256_and_si256(_mm256_srli_epi32(V, static_cast<int>(Shift)),
+                             _mm256_set1_epi32(static_cast<int>(Mask)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(Out + K), V);
+      }
+    }
+  }
+#elif defined(__AVX2__)
+  using RawType = typename L::RawType;
+  if constexpr (sizeof(BitFieldT) % sizeof(RawType) == 0 &&
+                (sizeof(RawType) == 4 || sizeof(RawType) == 8)) {
+    constexpr std::size_t Word = L::template word<I>();
+    constexpr std::size_t Shift = L::template shift<I>();
+    constexpr RawType Mask =
+        static_cast<RawType>(L::template mask<I>() >> Shift);
+    constexpr std::size_t Stride = sizeof(BitFieldT) / sizeof(RawType);
+    const auto *Base = Records[0].Data.data() + Word;
+    for (; K + 4 <= N; K += 4) {
+      if (Distance) {
+        prefetchField<I>(Records, Indices, std::min(Limit, K + Distance),
+                         std::min(Limit, K + Distance + 4));
+      }
+      const __m256i Index = _mm256_setr_epi64x(
+          static_cast<long long>(Indices[K] * Stride),
+          static_cast<long long>(Indices[K + 1] * Stride),
+          static_cast<long long>(Indices[K + 2] * Stride),
+          static_cast<long long>(Indices[K + 3] * Stride));
+      if constexpr (sizeof(RawType) == 8) {
+        __m256i V = _mm256_i64gather_epi64(
+            reinterpret_cast<const long long *>(Base), Index, 8);
+        V = _mm256_and_si256(_mm256_srli_epi64(V, static_cast<int>(Shift)),
+                             _mm256_set1_epi64x(static_cast<long long>(Mask)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(Out + K), V);
+      } else {
+        __m128i V = _mm256_i64gather_epi32(reinterpret_cast<const int *>(Base),
+                                           Index, 4);
+        V = _mm_and_si128(_mm_srli_epi32(V, static_cast<int>(Shift)),
+                          _mm_set1_epi32(static_cast<int>(Mask)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(Out + K), V);
+      }
+    }
+  }
+#endif
+
+  for (; K < N; ++K) {
+    if (Distance && K + Distance < Limit) {
+      prefetchField<I>(Records, Indices, K + Distance, K + Distance + 1);
+    }
+    Out[K] = L::template load<I>(Records[Indices[K]]);
+  }
+}
+
+/// Load values of the I-th field of the records at N indices into Out.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class BitFieldT, class IndexT, class OutT>
+void gatherFieldByIndex(const BitFieldT *Records, const IndexT *Indices,
+                        std::size_t N, OutT *Out, std::size_t Distance) {
+  using L = Layout<BitFieldT>;
+  using RawType = typename L::RawType;
+  static_assert(std::is_integral_v<IndexT>, "indices must be integers");
+  if constexpr (std::is_same_v<OutT, RawType> &&
+                std::is_unsigned_v<typename L::UnderlyingType>) {
+    gatherRaw<I>(Records, Indices, N, Out, Distance, N);
+  } else {
+    RawType Buf[ColumnTile];
+    for (std::size_t B = 0; B < N; B += ColumnTile) {
+      const std::size_t Len = std::min(ColumnTile, N - B);
+      gatherRaw<I>(Records, Indices + B, Len, Buf, Distance, N - B);
+      for (std::size_t K = 0; K < Len; ++K) {
+        Out[B + K] = static_cast<OutT>(L::template value<I>(Buf[K]));
+      }
+    }
+  }
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Load values of a field of the records at N random indices.
+///
+/// \tparam Query Name of the field.
+/// \param Records Pointer to the first record.
+/// \param Indices Pointer to the first index (N elements).
+/// \param N Number of indices.
+/// \param Out Pointer to the first element of the output (N elements).
+/// \param Distance Number of lookups the prefetches run ahead of the loads. 0
+/// disables the prefetches.
+template <Util::CharArray Query, class... Args, class IndexT, class OutT,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+void gatherField(const BitField<Args...> *Records, const IndexT *Indices,
+                 std::size_t N, OutT *Out,
+                 std::size_t Distance = Util::PrefetchDistance) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::gatherFieldByIndex<L::template index<Query>()>(Records, Indices, N,
+                                                       Out, Distance);
+}
+#endif
+
+/// Load values of a field of the records at N random indices.
+///
+/// The lookups are pipelined with software prefetches Distance lookups ahead,
+/// and done by hardware gathers where AVX2 or AVX-512 is available and the
+/// field is in 32-bit or 64-bit storage units. Tune Distance to the memory
+/// latency divided by the time per lookup.
+///
+/// \tparam Query Tag of the field.
+/// \param Records Pointer to the first record.
+/// \param Indices Pointer to the first index (N elements).
+/// \param N Number of indices.
+/// \param Out Pointer to the first element of the output (N elements).
+/// \param Distance Number of lookups the prefetches run ahead of the loads. 0
+/// disables the prefetches.
+///
+/// \code
+///   enum class Tag { Key, Payload };
+///   using R = BitField<std::uint64_t, Field<Tag::Key, 40>,
+///                      Field<Tag::Payload, 24>>;
+///   std::vector<R> Table(M);
+///   std::vector<std::uint64_t> Probe(N), Keys(N);
+///   gatherField<Tag::Key>(Table.data(), Probe.data(), N, Keys.data());
+/// \endcode
+template <auto Query, class... Args, class IndexT, class OutT,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void gatherField(const BitField<Args...> *Records, const IndexT *Indices,
+                 std::size_t N, OutT *Out,
+                 std::size_t Distance = Util::PrefetchDistance) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::gatherFieldByIndex<L::template index<Query>()>(Records, Indices, N,
+                                                       Out, Distance);
+}
+
+/// Copy the records at N random indices, pipelined with software prefetches
+/// of all the cache lines of the records.
+///
+/// \param Records Pointer to the first record.
+/// \param Indices Pointer to the first index (N elements).
+/// \param N Number of indices.
+/// \param Out Pointer to the first output record (N records).
+/// \param Distance Number of lookups the prefetches run ahead of the loads. 0
+/// disables the prefetches.
+template <class... Args, class IndexT>
+void gatherRecords(const BitField<Args...> *Records, const IndexT *Indices,
+                   std::size_t N, BitField<Args...> *Out,
+                   std::size_t Distance = Util::PrefetchDistance) {
+  static_assert(std::is_integral_v<IndexT>, "indices must be integers");
+  constexpr std::size_t Size = sizeof(BitField<Args...>);
+  for (std::size_t K = 0; K < N; ++K) {
+    if (Distance && K + Distance < N) {
+      const auto Addr =
+          reinterpret_cast<std::uintptr_t>(Records + Indices[K + Distance]);
+      // every cache line which the record touches
+      for (auto Line = Addr / 64 * 64; Line < Addr + Size; Line += 64) {
+        Util::prefetchRead(reinterpret_cast<const void *>(Line));
+      }
+    }
+    Out[K] = Records[Indices[K]];
+  }
+}
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,384 @@
+//===-- Half.hpp - Half-precision and bfloat16 fields -----------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains field descriptors for 16-bit floating-point numbers
+/// (IEEE 754 binary16 and bfloat16), whose proxy objects convert the raw bits
+/// to and from `float`. F16C instructions are used if available, and the
+/// software conversion gives the same bits otherwise.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_HALF_HPP
+#define ORDERED_BIT_FIELD_HALF_HPP
+
+#include "Column.hpp"
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_bit_cast)
+#include <bit>
+#endif
+
+#if defined(__AVX2__) || defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+// whether constant evaluation can be told apart, also in C++17 by the
+// builtin of GCC 9 and Clang 9 on which std::is_constant_evaluated is built
+#if defined(__cpp_lib_is_constant_evaluated)
+#define ORDERED_BIT_FIELD_HAS_IS_CONSTANT_EVALUATED 1
+#elif defined(__clang__)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define ORDERED_BIT_FIELD_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#define ORDERED_BIT_FIELD_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Reinterpret the object representation of V as To.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class To, class From> constexpr To bitCast(From V) {
+  static_assert(sizeof(To) == sizeof(From), "sizes must be the same");
+#if defined(__cpp_lib_bit_cast)
+  return std::bit_cast<To>(V);
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+  return __builtin_bit_cast(To, V);
+#else
+  To R{};
+  std::memcpy(&R, &V, sizeof(To));
+  return R;
+#endif
+#else
+  To R{};
+  std::memcpy(&R, &V, sizeof(To));
+  return R;
+#endif
+}
+
+#if ORDERED_BIT_FIELD_HAS_IS_CONSTANT_EVALUATED
+/// Whether the call is evaluated in a constant expression.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr bool isConstantEvaluated() noexcept {
+#if defined(__cpp_lib_is_constant_evaluated)
+  return std::is_constant_evaluated();
+#else
+  return __builtin_is_constant_evaluated();
+#endif
+}
+#endif
+
+/// Software conversion from binary16 to binary32. Signaling NaNs are quieted
+/// as vcvtph2ps does.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint32_t halfToFloatBits(std::uint16_t H) {
+  const std::uint32_t Sign = static_cast<std::uint32_t>(H & 0x8000) << 16;
+  std::uint32_t E = H >> 10 & 0x1f;
+  std::uint32_t M = H & 0x3ff;
+  if (E == 0x1f) {
+    return Sign | 0x7f800000 | M << 13 | (M ? 0x400000 : 0);
+  }
+  if (E == 0) {
+    if (M == 0) {
+      return Sign;
+    }
+    // subnormal: normalize the mantissa
+    E = 1;
+    while (!(M & 0x400)) {
+      M <<= 1;
+      --E;
+    }
+    M &= 0x3ff;
+  }
+  return Sign | (E + 112) << 23 | M << 13;
+}
+
+/// Software conversion from binary32 to binary16, rounding to the nearest
+/// even. NaNs are quieted and keep the upper bits of the payload as
+/// vcvtps2ph does.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint16_t floatBitsToHalf(std::uint32_t F) {
+  const auto Sign = static_cast<std::uint16_t>(F >> 16 & 0x8000);
+  const std::uint32_t Abs = F & 0x7fffffff;
+  if (Abs > 0x7f800000) {
+    return static_cast<std::uint16_t>(Sign | 0x7e00 | (Abs >> 13 & 0x3ff));
+  }
+  if (Abs >= 0x477ff000) {
+    // rounds to infinity (65520 is a tie to the even infinity)
+    return static_cast<std::uint16_t>(Sign | 0x7c00);
+  }
+  if (Abs < 0x38800000) {
+    // subnormal or zero
+    if (Abs <= 0x33000000) {
+      return Sign;
+    }
+    const std::uint32_t M = (Abs & 0x7fffff) | 0x800000;
+    const std::uint32_t Shift = 126 - (Abs >> 23);
+    std::uint32_t R = M >> Shift;
+    const std::uint32_t Rem = M & ((std::uint32_t{1} << Shift) - 1);
+    const std::uint32_t Half = std::uint32_t{1} << (Shift - 1);
+    if (Rem > Half || (Rem == Half && (R & 1))) {
+      ++R;
+    }
+    return static_cast<std::uint16_t>(Sign | R);
+  }
+  std::uint32_t R = (Abs >> 13) - (112 << 10);
+  const std::uint32_t Rem = Abs & 0x1fff;
+  if (Rem > 0x1000 || (Rem == 0x1000 && (R & 1))) {
+    ++R;
+  }
+  return static_cast<std::uint16_t>(Sign | R);
+}
+
+/// Value codec for IEEE 754 binary16.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct Half {
+  using ValueType = float;
+
+  static constexpr ValueType decode(std::uint32_t Bits) {
+#if defined(__F16C__) && ORDERED_BIT_FIELD_HAS_IS_CONSTANT_EVALUATED
+    if (!isConstantEvaluated()) {
+      return _cvtsh_ss(static_cast<unsigned short>(Bits));
+    }
+#endif
+    return bitCast<float>(halfToFloatBits(static_cast<std::uint16_t>(Bits)));
+  }
+
+  static constexpr std::uint32_t encode(ValueType V) {
+#if defined(__F16C__) && ORDERED_BIT_FIELD_HAS_IS_CONSTANT_EVALUATED
+    if (!isConstantEvaluated()) {
+      return _cvtss_sh(V, _MM_FROUND_TO_NEAREST_INT);
+    }
+#endif
+    return floatBitsToHalf(bitCast<std::uint32_t>(V));
+  }
+
+  template <class OutT>
+  static void decode(const std::uint32_t *Bits, std::size_t N, OutT *Out) {
+    std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+    if constexpr (std::is_same_v<OutT, float>) {
+      kernels().DecodeHalf(Bits, N, Out);
+      K = N;
+    }
+#elif defined(__F16C__) && defined(__AVX2__)
+    if constexpr (std::is_same_v<OutT, float>) {
+      for (; K + 8 <= N; K += 8) {
+        const __m128i H = _mm_packus_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(Bits + K)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(Bits + K + 4)));
+        _mm256_storeu_ps(Out + K, _mm256_cvtph_ps(H));
+      }
+    }
+#endif
+
+    for (; K < N; ++K) {
+      Out[K] = static_cast<OutT>(decode(Bits[K]));
+    }
+  }
+
+  template <class InT>
+  static void encode(const InT *In, std::size_t N, std::uint32_t *Bits) {
+    std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+    if constexpr (std::is_same_v<InT, float>) {
+      kernels().EncodeHalf(In, N, Bits);
+      K = N;
+    }
+#elif defined(__F16C__) && defined(__AVX2__)
+    if constexpr (std::is_same_v<InT, float>) {
+      for (; K + 8 <= N; K += 8) {
+        const __m128i H =
+            _mm256_cvtps_ph(_mm256_loadu_ps(In + K), _MM_FROUND_TO_NEAREST_INT);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(Bits + K),
+                            _mm256_cvtepu16_epi32(H));
+      }
+    }
+#endif
+
+    for (; K < N; ++K) {
+      Bits[K] = encode(static_cast<ValueType>(In[K]));
+    }
+  }
+};
+
+/// Value codec for bfloat16 (upper half of binary32).
+///
+/// Encoding rounds to the nearest even. NaNs are quieted.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct BFloat16 {
+  using ValueType = float;
+
+  static constexpr ValueType decode(std::uint32_t Bits) {
+    return bitCast<float>(Bits << 16);
+  }
+
+  static constexpr std::uint32_t encode(ValueType V) {
+    const auto F = bitCast<std::uint32_t>(V);
+    if ((F & 0x7fffffff) > 0x7f800000) {
+      return (F >> 16) | 0x40;
+    }
+    return (F + 0x7fff + (F >> 16 & 1)) >> 16;
+  }
+
+  template <class OutT>
+  static void decode(const std::uint32_t *Bits, std::size_t N, OutT *Out) {
+    std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+    if constexpr (std::is_same_v<OutT, float>) {
+      kernels().DecodeBFloat16(Bits, N, Out);
+      K = N;
+    }
+#elif defined(__AVX2__)
+    if constexpr (std::is_same_v<OutT, float>) {
+      for (; K + 8 <= N; K += 8) {
+        const __m256i V =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Bits + K));
+        _mm256_storeu_ps(Out + K,
+                         _mm256_castsi256_ps(_mm256_slli_epi32(V, 16)));
+      }
+    }
+#endif
+
+    for (; K < N; ++K) {
+      Out[K] = static_cast<OutT>(decode(Bits[K]));
+    }
+  }
+
+  template <class InT>
+  static void encode(const InT *In, std::size_t N, std::uint32_t *Bits) {
+    std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+    if constexpr (std::is_same_v<InT, float>) {
+      kernels().EncodeBFloat16(In, N, Bits);
+      K = N;
+    }
+#elif defined(__AVX2__)
+    if constexpr (std::is_same_v<InT, float>) {
+      const __m256i Bias = _mm256_set1_epi32(0x7fff);
+      const __m256i One = _mm256_set1_epi32(1);
+      const __m256i Quiet = _mm256_set1_epi32(0x40);
+      for (; K + 8 <= N; K += 8) {
+        const __m256 X = _mm256_loadu_ps(In + K);
+        const __m256i F = _mm256_castps_si256(X);
+        const __m256i Odd = _mm256_and_si256(_mm256_srli_epi32(F, 16), One);
+        const __m256i Rounded = _mm256_srli_epi32(
+            _mm256_add_epi32(_mm256_add_epi32(F, Bias), Odd), 16);
+        const __m256i NaN = _mm256_or_si256(_mm256_srli_epi32(F, 16), Quiet);
+        const __m256 IsNaN = _mm256_cmp_ps(X, X, _CMP_UNORD_Q);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(Bits + K),
+                            _mm256_castps_si256(_mm256_blendv_ps(
+                                _mm256_castsi256_ps(Rounded),
+                                _mm256_castsi256_ps(NaN), IsNaN)));
+      }
+    }
+#endif
+
+    for (; K < N; ++K) {
+      Bits[K] = encode(static_cast<ValueType>(In[K]));
+    }
+  }
+};
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+inline namespace RefByStr {
+/// Bit field descriptor for IEEE 754 half-precision (binary16) numbers.
+///
+/// Proxy objects to the field convert from and to `float`.
+///
+/// \tparam T Name of the field.
+/// \tparam D Default raw bits of the field.
+template <Util::CharArray T, auto D = 0> struct HalfField : Field<T, 16, D> {
+  /// Value codec of the field.
+  using Codec = Util::Half;
+};
+
+/// Bit field descriptor for bfloat16 numbers.
+///
+/// Proxy objects to the field convert from and to `float`.
+///
+/// \tparam T Name of the field.
+/// \tparam D Default raw bits of the field.
+template <Util::CharArray T, auto D = 0>
+struct BFloat16Field : Field<T, 16, D> {
+  /// Value codec of the field.
+  using Codec = Util::BFloat16;
+};
+} // namespace RefByStr
+#endif
+
+#if !ORDERED_BIT_FIELD_REF_BY_STR
+inline
+#endif
+    namespace RefByEnum {
+/// Bit field descriptor for IEEE 754 half-precision (binary16) numbers.
+///
+/// Proxy objects to the field convert from and to `float`.
+///
+/// \tparam T Tag of the field.
+/// \tparam D Default raw bits of the field.
+///
+/// \code
+///   enum class Tag { X, Y, Z, W };
+///   using R = BitField<std::uint64_t, HalfField<Tag::X>, HalfField<Tag::Y>,
+///                      BFloat16Field<Tag::Z>, BFloat16Field<Tag::W>>;
+///   R Record;
+///   get<Tag::X>(Record) = 0.5f;
+///   float X = get<Tag::X>(Record);
+/// \endcode
+template <auto T, auto D = 0> struct HalfField : Field<T, 16, D> {
+  /// Value codec of the field.
+  using Codec = Util::Half;
+};
+
+/// Bit field descriptor for bfloat16 numbers.
+///
+/// Proxy objects to the field convert from and to `float`.
+///
+/// \tparam T Tag of the field.
+/// \tparam D Default raw bits of the field.
+template <auto T, auto D = 0> struct BFloat16Field : Field<T, 16, D> {
+  /// Value codec of the field.
+  using Codec = Util::BFloat16;
+};
+} // namespace RefByEnum
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,450 @@
+//===-- HeaderStack.hpp - Stacks of protocol headers ------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains HeaderStack class template, which overlays a chain of
+/// BitField layouts (e.g. Ethernet, VLAN, IPv4, UDP) on a packet. The offset
+/// of each layer is the sum of the lengths of the preceding present layers,
+/// and a layer may be present only if a field of the preceding layers holds a
+/// given value (e.g. EtherType). The length of a layer is the size of its
+/// layout, or is given by a field of the layer for headers of variable length
+/// (e.g. IHL of IPv4 with options).
+///
+/// Storage units of more than one byte hold the bytes of the buffer in the
+/// byte order of the host, so that 16-bit fields of network headers read
+/// byte-swapped on little-endian hosts. Selectors of such fields take
+/// ByteOrder::Big to be compared with values in network byte order.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_HEADER_STACK_HPP
+#define ORDERED_BIT_FIELD_HEADER_STACK_HPP
+
+#include "OrderedBitField.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace OrderedBitField {
+/// Byte order of the value of a selector field in the buffer.
+enum class ByteOrder {
+  /// As stored in the record, i.e. in the byte order of the host.
+  Native,
+  /// Big-endian (network byte order), e.g. EtherType.
+  Big,
+  /// Little-endian.
+  Little,
+};
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+inline namespace RefByStr {
+/// Layer of a HeaderStack which is present only if the field named Query of
+/// the nearest preceding present layer having such a field holds Value.
+///
+/// \tparam LayerT BitField type of the layer.
+/// \tparam Query Name of the field which selects the layer.
+/// \tparam Value Value of the field.
+/// \tparam Order Byte order of Value in the buffer. Other than Native, the
+/// field must consist of whole bytes.
+template <class LayerT, Util::CharArray Query, auto Value,
+          ByteOrder Order = ByteOrder::Native>
+struct OptionalLayer {
+  /// BitField type of the layer.
+  using Layer = LayerT;
+  /// Name of the field which selects the layer.
+  static constexpr auto Selector = Query.asStringView();
+  /// Value of the field which selects the layer.
+  static constexpr auto Selected = Value;
+  /// Byte order of Selected in the buffer.
+  static constexpr ByteOrder SelectorOrder = Order;
+};
+
+/// Layer of a HeaderStack whose length in bytes is the value of its field
+/// named Query times Scale, e.g. IHL of IPv4 times 4. The bytes after the
+/// layout (e.g. options) are skipped. It may be the layer of an
+/// OptionalLayer.
+///
+/// \tparam LayerT BitField type of the fixed part of the layer.
+/// \tparam Query Name of the field which gives the length.
+/// \tparam Scale Bytes per unit of the length field.
+template <class LayerT, Util::CharArray Query, std::size_t Scale = 1>
+struct SizedLayer {
+  /// BitField type of the fixed part of the layer.
+  using Header = LayerT;
+  /// Name of the field which gives the length.
+  static constexpr auto LengthSelector = Query.asStringView();
+  /// Bytes per unit of the length field.
+  static constexpr std::size_t LengthScale = Scale;
+};
+} // namespace RefByStr
+#endif
+
+#if !ORDERED_BIT_FIELD_REF_BY_STR
+inline
+#endif
+    namespace RefByEnum {
+/// Layer of a HeaderStack which is present only if the field tagged Query of
+/// the nearest preceding present layer having such a field holds Value.
+///
+/// \tparam LayerT BitField type of the layer.
+/// \tparam Query Tag of the field which selects the layer.
+/// \tparam Value Value of the field.
+/// \tparam Order Byte order of Value in the buffer. Other than Native, the
+/// field must consist of whole bytes.
+template <class LayerT, auto Query, auto Value,
+          ByteOrder Order = ByteOrder::Native>
+struct OptionalLayer {
+  /// BitField type of the layer.
+  using Layer = LayerT;
+  /// Tag of the field which selects the layer.
+  static constexpr auto Selector = Query;
+  /// Value of the field which selects the layer.
+  static constexpr auto Selected = Value;
+  /// Byte order of Selected in the buffer.
+  static constexpr ByteOrder SelectorOrder = Order;
+};
+
+/// Layer of a HeaderStack whose length in bytes is the value of its field
+/// tagged Query times Scale, e.g. IHL of IPv4 times 4. The bytes after the
+/// layout (e.g. options) are skipped. It may be the layer of an
+/// OptionalLayer.
+///
+/// \tparam LayerT BitField type of the fixed part of the layer.
+/// \tparam Query Tag of the field which gives the length.
+/// \tparam Scale Bytes per unit of the length field.
+template <class LayerT, auto Query, std::size_t Scale = 1> struct SizedLayer {
+  /// BitField type of the fixed part of the layer.
+  using Header = LayerT;
+  /// Tag of the field which gives the length.
+  static constexpr auto LengthSelector = Query;
+  /// Bytes per unit of the length field.
+  static constexpr std::size_t LengthScale = Scale;
+};
+} // namespace RefByEnum
+
+namespace Util {
+/// Length of a layer of HeaderStack.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class LayerT, class = void> struct LengthTraits {
+  using Type = LayerT;
+  static constexpr bool Sized = false;
+};
+
+template <class LayerT>
+struct LengthTraits<LayerT, std::void_t<typename LayerT::Header>> {
+  using Type = typename LayerT::Header;
+  using Descriptor = LayerT;
+  static constexpr bool Sized = true;
+};
+
+/// Properties of a layer of HeaderStack.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class LayerT, class = void> struct LayerTraits {
+  using Length = LengthTraits<LayerT>;
+  using Type = typename Length::Type;
+  static constexpr bool Optional = false;
+};
+
+template <class LayerT>
+struct LayerTraits<LayerT, std::void_t<typename LayerT::Layer>> {
+  using Length = LengthTraits<typename LayerT::Layer>;
+  using Type = typename Length::Type;
+  using Descriptor = LayerT;
+  static constexpr bool Optional = true;
+};
+
+/// Byte order of the host.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr ByteOrder HostByteOrder =
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) &&                \
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    ByteOrder::Big;
+#else
+    ByteOrder::Little;
+#endif
+
+/// Value of the I-th field of BitFieldT as stored in the record, which holds
+/// Value in the byte order Order in the buffer.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT, std::size_t I, ByteOrder Order, class T>
+constexpr typename Layout<BitFieldT>::FieldType storedValue(T Value) {
+  using L = Layout<BitFieldT>;
+  using FieldType = typename L::FieldType;
+  if constexpr (Order == ByteOrder::Native || Order == HostByteOrder) {
+    return static_cast<FieldType>(Value);
+  } else {
+    constexpr std::size_t Bits = L::template bits<I>();
+    static_assert(Bits % 8 == 0 && L::template shift<I>() % 8 == 0,
+                  "field selected in a byte order must consist of whole "
+                  "bytes");
+    const auto V = static_cast<std::uint64_t>(
+        static_cast<typename L::UnderlyingType>(static_cast<FieldType>(Value)));
+    std::uint64_t R = 0;
+    for (std::size_t B = 0; B < Bits; B += 8) {
+      R |= ((V >> B) & 0xff) << (Bits - 8 - B);
+    }
+    return static_cast<FieldType>(
+        static_cast<typename L::UnderlyingType>(R));
+  }
+}
+
+/// Index of the field of BitFieldT tagged Query, or NFields if there is no
+/// such field.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT, class QueryT, std::size_t... I>
+constexpr std::size_t findField(QueryT Query, std::index_sequence<I...>) {
+  using L = Layout<BitFieldT>;
+  std::size_t Index = L::NFields;
+  auto match = [&](std::size_t J, auto Tag) {
+    if constexpr (std::is_same_v<std::remove_cv_t<decltype(Tag)>, QueryT>) {
+      if (Index == L::NFields && Tag == Query) {
+        Index = J;
+      }
+    }
+  };
+  (match(I, L::template Descriptor<I>::Tag), ...);
+  return Index;
+}
+
+/// Index of the field of BitFieldT tagged Query, or NFields if there is no
+/// such field.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT, class QueryT>
+constexpr std::size_t findField(QueryT Query) {
+  return findField<BitFieldT>(
+      Query, std::make_index_sequence<Layout<BitFieldT>::NFields>());
+}
+} // namespace Util
+
+/// Overlay of a stack of protocol headers on a buffer.
+///
+/// The layers are parsed in one pass at construction. A layer is placed right
+/// after the preceding present layer and is absent if it is an OptionalLayer
+/// whose selector does not match, or if it does not fit in the buffer (then
+/// the following layers are absent too). A SizedLayer also does not fit if
+/// its length field gives less than the size of its layout. Present layers
+/// are accessed through pointers into the buffer, without copies.
+///
+/// \tparam ByteT `const unsigned char` for read-only views or `unsigned char`
+/// for mutable ones. Use HeaderStack or MutableHeaderStack.
+/// \tparam Layers BitField types, SizedLayer or OptionalLayer descriptors.
+/// The buffer must be suitably aligned for each layer, which always holds for
+/// layers of single-byte base types.
+///
+/// \code
+///   enum class Hdr { Dst, Src, Type, Tci, Proto, SrcPort, DstPort, ... };
+///   constexpr auto Big = ByteOrder::Big;
+///   using Stack = HeaderStack<Ethernet,
+///                             OptionalLayer<Vlan, Hdr::Type, VlanType, Big>,
+///                             OptionalLayer<SizedLayer<Ipv4, Hdr::Ihl, 4>,
+///                                           Hdr::Type, Ipv4Type, Big>,
+///                             OptionalLayer<Udp, Hdr::Proto, 17>>;
+///   Stack S(Packet, Length);
+///   if (const auto *U = S.get<3>()) {
+///     auto Port = get<Hdr::DstPort>(*U);
+///   }
+/// \endcode
+template <class ByteT, class... Layers> class BasicHeaderStack {
+  static_assert(std::is_same_v<std::remove_const_t<ByteT>, unsigned char>,
+                "byte type must be unsigned char");
+
+public:
+  /// Number of layers.
+  static constexpr std::size_t NLayers = sizeof...(Layers);
+
+  /// BitField type of the K-th layer.
+  template <std::size_t K>
+  using Layer = typename Util::LayerTraits<
+      std::tuple_element_t<K, std::tuple<Layers...>>>::Type;
+
+  /// Offset recorded for absent layers.
+  static constexpr std::size_t Absent = std::numeric_limits<std::size_t>::max();
+
+private:
+  template <std::size_t K>
+  using Traits =
+      Util::LayerTraits<std::tuple_element_t<K, std::tuple<Layers...>>>;
+
+  template <std::size_t K>
+  using Pointer =
+      std::conditional_t<std::is_const_v<ByteT>, const Layer<K> *, Layer<K> *>;
+
+  using VoidPointer =
+      std::conditional_t<std::is_const_v<ByteT>, const void *, void *>;
+
+  template <std::size_t... K>
+  static constexpr std::array<std::size_t, NLayers + 1>
+  fullOffsets(std::index_sequence<K...>) {
+    std::array<std::size_t, NLayers + 1> O{};
+    ((O[K + 1] = O[K] + sizeof(Layer<K>)), ...);
+    return O;
+  }
+
+public:
+  /// Offsets of the layers if all the layers are present, with the layers of
+  /// variable length at the sizes of their layouts. The last element is the
+  /// total size of the headers.
+  static constexpr std::array<std::size_t, NLayers + 1> FullOffsets =
+      fullOffsets(std::make_index_sequence<NLayers>());
+
+  /// Parse the headers in the buffer.
+  ///
+  /// \param Buf Pointer to the first byte of the packet.
+  /// \param Len Length of the packet in bytes.
+  BasicHeaderStack(VoidPointer Buf, std::size_t Len)
+      : Base(static_cast<ByteT *>(Buf)) {
+    parse(Len, std::make_index_sequence<NLayers>());
+  }
+
+  /// Pointer to the K-th layer, or nullptr if it is absent.
+  template <std::size_t K> Pointer<K> get() const {
+    static_assert(K < NLayers, "layer not found");
+    return Offsets[K] == Absent
+               ? nullptr
+               : reinterpret_cast<Pointer<K>>(Base + Offsets[K]);
+  }
+
+  /// Pointer to the layer of type LayerT, or nullptr if it is absent.
+  template <class LayerT> auto get() const {
+    constexpr std::size_t K = indexOf<LayerT>();
+    static_assert(K < NLayers, "layer not found");
+    return get<K>();
+  }
+
+  /// Whether the K-th layer is present or not.
+  template <std::size_t K> bool has() const { return Offsets[K] != Absent; }
+
+  /// Offset of the K-th layer in bytes, or Absent.
+  template <std::size_t K> std::size_t offset() const { return Offsets[K]; }
+
+  /// Total size of the present layers, i.e. the offset of the payload.
+  std::size_t size() const { return End; }
+
+  /// Pointer to the payload after the present layers.
+  ByteT *payload() const { return Base + End; }
+
+  /// Whether a layer was cut off by the end of the buffer, or had a length
+  /// field shorter than its layout, or not.
+  bool truncated() const { return Truncated; }
+
+private:
+  template <class LayerT, std::size_t... K>
+  static constexpr std::size_t indexOf(std::index_sequence<K...>) {
+    std::size_t Index = NLayers;
+    std::size_t Count = 0;
+    ((std::is_same_v<Layer<K>, LayerT> ? (Index = K, ++Count) : 0), ...);
+    return Count == 1 ? Index : NLayers;
+  }
+
+  template <class LayerT> static constexpr std::size_t indexOf() {
+    return indexOf<LayerT>(std::make_index_sequence<NLayers>());
+  }
+
+  /// Whether the selector of the K-th layer matches, looking up the J-th and
+  /// preceding layers.
+  template <std::size_t K, std::size_t J> bool selected() const {
+    using L = Util::Layout<Layer<J>>;
+    constexpr std::size_t I =
+        Util::findField<Layer<J>>(Traits<K>::Descriptor::Selector);
+    if constexpr (I < L::NFields) {
+      if (Offsets[J] != Absent) {
+        const auto &Header =
+            *reinterpret_cast<const Layer<J> *>(Base + Offsets[J]);
+        using Descriptor = typename Traits<K>::Descriptor;
+        constexpr auto Selected =
+            Util::storedValue<Layer<J>, I, Descriptor::SelectorOrder>(
+                Descriptor::Selected);
+        return L::template value<I>(L::template load<I>(Header)) == Selected;
+      }
+    }
+    if constexpr (J > 0) {
+      return selected<K, J - 1>();
+    } else {
+      return false;
+    }
+  }
+
+  template <std::size_t K> void parseLayer(std::size_t Len) {
+    if constexpr (Traits<K>::Optional) {
+      static_assert(K > 0, "the first layer cannot be optional");
+      if (Truncated || !selected<K, K - 1>()) {
+        Offsets[K] = Absent;
+        return;
+      }
+    }
+    if (Truncated || Len - End < sizeof(Layer<K>)) {
+      Truncated = true;
+      Offsets[K] = Absent;
+      return;
+    }
+    std::size_t Length = sizeof(Layer<K>);
+    if constexpr (Traits<K>::Length::Sized) {
+      Length = length<K>();
+      if (Length < sizeof(Layer<K>) || Len - End < Length) {
+        Truncated = true;
+        Offsets[K] = Absent;
+        return;
+      }
+    }
+    Offsets[K] = End;
+    End += Length;
+  }
+
+  /// Length in bytes of the K-th layer at End, given by its length field.
+  template <std::size_t K> std::size_t length() const {
+    using L = Util::Layout<Layer<K>>;
+    using Descriptor = typename Traits<K>::Length::Descriptor;
+    constexpr std::size_t I =
+        Util::findField<Layer<K>>(Descriptor::LengthSelector);
+    static_assert(I < L::NFields, "length field not found");
+    const auto &Header = *reinterpret_cast<const Layer<K> *>(Base + End);
+    const auto Units = static_cast<std::make_unsigned_t<
+        typename L::UnderlyingType>>(static_cast<typename L::UnderlyingType>(
+        L::template value<I>(L::template load<I>(Header))));
+    return static_cast<std::size_t>(Units) * Descriptor::LengthScale;
+  }
+
+  template <std::size_t... K>
+  void parse(std::size_t Len, std::index_sequence<K...>) {
+    (parseLayer<K>(Len), ...);
+  }
+
+  ByteT *Base;
+  std::size_t End = 0;
+  bool Truncated = false;
+  std::array<std::size_t, NLayers> Offsets{};
+};
+
+/// Read-only overlay of a stack of protocol headers. See BasicHeaderStack.
+template <class... Layers>
+using HeaderStack = BasicHeaderStack<const unsigned char, Layers...>;
+
+/// Mutable overlay of a stack of protocol headers. See BasicHeaderStack.
+template <class... Layers>
+using MutableHeaderStack = BasicHeaderStack<unsigned char, Layers...>;
+} // namespace OrderedBitField
+
+#endif
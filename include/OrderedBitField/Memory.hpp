@@ -0,0 +1,346 @@
+//===-- Memory.hpp - Allocation of record arrays ----------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains helpers to allocate arrays of BitField records without
+/// storing the default image into records which are about to be overwritten,
+/// and to fill large arrays with the default image quickly.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_MEMORY_HPP
+#define ORDERED_BIT_FIELD_MEMORY_HPP
+
+#include "Dispatch.hpp"
+#include "OrderedBitField.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Deleter of arrays made by makeForOverwrite.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct OverwriteDelete {
+  template <class T> void operator()(T *P) const noexcept {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "records must be trivially destructible");
+    ::operator delete[](static_cast<void *>(P));
+  }
+};
+
+/// Whether T is a BitField or not.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class T> struct IsBitField : std::false_type {};
+
+template <class... Args>
+struct IsBitField<BitField<Args...>> : std::true_type {};
+
+/// Begin the lifetime of N records in Storage without storing into them, as
+/// C++23 std::start_lifetime_as_array does. memmove() implicitly creates the
+/// records in its destination, and copying the bytes onto themselves is
+/// folded away by compilers, so the records keep the bytes of Storage.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT>
+BitFieldT *startLifetime(void *Storage, std::size_t N) noexcept {
+  static_assert(std::is_trivially_copyable_v<BitFieldT> &&
+                    std::is_trivially_destructible_v<BitFieldT>,
+                  "records must be trivially copyable and destructible");
+  if (N == 0) {
+    // Storage may be null
+    return static_cast<BitFieldT *>(Storage);
+  }
+  return std::launder(static_cast<BitFieldT *>(
+      std::memmove(Storage, Storage, N * sizeof(BitFieldT))));
+}
+
+/// Deleter of arrays made by makeDefaultArray.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct FreeDelete {
+  template <class T> void operator()(T *P) const noexcept {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "records must be trivially destructible");
+    std::free(static_cast<void *>(P));
+  }
+};
+
+/// Minimum size in bytes of an array filled with non-temporal stores, which
+/// bypass the caches. Smaller arrays are likely to be read soon.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t NonTemporalBytes = std::size_t{1} << 24;
+
+/// Maximum size in bytes of the repeated pattern of default images. Records
+/// whose pattern is larger are copied one by one.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t MaxPatternBytes = 4096;
+
+/// Whether the default image of the records is all zero or not.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT> constexpr bool isZeroDefault() {
+  using L = Layout<BitFieldT>;
+  for (auto U : L::DefaultData) {
+    if (static_cast<typename L::UnderlyingType>(U) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Fill Bytes bytes from Dst, which is aligned to 64 bytes, by repeating the
+/// pattern of P bytes. The pattern is held in vector registers if it fits.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t P>
+void broadcastPattern(unsigned char *Dst, std::size_t Bytes,
+                      const unsigned char *Pattern) {
+  static_assert(P % 64 == 0, "pattern must consist of cache lines");
+  std::size_t K = 0;
+
+#if ORDERED_BIT_FIELD_KERNELS
+  kernels().FillPattern(Dst, Bytes, Pattern, P);
+  return;
+#elif defined(__AVX2__)
+  if constexpr (P <= 512) {
+    __m256i V[P / 32];
+    for (std::size_t J = 0; J < P / 32; ++J) {
+      V[J] = _mm256_load_si256(
+          reinterpret_cast<const __m256i *>(Pattern + J * 32));
+    }
+    if (Bytes >= NonTemporalBytes) {
+      for (; K + P <= Bytes; K += P) {
+        for (std::size_t J = 0; J < P / 32; ++J) {
+          _mm256_stream_si256(reinterpret_cast<__m256i *>(Dst + K + J * 32),
+                              V[J]);
+        }
+      }
+      _mm_sfence();
+    } else {
+      for (; K + P <= Bytes; K += P) {
+        for (std::size_t J = 0; J < P / 32; ++J) {
+          _mm256_store_si256(reinterpret_cast<__m256i *>(Dst + K + J * 32),
+                             V[J]);
+        }
+      }
+    }
+  }
+#endif
+
+  for (; K + P <= Bytes; K += P) {
+    std::memcpy(Dst + K, Pattern, P);
+  }
+  std::memcpy(Dst + K, Pattern, Bytes - K);
+}
+
+/// Fill N records with the default image on the calling thread.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT>
+void fillDefaultRange(BitFieldT *Records, std::size_t N) {
+  using L = Layout<BitFieldT>;
+  constexpr std::size_t Size = sizeof(BitFieldT);
+  static_assert(Size == sizeof(L::DefaultData),
+                "records must not have padding");
+  auto *Dst = reinterpret_cast<unsigned char *>(Records);
+  const std::size_t Bytes = N * Size;
+  if (N == 0) {
+    return;
+  }
+
+  if constexpr (isZeroDefault<BitFieldT>()) {
+    std::memset(Dst, 0, Bytes);
+    return;
+  }
+
+  // the image repeats every lcm(Size, 64) bytes, i.e. whole cache lines
+  constexpr std::size_t P = Size / std::gcd(Size, std::size_t{64}) * 64;
+  if constexpr (P > MaxPatternBytes) {
+    for (std::size_t I = 0; I < N; ++I) {
+      std::memcpy(Records + I, L::DefaultData.data(), Size);
+    }
+  } else {
+    unsigned char Image[Size];
+    std::memcpy(Image, L::DefaultData.data(), Size);
+    const auto Addr = reinterpret_cast<std::uintptr_t>(Dst);
+    const std::size_t Head =
+        std::min<std::size_t>(Bytes, (64 - Addr % 64) % 64);
+    for (std::size_t K = 0; K < Head; ++K) {
+      Dst[K] = Image[K % Size];
+    }
+    // pattern starting at the first cache line boundary
+    alignas(64) unsigned char Pattern[P];
+    for (std::size_t K = 0; K < P; ++K) {
+      Pattern[K] = Image[(Head + K) % Size];
+    }
+    broadcastPattern<P>(Dst + Head, Bytes - Head, Pattern);
+  }
+}
+} // namespace Util
+
+/// Owning pointer to an array made by makeForOverwrite.
+template <class BitFieldT>
+using OverwriteArray = std::unique_ptr<BitFieldT[], Util::OverwriteDelete>;
+
+/// Allocate an array of records whose storage is left uninitialized, as
+/// std::make_unique_for_overwrite does.
+///
+/// \tparam BitFieldT Type of the records.
+/// \param N Number of records.
+/// \returns Owning pointer to the first record.
+///
+/// \code
+///   auto Records = makeForOverwrite<R>(N);
+///   std::fread(Records.get(), sizeof(R), N, File);
+/// \endcode
+template <class BitFieldT>
+OverwriteArray<BitFieldT> makeForOverwrite(std::size_t N) {
+  static_assert(alignof(BitFieldT) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                "over-aligned records are not supported");
+  if (N > std::numeric_limits<std::size_t>::max() / sizeof(BitFieldT)) {
+    throw std::bad_array_new_length();
+  }
+  return OverwriteArray<BitFieldT>(Util::startLifetime<BitFieldT>(
+      ::operator new[](N * sizeof(BitFieldT)), N));
+}
+
+/// Fill N records with the default values of the fields.
+///
+/// The default image is broadcast from vector registers with aligned stores,
+/// and with non-temporal stores for arrays larger than the caches. Records
+/// whose default image is all zero are filled by memset().
+///
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param NThreads Maximum number of threads. 0 means
+/// std::thread::hardware_concurrency().
+template <class... Args>
+void fillDefault(BitField<Args...> *Records, std::size_t N,
+                 unsigned NThreads = 0) {
+  const unsigned NBlocks = Util::threadCount(N, NThreads);
+  Util::parallelFor(NBlocks, [&](unsigned Block) {
+    const std::size_t Begin = Util::blockBegin(N, NBlocks, Block);
+    const std::size_t End = Util::blockBegin(N, NBlocks, Block + 1);
+    Util::fillDefaultRange(Records + Begin, End - Begin);
+  });
+}
+
+/// Owning pointer to an array made by makeDefaultArray.
+template <class BitFieldT>
+using DefaultArray = std::unique_ptr<BitFieldT[], Util::FreeDelete>;
+
+/// Allocate an array of records holding the default values of the fields.
+///
+/// If the default image is all zero, the array is allocated by calloc(),
+/// which takes large blocks from fresh mmap() pages and skips clearing them.
+/// The pages are zero-filled by the kernel on first touch. Otherwise the
+/// records are filled by fillDefault.
+///
+/// \tparam BitFieldT Type of the records.
+/// \param N Number of records.
+/// \param NThreads Maximum number of threads to fill the records. 0 means
+/// std::thread::hardware_concurrency().
+/// \returns Owning pointer to the first record.
+template <class BitFieldT>
+DefaultArray<BitFieldT> makeDefaultArray(std::size_t N,
+                                         unsigned NThreads = 0) {
+  static_assert(alignof(BitFieldT) <= alignof(std::max_align_t),
+                "over-aligned records are not supported");
+  if (N > std::numeric_limits<std::size_t>::max() / sizeof(BitFieldT)) {
+    throw std::bad_array_new_length();
+  }
+  constexpr bool Zero = Util::isZeroDefault<BitFieldT>();
+  void *P = Zero ? std::calloc(N, sizeof(BitFieldT))
+                 : std::malloc(N * sizeof(BitFieldT));
+  if (!P && N > 0) {
+    throw std::bad_alloc();
+  }
+  // the pages of calloc() are not touched
+  auto *Records = Util::startLifetime<BitFieldT>(P, N);
+  if constexpr (!Zero) {
+    fillDefault(Records, N, NThreads);
+  }
+  return DefaultArray<BitFieldT>(Records);
+}
+
+/// Allocator which leaves records uninitialized on value-initialization, so
+/// that `std::vector<R, OverwriteAllocator<R>>(N)` and resize() skip the
+/// default image. Construction with arguments, e.g. copies, is done as
+/// usual.
+///
+/// \tparam T Type of the elements.
+template <class T> struct OverwriteAllocator {
+  using value_type = T;
+
+  OverwriteAllocator() noexcept = default;
+
+  template <class U>
+  constexpr OverwriteAllocator(const OverwriteAllocator<U> &) noexcept {}
+
+  T *allocate(std::size_t N) { return std::allocator<T>().allocate(N); }
+
+  void deallocate(T *P, std::size_t N) noexcept {
+    std::allocator<T>().deallocate(P, N);
+  }
+
+  template <class U> void construct(U *P) noexcept {
+    if constexpr (Util::IsBitField<U>::value) {
+      Util::startLifetime<U>(P, 1);
+    } else {
+      ::new (static_cast<void *>(P)) U;
+    }
+  }
+
+  template <class U, class... Args> void construct(U *P, Args &&...A) {
+    ::new (static_cast<void *>(P)) U(std::forward<Args>(A)...);
+  }
+
+  template <class U>
+  friend constexpr bool operator==(const OverwriteAllocator &,
+                                   const OverwriteAllocator<U> &) noexcept {
+    return true;
+  }
+
+  template <class U>
+  friend constexpr bool operator!=(const OverwriteAllocator &,
+                                   const OverwriteAllocator<U> &) noexcept {
+    return false;
+  }
+};
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,348 @@
+//===-- Morton.hpp - Morton (Z-order) keys from BitField fields -*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains construction of Morton (Z-order) keys by interleaving
+/// bits of the selected fields of a BitField, and its inverse.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_MORTON_HPP
+#define ORDERED_BIT_FIELD_MORTON_HPP
+
+#include "OrderedBitField.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+/// Bit masks of the Morton key for fields of the given widths.
+///
+/// Bits of the fields are interleaved from the least significant bit: bit 0
+/// of every field, then bit 1 of every field which is wider than 1, and so on.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <std::size_t... Widths> struct MortonMasks {
+  /// Number of interleaved fields.
+  static constexpr std::size_t NFields = sizeof...(Widths);
+
+  /// Total number of bits of the key.
+  static constexpr std::size_t KeyBits = (Widths + ... + 0);
+  static_assert(KeyBits <= 64, "Morton key does not fit in 64 bits");
+
+  /// Widths of the fields.
+  static constexpr std::array<std::size_t, NFields> Width = {Widths...};
+
+  /// Whether the all fields have the same width.
+  static constexpr bool Uniform = ((Widths == Width[0]) && ...);
+
+  /// Positions in the key which each field occupies.
+  static constexpr std::array<std::uint64_t, NFields> Mask = [] {
+    std::array<std::uint64_t, NFields> M{};
+    std::size_t Pos = 0;
+    for (std::size_t B = 0; Pos < KeyBits; ++B) {
+      for (std::size_t I = 0; I < NFields; ++I) {
+        if (B < Width[I]) {
+          M[I] |= std::uint64_t{1} << Pos++;
+        }
+      }
+    }
+    return M;
+  }();
+};
+
+/// Deposit the low bits of V into the set bits of Mask (software pdep).
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint64_t depositBits(std::uint64_t V, std::uint64_t Mask) {
+  std::uint64_t R = 0;
+  for (std::uint64_t B = 1; Mask != 0; B <<= 1) {
+    if (V & B) {
+      R |= Mask & -Mask;
+    }
+    Mask &= Mask - 1;
+  }
+  return R;
+}
+
+/// Gather the bits of V at the set bits of Mask (software pext).
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint64_t extractBits(std::uint64_t V, std::uint64_t Mask) {
+  std::uint64_t R = 0;
+  for (std::uint64_t B = 1; Mask != 0; B <<= 1) {
+    if (V & Mask & -Mask) {
+      R |= B;
+    }
+    Mask &= Mask - 1;
+  }
+  return R;
+}
+
+/// Spread the low 32 bits of V into the even bits.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint64_t spreadBits2(std::uint64_t V) {
+  V &= 0x00000000ffffffff;
+  V = (V | V << 16) & 0x0000ffff0000ffff;
+  V = (V | V << 8) & 0x00ff00ff00ff00ff;
+  V = (V | V << 4) & 0x0f0f0f0f0f0f0f0f;
+  V = (V | V << 2) & 0x3333333333333333;
+  V = (V | V << 1) & 0x5555555555555555;
+  return V;
+}
+
+/// Inverse of spreadBits2.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint64_t compactBits2(std::uint64_t V) {
+  V &= 0x5555555555555555;
+  V = (V | V >> 1) & 0x3333333333333333;
+  V = (V | V >> 2) & 0x0f0f0f0f0f0f0f0f;
+  V = (V | V >> 4) & 0x00ff00ff00ff00ff;
+  V = (V | V >> 8) & 0x0000ffff0000ffff;
+  V = (V | V >> 16) & 0x00000000ffffffff;
+  return V;
+}
+
+/// Spread the low 21 bits of V into every third bit.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint64_t spreadBits3(std::uint64_t V) {
+  V &= 0x00000000001fffff;
+  V = (V | V << 32) & 0x001f00000000ffff;
+  V = (V | V << 16) & 0x001f0000ff0000ff;
+  V = (V | V << 8) & 0x100f00f00f00f00f;
+  V = (V | V << 4) & 0x10c30c30c30c30c3;
+  V = (V | V << 2) & 0x1249249249249249;
+  return V;
+}
+
+/// Inverse of spreadBits3.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::uint64_t compactBits3(std::uint64_t V) {
+  V &= 0x1249249249249249;
+  V = (V | V >> 2) & 0x10c30c30c30c30c3;
+  V = (V | V >> 4) & 0x100f00f00f00f00f;
+  V = (V | V >> 8) & 0x001f0000ff0000ff;
+  V = (V | V >> 16) & 0x001f00000000ffff;
+  V = (V | V >> 32) & 0x00000000001fffff;
+  return V;
+}
+
+/// Deposit V into the bits of the key which the K-th field occupies.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class MasksT, std::size_t K>
+inline std::uint64_t mortonDeposit(std::uint64_t V) {
+  constexpr std::uint64_t Mask = MasksT::Mask[K];
+#if defined(__BMI2__)
+  return _pdep_u64(V, Mask);
+#else
+  if constexpr (MasksT::Uniform && MasksT::NFields == 1) {
+    return V & Mask;
+  } else if constexpr (MasksT::Uniform && MasksT::NFields == 2) {
+    return spreadBits2(V) << K & Mask;
+  } else if constexpr (MasksT::Uniform && MasksT::NFields == 3) {
+    return spreadBits3(V) << K & Mask;
+  } else {
+    return depositBits(V, Mask);
+  }
+#endif
+}
+
+/// Extract the bits of the key which the K-th field occupies.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class MasksT, std::size_t K>
+inline std::uint64_t mortonExtract(std::uint64_t Key) {
+  constexpr std::uint64_t Mask = MasksT::Mask[K];
+#if defined(__BMI2__)
+  return _pext_u64(Key, Mask);
+#else
+  if constexpr (MasksT::Uniform && MasksT::NFields == 1) {
+    return Key & Mask;
+  } else if constexpr (MasksT::Uniform && MasksT::NFields == 2) {
+    return compactBits2((Key & Mask) >> K);
+  } else if constexpr (MasksT::Uniform && MasksT::NFields == 3) {
+    return compactBits3((Key & Mask) >> K);
+  } else {
+    return extractBits(Key, Mask);
+  }
+#endif
+}
+
+/// Morton key of the fields of the given indices.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t... Is, class BitFieldT, std::size_t... Ks>
+inline std::uint64_t mortonKeyByIndex(const BitFieldT &BF,
+                                      std::index_sequence<Ks...>) {
+  using L = Layout<BitFieldT>;
+  using MasksT = MortonMasks<L::template bits<Is>()...>;
+  return (mortonDeposit<MasksT, Ks>(
+              static_cast<std::uint64_t>(L::template load<Is>(BF))) |
+          ...);
+}
+
+/// Store the fields of the given indices from a Morton key.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t... Is, class BitFieldT, std::size_t... Ks>
+inline void fromMortonKeyByIndex(BitFieldT &BF, std::uint64_t Key,
+                                 std::index_sequence<Ks...>) {
+  using L = Layout<BitFieldT>;
+  using MasksT = MortonMasks<L::template bits<Is>()...>;
+  static_assert((!L::template fixed<Is>() && ...),
+                "assignment of read-only memeber is not allowed");
+  (L::template store<Is>(BF, static_cast<typename L::RawType>(
+                                 mortonExtract<MasksT, Ks>(Key))),
+   ...);
+}
+
+/// Morton keys of N records.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t... Is, class BitFieldT>
+void mortonKeysByIndex(const BitFieldT *Records, std::size_t N,
+                       std::uint64_t *Keys) {
+  for (std::size_t K = 0; K < N; ++K) {
+    Keys[K] = mortonKeyByIndex<Is...>(
+        Records[K], std::make_index_sequence<sizeof...(Is)>{});
+  }
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Morton (Z-order) key of the selected fields.
+///
+/// \tparam Queries Names of the fields. Raw bits of the fields are
+/// interleaved from the least significant bit, in the given order.
+/// \returns Morton key.
+template <Util::CharArray... Queries, class... Args,
+          decltype(((Queries ==
+                     std::declval<typename BitField<Args...>::TagT>()),
+                    ...),
+                   nullptr) = nullptr>
+inline std::uint64_t mortonKey(const BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::mortonKeyByIndex<L::template index<Queries>()...>(
+      BF, std::make_index_sequence<sizeof...(Queries)>{});
+}
+
+/// Store the selected fields from a Morton (Z-order) key. Inverse of
+/// mortonKey.
+///
+/// \tparam Queries Names of the fields in the same order as mortonKey.
+template <Util::CharArray... Queries, class... Args,
+          decltype(((Queries ==
+                     std::declval<typename BitField<Args...>::TagT>()),
+                    ...),
+                   nullptr) = nullptr>
+inline void fromMortonKey(BitField<Args...> &BF, std::uint64_t Key) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::fromMortonKeyByIndex<L::template index<Queries>()...>(
+      BF, Key, std::make_index_sequence<sizeof...(Queries)>{});
+}
+
+/// Morton (Z-order) keys of N records, e.g. as input of radix sorting.
+///
+/// \tparam Queries Names of the fields.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Keys Pointer to the first key (N elements).
+template <Util::CharArray... Queries, class... Args,
+          decltype(((Queries ==
+                     std::declval<typename BitField<Args...>::TagT>()),
+                    ...),
+                   nullptr) = nullptr>
+void mortonKeys(const BitField<Args...> *Records, std::size_t N,
+                std::uint64_t *Keys) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::mortonKeysByIndex<L::template index<Queries>()...>(Records, N, Keys);
+}
+#endif
+
+/// Morton (Z-order) key of the selected fields.
+///
+/// \tparam Queries Tags of the fields. Raw bits of the fields are interleaved
+/// from the least significant bit, in the given order.
+/// \returns Morton key.
+///
+/// \code
+///   enum class Tag { X, Y, Z };
+///   using P = BitField<std::uint32_t, Field<Tag::X, 10>, Field<Tag::Y, 10>,
+///                      Field<Tag::Z, 10>>;
+///   P Point;
+///   std::uint64_t Key = mortonKey<Tag::X, Tag::Y, Tag::Z>(Point);
+///   fromMortonKey<Tag::X, Tag::Y, Tag::Z>(Point, Key);
+/// \endcode
+///
+/// \note Uses pdep if BMI2 is enabled, otherwise magic-number bit spreading
+/// (2 or 3 fields of the same width) or a bit-by-bit loop.
+template <auto... Queries, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+inline std::uint64_t mortonKey(const BitField<Args...> &BF) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::mortonKeyByIndex<L::template index<Queries>()...>(
+      BF, std::make_index_sequence<sizeof...(Queries)>{});
+}
+
+/// Store the selected fields from a Morton (Z-order) key. Inverse of
+/// mortonKey.
+///
+/// \tparam Queries Tags of the fields in the same order as mortonKey.
+template <auto... Queries, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+inline void fromMortonKey(BitField<Args...> &BF, std::uint64_t Key) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::fromMortonKeyByIndex<L::template index<Queries>()...>(
+      BF, Key, std::make_index_sequence<sizeof...(Queries)>{});
+}
+
+/// Morton (Z-order) keys of N records, e.g. as input of radix sorting.
+///
+/// \tparam Queries Tags of the fields.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Keys Pointer to the first key (N elements).
+template <auto... Queries, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void mortonKeys(const BitField<Args...> *Records, std::size_t N,
+                std::uint64_t *Keys) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::mortonKeysByIndex<L::template index<Queries>()...>(Records, N, Keys);
+}
+} // namespace OrderedBitField
+
+#endif
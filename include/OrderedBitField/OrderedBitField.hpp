@@ -27,7 +27,9 @@
 #define ORDERED_BIT_FIELD_REF_BY_STR 0
 #endif
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <limits>
 #include <tuple>
 #include <type_traits>
@@ -36,6 +38,68 @@
 #include <string_view>
 #endif
 
+/// Inlining policy of the access path (get, proxy objects and the kernels
+/// they forward to), which matters at -O0 and -Og where nothing is inlined
+/// unless forced.
+///
+/// 0: nothing is forced, so that every level can be stepped into.
+/// 1 (default): get and proxy objects are forced inline, leaving one call to
+/// a kernel shared by the fields at the same position per access.
+/// 2: kernels are forced inline too, leaving no call at all.
+///
+/// Forcing inline trades code size at -O0 for speed: every access expands
+/// its wrappers in place, so .text grows from policy 0 to 1 and grows most
+/// at 2 (see bench/BinarySize.cpp). The default is 1 at every optimization
+/// level, since the speed of -O0 builds and test suites is what the policy is
+/// for; policy 0 is the opt-out for the smallest debug binaries. With
+/// optimization the inlined wrappers fold away, and policies 1 and 2 give the
+/// smallest code at -O2.
+#ifndef ORDERED_BIT_FIELD_FORCE_INLINE
+#define ORDERED_BIT_FIELD_FORCE_INLINE 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ORDERED_BIT_FIELD_FORCE_INLINE_ATTRIBUTE                               \
+  __attribute__((always_inline)) inline
+#define ORDERED_BIT_FIELD_FLATTEN_ATTRIBUTE __attribute__((flatten))
+#elif defined(_MSC_VER)
+#define ORDERED_BIT_FIELD_FORCE_INLINE_ATTRIBUTE __forceinline
+#define ORDERED_BIT_FIELD_FLATTEN_ATTRIBUTE
+#else
+#define ORDERED_BIT_FIELD_FORCE_INLINE_ATTRIBUTE inline
+#define ORDERED_BIT_FIELD_FLATTEN_ATTRIBUTE
+#endif
+
+/// Attribute of thin wrappers which must leave no code of their own, such as
+/// get and the operators of proxy objects.
+#ifndef ORDERED_BIT_FIELD_ALWAYS_INLINE
+#if ORDERED_BIT_FIELD_FORCE_INLINE >= 1
+#define ORDERED_BIT_FIELD_ALWAYS_INLINE ORDERED_BIT_FIELD_FORCE_INLINE_ATTRIBUTE
+#else
+#define ORDERED_BIT_FIELD_ALWAYS_INLINE inline
+#endif
+#endif
+
+/// Attribute of the kernels of proxy objects.
+#ifndef ORDERED_BIT_FIELD_KERNEL_INLINE
+#if ORDERED_BIT_FIELD_FORCE_INLINE >= 2
+#define ORDERED_BIT_FIELD_KERNEL_INLINE ORDERED_BIT_FIELD_FORCE_INLINE_ATTRIBUTE
+#else
+#define ORDERED_BIT_FIELD_KERNEL_INLINE inline
+#endif
+#endif
+
+/// Attribute of functions whose callees are all inlined into them. Users may
+/// put it on their own hot functions to inline the kernels of proxy objects
+/// from -Og on; GCC ignores it at -O0, where policy 2 is needed instead.
+#ifndef ORDERED_BIT_FIELD_FLATTEN
+#if ORDERED_BIT_FIELD_FORCE_INLINE >= 1
+#define ORDERED_BIT_FIELD_FLATTEN ORDERED_BIT_FIELD_FLATTEN_ATTRIBUTE
+#else
+#define ORDERED_BIT_FIELD_FLATTEN
+#endif
+#endif
+
 namespace OrderedBitField {
 /// Utilities.
 namespace Util {
@@ -90,6 +154,184 @@ public:
 /// may have breaking change.
 template <class T>
 using UnderlyingType = typename UnderlyingTypeHelper<T>::Type;
+
+/// Operations on a field in a storage unit, which the proxy objects forward
+/// to. They depend only on the position of the field, so that fields at the
+/// same position share one copy in any records.
+///
+/// \tparam F Type of the storage unit.
+/// \tparam Shift Shift width.
+/// \tparam Mask Bit mask.
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class F, std::size_t Shift, UnderlyingType<F> Mask>
+struct FieldKernel {
+  using U = UnderlyingType<F>;
+
+  /// Offset of the most significant bit of Mask from the top of U.
+  static constexpr std::size_t MaskMsbOffset = [] {
+    constexpr std::size_t Digits =
+        sizeof(U) * std::numeric_limits<unsigned char>::digits;
+    for (std::size_t Offset = 0; Offset < Digits; ++Offset) {
+      const auto M = static_cast<U>(static_cast<std::make_unsigned_t<U>>(1)
+                                    << (Digits - Offset - 1));
+      if (Mask & M)
+        return Offset;
+    }
+    // never reaches here since Mask is nonzero
+    return std::size_t{};
+  }();
+
+  /// Unsigned type of the raw bits of U.
+  using R = std::make_unsigned_t<U>;
+
+  /// R after integral promotion, which stays unsigned so that the kernels
+  /// never shift a signed value.
+  using P = std::common_type_t<R, unsigned>;
+
+  /// Mask as raw bits.
+  static constexpr P M = static_cast<R>(Mask);
+
+  /// Value of the field, sign-extended if U is signed.
+  ORDERED_BIT_FIELD_KERNEL_INLINE static constexpr U read(F Word) {
+    const P W = static_cast<R>(static_cast<U>(Word));
+    if constexpr (std::is_unsigned_v<U>) {
+      return static_cast<U>((W & M) >> Shift);
+    } else {
+      // move the field to the top, then shift it back arithmetically
+      const auto Top = static_cast<U>((W & M) << MaskMsbOffset);
+      return static_cast<U>(Top >> (Shift + MaskMsbOffset));
+    }
+  }
+
+  /// Replace the field by V.
+  ORDERED_BIT_FIELD_KERNEL_INLINE static constexpr void write(F &Word, U V) {
+    const P W = static_cast<R>(static_cast<U>(Word));
+    const P X = static_cast<R>(V);
+    Word = static_cast<F>(static_cast<U>((W & ~M) | ((X << Shift) & M)));
+  }
+
+  /// Replace the field by its bitwise AND with V.
+  ORDERED_BIT_FIELD_KERNEL_INLINE static constexpr void bitAnd(F &Word, U V) {
+    const P W = static_cast<R>(static_cast<U>(Word));
+    const P X = static_cast<R>(V);
+    Word = static_cast<F>(static_cast<U>(W & ((X << Shift) | ~M)));
+  }
+
+  /// Replace the field by its bitwise OR with V.
+  ORDERED_BIT_FIELD_KERNEL_INLINE static constexpr void bitOr(F &Word, U V) {
+    const P W = static_cast<R>(static_cast<U>(Word));
+    const P X = static_cast<R>(V);
+    Word = static_cast<F>(static_cast<U>(W | ((X << Shift) & M)));
+  }
+
+  /// Replace the field by its bitwise XOR with V.
+  ORDERED_BIT_FIELD_KERNEL_INLINE static constexpr void bitXor(F &Word, U V) {
+    const P W = static_cast<R>(static_cast<U>(Word));
+    const P X = static_cast<R>(V);
+    Word = static_cast<F>(static_cast<U>(W ^ ((X << Shift) & M)));
+  }
+
+  /// Shift the field left by N bits.
+  template <class T>
+  ORDERED_BIT_FIELD_KERNEL_INLINE static constexpr void shiftLeft(F &Word,
+                                                                  T N) {
+    const P W = static_cast<R>(static_cast<U>(Word));
+    Word = static_cast<F>(static_cast<U>((W & ~M) | (((W & M) << N) & M)));
+  }
+
+  /// Shift the field right by N bits, arithmetically if U is signed.
+  template <class T>
+  ORDERED_BIT_FIELD_KERNEL_INLINE static constexpr void shiftRight(F &Word,
+                                                                   T N) {
+    const P W = static_cast<R>(static_cast<U>(Word));
+    if constexpr (std::is_unsigned_v<U>) {
+      Word = static_cast<F>(static_cast<U>((W & ~M) | (((W & M) >> N) & M)));
+    } else {
+      const P X = static_cast<R>(static_cast<U>(read(Word) >> N));
+      Word = static_cast<F>(static_cast<U>((W & ~M) | ((X << Shift) & M)));
+    }
+  }
+};
+
+/// Helper class to detect the guard policy of a field descriptor.
+///
+/// A field descriptor may have a member type `Guard`, which makes the field a
+/// guarded field: a field derived from the other fields (e.g. checksum), which
+/// the guard policy keeps up to date on every write through proxy objects.
+/// The policy must provide the following static member functions:
+///
+/// \code
+///   // Compute the guarded field of the default image.
+///   template <class BitFieldT, std::size_t I>
+///   static constexpr void initialize(FieldType *Units);
+///   // Called after the Word-th unit, whose previous value is Old, is
+///   // overwritten.
+///   template <class BitFieldT, std::size_t I, std::size_t Word>
+///   static constexpr void update(FieldType *Units, FieldType Old);
+/// \endcode
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class F, class = std::void_t<>> struct FieldGuard {
+  using Type = void;
+};
+
+template <class F> struct FieldGuard<F, std::void_t<typename F::Guard>> {
+  using Type = typename F::Guard;
+};
+
+/// Helper class to detect the value codec of a field descriptor.
+///
+/// A field descriptor may have a member type `Codec`, which makes proxy
+/// objects to the field convert its raw bits to and from `Codec::ValueType`
+/// (e.g. fixed-point numbers). Such a field must fit in a storage unit of at
+/// most 32 bits. The codec must provide the following:
+///
+/// \code
+///   using ValueType = ...;
+///   // Convert raw bits of the field into a value.
+///   static constexpr ValueType decode(std::uint32_t Bits);
+///   // Convert a value into raw bits of the field.
+///   static constexpr std::uint32_t encode(ValueType V);
+///   // Bulk versions of the above, used for columns of record arrays.
+///   template <class OutT>
+///   static void decode(const std::uint32_t *Bits, std::size_t N, OutT *Out);
+///   template <class InT>
+///   static void encode(const InT *In, std::size_t N, std::uint32_t *Bits);
+/// \endcode
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class F, class = std::void_t<>> struct FieldCodec {
+  using Type = void;
+};
+
+template <class F> struct FieldCodec<F, std::void_t<typename F::Codec>> {
+  using Type = typename F::Codec;
+};
+
+/// Helper class to detect the alignment of a field descriptor.
+///
+/// A field descriptor may have a static data member `Alignment`, which rounds
+/// the beginning of the next field up to a multiple of `Alignment` bits within
+/// the storage unit. 0 if the descriptor has no alignment.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class F, class = std::void_t<>> struct FieldAlign {
+  static constexpr std::size_t Value = 0;
+};
+
+template <class F> struct FieldAlign<F, std::void_t<decltype(F::Alignment)>> {
+  static constexpr std::size_t Value = F::Alignment;
+};
+
+/// Compile-time description of the storage layout of a BitField.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class BitFieldT> struct Layout;
 } // namespace Util
 
 #if ORDERED_BIT_FIELD_REF_BY_STR
@@ -132,6 +374,22 @@ using ConstField = Field<Tag, W, D, true>;
 /// than `char` (e.g. `char8_t`, `wchar_t`, ...)
 template <std::size_t W, class CharT = char>
 using Padding = Field<Util::CharArray<CharT, 1>{{0}}, W, 0, true>;
+
+/// Bit field descriptor which aligns the next field.
+///
+/// The next field begins at a multiple of Bits within the storage unit, or at
+/// the next unit if there is none left. Unlike `Padding<0>`, it wastes no more
+/// bits than needed, e.g. to let a hot field be loaded as a whole byte.
+///
+/// \tparam Bits Alignment of the next field in bits.
+/// \tparam CharT Character type of tags. You must set this if you use other
+/// than `char` (e.g. `char8_t`, `wchar_t`, ...)
+template <std::size_t Bits, class CharT = char>
+struct Align : Padding<0, CharT> {
+  static_assert(Bits > 0, "alignment must be positive");
+  /// Alignment of the next field in bits.
+  static constexpr std::size_t Alignment = Bits;
+};
 } // namespace RefByStr
 #endif
 
@@ -182,6 +440,21 @@ using Padding =
     Field<static_cast<EnumT>(
               std::numeric_limits<std::underlying_type_t<EnumT>>::max()),
           W, 0, true>;
+
+/// Bit field descriptor which aligns the next field.
+///
+/// The next field begins at a multiple of Bits within the storage unit, or at
+/// the next unit if there is none left. Unlike `Padding<EnumT, 0>`, it wastes
+/// no more bits than needed, e.g. to let a hot field be loaded as a whole byte.
+///
+/// \tparam EnumT Type of tags.
+/// \tparam Bits Alignment of the next field in bits.
+template <class EnumT, std::size_t Bits>
+struct Align : Padding<EnumT, 0> {
+  static_assert(Bits > 0, "alignment must be positive");
+  /// Alignment of the next field in bits.
+  static constexpr std::size_t Alignment = Bits;
+};
 } // namespace RefByEnum
 
 /// Alignment-guaranteed bit fields.
@@ -216,6 +489,8 @@ using Padding =
 /// // Output: 10011110
 /// \endcode
 template <class BaseT, class FirstField, class... Fields> class BitField {
+  template <class> friend struct Util::Layout;
+
   static_assert(std::is_integral_v<BaseT> || std::is_enum_v<BaseT>,
                 "base type must be an integral type or an enum type");
   static_assert((std::conjunction_v<std::is_same<decltype(FirstField::Tag),
@@ -259,6 +534,11 @@ private:
   static constexpr std::array<TagT, NFields> Tag = {FirstField::Tag,
                                                     Fields::Tag...};
 
+  /// List of alignments of the next field for each field. 0 if the field is
+  /// not an alignment.
+  static constexpr std::array<std::size_t, NFields> FieldAlign = {
+      Util::FieldAlign<FirstField>::Value, Util::FieldAlign<Fields>::Value...};
+
   /// List of begining positions of each field.
   static constexpr std::array<std::size_t, NFields + 1> FieldBegin = []() {
     std::array<std::size_t, NFields + 1> B{};
@@ -269,6 +549,17 @@ private:
     };
 
     for (std::size_t I = 0; I < NFields; ++I) {
+      if (FieldAlign[I] != 0) {
+        // the descriptor sits where it is, and the next field is rounded up
+        // within the unit or skipped to the next unit
+        B[I] = BeginBit;
+        const std::size_t Unit = BeginBit / FieldTypeBits * FieldTypeBits;
+        const std::size_t Offset =
+            (BeginBit - Unit + FieldAlign[I] - 1) / FieldAlign[I] *
+            FieldAlign[I];
+        BeginBit = Unit + std::min(Offset, FieldTypeBits);
+        continue;
+      }
       if (toSkipToNextUnit(Width[I])) {
         BeginBit =
             ((BeginBit + FieldTypeBits - 1) / FieldTypeBits) * FieldTypeBits;
@@ -282,6 +573,17 @@ private:
       }
     }
     B[NFields] = BeginBit;
+    // a trailing empty descriptor on a unit boundary would begin past the
+    // storage, so keep it in the last unit
+    if (BeginBit != 0) {
+      const std::size_t LastUnit =
+          (BeginBit - 1) / FieldTypeBits * FieldTypeBits;
+      for (std::size_t I = 0; I < NFields; ++I) {
+        if (Width[I] == 0 && B[I] > LastUnit + FieldTypeBits - 1) {
+          B[I] = LastUnit;
+        }
+      }
+    }
     return B;
   }();
 
@@ -292,7 +594,8 @@ private:
       std::size_t S = FieldBegin[I] % FieldTypeBits;
       UnderlyingType M{};
       for (std::size_t J = 0; J < std::min(Width[I], FieldTypeBits); ++J) {
-        M |= static_cast<UnderlyingType>(1 << S);
+        M |= static_cast<UnderlyingType>(
+            static_cast<std::make_unsigned_t<UnderlyingType>>(1) << S);
         ++S;
       }
       Mask[I] = static_cast<FieldType>(M);
@@ -309,14 +612,69 @@ private:
   static constexpr std::array<bool, NFields> FieldFixed = {FirstField::Fixed,
                                                            Fields::Fixed...};
 
+  /// List of flags whether the fields are guarded.
+  static constexpr std::array<bool, NFields> FieldGuarded = {
+      !std::is_void_v<typename Util::FieldGuard<FirstField>::Type>,
+      !std::is_void_v<typename Util::FieldGuard<Fields>::Type>...};
+
+  /// Index of the guarded field, or NFields if there is none.
+  static constexpr std::size_t GuardIndex = []() {
+    for (std::size_t I = 0; I < NFields; ++I) {
+      if (FieldGuarded[I]) {
+        return I;
+      }
+    }
+    return NFields;
+  }();
+
+  static_assert(
+      [] {
+        std::size_t N = 0;
+        for (std::size_t I = 0; I < NFields; ++I) {
+          N += FieldGuarded[I];
+        }
+        return N <= 1;
+      }(),
+      "no more than one guarded field is allowed");
+  static_assert(GuardIndex == NFields || FieldFixed[GuardIndex],
+                "guarded field must be const-qualified");
+
+  /// Guard policy of the guarded field. void if there is no guarded field.
+  using Guard = std::tuple_element_t<
+      GuardIndex < NFields ? GuardIndex : 0,
+      std::tuple<typename Util::FieldGuard<FirstField>::Type,
+                 typename Util::FieldGuard<Fields>::Type...>>;
+
+  /// List of value codecs of the fields. void for plain fields.
+  using Codecs = std::tuple<typename Util::FieldCodec<FirstField>::Type,
+                            typename Util::FieldCodec<Fields>::Type...>;
+
+  static_assert(
+      [] {
+        constexpr std::array<bool, NFields> Coded = {
+            !std::is_void_v<typename Util::FieldCodec<FirstField>::Type>,
+            !std::is_void_v<typename Util::FieldCodec<Fields>::Type>...};
+        for (std::size_t I = 0; I < NFields; ++I) {
+          if (Coded[I] && Width[I] > std::min<std::size_t>(FieldTypeBits, 32)) {
+            return false;
+          }
+        }
+        return true;
+      }(),
+      "field with a value codec must fit in a storage unit of at most 32 "
+      "bits");
+
   /// Proxy object for each field in bit_field.
   ///
   /// \tparam FieldT Base type of the field.
   /// \tparam Shift Shift width.
   /// \tparam Mask Bit mask.
+  /// \tparam Word Index of the storage unit. Only used to notify the guard
+  /// policy, and 0 if there is no guarded field.
   /// \note This struct has a reference to BitField. Take care of dangling
   /// references.
-  template <class FieldT, std::size_t Shift, BaseT Mask> class FieldProxy {
+  template <class FieldT, std::size_t Shift, BaseT Mask, std::size_t Word = 0>
+  class FieldProxy {
     //// Base type of the field.
     using FieldType = std::remove_reference_t<std::remove_const_t<FieldT>>;
 
@@ -325,6 +683,10 @@ private:
     /// enum type.
     using UnderlyingType = Util::UnderlyingType<FieldType>;
 
+    /// Operations shared by the fields at the same position.
+    using Kernel =
+        Util::FieldKernel<FieldType, Shift, static_cast<UnderlyingType>(Mask)>;
+
     static_assert(static_cast<UnderlyingType>(Mask) > 0,
                   "cannot access member of size zero");
 
@@ -354,197 +716,127 @@ private:
         : std::true_type {};
 
   public:
-    constexpr operator FieldType() const {
-      if constexpr (std::is_unsigned_v<UnderlyingType>) {
-        return static_cast<FieldType>((static_cast<UnderlyingType>(Field) &
-                                       static_cast<UnderlyingType>(Mask)) >>
-                                      Shift);
-      } else {
-        constexpr std::size_t MaskMsbOffset = [] {
-          for (std::size_t Offset = 0;
-               Offset < sizeof(UnderlyingType) *
-                            std::numeric_limits<unsigned char>::digits;
-               ++Offset) {
-            UnderlyingType M =
-                1 << (sizeof(UnderlyingType) *
-                          std::numeric_limits<unsigned char>::digits -
-                      Offset - 1);
-            if (static_cast<UnderlyingType>(Mask) & M)
-              return Offset;
-          }
-          // never reaches here since Mask is nonzero
-          return std::size_t{};
-        }();
-        return static_cast<FieldType>((static_cast<UnderlyingType>(Field) &
-                                       static_cast<UnderlyingType>(Mask))
-                                          << MaskMsbOffset >>
-                                      (Shift + MaskMsbOffset));
-      }
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr operator FieldType() const {
+      return static_cast<FieldType>(Kernel::read(Field));
     }
 
     template <class T>
-    constexpr auto operator=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator=(T Rhs)
         -> decltype(std::declval<FieldType &>() = std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field =
-          static_cast<FieldType>((static_cast<UnderlyingType>(Field) &
-                                  ~static_cast<UnderlyingType>(Mask)) |
-                                 ((static_cast<UnderlyingType>(Rhs) << Shift) &
-                                  static_cast<UnderlyingType>(Mask)));
+      update<&Kernel::write>(static_cast<UnderlyingType>(Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator+=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator+=(T Rhs)
         -> decltype(std::declval<FieldType>() + std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field = static_cast<FieldType>(
-          (static_cast<UnderlyingType>(Field) &
-           ~static_cast<UnderlyingType>(Mask)) |
-          ((static_cast<FieldType>(*this) + Rhs) << Shift &
-           static_cast<UnderlyingType>(Mask)));
+      update<&Kernel::write>(
+          static_cast<UnderlyingType>(static_cast<FieldType>(*this) + Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator-=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator-=(T Rhs)
         -> decltype(std::declval<FieldType>() - std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field = static_cast<FieldType>(
-          (static_cast<UnderlyingType>(Field) &
-           ~static_cast<UnderlyingType>(Mask)) |
-          ((static_cast<FieldType>(*this) - Rhs) << Shift &
-           static_cast<UnderlyingType>(Mask)));
+      update<&Kernel::write>(
+          static_cast<UnderlyingType>(static_cast<FieldType>(*this) - Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator*=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator*=(T Rhs)
         -> decltype(std::declval<FieldType>() * std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field = static_cast<FieldType>(
-          (static_cast<UnderlyingType>(Field) &
-           ~static_cast<UnderlyingType>(Mask)) |
-          ((static_cast<FieldType>(*this) * Rhs) << Shift &
-           static_cast<UnderlyingType>(Mask)));
+      update<&Kernel::write>(
+          static_cast<UnderlyingType>(static_cast<FieldType>(*this) * Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator/=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator/=(T Rhs)
         -> decltype(std::declval<FieldType>() / std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field = static_cast<FieldType>(
-          (static_cast<UnderlyingType>(Field) &
-           ~static_cast<UnderlyingType>(Mask)) |
-          ((static_cast<FieldType>(*this) / Rhs) << Shift &
-           static_cast<UnderlyingType>(Mask)));
+      update<&Kernel::write>(
+          static_cast<UnderlyingType>(static_cast<FieldType>(*this) / Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator%=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator%=(T Rhs)
         -> decltype(std::declval<FieldType>() % std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field = static_cast<FieldType>(
-          (static_cast<UnderlyingType>(Field) &
-           ~static_cast<UnderlyingType>(Mask)) |
-          ((static_cast<FieldType>(*this) % Rhs) << Shift &
-           static_cast<UnderlyingType>(Mask)));
+      update<&Kernel::write>(
+          static_cast<UnderlyingType>(static_cast<FieldType>(*this) % Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator&=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator&=(T Rhs)
         -> decltype(std::declval<FieldType>() & std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field =
-          static_cast<FieldType>(static_cast<UnderlyingType>(Field) &
-                                 (static_cast<UnderlyingType>(Rhs) << Shift |
-                                  ~static_cast<UnderlyingType>(Mask)));
+      update<&Kernel::bitAnd>(static_cast<UnderlyingType>(Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator|=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator|=(T Rhs)
         -> decltype(std::declval<FieldType>() | std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field = static_cast<FieldType>(static_cast<UnderlyingType>(Field) |
-                                     static_cast<UnderlyingType>(Rhs) << Shift &
-                                         static_cast<UnderlyingType>(Mask));
+      update<&Kernel::bitOr>(static_cast<UnderlyingType>(Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator^=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator^=(T Rhs)
         -> decltype(std::declval<FieldType>() ^ std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field =
-          static_cast<FieldType>(static_cast<UnderlyingType>(Field) &
-                                     ~static_cast<UnderlyingType>(Mask) |
-                                 (static_cast<UnderlyingType>(Field) ^
-                                  static_cast<UnderlyingType>(Rhs) << Shift) &
-                                     static_cast<UnderlyingType>(Mask));
+      update<&Kernel::bitXor>(static_cast<UnderlyingType>(Rhs));
       return *this;
     }
 
     template <class T>
-    constexpr auto operator<<=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator<<=(T Rhs)
         -> decltype(std::declval<FieldType>() << std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      Field = static_cast<FieldType>(static_cast<UnderlyingType>(Field) &
-                                         ~static_cast<UnderlyingType>(Mask) |
-                                     (static_cast<UnderlyingType>(Field) &
-                                      static_cast<UnderlyingType>(Mask))
-                                             << Rhs &
-                                         static_cast<UnderlyingType>(Mask));
+      update<&Kernel::template shiftLeft<T>>(Rhs);
       return *this;
     }
 
     template <class T>
-    constexpr auto operator>>=(T Rhs)
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator>>=(T Rhs)
         -> decltype(std::declval<FieldType>() >> std::declval<T>(),
-                    std::declval<FieldProxy<FieldT, Shift, Mask> &>()) {
+                    std::declval<FieldProxy &>()) {
       static_assert(!std::is_const_v<FieldT>,
                     "assignment of read-only memeber is not allowed");
-      if constexpr (std::is_unsigned_v<UnderlyingType>) {
-        Field = static_cast<FieldType>(static_cast<UnderlyingType>(Field) &
-                                           ~static_cast<UnderlyingType>(Mask) |
-                                       (static_cast<UnderlyingType>(Field) &
-                                        static_cast<UnderlyingType>(Mask)) >>
-                                               Rhs &
-                                           static_cast<UnderlyingType>(Mask));
-      } else {
-        Field = static_cast<FieldType>(static_cast<UnderlyingType>(Field) &
-                                           ~static_cast<UnderlyingType>(Mask) |
-                                       static_cast<FieldType>(*this) << Shift >>
-                                               Rhs &
-                                           static_cast<UnderlyingType>(Mask));
-      }
+      update<&Kernel::template shiftRight<T>>(Rhs);
       return *this;
     }
 
-    constexpr auto operator++() -> FieldProxy<FieldT, Shift, Mask> & {
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator++()
+        -> FieldProxy & {
       if constexpr (PreIncrementable<FieldType>::value) {
         static_assert(!std::is_const_v<FieldT>,
                       "assignment of read-only memeber is not allowed");
@@ -556,7 +848,8 @@ private:
       }
     }
 
-    constexpr auto operator--() -> FieldProxy<FieldT, Shift, Mask> & {
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto operator--()
+        -> FieldProxy & {
       if constexpr (PreDecrementable<FieldType>::value) {
         static_assert(!std::is_const_v<BaseT>,
                       "assignment of read-only memeber is not allowed");
@@ -568,7 +861,7 @@ private:
       }
     }
 
-    constexpr FieldType operator++(int) {
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr FieldType operator++(int) {
       FieldType rv = static_cast<FieldType>(*this);
       if constexpr (PostIncrementable<FieldType>::value) {
         static_assert(!std::is_const_v<FieldT>,
@@ -583,7 +876,7 @@ private:
 
     template <class> constexpr FieldType operator--(int);
 
-    constexpr FieldType operator--(int) {
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr FieldType operator--(int) {
       FieldType rv = static_cast<FieldType>(*this);
       if constexpr (PostDecrementable<FieldType>::value) {
         static_assert(!std::is_const_v<FieldT>,
@@ -597,13 +890,102 @@ private:
     }
 
   private:
-    constexpr FieldProxy(FieldT &Field) : Field(Field) {}
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr FieldProxy(FieldT &Field)
+        : Field(Field) {}
+
+    /// Apply a kernel to the storage unit and notify the guard policy, if
+    /// any.
+    template <auto Op, class T>
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr void update(T V) {
+      if constexpr (GuardIndex < NFields) {
+        const FieldType Old = Field;
+        Op(Field, V);
+        Guard::template update<BitField, GuardIndex, Word>(&Field - Word, Old);
+      } else {
+        Op(Field, V);
+      }
+    }
 
     template <class, class, class...> friend struct BitField;
 
     FieldT &Field;
   };
 
+  /// Proxy object for a field with a value codec, which converts the raw bits
+  /// of the field to and from Codec::ValueType.
+  ///
+  /// \tparam Codec Value codec of the field.
+  /// \tparam RawProxy Proxy object to the raw bits of the field.
+  /// \tparam Bits Width of the field.
+  /// \note This struct has a reference to BitField. Take care of dangling
+  /// references.
+  template <class Codec, class RawProxy, std::size_t Bits> class CodedProxy {
+  public:
+    /// Type of values of the field.
+    using ValueType = typename Codec::ValueType;
+
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr operator ValueType() const {
+      return Codec::decode(bits());
+    }
+
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr CodedProxy &
+    operator=(ValueType Rhs) {
+      Raw = static_cast<FieldType>(
+          static_cast<UnderlyingType>(Codec::encode(Rhs)));
+      return *this;
+    }
+
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr CodedProxy &
+    operator=(const CodedProxy &Rhs) {
+      return *this = static_cast<ValueType>(Rhs);
+    }
+
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr CodedProxy &
+    operator+=(ValueType Rhs) {
+      return *this = static_cast<ValueType>(*this) + Rhs;
+    }
+
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr CodedProxy &
+    operator-=(ValueType Rhs) {
+      return *this = static_cast<ValueType>(*this) - Rhs;
+    }
+
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr CodedProxy &
+    operator*=(ValueType Rhs) {
+      return *this = static_cast<ValueType>(*this) * Rhs;
+    }
+
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr CodedProxy &
+    operator/=(ValueType Rhs) {
+      return *this = static_cast<ValueType>(*this) / Rhs;
+    }
+
+    /// Proxy object to the raw bits of the field.
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr RawProxy raw() const {
+      return Raw;
+    }
+
+  private:
+    template <class FieldT>
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr CodedProxy(FieldT &Field)
+        : Raw(Field) {}
+
+    /// Raw bits of the field.
+    ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr std::uint32_t bits() const {
+      constexpr std::uint32_t M =
+          Bits < 32 ? (std::uint32_t{1} << Bits) - 1 : ~std::uint32_t{};
+      return static_cast<std::uint32_t>(
+                 static_cast<std::make_unsigned_t<UnderlyingType>>(
+                     static_cast<UnderlyingType>(
+                         static_cast<FieldType>(Raw)))) &
+             M;
+    }
+
+    template <class, class, class...> friend struct BitField;
+
+    RawProxy Raw;
+  };
+
 public:
   /// Size of the storage.
   ///
@@ -612,14 +994,24 @@ public:
     return (FieldBegin[NFields] + FieldTypeBits - 1) / FieldTypeBits;
   }
 
-  /// %Data storage for bit fields.
+  /// %Data storage for bit fields, holding the default values of the fields
+  /// unless the record is initialized by an image, e.g. `BitField<...>{{...}}`.
   ///
   /// \note Array (not std::array) can be retrieved with Field.data().
-  std::array<FieldType, dataSize()> Data = []()
+  /// \note Arrays of records left uninitialized are made by makeForOverwrite
+  /// in OrderedBitField/Memory.hpp.
+  std::array<FieldType, dataSize()> Data = defaultData();
+
+private:
+  /// Storage image holding the default values of the fields.
+  static
 #if __cpp_consteval
       consteval
+#else
+      constexpr
 #endif
-  {
+      std::array<FieldType, dataSize()>
+      defaultData() noexcept {
     std::array<FieldType, dataSize()> F{};
 
     for (std::size_t I = 0; I < NFields; ++I) {
@@ -630,11 +1022,12 @@ public:
             << (FieldBegin[I] % FieldTypeBits)) &
            static_cast<UnderlyingType>(Mask[I])));
     }
+    if constexpr (GuardIndex < NFields) {
+      Guard::template initialize<BitField, GuardIndex>(F.data());
+    }
     return F;
   }
-  ();
 
-private:
 #if ORDERED_BIT_FIELD_REF_BY_STR
   /// Find index of the field by tag.
   ///
@@ -672,16 +1065,29 @@ private:
     return Index;
   }
 
+  /// Type of proxy object to the raw bits of the I-th field.
+  template <std::size_t I, class FieldT>
+  using RawProxyOf =
+      FieldProxy<FieldT, FieldBegin[I] % FieldTypeBits, Mask[I],
+                 GuardIndex < NFields ? FieldBegin[I] / FieldTypeBits : 0>;
+
+  /// Type of proxy object to the I-th field.
+  template <std::size_t I, class FieldT>
+  using ProxyOf = std::conditional_t<
+      std::is_void_v<std::tuple_element_t<I, Codecs>>, RawProxyOf<I, FieldT>,
+      CodedProxy<std::tuple_element_t<I, Codecs>, RawProxyOf<I, FieldT>,
+                 Width[I]>>;
+
   /// Get proxy object to the field by its index.
   ///
   /// \tparam I Index of the field.
   /// \returns Proxy object to the field.
   template <std::size_t I>
-  constexpr auto get() -> std::conditional_t<
-      FieldFixed[I],
-      FieldProxy<const FieldType, FieldBegin[I] % FieldTypeBits, Mask[I]>,
-      FieldProxy<FieldType, FieldBegin[I] % FieldTypeBits, Mask[I]>> {
-    return {Data[FieldBegin[I] / FieldTypeBits]};
+  ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto get()
+      -> ProxyOf<I, std::conditional_t<FieldFixed[I], const FieldType,
+                                       FieldType>> {
+    constexpr std::size_t W = FieldBegin[I] / FieldTypeBits;
+    return {Data[W]};
   }
 
   template <std::size_t I>
@@ -692,9 +1098,10 @@ private:
   /// \tparam I Index of the field.
   /// \returns Proxy object to the field.
   template <std::size_t I>
-  constexpr auto get() const
-      -> FieldProxy<const FieldType, FieldBegin[I] % FieldTypeBits, Mask[I]> {
-    return {Data[FieldBegin[I] / FieldTypeBits]};
+  ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto get() const
+      -> ProxyOf<I, const FieldType> {
+    constexpr std::size_t W = FieldBegin[I] / FieldTypeBits;
+    return {Data[W]};
   }
 
   template <std::size_t I>
@@ -710,7 +1117,8 @@ public:
   /// \note Use OrderedBitField::get for your convenience.
   /// \sa OrderedBitField::get
   template <Util::CharArray Query>
-  constexpr auto get() -> decltype(get<index<Query>()>()) {
+  ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto get()
+      -> decltype(get<index<Query>()>()) {
     return get<index<Query>()>();
   }
 
@@ -722,7 +1130,8 @@ public:
   /// \note Use OrderedBitField::get for your convenience.
   /// \sa OrderedBitField::get
   template <Util::CharArray Query>
-  constexpr auto get() const -> decltype(get<index<Query>()>()) {
+  ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto get() const
+      -> decltype(get<index<Query>()>()) {
     return get<index<Query>()>();
   }
 #endif
@@ -735,7 +1144,8 @@ public:
   /// \note Use OrderedBitField::get for your convenience.
   /// \sa OrderedBitField::get
   template <std::conditional_t<std::is_enum_v<TagT>, TagT, void *> Query>
-  constexpr auto get() -> decltype(get<index<Query>()>()) {
+  ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto get()
+      -> decltype(get<index<Query>()>()) {
     return get<index<Query>()>();
   }
 
@@ -747,10 +1157,171 @@ public:
   /// \note Use OrderedBitField::get for your convenience.
   /// \sa OrderedBitField::get
   template <std::conditional_t<std::is_enum_v<TagT>, TagT, void *> Query>
-  constexpr auto get() const -> decltype(get<index<Query>()>()) {
+  ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto get() const
+      -> decltype(get<index<Query>()>()) {
     return get<index<Query>()>();
   }
 };
+
+namespace Util {
+template <class BaseT, class FirstField, class... Fields>
+struct Layout<BitField<BaseT, FirstField, Fields...>> {
+  /// Described BitField type.
+  using Type = BitField<BaseT, FirstField, Fields...>;
+
+  /// Base type of the fields.
+  using FieldType = typename Type::FieldType;
+
+  /// Type of tags.
+  using TagT = typename Type::TagT;
+
+  /// Underlying type of the fields.
+  using UnderlyingType = typename Type::UnderlyingType;
+
+  /// Unsigned type used to handle raw bits of a storage unit.
+  using RawType = std::make_unsigned_t<UnderlyingType>;
+
+  // bulk operations copy and relocate records by their bytes
+  static_assert(std::is_trivially_copyable_v<Type> &&
+                    std::is_trivially_destructible_v<Type>,
+                "BitField must stay trivially copyable and destructible");
+#if defined(__has_builtin)
+#if __has_builtin(__is_trivially_relocatable)
+  static_assert(__is_trivially_relocatable(Type),
+                "BitField must stay trivially relocatable");
+#endif
+#endif
+
+  /// Size of a storage unit in bits.
+  static constexpr std::size_t FieldTypeBits = Type::FieldTypeBits;
+
+  /// Number of fields (including paddings).
+  static constexpr std::size_t NFields = Type::NFields;
+
+  /// Number of storage units.
+  static constexpr std::size_t DataSize = Type::dataSize();
+
+  /// Storage image holding the default values of the fields.
+  static constexpr std::array<FieldType, DataSize> DefaultData =
+      Type::defaultData();
+
+  /// Index of the guarded field, or NFields if there is none.
+  static constexpr std::size_t GuardIndex = Type::GuardIndex;
+
+  /// Guard policy of the guarded field. void if there is no guarded field.
+  using Guard = typename Type::Guard;
+
+  /// Index of the storage unit which holds the I-th field.
+  template <std::size_t I>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr std::size_t word() {
+    return Type::FieldBegin[I] / FieldTypeBits;
+  }
+
+  /// Offset of the I-th field in its storage unit.
+  template <std::size_t I>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr std::size_t shift() {
+    return Type::FieldBegin[I] % FieldTypeBits;
+  }
+
+  /// Number of bits actually stored for the I-th field.
+  template <std::size_t I>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr std::size_t bits() {
+    return std::min(Type::Width[I], FieldTypeBits);
+  }
+
+  /// Bit mask of the I-th field in its storage unit.
+  template <std::size_t I>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr RawType mask() {
+    return static_cast<RawType>(static_cast<UnderlyingType>(Type::Mask[I]));
+  }
+
+  /// Whether the I-th field is const-qualified (fixed) or not.
+  template <std::size_t I>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr bool fixed() {
+    return Type::FieldFixed[I];
+  }
+
+  /// Value codec of the I-th field. void for plain fields.
+  template <std::size_t I>
+  using Codec = std::tuple_element_t<I, typename Type::Codecs>;
+
+  /// Descriptor of the I-th field.
+  template <std::size_t I>
+  using Descriptor = std::tuple_element_t<I, std::tuple<FirstField, Fields...>>;
+
+  /// Raw bits of the W-th storage unit.
+  template <std::size_t W>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr RawType
+  unit(const Type &BF) {
+    return static_cast<RawType>(static_cast<UnderlyingType>(BF.Data[W]));
+  }
+
+  /// Overwrite the W-th storage unit. V must keep the bits of the guarded
+  /// field, if any. The guard policy is notified as writes through proxy
+  /// objects.
+  template <std::size_t W>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr void storeUnit(Type &BF,
+                                                                  RawType V) {
+    const FieldType Old = BF.Data[W];
+    BF.Data[W] = static_cast<FieldType>(static_cast<UnderlyingType>(V));
+    if constexpr (GuardIndex < NFields) {
+      Guard::template update<Type, GuardIndex, W>(BF.Data.data(), Old);
+    }
+  }
+
+  /// Raw bits of the I-th field, shifted down to the least significant bit.
+  template <std::size_t I>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr RawType
+  load(const Type &BF) {
+    return static_cast<RawType>(
+        (static_cast<RawType>(static_cast<UnderlyingType>(BF.Data[word<I>()])) &
+         mask<I>()) >>
+        shift<I>());
+  }
+
+  /// Overwrite raw bits of the I-th field. Excess bits of V are discarded.
+  /// The guard policy is notified as writes through proxy objects.
+  template <std::size_t I>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr void store(Type &BF,
+                                                              RawType V) {
+    auto &W = BF.Data[word<I>()];
+    const FieldType Old = W;
+    W = static_cast<FieldType>(static_cast<UnderlyingType>(
+        (static_cast<RawType>(static_cast<UnderlyingType>(W)) & ~mask<I>()) |
+        (static_cast<RawType>(V << shift<I>()) & mask<I>())));
+    if constexpr (GuardIndex < NFields && I != GuardIndex) {
+      Guard::template update<Type, GuardIndex, word<I>()>(BF.Data.data(), Old);
+    }
+  }
+
+  /// Convert raw bits of the I-th field into its value as the proxy object
+  /// does (sign extension for signed base types).
+  template <std::size_t I>
+  ORDERED_BIT_FIELD_ALWAYS_INLINE static constexpr FieldType value(RawType V) {
+    if constexpr (std::is_unsigned_v<UnderlyingType>) {
+      return static_cast<FieldType>(V);
+    } else {
+      constexpr std::size_t Ext = FieldTypeBits - bits<I>();
+      return static_cast<FieldType>(
+          static_cast<UnderlyingType>(static_cast<RawType>(V << Ext)) >> Ext);
+    }
+  }
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+  /// Find index of the field by tag.
+  template <CharArray Query> static constexpr std::size_t index() {
+    return Type::template index<Query>();
+  }
+#endif
+
+  /// Find index of the field by tag.
+  template <std::conditional_t<std::is_enum_v<TagT>, TagT, void *> Query>
+  static constexpr std::size_t index() {
+    return Type::template index<Query>();
+  }
+};
+} // namespace Util
+
 #if ORDERED_BIT_FIELD_REF_BY_STR
 /// Get proxy object to the field by its tag.
 ///
@@ -770,7 +1341,7 @@ public:
 template <Util::CharArray Query, class... Args,
           decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
                    nullptr) = nullptr>
-constexpr auto get(BitField<Args...> &BF) {
+ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto get(BitField<Args...> &BF) {
   return BF.template get<Query>();
 }
 
@@ -792,7 +1363,8 @@ constexpr auto get(BitField<Args...> &BF) {
 template <Util::CharArray Query, class... Args,
           class = decltype(Query ==
                            std::declval<typename BitField<Args...>::TagT>())>
-constexpr auto get(const BitField<Args...> &BF) {
+ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto
+get(const BitField<Args...> &BF) {
   return BF.template get<Query>();
 }
 
@@ -821,7 +1393,7 @@ constexpr auto get(BitField<Args...> &&) = delete;
 template <auto Query, class... Args,
           std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
                            std::nullptr_t> = nullptr>
-constexpr auto get(BitField<Args...> &BF) {
+ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto get(BitField<Args...> &BF) {
   return BF.template get<Query>();
 }
 
@@ -845,7 +1417,8 @@ constexpr auto get(BitField<Args...> &BF) {
 template <auto Query, class... Args,
           std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
                            std::nullptr_t> = nullptr>
-constexpr auto get(const BitField<Args...> &BF) {
+ORDERED_BIT_FIELD_ALWAYS_INLINE constexpr auto
+get(const BitField<Args...> &BF) {
   return BF.template get<Query>();
 }
 
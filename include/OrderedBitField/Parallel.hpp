@@ -0,0 +1,85 @@
+//===-- Parallel.hpp - Thread helpers for bulk operations -------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains small thread helpers shared by bulk operations over
+/// arrays of BitField records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_PARALLEL_HPP
+#define ORDERED_BIT_FIELD_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace OrderedBitField {
+namespace Util {
+/// Minimum number of records processed by a thread. Smaller inputs are
+/// processed by fewer threads.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t MinRecordsPerThread = std::size_t{1} << 16;
+
+/// Decide the number of threads used for N records.
+///
+/// \param N Number of records.
+/// \param NThreads Requested number of threads. 0 means
+/// std::thread::hardware_concurrency().
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline unsigned threadCount(std::size_t N, unsigned NThreads) {
+  if (NThreads == 0) {
+    NThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const std::size_t Limit = std::max<std::size_t>(1, N / MinRecordsPerThread);
+  return static_cast<unsigned>(std::min<std::size_t>(NThreads, Limit));
+}
+
+/// Run F(Block) for Block in [0, NBlocks) on NBlocks threads. The calling
+/// thread runs block 0.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class Func> void parallelFor(unsigned NBlocks, Func &&F) {
+  if (NBlocks <= 1) {
+    F(0u);
+    return;
+  }
+  std::vector<std::thread> Workers;
+  Workers.reserve(NBlocks - 1);
+  struct Joiner {
+    std::vector<std::thread> &Workers;
+    ~Joiner() {
+      for (auto &T : Workers) {
+        T.join();
+      }
+    }
+  } J{Workers};
+  for (unsigned B = 1; B < NBlocks; ++B) {
+    Workers.emplace_back([&F, B] { F(B); });
+  }
+  F(0u);
+}
+
+/// Begin of the Block-th of NBlocks equal partitions of [0, N).
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+constexpr std::size_t blockBegin(std::size_t N, unsigned NBlocks,
+                                 unsigned Block) {
+  return N / NBlocks * Block + std::min<std::size_t>(Block, N % NBlocks);
+}
+} // namespace Util
+} // namespace OrderedBitField
+
+#endif
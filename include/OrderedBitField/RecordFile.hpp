@@ -0,0 +1,656 @@
+//===-- RecordFile.hpp - Bulk file I/O of record arrays ---------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains bulk reads and writes of arrays of BitField records
+/// from and to files on POSIX systems. The array is moved in chunks with
+/// several requests in flight: by io_uring with registered buffers on Linux,
+/// or by threads calling pread()/pwrite() otherwise. Direct I/O (O_DIRECT)
+/// is optional.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_RECORD_FILE_HPP
+#define ORDERED_BIT_FIELD_RECORD_FILE_HPP
+
+#include "OrderedBitField.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define ORDERED_BIT_FIELD_HAS_IO_URING 1
+#else
+#define ORDERED_BIT_FIELD_HAS_IO_URING 0
+#endif
+
+namespace OrderedBitField {
+/// Back ends of bulk file I/O.
+enum class RecordFileBackend {
+  /// io_uring if the kernel allows it, threads otherwise.
+  Auto,
+  /// io_uring. std::system_error is thrown if it is not available.
+  Uring,
+  /// Threads calling pread()/pwrite().
+  Threads,
+};
+
+/// Options of bulk file I/O.
+struct RecordFileOptions {
+  /// Back end.
+  RecordFileBackend Backend = RecordFileBackend::Auto;
+  /// Bytes per request, rounded up to a multiple of 4096.
+  std::size_t ChunkBytes = std::size_t{1} << 20;
+  /// Number of requests in flight, i.e. the number of threads for
+  /// RecordFileBackend::Threads.
+  unsigned QueueDepth = 8;
+  /// Bypass the page cache by O_DIRECT, which is set on the file descriptor
+  /// during the transfer. It applies to the blocks of the transfer if the
+  /// offset is a multiple of 4096. The rest, and files which do not support
+  /// direct I/O, are transferred through the page cache.
+  bool Direct = false;
+};
+
+namespace Util {
+/// Alignment of buffers, offsets and lengths for direct I/O.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t DirectAlign = 4096;
+
+/// Exception for errno E.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline std::system_error ioError(int E, const char *What) {
+  return std::system_error(E, std::system_category(), What);
+}
+
+/// Deleter of buffers for direct I/O.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct AlignedDelete {
+  void operator()(unsigned char *P) const noexcept {
+    ::operator delete[](static_cast<void *>(P),
+                        std::align_val_t{DirectAlign});
+  }
+};
+
+/// Buffer for direct I/O.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+using AlignedBuffer = std::unique_ptr<unsigned char[], AlignedDelete>;
+
+/// Allocate a buffer for direct I/O.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline AlignedBuffer allocateAligned(std::size_t Bytes) {
+  return AlignedBuffer(static_cast<unsigned char *>(
+      ::operator new[](Bytes, std::align_val_t{DirectAlign})));
+}
+
+/// Range of a transfer left to buffered I/O, relative to the beginning of the
+/// transfer.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+struct TransferTail {
+  std::uint64_t Pos;
+  std::size_t Len;
+};
+
+/// Read or write Len bytes at Off by pread()/pwrite(), resuming after
+/// interruptions and short transfers. Return 0 or an errno value.
+///
+/// For direct I/O, Done is given: a short transfer which leaves the position
+/// off the blocks is not resumed, since the rest would fail with EINVAL. The
+/// number of bytes in whole blocks done is stored in Done instead, and the
+/// rest is left to buffered I/O.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline int transferAll(int Fd, bool Write, unsigned char *Buf,
+                       std::size_t Len, std::uint64_t Off,
+                       std::size_t *Done = nullptr) {
+  std::size_t Pos = 0;
+  while (Pos != Len) {
+    const ssize_t R =
+        Write ? ::pwrite(Fd, Buf + Pos, Len - Pos,
+                         static_cast<off_t>(Off + Pos))
+              : ::pread(Fd, Buf + Pos, Len - Pos,
+                        static_cast<off_t>(Off + Pos));
+    if (R < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      return errno;
+    }
+    if (R == 0) {
+      // end of file
+      return EIO;
+    }
+    Pos += static_cast<std::size_t>(R);
+    if (Done && Pos != Len && Pos % DirectAlign != 0) {
+      break;
+    }
+  }
+  if (Done) {
+    *Done = Pos == Len ? Len : Pos / DirectAlign * DirectAlign;
+  }
+  return 0;
+}
+
+/// Transfer Total bytes at Offset in chunks of Chunk bytes on up to Depth
+/// threads. Chunks go through aligned buffers for direct I/O, and the ranges
+/// which direct I/O cannot finish are appended to Tails.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline void threadTransfer(int Fd, bool Write, unsigned char *Data,
+                           std::uint64_t Total, std::uint64_t Offset,
+                           std::size_t Chunk, unsigned Depth, bool Direct,
+                           std::vector<TransferTail> &Tails) {
+  const std::uint64_t NChunks = (Total + Chunk - 1) / Chunk;
+  const auto NBlocks = static_cast<unsigned>(
+      std::min<std::uint64_t>(std::max(1u, Depth), NChunks));
+  // everything which may throw is done here, since exceptions do not leave
+  // the workers
+  AlignedBuffer Bufs = Direct ? allocateAligned(NBlocks * Chunk) : nullptr;
+  if (Direct) {
+    Tails.reserve(Tails.size() + NChunks);
+  }
+  std::mutex TailLock;
+  std::atomic<int> Error{0};
+  parallelFor(NBlocks, [&](unsigned Block) {
+    // chunks are dealt round-robin so that the threads move along together
+    for (std::uint64_t K = Block; K < NChunks && Error.load() == 0;
+         K += NBlocks) {
+      const std::uint64_t Pos = K * Chunk;
+      const auto Len = static_cast<std::size_t>(
+          std::min<std::uint64_t>(Chunk, Total - Pos));
+      unsigned char *P = Direct ? Bufs.get() + Block * Chunk : Data + Pos;
+      if (Direct && Write) {
+        std::memcpy(P, Data + Pos, Len);
+      }
+      std::size_t Done = Len;
+      if (const int E = transferAll(Fd, Write, P, Len, Offset + Pos,
+                                    Direct ? &Done : nullptr)) {
+        int Expected = 0;
+        Error.compare_exchange_strong(Expected, E);
+        return;
+      }
+      if (Direct && !Write) {
+        std::memcpy(Data + Pos, P, Done);
+      }
+      if (Done < Len) {
+        const std::lock_guard<std::mutex> Lock(TailLock);
+        Tails.push_back({Pos + Done, Len - Done});
+      }
+    }
+  });
+  if (const int E = Error.load()) {
+    throw ioError(E, Write ? "pwrite" : "pread");
+  }
+}
+
+#if ORDERED_BIT_FIELD_HAS_IO_URING
+/// Minimal io_uring instance driven by raw system calls.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+class Uring {
+public:
+  /// Set up a ring of at least Entries entries. std::system_error is thrown
+  /// on failure.
+  explicit Uring(unsigned Entries) {
+    io_uring_params P;
+    std::memset(&P, 0, sizeof(P));
+    Fd = static_cast<int>(::syscall(__NR_io_uring_setup, Entries, &P));
+    if (Fd < 0) {
+      throw ioError(errno, "io_uring_setup");
+    }
+    SqBytes = P.sq_off.array + P.sq_entries * sizeof(unsigned);
+    CqBytes = P.cq_off.cqes + P.cq_entries * sizeof(io_uring_cqe);
+    const bool Single = (P.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (Single) {
+      SqBytes = CqBytes = std::max(SqBytes, CqBytes);
+    }
+    SqRing = map(SqBytes, IORING_OFF_SQ_RING);
+    CqRing = Single ? SqRing : map(CqBytes, IORING_OFF_CQ_RING);
+    SqeBytes = P.sq_entries * sizeof(io_uring_sqe);
+    Sqes = static_cast<io_uring_sqe *>(map(SqeBytes, IORING_OFF_SQES));
+    if (!SqRing || !CqRing || !Sqes) {
+      const int E = errno;
+      release();
+      throw ioError(E, "mmap");
+    }
+    auto *Sq = static_cast<unsigned char *>(SqRing);
+    auto *Cq = static_cast<unsigned char *>(CqRing);
+    SqTail = reinterpret_cast<unsigned *>(Sq + P.sq_off.tail);
+    SqMask = *reinterpret_cast<unsigned *>(Sq + P.sq_off.ring_mask);
+    SqArray = reinterpret_cast<unsigned *>(Sq + P.sq_off.array);
+    CqHead = reinterpret_cast<unsigned *>(Cq + P.cq_off.head);
+    CqTail = reinterpret_cast<unsigned *>(Cq + P.cq_off.tail);
+    CqMask = *reinterpret_cast<unsigned *>(Cq + P.cq_off.ring_mask);
+    Cqes = reinterpret_cast<io_uring_cqe *>(Cq + P.cq_off.cqes);
+  }
+
+  Uring(const Uring &) = delete;
+  Uring &operator=(const Uring &) = delete;
+  ~Uring() {
+    if (!drain()) {
+      // the kernel may still read or write the buffers, which are leaked
+      // rather than freed under its requests
+      for (AlignedBuffer &B : Buffers) {
+        static_cast<void>(B.release());
+      }
+    }
+    release();
+  }
+
+  /// Allocate a buffer for requests. It is owned by the ring, so that it
+  /// outlives the requests even if the transfer is abandoned by an exception.
+  unsigned char *allocate(std::size_t Bytes) {
+    Buffers.push_back(allocateAligned(Bytes));
+    return Buffers.back().get();
+  }
+
+  /// Register N buffers for fixed reads and writes. Return whether it
+  /// succeeded; it fails e.g. beyond RLIMIT_MEMLOCK.
+  bool registerBuffers(const iovec *Vecs, unsigned N) {
+    return ::syscall(__NR_io_uring_register, Fd, IORING_REGISTER_BUFFERS,
+                     Vecs, N) == 0;
+  }
+
+  /// Queue a request. It is submitted by the next wait().
+  void push(unsigned char Op, int FileFd, void *Addr, std::size_t Len,
+            std::uint64_t Off, unsigned BufIndex, std::uint64_t UserData) {
+    const unsigned Tail = *SqTail;
+    const unsigned Index = Tail & SqMask;
+    io_uring_sqe &S = Sqes[Index];
+    std::memset(&S, 0, sizeof(S));
+    S.opcode = Op;
+    S.fd = FileFd;
+    S.addr = reinterpret_cast<std::uintptr_t>(Addr);
+    S.len = static_cast<unsigned>(Len);
+    S.off = Off;
+    S.buf_index = static_cast<std::uint16_t>(BufIndex);
+    S.user_data = UserData;
+    SqArray[Index] = Index;
+    __atomic_store_n(SqTail, Tail + 1, __ATOMIC_RELEASE);
+    ++Unsubmitted;
+    ++Pending;
+  }
+
+  /// Submit the queued requests and wait for a completion.
+  io_uring_cqe wait() {
+    for (;;) {
+      const unsigned Head = *CqHead;
+      if (Head != __atomic_load_n(CqTail, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe C = Cqes[Head & CqMask];
+        __atomic_store_n(CqHead, Head + 1, __ATOMIC_RELEASE);
+        --Pending;
+        return C;
+      }
+      const long R = ::syscall(__NR_io_uring_enter, Fd, Unsubmitted, 1,
+                               IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (R < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw ioError(errno, "io_uring_enter");
+      }
+      Unsubmitted -= static_cast<unsigned>(R);
+    }
+  }
+
+  /// Wait for all the queued requests. Return whether it succeeded.
+  bool drain() noexcept {
+    try {
+      while (Pending != 0) {
+        wait();
+      }
+      return true;
+    } catch (...) {
+      return false;
+    }
+  }
+
+private:
+  void *map(std::size_t Bytes, off_t Off) {
+    void *P = ::mmap(nullptr, Bytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, Fd, Off);
+    return P == MAP_FAILED ? nullptr : P;
+  }
+
+  void release() {
+    if (Sqes) {
+      ::munmap(Sqes, SqeBytes);
+    }
+    if (CqRing && CqRing != SqRing) {
+      ::munmap(CqRing, CqBytes);
+    }
+    if (SqRing) {
+      ::munmap(SqRing, SqBytes);
+    }
+    ::close(Fd);
+  }
+
+  int Fd = -1;
+  void *SqRing = nullptr;
+  void *CqRing = nullptr;
+  io_uring_sqe *Sqes = nullptr;
+  std::size_t SqBytes = 0;
+  std::size_t CqBytes = 0;
+  std::size_t SqeBytes = 0;
+  unsigned *SqTail = nullptr;
+  unsigned SqMask = 0;
+  unsigned *SqArray = nullptr;
+  unsigned *CqHead = nullptr;
+  unsigned *CqTail = nullptr;
+  unsigned CqMask = 0;
+  io_uring_cqe *Cqes = nullptr;
+  unsigned Unsubmitted = 0;
+  unsigned Pending = 0;
+  std::vector<AlignedBuffer> Buffers;
+};
+
+/// Transfer Total bytes at Offset in chunks of Chunk bytes with Depth
+/// requests in flight. Each request has its registered buffer, which is
+/// refilled or drained when the request completes. For direct I/O, the ranges
+/// after short transfers off the blocks are appended to Tails.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline void uringTransfer(Uring &Ring, int Fd, bool Write, unsigned char *Data,
+                          std::uint64_t Total, std::uint64_t Offset,
+                          std::size_t Chunk, unsigned Depth, bool Direct,
+                          std::vector<TransferTail> &Tails) {
+  struct Slot {
+    std::uint64_t Pos;
+    std::size_t Len;
+    std::size_t Done;
+  };
+  const std::uint64_t NChunks = (Total + Chunk - 1) / Chunk;
+  Depth = static_cast<unsigned>(std::min<std::uint64_t>(Depth, NChunks));
+  unsigned char *Bufs = Ring.allocate(Depth * Chunk);
+  std::vector<iovec> Vecs(Depth);
+  for (unsigned S = 0; S < Depth; ++S) {
+    Vecs[S] = {Bufs + S * Chunk, Chunk};
+  }
+  const bool Fixed = Ring.registerBuffers(Vecs.data(), Depth);
+  const unsigned char Op = Write ? (Fixed ? IORING_OP_WRITE_FIXED
+                                          : IORING_OP_WRITE)
+                                 : (Fixed ? IORING_OP_READ_FIXED
+                                          : IORING_OP_READ);
+
+  std::vector<Slot> Slots(Depth);
+  std::uint64_t Next = 0;
+  unsigned InFlight = 0;
+  int Error = 0;
+  const auto issue = [&](unsigned S) {
+    Slot &Sl = Slots[S];
+    Ring.push(Op, Fd, Bufs + S * Chunk + Sl.Done, Sl.Len - Sl.Done,
+              Offset + Sl.Pos + Sl.Done, S, S);
+  };
+  const auto start = [&](unsigned S) {
+    const std::uint64_t Pos = Next++ * Chunk;
+    Slots[S] = {Pos,
+                static_cast<std::size_t>(
+                    std::min<std::uint64_t>(Chunk, Total - Pos)),
+                0};
+    if (Write) {
+      std::memcpy(Bufs + S * Chunk, Data + Pos, Slots[S].Len);
+    }
+    issue(S);
+  };
+
+  for (unsigned S = 0; S < Depth; ++S, ++InFlight) {
+    start(S);
+  }
+  while (InFlight != 0) {
+    const io_uring_cqe C = Ring.wait();
+    const auto S = static_cast<unsigned>(C.user_data);
+    Slot &Sl = Slots[S];
+    if (C.res == -EINTR || C.res == -EAGAIN) {
+      issue(S);
+      continue;
+    }
+    if (C.res <= 0 || Error != 0) {
+      // wait for the other requests, which refer to the buffers
+      if (Error == 0) {
+        Error = C.res < 0 ? -C.res : EIO;
+      }
+      --InFlight;
+      continue;
+    }
+    Sl.Done += static_cast<std::size_t>(C.res);
+    if (Sl.Done < Sl.Len) {
+      if (!Direct || Sl.Done % DirectAlign == 0) {
+        issue(S);
+        continue;
+      }
+      // the rest is off the blocks of direct I/O
+      const std::size_t Aligned = Sl.Done / DirectAlign * DirectAlign;
+      Tails.push_back({Sl.Pos + Aligned, Sl.Len - Aligned});
+      Sl.Len = Aligned;
+    }
+    if (!Write) {
+      std::memcpy(Data + Sl.Pos, Bufs + S * Chunk, Sl.Len);
+    }
+    if (Next < NChunks) {
+      start(S);
+    } else {
+      --InFlight;
+    }
+  }
+  if (Error != 0) {
+    throw ioError(Error, Write ? "io_uring write" : "io_uring read");
+  }
+}
+#endif
+
+/// Whether io_uring is available to this process.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline bool uringAvailable() {
+#if ORDERED_BIT_FIELD_HAS_IO_URING
+  static const bool Available = [] {
+    try {
+      Uring Ring(1);
+      return true;
+    } catch (const std::system_error &) {
+      return false;
+    }
+  }();
+  return Available;
+#else
+  return false;
+#endif
+}
+
+/// Set the O_DIRECT flag of a file descriptor and restore the flags on
+/// destruction.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+class DirectFlag {
+public:
+  explicit DirectFlag(int Fd) : Fd(Fd), Saved(::fcntl(Fd, F_GETFL)) {}
+  DirectFlag(const DirectFlag &) = delete;
+  DirectFlag &operator=(const DirectFlag &) = delete;
+  ~DirectFlag() {
+    if (Saved >= 0) {
+      ::fcntl(Fd, F_SETFL, Saved);
+    }
+  }
+
+  /// Turn direct I/O on or off. Return whether it succeeded.
+  bool set(bool On) {
+    return Saved >= 0 &&
+           ::fcntl(Fd, F_SETFL, On ? Saved | O_DIRECT : Saved & ~O_DIRECT) ==
+               0;
+  }
+
+private:
+  int Fd;
+  int Saved;
+};
+
+/// Transfer Total bytes of Data at Offset of the file.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+inline void transferRecords(int Fd, bool Write, unsigned char *Data,
+                            std::uint64_t Total, std::uint64_t Offset,
+                            const RecordFileOptions &Options) {
+  if (Total == 0) {
+    return;
+  }
+  const std::size_t Chunk =
+      (std::clamp<std::size_t>(Options.ChunkBytes, 1, std::size_t{1} << 30) +
+       DirectAlign - 1) /
+      DirectAlign * DirectAlign;
+  const unsigned Depth = std::max(1u, Options.QueueDepth);
+  bool UseUring = false;
+  if (Options.Backend == RecordFileBackend::Uring) {
+    if (!uringAvailable()) {
+      throw ioError(ENOSYS, "io_uring");
+    }
+    UseUring = true;
+  } else if (Options.Backend == RecordFileBackend::Auto) {
+    UseUring = uringAvailable();
+  }
+
+  // whole blocks go through the bulk path, directly if requested. The
+  // remaining bytes are transferred through the page cache.
+  DirectFlag Flag(Fd);
+  const bool Direct = Options.Direct && Offset % DirectAlign == 0 &&
+                      Total >= DirectAlign && Flag.set(true);
+  if (!Direct) {
+    Flag.set(false);
+  }
+  const std::uint64_t Bulk = Direct ? Total / DirectAlign * DirectAlign : Total;
+  std::vector<TransferTail> Tails;
+#if ORDERED_BIT_FIELD_HAS_IO_URING
+  std::unique_ptr<Uring> Ring;
+  if (UseUring) {
+    try {
+      Ring = std::make_unique<Uring>(Depth);
+    } catch (const std::system_error &) {
+      // e.g. a queue deeper than the kernel allows
+      if (Options.Backend == RecordFileBackend::Uring) {
+        throw;
+      }
+    }
+  }
+  if (Ring) {
+    uringTransfer(*Ring, Fd, Write, Data, Bulk, Offset, Chunk, Depth, Direct,
+                  Tails);
+  } else {
+    threadTransfer(Fd, Write, Data, Bulk, Offset, Chunk, Depth, Direct,
+                   Tails);
+  }
+#else
+  static_cast<void>(UseUring);
+  threadTransfer(Fd, Write, Data, Bulk, Offset, Chunk, Depth, Direct, Tails);
+#endif
+  if (Bulk < Total) {
+    Tails.push_back({Bulk, static_cast<std::size_t>(Total - Bulk)});
+  }
+  if (!Tails.empty()) {
+    Flag.set(false);
+  }
+  for (const TransferTail &T : Tails) {
+    if (const int E = transferAll(Fd, Write, Data + T.Pos, T.Len,
+                                  Offset + T.Pos)) {
+      throw ioError(E, Write ? "pwrite" : "pread");
+    }
+  }
+}
+} // namespace Util
+
+/// Read N records from a file.
+///
+/// The records are read in chunks with Options.QueueDepth requests in flight,
+/// by io_uring with registered buffers if available, or by threads calling
+/// pread(). std::system_error is thrown on failure, including the end of the
+/// file before N records.
+///
+/// \param Fd File descriptor opened for reading.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Offset Offset in bytes of the first record in the file.
+/// \param Options Options of the transfer.
+///
+/// \code
+///   auto Table = makeForOverwrite<R>(N);
+///   const int Fd = open("table.bin", O_RDONLY);
+///   RecordFileOptions Options;
+///   Options.Direct = true;
+///   readRecords(Fd, Table.get(), N, 0, Options);
+/// \endcode
+template <class... Args>
+void readRecords(int Fd, BitField<Args...> *Records, std::size_t N,
+                 std::uint64_t Offset = 0,
+                 const RecordFileOptions &Options = {}) {
+  Util::transferRecords(Fd, false,
+                        reinterpret_cast<unsigned char *>(Records),
+                        std::uint64_t{N} * sizeof(BitField<Args...>), Offset,
+                        Options);
+}
+
+/// Write N records to a file.
+///
+/// The records are written in chunks with Options.QueueDepth requests in
+/// flight, by io_uring with registered buffers if available, or by threads
+/// calling pwrite(). std::system_error is thrown on failure. The data is not
+/// synchronized to the device; call fsync() for durability.
+///
+/// \param Fd File descriptor opened for writing.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Offset Offset in bytes of the first record in the file.
+/// \param Options Options of the transfer.
+template <class... Args>
+void writeRecords(int Fd, const BitField<Args...> *Records, std::size_t N,
+                  std::uint64_t Offset = 0,
+                  const RecordFileOptions &Options = {}) {
+  // the bytes are only read when writing
+  Util::transferRecords(
+      Fd, true,
+      const_cast<unsigned char *>(
+          reinterpret_cast<const unsigned char *>(Records)),
+      std::uint64_t{N} * sizeof(BitField<Args...>), Offset, Options);
+}
+} // namespace OrderedBitField
+
+#endif
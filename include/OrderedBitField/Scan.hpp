@@ -0,0 +1,204 @@
+//===-- Scan.hpp - Prefix sum over a field of BitField records --*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains multi-threaded exclusive prefix sum over a field of an
+/// array of BitField records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_SCAN_HPP
+#define ORDERED_BIT_FIELD_SCAN_HPP
+
+#include "Column.hpp"
+#include "OrderedBitField.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace OrderedBitField {
+namespace Util {
+/// Two-pass exclusive prefix sum over the I-th field of N records.
+///
+/// The records are split into one block per thread. The first pass sums up
+/// each block, and the second pass scans each block again starting from the
+/// sum of the preceding blocks. Each tile of prefix sums is handed to
+/// Sink(Begin, Prefix, Len).
+///
+/// \returns Sum of the all values.
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class SumT, class BitFieldT, class SinkT>
+SumT exclusiveScanByIndex(const BitFieldT *Records, std::size_t N,
+                          unsigned NThreads, SinkT &&Sink) {
+  const unsigned NBlocks = threadCount(N, NThreads);
+  std::vector<SumT> Partial(NBlocks + 1);
+
+  auto scanBlock = [&](unsigned Block) {
+    const std::size_t Begin = blockBegin(N, NBlocks, Block);
+    const std::size_t End = blockBegin(N, NBlocks, Block + 1);
+    SumT Value[ColumnTile];
+    SumT Prefix[ColumnTile];
+    SumT Acc = Partial[Block];
+    for (std::size_t T = Begin; T < End; T += ColumnTile) {
+      const std::size_t Len = std::min(ColumnTile, End - T);
+      extractColumnByIndex<I>(Records + T, Len, Value);
+      for (std::size_t K = 0; K < Len; ++K) {
+        Prefix[K] = Acc;
+        Acc += Value[K];
+      }
+      Sink(T, static_cast<const SumT *>(Prefix), Len);
+    }
+    return Acc;
+  };
+
+  if (NBlocks > 1) {
+    parallelFor(NBlocks, [&](unsigned Block) {
+      const std::size_t Begin = blockBegin(N, NBlocks, Block);
+      const std::size_t End = blockBegin(N, NBlocks, Block + 1);
+      SumT Value[ColumnTile];
+      SumT Acc{};
+      for (std::size_t T = Begin; T < End; T += ColumnTile) {
+        const std::size_t Len = std::min(ColumnTile, End - T);
+        extractColumnByIndex<I>(Records + T, Len, Value);
+        for (std::size_t K = 0; K < Len; ++K) {
+          Acc += Value[K];
+        }
+      }
+      Partial[Block + 1] = Acc;
+    });
+    for (unsigned B = 0; B < NBlocks; ++B) {
+      Partial[B + 1] += Partial[B];
+    }
+    parallelFor(NBlocks, [&](unsigned Block) { scanBlock(Block); });
+    return Partial[NBlocks];
+  }
+
+  return scanBlock(0);
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Exclusive prefix sum of a field over N records into a column.
+///
+/// \tparam Query Name of the field to be summed up.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Out Pointer to the first element of the result (N elements).
+/// Out[i] is the sum of the field of Records[0], ..., Records[i - 1].
+/// \param NThreads Maximum number of threads. 0 means
+/// std::thread::hardware_concurrency().
+/// \returns Sum of the field over all the records.
+template <Util::CharArray Query, class... Args, class OutT,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+OutT exclusiveScan(const BitField<Args...> *Records, std::size_t N, OutT *Out,
+                   unsigned NThreads = 0) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::exclusiveScanByIndex<L::template index<Query>(), OutT>(
+      Records, N, NThreads,
+      [Out](std::size_t Begin, const OutT *Prefix, std::size_t Len) {
+        std::copy(Prefix, Prefix + Len, Out + Begin);
+      });
+}
+
+/// Exclusive prefix sum of a field over N records into another field.
+///
+/// \tparam Query Name of the field to be summed up.
+/// \tparam Dest Name of the field which receives the result. Values which do
+/// not fit in the field are truncated.
+/// \tparam SumT Type used for the summation.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param NThreads Maximum number of threads. 0 means
+/// std::thread::hardware_concurrency().
+/// \returns Sum of the field over all the records.
+template <Util::CharArray Query, Util::CharArray Dest,
+          class SumT = std::uint64_t, class... Args,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+SumT exclusiveScanInto(BitField<Args...> *Records, std::size_t N,
+                       unsigned NThreads = 0) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::exclusiveScanByIndex<L::template index<Query>(), SumT>(
+      Records, N, NThreads,
+      [Records](std::size_t Begin, const SumT *Prefix, std::size_t Len) {
+        Util::storeColumnByIndex<L::template index<Dest>()>(Records + Begin,
+                                                            Len, Prefix);
+      });
+}
+#endif
+
+/// Exclusive prefix sum of a field over N records into a column.
+///
+/// \tparam Query Tag of the field to be summed up.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param Out Pointer to the first element of the result (N elements).
+/// Out[i] is the sum of the field of Records[0], ..., Records[i - 1].
+/// \param NThreads Maximum number of threads. 0 means
+/// std::thread::hardware_concurrency().
+/// \returns Sum of the field over all the records.
+///
+/// \code
+///   enum class Tag { Len, Offset };
+///   using R = BitField<std::uint32_t, Field<Tag::Len, 12>,
+///                      Field<Tag::Offset, 20>>;
+///   std::vector<R> Records(N);
+///   std::vector<std::uint64_t> Offsets(N);
+///   auto Total = exclusiveScan<Tag::Len>(Records.data(), N, Offsets.data());
+/// \endcode
+template <auto Query, class... Args, class OutT,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+OutT exclusiveScan(const BitField<Args...> *Records, std::size_t N, OutT *Out,
+                   unsigned NThreads = 0) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::exclusiveScanByIndex<L::template index<Query>(), OutT>(
+      Records, N, NThreads,
+      [Out](std::size_t Begin, const OutT *Prefix, std::size_t Len) {
+        std::copy(Prefix, Prefix + Len, Out + Begin);
+      });
+}
+
+/// Exclusive prefix sum of a field over N records into another field.
+///
+/// \tparam Query Tag of the field to be summed up.
+/// \tparam Dest Tag of the field which receives the result. Values which do
+/// not fit in the field are truncated.
+/// \tparam SumT Type used for the summation.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+/// \param NThreads Maximum number of threads. 0 means
+/// std::thread::hardware_concurrency().
+/// \returns Sum of the field over all the records.
+///
+/// \code
+///   auto Total = exclusiveScanInto<Tag::Len, Tag::Offset>(Records.data(), N);
+/// \endcode
+template <auto Query, auto Dest, class SumT = std::uint64_t, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+SumT exclusiveScanInto(BitField<Args...> *Records, std::size_t N,
+                       unsigned NThreads = 0) {
+  using L = Util::Layout<BitField<Args...>>;
+  return Util::exclusiveScanByIndex<L::template index<Query>(), SumT>(
+      Records, N, NThreads,
+      [Records](std::size_t Begin, const SumT *Prefix, std::size_t Len) {
+        Util::storeColumnByIndex<L::template index<Dest>()>(Records + Begin,
+                                                            Len, Prefix);
+      });
+}
+} // namespace OrderedBitField
+
+#endif
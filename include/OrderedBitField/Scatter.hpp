@@ -0,0 +1,353 @@
+//===-- Scatter.hpp - Batched random-access updates of records --*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains batched updates of a field at random indices of an array
+/// of BitField records. The updates are radix-partitioned by the range of the
+/// array they touch and applied a partition at a time with prefetches, on
+/// several threads if requested.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_SCATTER_HPP
+#define ORDERED_BIT_FIELD_SCATTER_HPP
+
+#include "Gather.hpp"
+#include "OrderedBitField.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace OrderedBitField {
+/// Update of a field of the record at an index.
+///
+/// \tparam ValueT Type of the new value.
+template <class ValueT> struct FieldUpdate {
+  /// Index of the record.
+  std::size_t Index;
+  /// New value, or operand of the duplicate policy.
+  ValueT Value;
+};
+
+/// Policies to resolve several updates of the same record. The updates of a
+/// record are applied in their original order.
+namespace Duplicate {
+/// The last update wins.
+struct LastWins {
+  static constexpr bool ReadsField = false;
+  template <class T> static constexpr T combine(T, T New) { return New; }
+};
+
+/// The values of the updates are added to the field (modulo its width).
+struct Sum {
+  static constexpr bool ReadsField = true;
+  template <class T> static constexpr T combine(T Old, T New) {
+    return static_cast<T>(Old + New);
+  }
+};
+
+/// The field takes the maximum of its value and the values of the updates.
+struct Max {
+  static constexpr bool ReadsField = true;
+  template <class T> static constexpr T combine(T Old, T New) {
+    return std::max(Old, New);
+  }
+};
+} // namespace Duplicate
+
+namespace Util {
+/// Size in bytes of the regions of the array by which updates are
+/// partitioned. A region spans a page, so that a partition covers whole
+/// TLB entries.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t ScatterRegionBytes = 4096;
+
+/// Maximum number of key bits by which updates are partitioned.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr unsigned ScatterPartitionBits = 10;
+
+/// Number of updates buffered per partition before they are applied.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t ScatterBufferUpdates = 256;
+
+/// Minimum number of updates which are partitioned. Fewer updates are applied
+/// in the given order.
+///
+/// \note This definition is not intended to be used by library users. This API
+/// may have breaking change.
+inline constexpr std::size_t MinPartitionedUpdates = std::size_t{1} << 12;
+
+/// Shift from record indices to region numbers.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <class BitFieldT> constexpr unsigned regionShift() {
+  unsigned Shift = 0;
+  while ((sizeof(BitFieldT) << (Shift + 1)) <= ScatterRegionBytes) {
+    ++Shift;
+  }
+  return Shift;
+}
+
+/// Apply an update to the I-th field of a record.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class PolicyT, class BitFieldT, class ValueT>
+void applyUpdate(BitFieldT &BF, const ValueT &V) {
+  using L = Layout<BitFieldT>;
+  static_assert(!L::template fixed<I>(),
+                "assignment of read-only memeber is not allowed");
+  using RawType = typename L::RawType;
+  auto Raw = static_cast<RawType>(static_cast<typename L::UnderlyingType>(
+      static_cast<typename L::FieldType>(V)));
+  if constexpr (PolicyT::ReadsField) {
+    // combine the values as the field holds them
+    constexpr auto Mask =
+        static_cast<RawType>(L::template mask<I>() >> L::template shift<I>());
+    const auto New = PolicyT::combine(
+        L::template value<I>(L::template load<I>(BF)),
+        L::template value<I>(static_cast<RawType>(Raw & Mask)));
+    Raw = static_cast<RawType>(static_cast<typename L::UnderlyingType>(New));
+  }
+  L::template store<I>(BF, Raw);
+}
+
+/// Apply N updates in the given order, prefetching the records Distance
+/// updates ahead.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class PolicyT, class BitFieldT, class UpdateT>
+void applyUpdates(BitFieldT *Records, const UpdateT *Updates, std::size_t N,
+                  std::size_t Distance) {
+  constexpr std::size_t Word = Layout<BitFieldT>::template word<I>();
+  for (std::size_t K = 0; K < N; ++K) {
+    if (Distance && K + Distance < N) {
+      prefetchWrite(Records[Updates[K + Distance].Index].Data.data() + Word);
+    }
+    applyUpdate<I, PolicyT>(Records[Updates[K].Index], Updates[K].Value);
+  }
+}
+
+/// Apply N updates to the I-th field of the records.
+///
+/// \note This function is not intended to be used by library users. This API
+/// may have breaking change.
+template <std::size_t I, class PolicyT, class BitFieldT, class UpdateT>
+void scatterUpdateByIndex(BitFieldT *Records, const UpdateT *Updates,
+                          std::size_t N, unsigned NThreads,
+                          std::size_t Distance) {
+  if (N < MinPartitionedUpdates) {
+    applyUpdates<I, PolicyT>(Records, Updates, N, Distance);
+    return;
+  }
+
+  const unsigned NBlocks = threadCount(N, NThreads);
+
+  // the top bits of the region numbers select the partition
+  constexpr unsigned Shift = regionShift<BitFieldT>();
+  std::vector<std::size_t> BlockMax(NBlocks);
+  parallelFor(NBlocks, [&](unsigned Block) {
+    std::size_t M = 0;
+    for (std::size_t K = blockBegin(N, NBlocks, Block),
+                     E = blockBegin(N, NBlocks, Block + 1);
+         K < E; ++K) {
+      M = std::max(M, static_cast<std::size_t>(Updates[K].Index));
+    }
+    BlockMax[Block] = M;
+  });
+  std::size_t MaxKey =
+      *std::max_element(BlockMax.begin(), BlockMax.end()) >> Shift;
+  unsigned KeyBits = 0;
+  while (KeyBits < sizeof(std::size_t) * 8 && (MaxKey >> KeyBits) != 0) {
+    ++KeyBits;
+  }
+  const unsigned TopBits = std::min(KeyBits, ScatterPartitionBits);
+  const unsigned LowBits = Shift + KeyBits - TopBits;
+  const std::size_t NParts = std::size_t{1} << TopBits;
+
+  if (NBlocks == 1) {
+    // updates are buffered per partition and applied when the buffer fills
+    // up, so that a batch of updates hits a narrow range of the array. A
+    // partition buffers at most as many updates as it receives, so the
+    // buffers are no larger than the updates themselves. The updates of a
+    // record stay in their order since they go to the same partition.
+    std::vector<std::size_t> Begin(NParts + 1);
+    for (std::size_t K = 0; K < N; ++K) {
+      ++Begin[(static_cast<std::size_t>(Updates[K].Index) >> LowBits) + 1];
+    }
+    for (std::size_t P = 0; P < NParts; ++P) {
+      Begin[P + 1] = Begin[P] + std::min(Begin[P + 1], ScatterBufferUpdates);
+    }
+    std::unique_ptr<UpdateT[]> Buf(new UpdateT[Begin[NParts]]);
+    std::vector<std::size_t> Next(Begin.begin(), Begin.end() - 1);
+    for (std::size_t K = 0; K < N; ++K) {
+      const std::size_t P =
+          static_cast<std::size_t>(Updates[K].Index) >> LowBits;
+      Buf[Next[P]++] = Updates[K];
+      if (Next[P] == Begin[P + 1]) {
+        applyUpdates<I, PolicyT>(Records, Buf.get() + Begin[P],
+                                 Next[P] - Begin[P], Distance);
+        Next[P] = Begin[P];
+      }
+    }
+    for (std::size_t P = 0; P < NParts; ++P) {
+      applyUpdates<I, PolicyT>(Records, Buf.get() + Begin[P],
+                               Next[P] - Begin[P], Distance);
+    }
+    return;
+  }
+
+  // each thread counts the partitions of its slice of the updates, and then
+  // moves the slice to its places in a copy ordered by partition. The
+  // slices of a partition follow each other in the order of the threads, so
+  // the updates of a record stay in their order.
+  std::vector<std::size_t> Count(std::size_t{NBlocks} * NParts);
+  parallelFor(NBlocks, [&](unsigned Block) {
+    std::size_t *C = Count.data() + std::size_t{Block} * NParts;
+    for (std::size_t K = blockBegin(N, NBlocks, Block),
+                     E = blockBegin(N, NBlocks, Block + 1);
+         K < E; ++K) {
+      ++C[static_cast<std::size_t>(Updates[K].Index) >> LowBits];
+    }
+  });
+  std::vector<std::size_t> Begin(NParts + 1);
+  std::size_t Offset = 0;
+  for (std::size_t P = 0; P < NParts; ++P) {
+    Begin[P] = Offset;
+    for (unsigned Block = 0; Block < NBlocks; ++Block) {
+      std::size_t &C = Count[std::size_t{Block} * NParts + P];
+      const std::size_t Slice = C;
+      C = Offset;
+      Offset += Slice;
+    }
+  }
+  Begin[NParts] = Offset;
+
+  std::unique_ptr<UpdateT[]> Sorted(new UpdateT[N]);
+  parallelFor(NBlocks, [&](unsigned Block) {
+    std::size_t *Next = Count.data() + std::size_t{Block} * NParts;
+    for (std::size_t K = blockBegin(N, NBlocks, Block),
+                     E = blockBegin(N, NBlocks, Block + 1);
+         K < E; ++K) {
+      Sorted[Next[static_cast<std::size_t>(Updates[K].Index) >> LowBits]++] =
+          Updates[K];
+    }
+  });
+
+  // threads own disjoint ranges of partitions holding about the same number
+  // of updates, so that they need no atomics
+  auto firstPart = [&](unsigned Block) {
+    return static_cast<std::size_t>(
+        std::lower_bound(Begin.begin(), Begin.end() - 1,
+                         blockBegin(N, NBlocks, Block)) -
+        Begin.begin());
+  };
+  parallelFor(NBlocks, [&](unsigned Block) {
+    const std::size_t First = Begin[firstPart(Block)];
+    const std::size_t Last =
+        Block + 1 == NBlocks ? N : Begin[firstPart(Block + 1)];
+    applyUpdates<I, PolicyT>(Records, Sorted.get() + First, Last - First,
+                             Distance);
+  });
+}
+} // namespace Util
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Apply N updates to a field of the records at random indices.
+///
+/// \tparam Query Name of the field.
+/// \tparam PolicyT Policy for several updates of the same record.
+/// \param Records Pointer to the first record.
+/// \param Updates Pointer to the first update. An update has members Index
+/// and Value, e.g. FieldUpdate.
+/// \param N Number of updates.
+/// \param NThreads Maximum number of threads. 0 means
+/// std::thread::hardware_concurrency().
+/// \param Distance Number of updates the prefetches run ahead. 0 disables the
+/// prefetches.
+template <Util::CharArray Query, class PolicyT = Duplicate::LastWins,
+          class... Args, class UpdateT,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+void scatterUpdate(BitField<Args...> *Records, const UpdateT *Updates,
+                   std::size_t N, unsigned NThreads = 0,
+                   std::size_t Distance = Util::PrefetchDistance) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::scatterUpdateByIndex<L::template index<Query>(), PolicyT>(
+      Records, Updates, N, NThreads, Distance);
+}
+#endif
+
+/// Apply N updates to a field of the records at random indices.
+///
+/// Large batches are radix-partitioned by the range of the array they touch,
+/// made of whole 4 KiB regions, so that each batch of read-modify-writes hits
+/// a narrow range of the array (and few TLB entries) instead of all of it.
+/// On one thread, updates are buffered per partition and a full buffer is
+/// applied with software prefetches. A partition buffers at most 256 updates
+/// and no more than it receives, so the buffers never outgrow the updates.
+/// On several threads, the updates are partitioned once into a copy, by a
+/// histogram and a scatter pass over slices of them on each thread, and
+/// ranges of partitions holding about the same number of updates are applied
+/// in parallel. Partitions cover disjoint records, so they need no atomics.
+/// The updates of a record are applied in their original order, and combined
+/// with the field by PolicyT.
+///
+/// The updates of a partition are not sorted by index before they are
+/// applied. A partition spans few enough records to stay in the caches, and
+/// a stable sort of each batch by index costs several times more than it
+/// saves.
+///
+/// \tparam Query Tag of the field.
+/// \tparam PolicyT Policy for several updates of the same record:
+/// Duplicate::LastWins, Duplicate::Sum or Duplicate::Max.
+/// \param Records Pointer to the first record.
+/// \param Updates Pointer to the first update. An update has members Index
+/// and Value, e.g. FieldUpdate.
+/// \param N Number of updates.
+/// \param NThreads Maximum number of threads. 0 means
+/// std::thread::hardware_concurrency().
+/// \param Distance Number of updates the prefetches run ahead. 0 disables the
+/// prefetches.
+///
+/// \code
+///   enum class Tag { Count, Flags };
+///   using R = BitField<std::uint32_t, Field<Tag::Count, 24>,
+///                      Field<Tag::Flags, 8>>;
+///   std::vector<R> Table(M);
+///   std::vector<FieldUpdate<std::uint32_t>> Hits = ...;
+///   scatterUpdate<Tag::Count, Duplicate::Sum>(Table.data(), Hits.data(),
+///                                             Hits.size());
+/// \endcode
+template <auto Query, class PolicyT = Duplicate::LastWins, class... Args,
+          class UpdateT,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+void scatterUpdate(BitField<Args...> *Records, const UpdateT *Updates,
+                   std::size_t N, unsigned NThreads = 0,
+                   std::size_t Distance = Util::PrefetchDistance) {
+  using L = Util::Layout<BitField<Args...>>;
+  Util::scatterUpdateByIndex<L::template index<Query>(), PolicyT>(
+      Records, Updates, N, NThreads, Distance);
+}
+} // namespace OrderedBitField
+
+#endif
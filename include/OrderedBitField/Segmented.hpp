@@ -0,0 +1,313 @@
+//===-- Segmented.hpp - Records in segmented buffers ------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains views of BitField records in segmented (scatter/gather)
+/// buffers such as `iovec` lists. A record lying in one segment is accessed in
+/// place, and only the storage units of a record which straddle a segment
+/// boundary are stitched from the segments.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_SEGMENTED_HPP
+#define ORDERED_BIT_FIELD_SEGMENTED_HPP
+
+#include "OrderedBitField.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace OrderedBitField {
+/// Segment of a buffer, laid out as `iovec`.
+struct Segment {
+  /// Pointer to the first byte of the segment.
+  void *Base;
+  /// Length of the segment in bytes.
+  std::size_t Len;
+};
+
+namespace Util {
+/// Access to the pointer and the length of a segment. Segment types with
+/// `iov_base` and `iov_len` (e.g. `iovec`) are supported as well.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class SegmentT, class = void> struct SegmentTraits {
+  static auto base(const SegmentT &S) { return S.Base; }
+  static std::size_t length(const SegmentT &S) { return S.Len; }
+};
+
+template <class SegmentT>
+struct SegmentTraits<SegmentT,
+                     std::void_t<decltype(std::declval<SegmentT>().iov_base)>> {
+  static auto base(const SegmentT &S) { return S.iov_base; }
+  static std::size_t length(const SegmentT &S) { return S.iov_len; }
+};
+} // namespace Util
+
+template <class BitFieldT, std::size_t I, class SegmentT>
+class SegmentedFieldProxy;
+
+/// Record in a segmented buffer.
+///
+/// \tparam BitFieldT Type of the record. const-qualify it for read-only
+/// access.
+/// \tparam SegmentT Type of the segments.
+template <class BitFieldT, class SegmentT = Segment> class SegmentedRecord {
+  using Type = std::remove_const_t<BitFieldT>;
+  using L = Util::Layout<Type>;
+  using Traits = Util::SegmentTraits<SegmentT>;
+  using ByteT = std::conditional_t<std::is_const_v<BitFieldT>,
+                                   const unsigned char, unsigned char>;
+  static constexpr std::size_t UnitBytes = sizeof(typename L::FieldType);
+
+public:
+  /// Base type of the fields.
+  using FieldType = typename L::FieldType;
+
+  /// Record starting at Skip bytes from the beginning of the Seg-th segment.
+  /// The segments must hold sizeof(BitFieldT) bytes from there.
+  SegmentedRecord(const SegmentT *Segs, std::size_t Seg, std::size_t Skip)
+      : Segs(Segs), Seg(Seg), Skip(Skip),
+        Direct(Skip + sizeof(Type) <= Traits::length(Segs[Seg])
+                   ? byte(Seg) + Skip
+                   : nullptr) {}
+
+  /// Whether the record lies in one segment or not.
+  bool contiguous() const { return Direct != nullptr; }
+
+  /// Pointer to the record if it lies in one segment and is suitably aligned,
+  /// or nullptr.
+  BitFieldT *direct() const {
+    const auto Addr = reinterpret_cast<std::uintptr_t>(Direct);
+    return Direct && Addr % alignof(Type) == 0
+               ? reinterpret_cast<BitFieldT *>(Direct)
+               : nullptr;
+  }
+
+  /// Copy of the record.
+  Type load() const {
+    Type BF;
+    copyOut(0, static_cast<void *>(BF.Data.data()), sizeof(Type));
+    return BF;
+  }
+
+  /// Overwrite the record.
+  void store(const Type &BF) const {
+    static_assert(!std::is_const_v<BitFieldT>, "record is read-only");
+    copyIn(0, static_cast<const void *>(BF.Data.data()), sizeof(Type));
+  }
+
+  /// Value of the I-th field. Only the storage unit holding the field is
+  /// read.
+  template <std::size_t I> FieldType field() const {
+    constexpr std::size_t W = L::template word<I>();
+    Type BF;
+    copyOut(W * UnitBytes, static_cast<void *>(BF.Data.data() + W), UnitBytes);
+    return L::template value<I>(L::template load<I>(BF));
+  }
+
+  /// Overwrite the I-th field. Only the storage unit holding the field is
+  /// read and written, unless the record has a guarded field.
+  template <std::size_t I> void setField(FieldType V) const {
+    static_assert(!std::is_const_v<BitFieldT>, "record is read-only");
+    static_assert(!L::template fixed<I>(),
+                  "assignment of read-only memeber is not allowed");
+    const auto Raw = static_cast<typename L::RawType>(
+        static_cast<typename L::UnderlyingType>(V));
+    if constexpr (L::GuardIndex < L::NFields) {
+      // the guard may depend on any unit of the record
+      Type BF = load();
+      L::template store<I>(BF, Raw);
+      store(BF);
+    } else {
+      constexpr std::size_t W = L::template word<I>();
+      Type BF;
+      copyOut(W * UnitBytes, static_cast<void *>(BF.Data.data() + W),
+              UnitBytes);
+      L::template store<I>(BF, Raw);
+      copyIn(W * UnitBytes, static_cast<const void *>(BF.Data.data() + W),
+             UnitBytes);
+    }
+  }
+
+private:
+  ByteT *byte(std::size_t S) const {
+    return static_cast<ByteT *>(Traits::base(Segs[S]));
+  }
+
+  /// Call F on the pieces of Bytes bytes from Pos in the segments. Empty
+  /// segments, whose base may be null, are skipped.
+  template <class Fn>
+  void walk(std::size_t Pos, std::size_t Bytes, Fn &&F) const {
+    std::size_t S = Seg;
+    std::size_t Off = Skip + Pos;
+    while (Off >= Traits::length(Segs[S])) {
+      Off -= Traits::length(Segs[S]);
+      ++S;
+    }
+    for (std::size_t Done = 0; Done < Bytes; ++S, Off = 0) {
+      const std::size_t Len =
+          std::min(Traits::length(Segs[S]) - Off, Bytes - Done);
+      if (Len == 0) {
+        continue;
+      }
+      F(byte(S) + Off, Done, Len);
+      Done += Len;
+    }
+  }
+
+  void copyOut(std::size_t Pos, void *Dst, std::size_t Bytes) const {
+    auto *D = static_cast<unsigned char *>(Dst);
+    if (Direct) {
+      std::memcpy(D, Direct + Pos, Bytes);
+      return;
+    }
+    walk(Pos, Bytes, [&](const unsigned char *P, std::size_t Done,
+                         std::size_t Len) { std::memcpy(D + Done, P, Len); });
+  }
+
+  void copyIn(std::size_t Pos, const void *Src, std::size_t Bytes) const {
+    const auto *S = static_cast<const unsigned char *>(Src);
+    if (Direct) {
+      std::memcpy(Direct + Pos, S, Bytes);
+      return;
+    }
+    walk(Pos, Bytes, [&](unsigned char *P, std::size_t Done,
+                         std::size_t Len) { std::memcpy(P, S + Done, Len); });
+  }
+
+  const SegmentT *Segs;
+  std::size_t Seg;
+  std::size_t Skip;
+  ByteT *Direct;
+};
+
+/// View of records packed in a segmented buffer. A record may straddle a
+/// segment boundary.
+///
+/// \tparam BitFieldT Type of the records. const-qualify it for read-only
+/// access.
+/// \tparam SegmentT Type of the segments, e.g. Segment or `iovec`.
+///
+/// \code
+///   iovec Vec[] = {{Buf0, Len0}, {Buf1, Len1}};
+///   SegmentedView<R, iovec> View(Vec, 2);
+///   for (std::size_t K = 0; K < View.size(); ++K) {
+///     get<Tag::Len>(View[K]) = 0;
+///   }
+/// \endcode
+template <class BitFieldT, class SegmentT = Segment> class SegmentedView {
+  using Traits = Util::SegmentTraits<SegmentT>;
+
+public:
+  /// Type of the records in the view.
+  using Record = SegmentedRecord<BitFieldT, SegmentT>;
+
+  /// Construct the view. The segments are referred to, not copied.
+  ///
+  /// \param Segs Pointer to the first segment.
+  /// \param NSegs Number of segments.
+  SegmentedView(const SegmentT *Segs, std::size_t NSegs)
+      : Segs(Segs), Ends(NSegs) {
+    std::size_t End = 0;
+    for (std::size_t S = 0; S < NSegs; ++S) {
+      End += Traits::length(Segs[S]);
+      Ends[S] = End;
+    }
+  }
+
+  /// Total length of the segments in bytes.
+  std::size_t bytes() const { return Ends.empty() ? 0 : Ends.back(); }
+
+  /// Number of whole records in the view.
+  std::size_t size() const { return bytes() / sizeof(BitFieldT); }
+
+  /// Record starting at Offset bytes. It must end within the view.
+  Record at(std::size_t Offset) const {
+    const auto It = std::upper_bound(Ends.begin(), Ends.end(), Offset);
+    const auto S = static_cast<std::size_t>(It - Ends.begin());
+    return Record(Segs, S, Offset - (S == 0 ? 0 : Ends[S - 1]));
+  }
+
+  /// K-th record.
+  Record operator[](std::size_t K) const { return at(K * sizeof(BitFieldT)); }
+
+private:
+  const SegmentT *Segs;
+  std::vector<std::size_t> Ends;
+};
+
+/// Proxy object to a field of a record in a segmented buffer.
+///
+/// \note The proxy object refers to the segments. Watch for dangling
+/// references.
+template <class BitFieldT, std::size_t I, class SegmentT>
+class SegmentedFieldProxy {
+  using RecordT = SegmentedRecord<BitFieldT, SegmentT>;
+
+public:
+  /// Base type of the fields.
+  using FieldType = typename RecordT::FieldType;
+
+  explicit SegmentedFieldProxy(const RecordT &Rec) : Rec(Rec) {}
+
+  /// Value of the field.
+  operator FieldType() const { return Rec.template field<I>(); }
+
+  /// Overwrite the field.
+  const SegmentedFieldProxy &operator=(FieldType V) const {
+    Rec.template setField<I>(V);
+    return *this;
+  }
+
+  /// Overwrite the field with the value of another field.
+  const SegmentedFieldProxy &operator=(const SegmentedFieldProxy &P) const {
+    return *this = static_cast<FieldType>(P);
+  }
+
+private:
+  RecordT Rec;
+};
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Get proxy object to a field of a record in a segmented buffer.
+///
+/// \tparam Query Name of the field.
+template <Util::CharArray Query, class BitFieldT, class SegmentT,
+          decltype(Query == std::declval<typename std::remove_const_t<
+                                BitFieldT>::TagT>(),
+                   nullptr) = nullptr>
+auto get(const SegmentedRecord<BitFieldT, SegmentT> &Rec) {
+  using L = Util::Layout<std::remove_const_t<BitFieldT>>;
+  return SegmentedFieldProxy<BitFieldT, L::template index<Query>(), SegmentT>(
+      Rec);
+}
+#endif
+
+/// Get proxy object to a field of a record in a segmented buffer.
+///
+/// \tparam Query Tag of the field.
+template <auto Query, class BitFieldT, class SegmentT,
+          std::enable_if_t<std::is_enum_v<typename std::remove_const_t<
+                               BitFieldT>::TagT>,
+                           std::nullptr_t> = nullptr>
+auto get(const SegmentedRecord<BitFieldT, SegmentT> &Rec) {
+  using L = Util::Layout<std::remove_const_t<BitFieldT>>;
+  return SegmentedFieldProxy<BitFieldT, L::template index<Query>(), SegmentT>(
+      Rec);
+}
+} // namespace OrderedBitField
+
+#endif
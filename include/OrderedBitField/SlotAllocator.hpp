@@ -0,0 +1,306 @@
+//===-- SlotAllocator.hpp - Lock-free slot allocator ------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a lock-free allocator of slots in an array of BitField
+/// records, which uses a 1-bit field of the records as the allocation bitmap.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_SLOT_ALLOCATOR_HPP
+#define ORDERED_BIT_FIELD_SLOT_ALLOCATOR_HPP
+
+#include "OrderedBitField.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace OrderedBitField {
+namespace Util {
+/// Atomic operations on a storage unit of a record.
+///
+/// \note This class is not intended to be used by library users. This API may
+/// have breaking change.
+template <class T> struct AtomicUnit {
+#if defined(__cpp_lib_atomic_ref)
+  static T load(T &U) {
+    return std::atomic_ref<T>(U).load(std::memory_order_acquire);
+  }
+  static void store(T &U, T V) {
+    std::atomic_ref<T>(U).store(V, std::memory_order_release);
+  }
+  static bool compareExchange(T &U, T &Expected, T Desired) {
+    return std::atomic_ref<T>(U).compare_exchange_weak(
+        Expected, Desired, std::memory_order_acq_rel,
+        std::memory_order_acquire);
+  }
+  static void fetchOr(T &U, T V) {
+    std::atomic_ref<T>(U).fetch_or(V, std::memory_order_acq_rel);
+  }
+#else
+  static T load(T &U) { return __atomic_load_n(&U, __ATOMIC_ACQUIRE); }
+  static void store(T &U, T V) { __atomic_store_n(&U, V, __ATOMIC_RELEASE); }
+  static bool compareExchange(T &U, T &Expected, T Desired) {
+    return __atomic_compare_exchange_n(&U, &Expected, Desired, true,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+  }
+  static void fetchOr(T &U, T V) {
+    __atomic_fetch_or(&U, V, __ATOMIC_ACQ_REL);
+  }
+#endif
+};
+} // namespace Util
+
+/// Lock-free allocator of slots in an array of records.
+///
+/// A 1-bit field of the records tells whether the slot is free (1) or not
+/// (0), and the allocator keeps a summary bitmap of the free slots, 64 slots
+/// per word, to find a candidate with a single count-trailing-zeros. A slot is
+/// claimed by a compare-and-swap on the storage unit of the record, so the
+/// field stays the authoritative state.
+///
+/// While the allocator is in use, other threads load the storage unit of the
+/// free field of any slot at any time, so every write to that unit must be
+/// atomic, whether the slot is free or claimed. Fields sharing the unit with
+/// the free field are therefore accessed by the owner of a claimed slot
+/// through load() and modify(), never by get() on the record in the array.
+/// Fields in other units of the record are accessed as usual by the owner.
+///
+/// \tparam BitFieldT Type of the records.
+/// \tparam I Index of the 1-bit field. Use makeSlotAllocator to specify the
+/// field by its tag.
+template <class BitFieldT, std::size_t I> class SlotAllocator {
+  using L = Util::Layout<BitFieldT>;
+  using FieldType = typename L::FieldType;
+  using Atomic = Util::AtomicUnit<FieldType>;
+
+  static_assert(std::is_integral_v<FieldType>,
+                "slot allocator needs an integral base type");
+  static_assert(L::template bits<I>() == 1, "free field must be 1 bit wide");
+  static_assert(!L::template fixed<I>(),
+                "assignment of read-only memeber is not allowed");
+  static_assert(L::GuardIndex == L::NFields,
+                "slot records must not have a guarded field");
+
+  static constexpr std::size_t Word = L::template word<I>();
+  static constexpr auto Bit = static_cast<FieldType>(L::template mask<I>());
+
+public:
+  /// Construct the allocator. Slots whose field is 1 are regarded as free.
+  ///
+  /// \param Records Pointer to the first record.
+  /// \param N Number of records.
+  SlotAllocator(BitFieldT *Records, std::size_t N)
+      : Records(Records), N(N), NWords((N + 63) / 64),
+        Summary(new std::atomic<std::uint64_t>[NWords]) {
+    for (std::size_t W = 0; W < NWords; ++W) {
+      std::uint64_t S = 0;
+      for (std::size_t K = W * 64; K < N && K < W * 64 + 64; ++K) {
+        S |= std::uint64_t{isFree(K)} << (K % 64);
+      }
+      Summary[W].store(S, std::memory_order_relaxed);
+    }
+  }
+
+  /// Number of slots.
+  std::size_t size() const { return N; }
+
+  /// Whether the slot is free or not.
+  bool isFree(std::size_t Slot) const {
+    return Atomic::load(Records[Slot].Data[Word]) & Bit;
+  }
+
+  /// Claim a free slot, starting the search from the slot where the calling
+  /// thread succeeded last time.
+  ///
+  /// \note The last slot is kept per thread and shared by all allocators of
+  /// the same record type and field, so a thread alternating between such
+  /// allocators starts from the slot it claimed in another one. The result
+  /// is still correct, but the search may be longer; give explicit hints to
+  /// allocate(std::size_t) in that case.
+  ///
+  /// \returns Index of the claimed slot, or size() if there is no free slot.
+  std::size_t allocate() {
+    thread_local std::size_t Hint =
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) *
+        0x9e3779b97f4a7c15ULL;
+    const std::size_t Slot = allocate(Hint);
+    if (Slot < N) {
+      Hint = Slot;
+    }
+    return Slot;
+  }
+
+  /// Claim a free slot, starting the search from Hint % size(). Give distinct
+  /// hints to threads to spread contention.
+  ///
+  /// \returns Index of the claimed slot, or size() if there is no free slot.
+  std::size_t allocate(std::size_t Hint) {
+    if (N == 0) {
+      return N;
+    }
+    Hint %= N;
+    const std::size_t First = Hint / 64;
+    for (std::size_t J = 0; J <= NWords; ++J) {
+      const std::size_t W = (First + J) % NWords;
+      std::uint64_t S = Summary[W].load(std::memory_order_acquire);
+      if (J == 0) {
+        // slots before the hint are visited at the end
+        S &= ~std::uint64_t{} << (Hint % 64);
+      } else if (J == NWords) {
+        S &= ~(~std::uint64_t{} << (Hint % 64));
+      }
+      while (S) {
+#if defined(__GNUC__)
+        const auto B = static_cast<std::size_t>(__builtin_ctzll(S));
+#else
+        std::size_t B = 0;
+        while (!(S >> B & 1)) {
+          ++B;
+        }
+#endif
+        const std::size_t Slot = W * 64 + B;
+        if (tryClaim(Slot)) {
+          Summary[W].fetch_and(~(std::uint64_t{1} << B),
+                               std::memory_order_acq_rel);
+          return Slot;
+        }
+        dropFromSummary(Slot);
+        S &= S - 1;
+      }
+    }
+    return N;
+  }
+
+  /// Release the claimed slot.
+  void release(std::size_t Slot) {
+    Atomic::fetchOr(Records[Slot].Data[Word], Bit);
+    Summary[Slot / 64].fetch_or(std::uint64_t{1} << (Slot % 64),
+                                std::memory_order_acq_rel);
+  }
+
+  /// Copy of the record of the claimed slot, with the storage unit of the
+  /// free field loaded atomically. Only the thread owning the slot may call
+  /// it.
+  BitFieldT load(std::size_t Slot) const {
+    BitFieldT Copy;
+    for (std::size_t W = 0; W < BitFieldT::dataSize(); ++W) {
+      Copy.Data[W] = W == Word ? Atomic::load(Records[Slot].Data[W])
+                               : Records[Slot].Data[W];
+    }
+    return Copy;
+  }
+
+  /// Modify fields of the claimed slot, storing the storage unit of the free
+  /// field atomically so that it does not race with the other threads
+  /// searching for free slots. Only the thread owning the slot may call it.
+  ///
+  /// \param Slot Index of the slot claimed by the calling thread.
+  /// \param Fn Function called with a copy of the record, whose fields other
+  /// than the free field are written back. The slot stays claimed.
+  ///
+  /// \code
+  ///   Alloc.modify(S, [&](R &Rec) { get<Tag::Owner>(Rec) = Id; });
+  /// \endcode
+  template <class F> void modify(std::size_t Slot, F &&Fn) {
+    BitFieldT Copy = load(Slot);
+    std::forward<F>(Fn)(Copy);
+    for (std::size_t W = 0; W < BitFieldT::dataSize(); ++W) {
+      if (W != Word) {
+        Records[Slot].Data[W] = Copy.Data[W];
+      }
+    }
+    Atomic::store(Records[Slot].Data[Word],
+                  static_cast<FieldType>(Copy.Data[Word] & ~Bit));
+  }
+
+private:
+  /// Clear the field of the slot if it is set.
+  bool tryClaim(std::size_t Slot) {
+    FieldType &U = Records[Slot].Data[Word];
+    FieldType Expected = Atomic::load(U);
+    while (Expected & Bit) {
+      if (Atomic::compareExchange(U, Expected,
+                                  static_cast<FieldType>(Expected & ~Bit))) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Clear the summary bit of the slot found claimed. The bit is set again if
+  /// the slot has been released meanwhile, so that free slots never disappear
+  /// from the summary.
+  void dropFromSummary(std::size_t Slot) {
+    const std::uint64_t B = std::uint64_t{1} << (Slot % 64);
+    Summary[Slot / 64].fetch_and(~B, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (isFree(Slot)) {
+      Summary[Slot / 64].fetch_or(B, std::memory_order_seq_cst);
+    }
+  }
+
+  BitFieldT *Records;
+  std::size_t N;
+  std::size_t NWords;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> Summary;
+};
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+/// Make a slot allocator over the records.
+///
+/// \tparam Query Name of the 1-bit field which tells whether the slot is free.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+template <Util::CharArray Query, class... Args,
+          decltype(Query == std::declval<typename BitField<Args...>::TagT>(),
+                   nullptr) = nullptr>
+auto makeSlotAllocator(BitField<Args...> *Records, std::size_t N) {
+  using L = Util::Layout<BitField<Args...>>;
+  return SlotAllocator<BitField<Args...>, L::template index<Query>()>(Records,
+                                                                      N);
+}
+#endif
+
+/// Make a slot allocator over the records.
+///
+/// \tparam Query Tag of the 1-bit field which tells whether the slot is free.
+/// \param Records Pointer to the first record.
+/// \param N Number of records.
+///
+/// \code
+///   enum class Tag { Free, Owner };
+///   using R = BitField<std::uint32_t, Field<Tag::Free, 1, 1>,
+///                      Field<Tag::Owner, 31>>;
+///   std::vector<R> Slots(N);
+///   auto Alloc = makeSlotAllocator<Tag::Free>(Slots.data(), N);
+///   std::size_t S = Alloc.allocate();
+///   if (S < N) {
+///     // Owner shares the storage unit with Free
+///     Alloc.modify(S, [&](R &Rec) { get<Tag::Owner>(Rec) = Id; });
+///     Alloc.release(S);
+///   }
+/// \endcode
+template <auto Query, class... Args,
+          std::enable_if_t<std::is_enum_v<typename BitField<Args...>::TagT>,
+                           std::nullptr_t> = nullptr>
+auto makeSlotAllocator(BitField<Args...> *Records, std::size_t N) {
+  using L = Util::Layout<BitField<Args...>>;
+  return SlotAllocator<BitField<Args...>, L::template index<Query>()>(Records,
+                                                                      N);
+}
+} // namespace OrderedBitField
+
+#endif
@@ -0,0 +1,293 @@
+//===-- Stream.hpp - Streaming decoder of records ---------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a streaming decoder which takes byte chunks, e.g. read
+/// from a socket, and hands out batches of BitField records viewed in place.
+/// Producers and consumers are C++20 coroutines which await the decoder, and
+/// a bounded number of chunks in flight gives backpressure. The decoder is
+/// available when the compiler supports coroutines.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ORDERED_BIT_FIELD_STREAM_HPP
+#define ORDERED_BIT_FIELD_STREAM_HPP
+
+#include "OrderedBitField.hpp"
+#include "Segmented.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+
+namespace OrderedBitField {
+/// Batch of whole records packed in one buffer, viewed in place. The records
+/// are in a chunk given to the decoder, or in its stitching buffer if the
+/// record straddled chunks.
+///
+/// \tparam BitFieldT Type of the records.
+template <class BitFieldT> class RecordBatch {
+public:
+  /// Type of the records in the batch.
+  using Record = SegmentedRecord<const BitFieldT>;
+
+  RecordBatch() : Seg{nullptr, 0} {}
+
+  RecordBatch(const unsigned char *Bytes, std::size_t N)
+      : Seg{const_cast<unsigned char *>(Bytes), N * sizeof(BitFieldT)} {}
+
+  /// Number of records in the batch.
+  std::size_t size() const { return Seg.Len / sizeof(BitFieldT); }
+
+  /// Whether the batch is empty, i.e. the end of the stream.
+  bool empty() const { return Seg.Len == 0; }
+
+  /// First byte of the records.
+  const unsigned char *bytes() const {
+    return static_cast<const unsigned char *>(Seg.Base);
+  }
+
+  /// Pointer to the first record if the records are suitably aligned, or
+  /// nullptr.
+  const BitFieldT *records() const {
+    const auto Addr = reinterpret_cast<std::uintptr_t>(Seg.Base);
+    return Addr % alignof(BitFieldT) == 0
+               ? reinterpret_cast<const BitFieldT *>(Seg.Base)
+               : nullptr;
+  }
+
+  /// K-th record.
+  ///
+  /// \note The record refers to the batch. Watch for dangling references.
+  Record operator[](std::size_t K) const {
+    return Record(&Seg, 0, K * sizeof(BitFieldT));
+  }
+
+private:
+  Segment Seg;
+};
+
+/// Decoder of a stream of records split into chunks at arbitrary bytes.
+///
+/// A producer pushes chunks and a consumer takes batches of records. Records
+/// are viewed in the chunks without copies, and only a record which straddles
+/// chunks is stitched in a buffer of the decoder. A chunk is held until the
+/// batches in it are consumed, and at most MaxChunks chunks are held: a
+/// producer awaiting push() is suspended until the decoder has room for the
+/// next chunk, so a producer which cycles through MaxChunks buffers may refill
+/// the next one whenever push() resumes it.
+///
+/// Coroutines are resumed inline by the other side. The decoder is not
+/// thread-safe.
+///
+/// \tparam BitFieldT Type of the records.
+///
+/// \code
+///   StreamDecoder<R> Decoder(4);
+///
+///   Task produce(Socket &S, StreamDecoder<R> &D) {
+///     std::vector<unsigned char> Buf[4];
+///     for (std::size_t K = 0;; K = (K + 1) % 4) {
+///       const std::size_t Len = co_await S.read(Buf[K]);
+///       if (Len == 0) {
+///         break;
+///       }
+///       co_await D.push(Buf[K].data(), Len);
+///     }
+///     co_await D.close();
+///   }
+///
+///   Task consume(StreamDecoder<R> &D) {
+///     for (;;) {
+///       const RecordBatch<R> Batch = co_await D.next();
+///       if (Batch.empty()) {
+///         break;
+///       }
+///       for (std::size_t K = 0; K < Batch.size(); ++K) {
+///         handle(get<Tag::Kind>(Batch[K]));
+///       }
+///     }
+///   }
+/// \endcode
+template <class BitFieldT> class StreamDecoder {
+  struct Chunk {
+    const unsigned char *Bytes;
+    std::size_t Len;
+  };
+
+public:
+  /// Awaiter of push(). It resumes the producer when the decoder is not
+  /// full.
+  class PushAwaiter {
+  public:
+    explicit PushAwaiter(StreamDecoder &D) : D(D) {}
+    bool await_ready() const noexcept { return !D.full(); }
+    void await_suspend(std::coroutine_handle<> H) noexcept { D.Producer = H; }
+    void await_resume() const noexcept {}
+
+  private:
+    StreamDecoder &D;
+  };
+
+  /// Awaiter of close(). It resumes the producer when the decoder holds no
+  /// chunks.
+  class CloseAwaiter {
+  public:
+    explicit CloseAwaiter(StreamDecoder &D) : D(D) {}
+    bool await_ready() const noexcept { return D.Chunks.empty(); }
+    void await_suspend(std::coroutine_handle<> H) noexcept { D.Producer = H; }
+    void await_resume() const noexcept {}
+
+  private:
+    StreamDecoder &D;
+  };
+
+  /// Awaiter of next(). It resumes the consumer with the next batch, or an
+  /// empty batch at the end of the stream.
+  class NextAwaiter {
+  public:
+    explicit NextAwaiter(StreamDecoder &D) : D(D) {}
+    bool await_ready() { return D.poll(); }
+    void await_suspend(std::coroutine_handle<> H) noexcept { D.Consumer = H; }
+    RecordBatch<BitFieldT> await_resume() const noexcept { return D.Current; }
+
+  private:
+    StreamDecoder &D;
+  };
+
+  /// \param MaxChunks Maximum number of chunks held by the decoder (> 0).
+  /// \param MaxBatch Maximum number of records in a batch (> 0).
+  explicit StreamDecoder(std::size_t MaxChunks = 4,
+                         std::size_t MaxBatch = 1024)
+      : MaxChunks(MaxChunks), MaxBatch(MaxBatch) {}
+
+  StreamDecoder(const StreamDecoder &) = delete;
+  StreamDecoder &operator=(const StreamDecoder &) = delete;
+
+  /// Whether the decoder holds MaxChunks chunks. push() must not be called
+  /// then.
+  bool full() const { return Chunks.size() >= MaxChunks; }
+
+  /// Number of chunks held by the decoder.
+  std::size_t heldChunks() const { return Chunks.size(); }
+
+  /// Number of bytes of an incomplete record at the end of the stream, valid
+  /// after the stream is closed and consumed.
+  std::size_t pendingBytes() const { return CarryLen; }
+
+  /// Give a chunk to the decoder. The bytes must stay valid and unchanged
+  /// until the decoder releases the chunk. Chunks are released in order, and
+  /// fewer than MaxChunks chunks are held when push() resumes the producer. A
+  /// waiting consumer is resumed if a batch is ready.
+  ///
+  /// \return Awaiter which suspends the producer while the decoder is full.
+  /// Producers which are not coroutines may discard it and check full().
+  PushAwaiter push(const void *Bytes, std::size_t Len) {
+    if (Len != 0) {
+      Chunks.push_back({static_cast<const unsigned char *>(Bytes), Len});
+      if (Consumer && produce()) {
+        std::exchange(Consumer, nullptr).resume();
+      }
+    }
+    return PushAwaiter(*this);
+  }
+
+  /// End the stream. A waiting consumer is resumed with an empty batch.
+  ///
+  /// \return Awaiter which suspends the producer until the decoder releases
+  /// all the chunks. Producers which are not coroutines may discard it and
+  /// check heldChunks().
+  CloseAwaiter close() {
+    Closed = true;
+    if (Consumer) {
+      Current = RecordBatch<BitFieldT>();
+      std::exchange(Consumer, nullptr).resume();
+    }
+    return CloseAwaiter(*this);
+  }
+
+  /// Take the next batch. The previous batch is released, and must not be
+  /// used any more.
+  ///
+  /// \return Awaiter which suspends the consumer until a batch is ready or
+  /// the stream is closed.
+  NextAwaiter next() { return NextAwaiter(*this); }
+
+private:
+  /// Release the current batch, make the next one and wake the producer if
+  /// there is room. Return whether the consumer may go on.
+  bool poll() {
+    if (!Current.empty() && Current.bytes() != Carry) {
+      Pos += Current.size() * sizeof(BitFieldT);
+    }
+    Current = RecordBatch<BitFieldT>();
+    bool Ready = produce();
+    // the producer runs until it awaits again, and may push chunks
+    while (Producer && (Closed ? Chunks.empty() : !full())) {
+      std::exchange(Producer, nullptr).resume();
+      Ready = Ready || produce();
+    }
+    return Ready || Closed;
+  }
+
+  /// Make the next batch from the held chunks into Current. Chunks are
+  /// released as they are used up.
+  bool produce() {
+    constexpr std::size_t Size = sizeof(BitFieldT);
+    while (!Chunks.empty()) {
+      const Chunk &C = Chunks.front();
+      const std::size_t Rem = C.Len - Pos;
+      if (CarryLen != 0 || Rem < Size) {
+        // stitch a record which straddles chunks
+        const std::size_t Len = std::min(Size - CarryLen, Rem);
+        std::memcpy(Carry + CarryLen, C.Bytes + Pos, Len);
+        CarryLen += Len;
+        Pos += Len;
+        if (Pos == C.Len) {
+          Chunks.pop_front();
+          Pos = 0;
+        }
+        if (CarryLen == Size) {
+          CarryLen = 0;
+          Current = RecordBatch<BitFieldT>(Carry, 1);
+          return true;
+        }
+      } else {
+        // the records are taken in place, and Pos moves on their release
+        Current = RecordBatch<BitFieldT>(C.Bytes + Pos,
+                                         std::min(Rem / Size, MaxBatch));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::size_t MaxChunks;
+  std::size_t MaxBatch;
+  std::deque<Chunk> Chunks;
+  /// Offset of the first byte not taken in the front chunk.
+  std::size_t Pos = 0;
+  alignas(BitFieldT) unsigned char Carry[sizeof(BitFieldT)];
+  std::size_t CarryLen = 0;
+  RecordBatch<BitFieldT> Current;
+  bool Closed = false;
+  std::coroutine_handle<> Producer = nullptr;
+  std::coroutine_handle<> Consumer = nullptr;
+};
+} // namespace OrderedBitField
+
+#endif
+
+#endif
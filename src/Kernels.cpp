@@ -0,0 +1,953 @@
+//===-- src/Kernels.cpp - Compiled SIMD kernels -----------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the scalar, AVX2 and AVX-512 versions of the bulk
+/// kernels, each compiled for its own instruction set regardless of the
+/// compiler flags, and the table selected by the running CPU.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Checksum.hpp"
+#include "OrderedBitField/Dispatch.hpp"
+#include "OrderedBitField/Ecc.hpp"
+#include "OrderedBitField/Half.hpp"
+#include "OrderedBitField/Memory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ORDERED_BIT_FIELD_X86_KERNELS 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define ORDERED_BIT_FIELD_TARGET(ISA) __attribute__((target(ISA)))
+#else
+#define ORDERED_BIT_FIELD_TARGET(ISA)
+#endif
+#endif
+
+namespace OrderedBitField {
+namespace Util {
+namespace {
+template <class T> T loadBytes(const unsigned char *P) {
+  T V;
+  std::memcpy(&V, P, sizeof(V));
+  return V;
+}
+
+template <BitwiseKind Op, class T> T applyScalar(T A, T B) {
+  switch (Op) {
+  case BitwiseKind::And:
+    return A & B;
+  case BitwiseKind::Or:
+    return A | B;
+  case BitwiseKind::Xor:
+    return A ^ B;
+  case BitwiseKind::AndNot:
+    return A & ~B;
+  case BitwiseKind::First:
+    return A;
+  default:
+    return ~A;
+  }
+}
+
+/// Call F<Op>() for the runtime value of Op.
+template <template <BitwiseKind> class F, class... ArgsT>
+void withOp(BitwiseKind Op, ArgsT... Args) {
+  switch (Op) {
+  case BitwiseKind::And:
+    return F<BitwiseKind::And>::run(Args...);
+  case BitwiseKind::Or:
+    return F<BitwiseKind::Or>::run(Args...);
+  case BitwiseKind::Xor:
+    return F<BitwiseKind::Xor>::run(Args...);
+  case BitwiseKind::AndNot:
+    return F<BitwiseKind::AndNot>::run(Args...);
+  case BitwiseKind::First:
+    return F<BitwiseKind::First>::run(Args...);
+  case BitwiseKind::Not:
+    return F<BitwiseKind::Not>::run(Args...);
+  }
+}
+
+template <BitwiseKind Op> struct MaskedScalar {
+  static void run(const unsigned char *X, const unsigned char *Y,
+                  unsigned char *Z, std::size_t Bytes, std::size_t P,
+                  const unsigned char *Keep, const unsigned char *Set) {
+    for (std::size_t K = 0; K < Bytes; K += 8) {
+      const std::size_t J = K % P;
+      const auto V = applyScalar<Op>(loadBytes<std::uint64_t>(X + K),
+                                     loadBytes<std::uint64_t>(Y + K));
+      const std::uint64_t R = (V & loadBytes<std::uint64_t>(Keep + J)) |
+                              loadBytes<std::uint64_t>(Set + J);
+      std::memcpy(Z + K, &R, sizeof(R));
+    }
+  }
+};
+
+void maskedBytesScalar(BitwiseKind Op, const unsigned char *X,
+                       const unsigned char *Y, unsigned char *Z,
+                       std::size_t Bytes, std::size_t P,
+                       const unsigned char *Keep, const unsigned char *Set) {
+  withOp<MaskedScalar>(Op, X, Y, Z, Bytes, P, Keep, Set);
+}
+
+void fillPatternScalar(unsigned char *Dst, std::size_t Bytes,
+                       const unsigned char *Pattern, std::size_t P) {
+  std::size_t K = 0;
+  for (; K + P <= Bytes; K += P) {
+    std::memcpy(Dst + K, Pattern, P);
+  }
+  std::memcpy(Dst + K, Pattern, Bytes - K);
+}
+
+std::uint64_t unpackMask(std::size_t B) {
+  return B >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << B) - 1;
+}
+
+/// Unpack values from Begin + K on, one or two words per value.
+void unpackTail(const std::uint64_t *Stream, std::size_t B,
+                std::size_t Begin, std::size_t K, std::size_t N,
+                std::uint64_t *Out) {
+  const std::uint64_t Mask = unpackMask(B);
+  for (; K < N; ++K) {
+    const std::size_t P = (Begin + K) * B;
+    const std::size_t Off = P % 64;
+    std::uint64_t V = Stream[P / 64] >> Off;
+    if (Off + B > 64) {
+      V |= Stream[P / 64 + 1] << (64 - Off);
+    }
+    Out[K] = V & Mask;
+  }
+}
+
+void unpackBitsScalar(const std::uint64_t *Stream, std::size_t B,
+                      std::size_t Begin, std::size_t N, std::uint64_t *Out) {
+  unpackTail(Stream, B, Begin, 0, N, Out);
+}
+
+bool matchBytesScalar(const unsigned char *X, std::size_t Bytes,
+                      std::size_t P, const unsigned char *Ignore,
+                      const unsigned char *Expect) {
+  for (std::size_t K = 0; K < Bytes; K += 8) {
+    const std::size_t J = K % P;
+    if ((loadBytes<std::uint64_t>(X + K) &
+         ~loadBytes<std::uint64_t>(Ignore + J)) !=
+        loadBytes<std::uint64_t>(Expect + J)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Word of Width bytes at P, zero-extended.
+std::uint64_t loadWord(const unsigned char *P, std::size_t Width) {
+  return Width == 8 ? loadBytes<std::uint64_t>(P)
+                    : loadBytes<std::uint32_t>(P);
+}
+
+/// Gather the words from the K-th index on.
+void gatherTail(const unsigned char *Base, std::size_t Stride,
+                std::size_t Width, const std::uint64_t *Indices,
+                std::size_t K, std::size_t N, unsigned Shift,
+                std::uint64_t Mask, unsigned char *Out) {
+  for (; K < N; ++K) {
+    const std::uint64_t I = Indices ? Indices[K] : K;
+    const std::uint64_t V = loadWord(Base + I * Stride, Width) >> Shift & Mask;
+    if (Width == 8) {
+      std::memcpy(Out + K * 8, &V, 8);
+    } else {
+      const auto V32 = static_cast<std::uint32_t>(V);
+      std::memcpy(Out + K * 4, &V32, 4);
+    }
+  }
+}
+
+void gatherBitsScalar(const unsigned char *Base, std::size_t Stride,
+                      std::size_t Width, const std::uint64_t *Indices,
+                      std::size_t N, unsigned Shift, std::uint64_t Mask,
+                      unsigned char *Out) {
+  gatherTail(Base, Stride, Width, Indices, 0, N, Shift, Mask, Out);
+}
+
+/// Verify the records from the K-th on and add the mismatches to Bad.
+std::size_t verifyTail(const unsigned char *Records, std::size_t Size,
+                       std::size_t K, std::size_t N, bool *Ok,
+                       std::size_t Bad) {
+  for (; K < N; ++K) {
+    std::uint64_t S = 0;
+    for (std::size_t B = 0; B < Size; B += 2) {
+      S += loadBytes<std::uint16_t>(Records + K * Size + B);
+    }
+    const bool R = foldSum(S) == 0xffff;
+    Bad += !R;
+    if (Ok) {
+      Ok[K] = R;
+    }
+  }
+  return Bad;
+}
+
+std::size_t verifySumsScalar(const unsigned char *Records, std::size_t Size,
+                             std::size_t N, bool *Ok) {
+  return verifyTail(Records, Size, 0, N, Ok, 0);
+}
+
+/// Check the records from the K-th on and add them to Dirty.
+std::uint64_t oddParityTail(const unsigned char *Records, std::size_t Stride,
+                            std::size_t Width, std::size_t Units,
+                            std::size_t K, std::size_t N,
+                            const std::uint64_t *Equation, std::size_t E,
+                            std::uint64_t Dirty) {
+  for (; K < N; ++K) {
+    for (std::size_t J = 0; J < E; ++J) {
+      std::uint64_t Acc = 0;
+      for (std::size_t U = 0; U < Units; ++U) {
+        Acc ^= loadWord(Records + K * Stride + U * Width, Width) &
+               Equation[J * Units + U];
+      }
+      if (parity(Acc)) {
+        Dirty |= std::uint64_t{1} << K;
+        break;
+      }
+    }
+  }
+  return Dirty;
+}
+
+std::uint64_t oddParityScalar(const unsigned char *Records,
+                              std::size_t Stride, std::size_t Width,
+                              std::size_t Units, std::size_t N,
+                              const std::uint64_t *Equation, std::size_t E) {
+  return oddParityTail(Records, Stride, Width, Units, 0, N, Equation, E, 0);
+}
+
+void decodeHalfScalar(const std::uint32_t *Bits, std::size_t N, float *Out) {
+  for (std::size_t K = 0; K < N; ++K) {
+    Out[K] = Half::decode(Bits[K]);
+  }
+}
+
+void encodeHalfScalar(const float *In, std::size_t N, std::uint32_t *Bits) {
+  for (std::size_t K = 0; K < N; ++K) {
+    Bits[K] = Half::encode(In[K]);
+  }
+}
+
+void decodeBFloat16Scalar(const std::uint32_t *Bits, std::size_t N,
+                          float *Out) {
+  for (std::size_t K = 0; K < N; ++K) {
+    Out[K] = BFloat16::decode(Bits[K]);
+  }
+}
+
+void encodeBFloat16Scalar(const float *In, std::size_t N,
+                          std::uint32_t *Bits) {
+  for (std::size_t K = 0; K < N; ++K) {
+    Bits[K] = BFloat16::encode(In[K]);
+  }
+}
+
+/// Raw value of fixed-point bits plus Bias.
+std::int32_t fixedInt(std::uint32_t Bits, std::uint32_t Mask, int Ext,
+                      std::int32_t Bias) {
+  const std::uint32_t Sign = std::uint32_t{1} << (31 - Ext);
+  const std::int64_t V = static_cast<std::int64_t>((Bits & Mask) ^ Sign) -
+                         static_cast<std::int64_t>(Sign);
+  return static_cast<std::int32_t>(V + Bias);
+}
+
+template <class T>
+void decodeFixedTail(const std::uint32_t *Bits, std::size_t K, std::size_t N,
+                     std::uint32_t Mask, int Ext, std::int32_t Bias,
+                     double Scale, T *Out) {
+  for (; K < N; ++K) {
+    Out[K] = static_cast<T>(fixedInt(Bits[K], Mask, Ext, Bias)) *
+             static_cast<T>(Scale);
+  }
+}
+
+void decodeFixedScalar(const std::uint32_t *Bits, std::size_t N,
+                       std::uint32_t Mask, int Ext, std::int32_t Bias,
+                       double Scale, float *Out) {
+  decodeFixedTail(Bits, 0, N, Mask, Ext, Bias, Scale, Out);
+}
+
+void decodeFixedDoubleScalar(const std::uint32_t *Bits, std::size_t N,
+                             std::uint32_t Mask, int Ext, std::int32_t Bias,
+                             double Scale, double *Out) {
+  decodeFixedTail(Bits, 0, N, Mask, Ext, Bias, Scale, Out);
+}
+
+/// Encode the values from the K-th on, as FixedPoint::encodeAs<float>.
+void encodeFixedTail(const float *In, std::size_t K, std::size_t N,
+                     float Scale, float Bias, float Lo, float Hi,
+                     std::uint32_t Mask, std::uint32_t *Bits) {
+  for (; K < N; ++K) {
+    float S = In[K] * Scale - Bias;
+    S = S > Lo ? S : Lo;
+    S = S < Hi ? S : Hi;
+    auto I = static_cast<long long>(S);
+    const float R = S - static_cast<float>(I);
+    if (R > 0.5f || (R == 0.5f && (I & 1))) {
+      ++I;
+    } else if (R < -0.5f || (R == -0.5f && (I & 1))) {
+      --I;
+    }
+    const auto Min = static_cast<long long>(Lo);
+    const auto Max = static_cast<long long>(Hi);
+    I = I < Min ? Min : I > Max ? Max : I;
+    Bits[K] = static_cast<std::uint32_t>(I) & Mask;
+  }
+}
+
+void encodeFixedScalar(const float *In, std::size_t N, float Scale,
+                       float Bias, float Lo, float Hi, std::uint32_t Mask,
+                       std::uint32_t *Bits) {
+  encodeFixedTail(In, 0, N, Scale, Bias, Lo, Hi, Mask, Bits);
+}
+
+#if ORDERED_BIT_FIELD_X86_KERNELS
+template <BitwiseKind Op>
+ORDERED_BIT_FIELD_TARGET("avx2")
+__m256i applyAvx2(__m256i A, __m256i B) {
+  switch (Op) {
+  case BitwiseKind::And:
+    return _mm256_and_si256(A, B);
+  case BitwiseKind::Or:
+    return _mm256_or_si256(A, B);
+  case BitwiseKind::Xor:
+    return _mm256_xor_si256(A, B);
+  case BitwiseKind::AndNot:
+    return _mm256_andnot_si256(B, A);
+  case BitwiseKind::First:
+    return A;
+  default:
+    return _mm256_xor_si256(A, _mm256_set1_epi32(-1));
+  }
+}
+
+template <BitwiseKind Op> struct MaskedAvx2 {
+  ORDERED_BIT_FIELD_TARGET("avx2")
+  static void run(const unsigned char *X, const unsigned char *Y,
+                  unsigned char *Z, std::size_t Bytes, std::size_t P,
+                  const unsigned char *Keep, const unsigned char *Set) {
+    for (std::size_t K = 0; K < Bytes; K += 32) {
+      const std::size_t J = K % P;
+      const __m256i V = applyAvx2<Op>(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(X + K)),
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Y + K)));
+      const __m256i KM =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Keep + J));
+      const __m256i SM =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Set + J));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(Z + K),
+                          _mm256_or_si256(_mm256_and_si256(V, KM), SM));
+    }
+  }
+};
+
+void maskedBytesAvx2(BitwiseKind Op, const unsigned char *X,
+                     const unsigned char *Y, unsigned char *Z,
+                     std::size_t Bytes, std::size_t P,
+                     const unsigned char *Keep, const unsigned char *Set) {
+  withOp<MaskedAvx2>(Op, X, Y, Z, Bytes, P, Keep, Set);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+void fillPatternAvx2(unsigned char *Dst, std::size_t Bytes,
+                     const unsigned char *Pattern, std::size_t P) {
+  std::size_t K = 0;
+  const bool Stream = Bytes >= NonTemporalBytes;
+  for (; K + P <= Bytes; K += P) {
+    for (std::size_t J = 0; J < P; J += 32) {
+      const __m256i V =
+          _mm256_load_si256(reinterpret_cast<const __m256i *>(Pattern + J));
+      if (Stream) {
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(Dst + K + J), V);
+      } else {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(Dst + K + J), V);
+      }
+    }
+  }
+  if (Stream) {
+    _mm_sfence();
+  }
+  std::memcpy(Dst + K, Pattern, Bytes - K);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+void unpackBitsAvx2(const std::uint64_t *Stream, std::size_t B,
+                    std::size_t Begin, std::size_t N, std::uint64_t *Out) {
+  std::size_t K = 0;
+  if (B != 0 && B <= 56) {
+    // one unaligned load per value, from the byte of its first bit
+    const auto *Bytes = reinterpret_cast<const long long *>(Stream);
+    const __m256i Step = _mm256_setr_epi64x(
+        0, static_cast<long long>(B), static_cast<long long>(2 * B),
+        static_cast<long long>(3 * B));
+    const __m256i Mask =
+        _mm256_set1_epi64x(static_cast<long long>(unpackMask(B)));
+    const __m256i Seven = _mm256_set1_epi64x(7);
+    for (; K + 4 <= N; K += 4) {
+      const __m256i P = _mm256_add_epi64(
+          _mm256_set1_epi64x(static_cast<long long>((Begin + K) * B)), Step);
+      const __m256i V =
+          _mm256_i64gather_epi64(Bytes, _mm256_srli_epi64(P, 3), 1);
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i *>(Out + K),
+          _mm256_and_si256(
+              _mm256_srlv_epi64(V, _mm256_and_si256(P, Seven)), Mask));
+    }
+  }
+  unpackTail(Stream, B, Begin, K, N, Out);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+bool matchBytesAvx2(const unsigned char *X, std::size_t Bytes, std::size_t P,
+                    const unsigned char *Ignore, const unsigned char *Expect) {
+  for (std::size_t K = 0; K < Bytes; K += 32) {
+    const std::size_t J = K % P;
+    const __m256i V =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(X + K));
+    const __m256i Diff = _mm256_xor_si256(
+        _mm256_andnot_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Ignore + J)),
+            V),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Expect + J)));
+    if (!_mm256_testz_si256(Diff, Diff)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+void gatherBitsAvx2(const unsigned char *Base, std::size_t Stride,
+                    std::size_t Width, const std::uint64_t *Indices,
+                    std::size_t N, unsigned Shift, std::uint64_t Mask,
+                    unsigned char *Out) {
+  std::size_t K = 0;
+  const __m128i Count = _mm_cvtsi32_si128(static_cast<int>(Shift));
+  for (; K + 4 <= N; K += 4) {
+    // byte offsets are 64-bit so that arrays beyond 4 GiB are reachable
+    long long Off[4];
+    for (std::size_t J = 0; J < 4; ++J) {
+      Off[J] = static_cast<long long>((Indices ? Indices[K + J] : K + J) *
+                                      Stride);
+    }
+    const __m256i Index = _mm256_setr_epi64x(Off[0], Off[1], Off[2], Off[3]);
+    if (Width == 8) {
+      const __m256i V = _mm256_i64gather_epi64(
+          reinterpret_cast<const long long *>(Base), Index, 1);
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i *>(Out + K * 8),
+          _mm256_and_si256(_mm256_srl_epi64(V, Count),
+                           _mm256_set1_epi64x(static_cast<long long>(Mask))));
+    } else {
+      const __m128i V = _mm256_i64gather_epi32(
+          reinterpret_cast<const int *>(Base), Index, 1);
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i *>(Out + K * 4),
+          _mm_and_si128(_mm_srl_epi32(V, Count),
+                        _mm_set1_epi32(static_cast<int>(Mask))));
+    }
+  }
+  gatherTail(Base, Stride, Width, Indices, K, N, Shift, Mask, Out);
+}
+
+/// Sums of the 16-bit halves of 32-bit words at P, in lanes of 32 bits.
+ORDERED_BIT_FIELD_TARGET("avx2")
+__m256i halfSumsAvx2(const unsigned char *P) {
+  const __m256i V = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(P));
+  return _mm256_add_epi32(_mm256_and_si256(V, _mm256_set1_epi32(0xffff)),
+                          _mm256_srli_epi32(V, 16));
+}
+
+/// Sums of the 16-bit halves of 8 records of W 32-bit words at P, one lane
+/// per record, as Util::recordSums8.
+ORDERED_BIT_FIELD_TARGET("avx2")
+__m256i recordSumsAvx2(const unsigned char *P, std::size_t W) {
+  if (W == 1) {
+    return halfSumsAvx2(P);
+  }
+  if (W == 2) {
+    const __m256i S = _mm256_hadd_epi32(halfSumsAvx2(P), halfSumsAvx2(P + 32));
+    return _mm256_permute4x64_epi64(S, 0b11'01'10'00);
+  }
+  if (W == 4) {
+    const __m256i A =
+        _mm256_hadd_epi32(halfSumsAvx2(P), halfSumsAvx2(P + 32));
+    const __m256i B =
+        _mm256_hadd_epi32(halfSumsAvx2(P + 64), halfSumsAvx2(P + 96));
+    return _mm256_permutevar8x32_epi32(
+        _mm256_hadd_epi32(A, B), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+  }
+  if (W % 8 == 0) {
+    __m256i H[8];
+    for (std::size_t R = 0; R < 8; ++R) {
+      H[R] = _mm256_setzero_si256();
+      for (std::size_t B = 0; B < W * 4; B += 32) {
+        H[R] = _mm256_add_epi32(H[R], halfSumsAvx2(P + R * W * 4 + B));
+      }
+    }
+    const __m256i E = _mm256_hadd_epi32(_mm256_hadd_epi32(H[0], H[1]),
+                                        _mm256_hadd_epi32(H[2], H[3]));
+    const __m256i F = _mm256_hadd_epi32(_mm256_hadd_epi32(H[4], H[5]),
+                                        _mm256_hadd_epi32(H[6], H[7]));
+    return _mm256_add_epi32(_mm256_permute2x128_si256(E, F, 0x20),
+                            _mm256_permute2x128_si256(E, F, 0x31));
+  }
+  const auto Size = static_cast<int>(W * 4);
+  const __m256i Index =
+      _mm256_setr_epi32(0, Size, 2 * Size, 3 * Size, 4 * Size, 5 * Size,
+                        6 * Size, 7 * Size);
+  const __m256i Low = _mm256_set1_epi32(0xffff);
+  __m256i S = _mm256_setzero_si256();
+  for (std::size_t B = 0; B < W * 4; B += 4) {
+    const __m256i V = _mm256_i32gather_epi32(
+        reinterpret_cast<const int *>(P + B), Index, 1);
+    S = _mm256_add_epi32(S, _mm256_and_si256(V, Low));
+    S = _mm256_add_epi32(S, _mm256_srli_epi32(V, 16));
+  }
+  return S;
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+std::size_t verifySumsAvx2(const unsigned char *Records, std::size_t Size,
+                           std::size_t N, bool *Ok) {
+  std::size_t Bad = 0;
+  std::size_t K = 0;
+  // lanes of the gathers must hold the offsets of 8 records
+  if (Size % 4 == 0 && Size <= 0x0fffffff) {
+    const __m256i Low = _mm256_set1_epi32(0xffff);
+    for (; K + 8 <= N; K += 8) {
+      __m256i S = recordSumsAvx2(Records + K * Size, Size / 4);
+      S = _mm256_add_epi32(_mm256_and_si256(S, Low), _mm256_srli_epi32(S, 16));
+      S = _mm256_add_epi32(_mm256_and_si256(S, Low), _mm256_srli_epi32(S, 16));
+      const auto Match = static_cast<unsigned>(_mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpeq_epi32(S, Low))));
+      for (unsigned J = 0; J < 8; ++J) {
+        const bool R = Match >> J & 1;
+        Bad += !R;
+        if (Ok) {
+          Ok[K + J] = R;
+        }
+      }
+    }
+  }
+  return verifyTail(Records, Size, K, N, Ok, Bad);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+std::uint64_t oddParityAvx2(const unsigned char *Records, std::size_t Stride,
+                            std::size_t Width, std::size_t Units,
+                            std::size_t N, const std::uint64_t *Equation,
+                            std::size_t E) {
+  std::uint64_t Dirty = 0;
+  std::size_t K = 0;
+  if (Width == 4 && Stride <= 0x0fffffff) {
+    // eight records at once: accumulate the masked units of every equation
+    // and reduce them to parity bits by xor-folding
+    const auto S = static_cast<int>(Stride);
+    const __m256i Index =
+        _mm256_setr_epi32(0, S, 2 * S, 3 * S, 4 * S, 5 * S, 6 * S, 7 * S);
+    for (; K + 8 <= N; K += 8) {
+      const unsigned char *P = Records + K * Stride;
+      __m256i Odd = _mm256_setzero_si256();
+      for (std::size_t J = 0; J < E; ++J) {
+        __m256i Acc = _mm256_setzero_si256();
+        for (std::size_t U = 0; U < Units; ++U) {
+          const std::uint64_t M = Equation[J * Units + U];
+          if (M != 0) {
+            const __m256i V = _mm256_i32gather_epi32(
+                reinterpret_cast<const int *>(P + U * 4), Index, 1);
+            Acc = _mm256_xor_si256(
+                Acc, _mm256_and_si256(V, _mm256_set1_epi32(
+                                             static_cast<int>(M))));
+          }
+        }
+        for (int Sh = 16; Sh > 0; Sh /= 2) {
+          Acc = _mm256_xor_si256(Acc,
+                                 _mm256_srl_epi32(Acc, _mm_cvtsi32_si128(Sh)));
+        }
+        Odd = _mm256_or_si256(Odd, Acc);
+      }
+      Dirty |= std::uint64_t{static_cast<unsigned>(_mm256_movemask_ps(
+                   _mm256_castsi256_ps(_mm256_slli_epi32(Odd, 31))))}
+               << K;
+    }
+  } else if (Width == 8) {
+    // four records at once, as above with 64-bit lanes
+    const auto S = static_cast<long long>(Stride);
+    const __m256i Index = _mm256_setr_epi64x(0, S, 2 * S, 3 * S);
+    for (; K + 4 <= N; K += 4) {
+      const unsigned char *P = Records + K * Stride;
+      __m256i Odd = _mm256_setzero_si256();
+      for (std::size_t J = 0; J < E; ++J) {
+        __m256i Acc = _mm256_setzero_si256();
+        for (std::size_t U = 0; U < Units; ++U) {
+          const std::uint64_t M = Equation[J * Units + U];
+          if (M != 0) {
+            const __m256i V = _mm256_i64gather_epi64(
+                reinterpret_cast<const long long *>(P + U * 8), Index, 1);
+            Acc = _mm256_xor_si256(
+                Acc, _mm256_and_si256(V, _mm256_set1_epi64x(
+                                             static_cast<long long>(M))));
+          }
+        }
+        for (int Sh = 32; Sh > 0; Sh /= 2) {
+          Acc = _mm256_xor_si256(Acc,
+                                 _mm256_srl_epi64(Acc, _mm_cvtsi32_si128(Sh)));
+        }
+        Odd = _mm256_or_si256(Odd, Acc);
+      }
+      Dirty |= std::uint64_t{static_cast<unsigned>(_mm256_movemask_pd(
+                   _mm256_castsi256_pd(_mm256_slli_epi64(Odd, 63))))}
+               << K;
+    }
+  }
+  return oddParityTail(Records, Stride, Width, Units, K, N, Equation, E,
+                       Dirty);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2,f16c")
+void decodeHalfAvx2(const std::uint32_t *Bits, std::size_t N, float *Out) {
+  std::size_t K = 0;
+  for (; K + 8 <= N; K += 8) {
+    const __m128i H = _mm_packus_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Bits + K)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Bits + K + 4)));
+    _mm256_storeu_ps(Out + K, _mm256_cvtph_ps(H));
+  }
+  decodeHalfScalar(Bits + K, N - K, Out + K);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2,f16c")
+void encodeHalfAvx2(const float *In, std::size_t N, std::uint32_t *Bits) {
+  std::size_t K = 0;
+  for (; K + 8 <= N; K += 8) {
+    const __m128i H =
+        _mm256_cvtps_ph(_mm256_loadu_ps(In + K), _MM_FROUND_TO_NEAREST_INT);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(Bits + K),
+                        _mm256_cvtepu16_epi32(H));
+  }
+  encodeHalfScalar(In + K, N - K, Bits + K);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+void decodeBFloat16Avx2(const std::uint32_t *Bits, std::size_t N,
+                        float *Out) {
+  std::size_t K = 0;
+  for (; K + 8 <= N; K += 8) {
+    const __m256i V =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Bits + K));
+    _mm256_storeu_ps(Out + K, _mm256_castsi256_ps(_mm256_slli_epi32(V, 16)));
+  }
+  decodeBFloat16Scalar(Bits + K, N - K, Out + K);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+void encodeBFloat16Avx2(const float *In, std::size_t N, std::uint32_t *Bits) {
+  std::size_t K = 0;
+  const __m256i Bias = _mm256_set1_epi32(0x7fff);
+  const __m256i One = _mm256_set1_epi32(1);
+  const __m256i Quiet = _mm256_set1_epi32(0x40);
+  for (; K + 8 <= N; K += 8) {
+    const __m256 X = _mm256_loadu_ps(In + K);
+    const __m256i F = _mm256_castps_si256(X);
+    const __m256i Odd = _mm256_and_si256(_mm256_srli_epi32(F, 16), One);
+    const __m256i Rounded = _mm256_srli_epi32(
+        _mm256_add_epi32(_mm256_add_epi32(F, Bias), Odd), 16);
+    const __m256i NaN = _mm256_or_si256(_mm256_srli_epi32(F, 16), Quiet);
+    const __m256 IsNaN = _mm256_cmp_ps(X, X, _CMP_UNORD_Q);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(Bits + K),
+                        _mm256_castps_si256(_mm256_blendv_ps(
+                            _mm256_castsi256_ps(Rounded),
+                            _mm256_castsi256_ps(NaN), IsNaN)));
+  }
+  encodeBFloat16Scalar(In + K, N - K, Bits + K);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+void decodeFixedAvx2(const std::uint32_t *Bits, std::size_t N,
+                     std::uint32_t Mask, int Ext, std::int32_t Bias,
+                     double Scale, float *Out) {
+  std::size_t K = 0;
+  const __m256i B = _mm256_set1_epi32(Bias);
+  const __m256i M = _mm256_set1_epi32(static_cast<int>(Mask));
+  const __m128i Count = _mm_cvtsi32_si128(Ext);
+  const __m256 S = _mm256_set1_ps(static_cast<float>(Scale));
+  for (; K + 8 <= N; K += 8) {
+    __m256i V = _mm256_and_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Bits + K)), M);
+    V = _mm256_sra_epi32(_mm256_sll_epi32(V, Count), Count);
+    V = _mm256_add_epi32(V, B);
+    _mm256_storeu_ps(Out + K, _mm256_mul_ps(_mm256_cvtepi32_ps(V), S));
+  }
+  decodeFixedTail(Bits, K, N, Mask, Ext, Bias, Scale, Out);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+void decodeFixedDoubleAvx2(const std::uint32_t *Bits, std::size_t N,
+                           std::uint32_t Mask, int Ext, std::int32_t Bias,
+                           double Scale, double *Out) {
+  std::size_t K = 0;
+  const __m128i B = _mm_set1_epi32(Bias);
+  const __m128i M = _mm_set1_epi32(static_cast<int>(Mask));
+  const __m128i Count = _mm_cvtsi32_si128(Ext);
+  const __m256d S = _mm256_set1_pd(Scale);
+  for (; K + 4 <= N; K += 4) {
+    __m128i V = _mm_and_si128(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Bits + K)), M);
+    V = _mm_sra_epi32(_mm_sll_epi32(V, Count), Count);
+    V = _mm_add_epi32(V, B);
+    _mm256_storeu_pd(Out + K, _mm256_mul_pd(_mm256_cvtepi32_pd(V), S));
+  }
+  decodeFixedTail(Bits, K, N, Mask, Ext, Bias, Scale, Out);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx2")
+void encodeFixedAvx2(const float *In, std::size_t N, float Scale, float Bias,
+                     float Lo, float Hi, std::uint32_t Mask,
+                     std::uint32_t *Bits) {
+  std::size_t K = 0;
+  const __m256 S = _mm256_set1_ps(Scale);
+  const __m256 B = _mm256_set1_ps(Bias);
+  const __m256 L = _mm256_set1_ps(Lo);
+  const __m256 H = _mm256_set1_ps(Hi);
+  const __m256i M = _mm256_set1_epi32(static_cast<int>(Mask));
+  for (; K + 8 <= N; K += 8) {
+    __m256 V = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(In + K), S), B);
+    V = _mm256_min_ps(_mm256_max_ps(V, L), H);
+    // rounds to the nearest even under the default rounding mode
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(Bits + K),
+                        _mm256_and_si256(_mm256_cvtps_epi32(V), M));
+  }
+  encodeFixedTail(In, K, N, Scale, Bias, Lo, Hi, Mask, Bits);
+}
+
+// GCC 12 takes the undefined sources of AVX-512 intrinsics as uninitialized
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+template <BitwiseKind Op>
+ORDERED_BIT_FIELD_TARGET("avx512f")
+__m512i applyAvx512(__m512i A, __m512i B) {
+  switch (Op) {
+  case BitwiseKind::And:
+    return _mm512_and_si512(A, B);
+  case BitwiseKind::Or:
+    return _mm512_or_si512(A, B);
+  case BitwiseKind::Xor:
+    return _mm512_xor_si512(A, B);
+  case BitwiseKind::AndNot:
+    return _mm512_andnot_si512(B, A);
+  case BitwiseKind::First:
+    return A;
+  default:
+    return _mm512_xor_si512(A, _mm512_set1_epi32(-1));
+  }
+}
+
+template <BitwiseKind Op> struct MaskedAvx512 {
+  ORDERED_BIT_FIELD_TARGET("avx512f")
+  static void run(const unsigned char *X, const unsigned char *Y,
+                  unsigned char *Z, std::size_t Bytes, std::size_t P,
+                  const unsigned char *Keep, const unsigned char *Set) {
+    // masks repeated twice, so that 64 bytes from any offset are in them
+    unsigned char Keep2[512];
+    unsigned char Set2[512];
+    std::memcpy(Keep2, Keep, P);
+    std::memcpy(Keep2 + P, Keep, P);
+    std::memcpy(Set2, Set, P);
+    std::memcpy(Set2 + P, Set, P);
+    std::size_t K = 0;
+    for (; K + 64 <= Bytes; K += 64) {
+      const std::size_t J = K % P;
+      const __m512i V = applyAvx512<Op>(_mm512_loadu_si512(X + K),
+                                        _mm512_loadu_si512(Y + K));
+      _mm512_storeu_si512(
+          Z + K, _mm512_or_si512(
+                     _mm512_and_si512(V, _mm512_loadu_si512(Keep2 + J)),
+                     _mm512_loadu_si512(Set2 + J)));
+    }
+    MaskedAvx2<Op>::run(X + K, Y + K, Z + K, Bytes - K, P, Keep2 + K % P,
+                        Set2 + K % P);
+  }
+};
+
+void maskedBytesAvx512(BitwiseKind Op, const unsigned char *X,
+                       const unsigned char *Y, unsigned char *Z,
+                       std::size_t Bytes, std::size_t P,
+                       const unsigned char *Keep, const unsigned char *Set) {
+  withOp<MaskedAvx512>(Op, X, Y, Z, Bytes, P, Keep, Set);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx512f")
+void fillPatternAvx512(unsigned char *Dst, std::size_t Bytes,
+                       const unsigned char *Pattern, std::size_t P) {
+  std::size_t K = 0;
+  const bool Stream = Bytes >= NonTemporalBytes;
+  for (; K + P <= Bytes; K += P) {
+    for (std::size_t J = 0; J < P; J += 64) {
+      const __m512i V = _mm512_load_si512(Pattern + J);
+      if (Stream) {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(Dst + K + J), V);
+      } else {
+        _mm512_store_si512(Dst + K + J, V);
+      }
+    }
+  }
+  if (Stream) {
+    _mm_sfence();
+  }
+  std::memcpy(Dst + K, Pattern, Bytes - K);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx512f")
+void unpackBitsAvx512(const std::uint64_t *Stream, std::size_t B,
+                      std::size_t Begin, std::size_t N, std::uint64_t *Out) {
+  std::size_t K = 0;
+  if (B != 0 && B <= 56) {
+    const auto *Bytes = reinterpret_cast<const long long *>(Stream);
+    const auto SB = static_cast<long long>(B);
+    const __m512i Step =
+        _mm512_setr_epi64(0, SB, 2 * SB, 3 * SB, 4 * SB, 5 * SB, 6 * SB,
+                          7 * SB);
+    const __m512i Mask =
+        _mm512_set1_epi64(static_cast<long long>(unpackMask(B)));
+    const __m512i Seven = _mm512_set1_epi64(7);
+    for (; K + 8 <= N; K += 8) {
+      const __m512i P = _mm512_add_epi64(
+          _mm512_set1_epi64(static_cast<long long>((Begin + K) * B)), Step);
+      const __m512i V =
+          _mm512_i64gather_epi64(_mm512_srli_epi64(P, 3), Bytes, 1);
+      _mm512_storeu_si512(
+          Out + K,
+          _mm512_and_si512(
+              _mm512_srlv_epi64(V, _mm512_and_si512(P, Seven)), Mask));
+    }
+  }
+  unpackTail(Stream, B, Begin, K, N, Out);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx512f")
+void gatherBitsAvx512(const unsigned char *Base, std::size_t Stride,
+                      std::size_t Width, const std::uint64_t *Indices,
+                      std::size_t N, unsigned Shift, std::uint64_t Mask,
+                      unsigned char *Out) {
+  std::size_t K = 0;
+  for (; K + 8 <= N; K += 8) {
+    alignas(64) long long Off[8];
+    for (std::size_t J = 0; J < 8; ++J) {
+      Off[J] = static_cast<long long>((Indices ? Indices[K + J] : K + J) *
+                                      Stride);
+    }
+    const __m512i Index = _mm512_load_si512(Off);
+    // masked forms keep GCC from warning about undefined pass-through
+    if (Width == 8) {
+      __m512i V = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(),
+                                              __mmask8{0xff}, Index, Base, 1);
+      V = _mm512_and_si512(
+          _mm512_srl_epi64(V, _mm_cvtsi32_si128(static_cast<int>(Shift))),
+          _mm512_set1_epi64(static_cast<long long>(Mask)));
+      _mm512_storeu_si512(Out + K * 8, V);
+    } else {
+      __m256i V = _mm512_mask_i64gather_epi32(_mm256_setzero_si256(),
+                                              __mmask8{0xff}, Index, Base, 1);
+      V = _mm256_and_si256(
+          _mm256_srl_epi32(V, _mm_cvtsi32_si128(static_cast<int>(Shift))),
+          _mm256_set1_epi32(static_cast<int>(Mask)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(Out + K * 4), V);
+    }
+  }
+  gatherTail(Base, Stride, Width, Indices, K, N, Shift, Mask, Out);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx512f")
+void decodeHalfAvx512(const std::uint32_t *Bits, std::size_t N, float *Out) {
+  std::size_t K = 0;
+  for (; K + 16 <= N; K += 16) {
+    const __m256i H = _mm512_cvtepi32_epi16(_mm512_loadu_si512(Bits + K));
+    _mm512_storeu_ps(Out + K, _mm512_cvtph_ps(H));
+  }
+  decodeHalfAvx2(Bits + K, N - K, Out + K);
+}
+
+ORDERED_BIT_FIELD_TARGET("avx512f")
+void encodeHalfAvx512(const float *In, std::size_t N, std::uint32_t *Bits) {
+  std::size_t K = 0;
+  for (; K + 16 <= N; K += 16) {
+    const __m256i H =
+        _mm512_cvtps_ph(_mm512_loadu_ps(In + K), _MM_FROUND_TO_NEAREST_INT);
+    _mm512_storeu_si512(Bits + K, _mm512_cvtepu16_epi32(H));
+  }
+  encodeHalfAvx2(In + K, N - K, Bits + K);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+const KernelTable ScalarKernels = {
+    SimdLevel::Scalar,      &maskedBytesScalar,    &fillPatternScalar,
+    &unpackBitsScalar,      &matchBytesScalar,     &gatherBitsScalar,
+    &verifySumsScalar,      &oddParityScalar,      &decodeHalfScalar,
+    &encodeHalfScalar,      &decodeBFloat16Scalar, &encodeBFloat16Scalar,
+    &decodeFixedScalar,     &decodeFixedDoubleScalar,
+    &encodeFixedScalar};
+#if ORDERED_BIT_FIELD_X86_KERNELS
+const KernelTable Avx2Kernels = {
+    SimdLevel::Avx2,    &maskedBytesAvx2,    &fillPatternAvx2,
+    &unpackBitsAvx2,    &matchBytesAvx2,     &gatherBitsAvx2,
+    &verifySumsAvx2,    &oddParityAvx2,      &decodeHalfAvx2,
+    &encodeHalfAvx2,    &decodeBFloat16Avx2, &encodeBFloat16Avx2,
+    &decodeFixedAvx2,   &decodeFixedDoubleAvx2,
+    &encodeFixedAvx2};
+// the kernels without AVX-512 versions are bound by their gathers or by
+// memory, so the AVX2 ones serve
+const KernelTable Avx512Kernels = {
+    SimdLevel::Avx512,  &maskedBytesAvx512,  &fillPatternAvx512,
+    &unpackBitsAvx512,  &matchBytesAvx2,     &gatherBitsAvx512,
+    &verifySumsAvx2,    &oddParityAvx2,      &decodeHalfAvx512,
+    &encodeHalfAvx512,  &decodeBFloat16Avx2, &encodeBFloat16Avx2,
+    &decodeFixedAvx2,   &decodeFixedDoubleAvx2,
+    &encodeFixedAvx2};
+#endif
+} // namespace
+
+const KernelTable &kernelsFor(SimdLevel Level) {
+#if ORDERED_BIT_FIELD_X86_KERNELS
+  switch (Level) {
+  case SimdLevel::Avx512:
+    return Avx512Kernels;
+  case SimdLevel::Avx2:
+    return Avx2Kernels;
+  default:
+    break;
+  }
+#else
+  static_cast<void>(Level);
+#endif
+  return ScalarKernels;
+}
+
+const KernelTable &kernels() {
+  static const KernelTable &Table = kernelsFor(simdLevel());
+  return Table;
+}
+} // namespace Util
+} // namespace OrderedBitField
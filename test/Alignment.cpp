@@ -12,6 +12,7 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "OrderedBitField/Bitwise.hpp"
 #include "OrderedBitField/OrderedBitField.hpp"
 
 #include <cstddef>
@@ -72,6 +73,30 @@ TEMPLATE_TEST_CASE("Alignment test (RefByEnum)", "[Alignment][RefByEnum]",
     REQUIRE(BF.Data[0] == TestType{0b0000'0'010});
     REQUIRE(BF.Data[1] == TestType{0b0000000'1});
   }
+
+  SECTION("alignment rounds up within the unit") {
+    BitField<TestType, RefByEnum::Field<Tag::A, 3>, RefByEnum::Align<Tag, 4>,
+             RefByEnum::Field<Tag::B, 1>, RefByEnum::Align<Tag, 1>,
+             RefByEnum::Field<Tag::C, 1>>
+        BF;
+    REQUIRE(BF.dataSize() == 1);
+    get<Tag::A>(BF) = TestType{2};
+    get<Tag::B>(BF) = TestType{0};
+    get<Tag::C>(BF) = TestType{1};
+    REQUIRE(BF.Data[0] == TestType{0b00'1'0'0'010});
+  }
+
+  SECTION("alignment skips to the next unit") {
+    BitField<TestType, RefByEnum::Field<Tag::A, 3>, RefByEnum::Field<Tag::B, 3>,
+             RefByEnum::Align<Tag, 4>, RefByEnum::Field<Tag::C, 1>>
+        BF;
+    REQUIRE(BF.dataSize() == 2);
+    get<Tag::A>(BF) = TestType{2};
+    get<Tag::B>(BF) = TestType{5};
+    get<Tag::C>(BF) = TestType{1};
+    REQUIRE(BF.Data[0] == TestType{0b00'101'010});
+    REQUIRE(BF.Data[1] == TestType{0b0000000'1});
+  }
 }
 
 TEST_CASE("Aligmnet test for multi-byte BaseT", "[Alignment][RefByEnum]") {
@@ -85,6 +110,44 @@ TEST_CASE("Aligmnet test for multi-byte BaseT", "[Alignment][RefByEnum]") {
   REQUIRE(BF.Data[0] == 0b0000000'01010'0'010);
 }
 
+TEST_CASE("Alignment descriptor test for multi-byte BaseT (RefByEnum)",
+          "[Alignment][RefByEnum]") {
+  BitField<std::uint16_t, RefByEnum::Field<Tag::A, 3>,
+           RefByEnum::Field<Tag::B, 1>, RefByEnum::Align<Tag, 8>,
+           RefByEnum::Field<Tag::C, 5>>
+      BF;
+  REQUIRE(BF.dataSize() == 1);
+  get<Tag::A>(BF) = 2;
+  get<Tag::B>(BF) = 0;
+  get<Tag::C>(BF) = 10;
+  REQUIRE(BF.Data[0] == 0b000'01010'0000'0'010);
+}
+
+TEST_CASE("Trailing alignment descriptor test (RefByEnum)",
+          "[Alignment][RefByEnum]") {
+  // rounds up to the end of the unit
+  using R = BitField<std::uint8_t, RefByEnum::Field<Tag::A, 7, 5>,
+                     RefByEnum::Align<Tag, 4>>;
+  static_assert(R::dataSize() == 1);
+  R BF;
+  REQUIRE(get<Tag::A>(BF) == 5);
+  constexpr R Constant{};
+  static_assert(get<Tag::A>(Constant) == 5);
+  get<Tag::A>(BF) = 0b1100110;
+  REQUIRE((BF & Constant).Data[0] == 0b0000100);
+
+  // already on the end of the unit
+  using S = BitField<std::uint8_t, RefByEnum::Field<Tag::A, 8, 3>,
+                     RefByEnum::Align<Tag, 4>>;
+  static_assert(S::dataSize() == 1);
+  S BS;
+  REQUIRE(get<Tag::A>(BS) == 3);
+  constexpr S ConstantS{};
+  static_assert(get<Tag::A>(ConstantS) == 3);
+  get<Tag::A>(BS) = 0xfe;
+  REQUIRE((BS & ConstantS).Data[0] == 0x02);
+}
+
 #if ORDERED_BIT_FIELD_REF_BY_STR
 TEMPLATE_TEST_CASE("Alignment test (RefByStr)", "[Alignment][RefByStr]",
                    std::byte, std::uint8_t) {
@@ -134,6 +197,30 @@ TEMPLATE_TEST_CASE("Alignment test (RefByStr)", "[Alignment][RefByStr]",
     REQUIRE(BF.Data[0] == TestType{0b0000'0'010});
     REQUIRE(BF.Data[1] == TestType{0b0000000'1});
   }
+
+  SECTION("alignment rounds up within the unit") {
+    BitField<TestType, RefByStr::Field<"A", 3>, RefByStr::Align<4>,
+             RefByStr::Field<"B", 1>, RefByStr::Align<1>,
+             RefByStr::Field<"C", 1>>
+        BF;
+    REQUIRE(BF.dataSize() == 1);
+    get<"A">(BF) = TestType{2};
+    get<"B">(BF) = TestType{0};
+    get<"C">(BF) = TestType{1};
+    REQUIRE(BF.Data[0] == TestType{0b00'1'0'0'010});
+  }
+
+  SECTION("alignment skips to the next unit") {
+    BitField<TestType, RefByStr::Field<"A", 3>, RefByStr::Field<"B", 3>,
+             RefByStr::Align<4>, RefByStr::Field<"C", 1>>
+        BF;
+    REQUIRE(BF.dataSize() == 2);
+    get<"A">(BF) = TestType{2};
+    get<"B">(BF) = TestType{5};
+    get<"C">(BF) = TestType{1};
+    REQUIRE(BF.Data[0] == TestType{0b00'101'010});
+    REQUIRE(BF.Data[1] == TestType{0b0000000'1});
+  }
 }
 
 TEST_CASE("Aligmnet test for multi-byte BaseT", "[Alignment][RefByStr]") {
@@ -146,4 +233,41 @@ TEST_CASE("Aligmnet test for multi-byte BaseT", "[Alignment][RefByStr]") {
   get<"C">(BF) = 10;
   REQUIRE(BF.Data[0] == 0b0000000'01010'0'010);
 }
+
+TEST_CASE("Alignment descriptor test for multi-byte BaseT (RefByStr)",
+          "[Alignment][RefByStr]") {
+  BitField<std::uint16_t, RefByStr::Field<"A", 3>, RefByStr::Field<"B", 1>,
+           RefByStr::Align<8>, RefByStr::Field<"C", 5>>
+      BF;
+  REQUIRE(BF.dataSize() == 1);
+  get<"A">(BF) = 2;
+  get<"B">(BF) = 0;
+  get<"C">(BF) = 10;
+  REQUIRE(BF.Data[0] == 0b000'01010'0000'0'010);
+}
+
+TEST_CASE("Trailing alignment descriptor test (RefByStr)",
+          "[Alignment][RefByStr]") {
+  // rounds up to the end of the unit
+  using R =
+      BitField<std::uint8_t, RefByStr::Field<"A", 7, 5>, RefByStr::Align<4>>;
+  static_assert(R::dataSize() == 1);
+  R BF;
+  REQUIRE(get<"A">(BF) == 5);
+  constexpr R Constant{};
+  static_assert(get<"A">(Constant) == 5);
+  get<"A">(BF) = 0b1100110;
+  REQUIRE((BF & Constant).Data[0] == 0b0000100);
+
+  // already on the end of the unit
+  using S =
+      BitField<std::uint8_t, RefByStr::Field<"A", 8, 3>, RefByStr::Align<4>>;
+  static_assert(S::dataSize() == 1);
+  S BS;
+  REQUIRE(get<"A">(BS) == 3);
+  constexpr S ConstantS{};
+  static_assert(get<"A">(ConstantS) == 3);
+  get<"A">(BS) = 0xfe;
+  REQUIRE((BS & ConstantS).Data[0] == 0x02);
+}
 #endif
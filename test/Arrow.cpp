@@ -0,0 +1,166 @@
+//===-- test/Arrow.cpp - Test for export to Apache Arrow --------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of export of records through the Arrow C Data
+/// Interface.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Arrow.hpp"
+#include "OrderedBitField/Fixed.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, D, E };
+enum class Color : std::uint8_t { Red, Green, Blue };
+
+template <> struct OrderedBitField::ArrowEnumNames<Color> {
+  static constexpr const char *Names[] = {"red", "green", "blue"};
+};
+
+template <class T> static const T *buffer(const ArrowArray &A, std::size_t K) {
+  REQUIRE(reinterpret_cast<std::uintptr_t>(A.buffers[K]) % 64 == 0);
+  return static_cast<const T *>(A.buffers[K]);
+}
+
+static bool bit(const ArrowArray &A, std::size_t K, std::size_t I) {
+  return (buffer<unsigned char>(A, K)[I / 8] >> I % 8) & 1;
+}
+
+TEST_CASE("Arrow export test", "[Arrow][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 12>,
+                     RefByEnum::Field<Tag::B, 1>, RefByEnum::Padding<Tag, 3>,
+                     RefByEnum::FixedField<Tag::C, 8, 2>,
+                     RefByEnum::Field<Tag::D, 8>>;
+  constexpr std::size_t N = 1000;
+  std::vector<R> Records(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::A>(Records[I]) = static_cast<std::uint32_t>(I * 3);
+    get<Tag::B>(Records[I]) = I % 3 == 0;
+    get<Tag::C>(Records[I]) = static_cast<double>(I % 64) / 4;
+    get<Tag::D>(Records[I]) = static_cast<std::uint32_t>(I % 200);
+  }
+  const char *Names[] = {"a", "b", "c", "d"};
+  ArrowArray Array;
+  ArrowSchema Schema;
+  exportArrow(Records.data(), N, &Array, &Schema, Names);
+
+  REQUIRE(std::string(Schema.format) == "+s");
+  REQUIRE(Schema.n_children == 4);
+  REQUIRE(Array.length == static_cast<std::int64_t>(N));
+  REQUIRE(Array.n_children == 4);
+  REQUIRE(Array.n_buffers == 1);
+  REQUIRE(Array.buffers[0] == nullptr);
+  const char *Formats[] = {"S", "b", "g", "C"};
+  for (std::size_t K = 0; K < 4; ++K) {
+    REQUIRE(std::string(Schema.children[K]->name) == Names[K]);
+    REQUIRE(std::string(Schema.children[K]->format) == Formats[K]);
+    REQUIRE(Array.children[K]->length == static_cast<std::int64_t>(N));
+    REQUIRE(Array.children[K]->null_count == 0);
+    REQUIRE(Array.children[K]->n_buffers == 2);
+    REQUIRE(Array.children[K]->buffers[0] == nullptr);
+  }
+  const ArrowArray &A = *Array.children[0];
+  const ArrowArray &B = *Array.children[1];
+  const ArrowArray &C = *Array.children[2];
+  const ArrowArray &D = *Array.children[3];
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(buffer<std::uint16_t>(A, 1)[I] == I * 3 % 4096);
+    REQUIRE(bit(B, 1, I) == (I % 3 == 0));
+    REQUIRE(buffer<double>(C, 1)[I] == static_cast<double>(I % 64) / 4);
+    REQUIRE(buffer<std::uint8_t>(D, 1)[I] == I % 200);
+  }
+
+  // a child moved away outlives its parent
+  ArrowArray Moved = *Array.children[3];
+  Array.children[3]->release = nullptr;
+  Array.release(&Array);
+  REQUIRE(Array.release == nullptr);
+  REQUIRE(buffer<std::uint8_t>(Moved, 1)[199] == 199);
+  Moved.release(&Moved);
+  Schema.release(&Schema);
+  REQUIRE(Schema.release == nullptr);
+}
+
+TEST_CASE("Arrow export test for signed and enum types", "[Arrow][RefByEnum]") {
+  using S = BitField<std::int32_t, RefByEnum::Field<Tag::A, 7>,
+                     RefByEnum::Field<Tag::B, 20>>;
+  S Rec;
+  get<Tag::A>(Rec) = -5;
+  get<Tag::B>(Rec) = -300000;
+  ArrowArray Array;
+  ArrowSchema Schema;
+  exportArrow(&Rec, 1, &Array, &Schema);
+  REQUIRE(std::string(Schema.children[0]->name) == "0");
+  REQUIRE(std::string(Schema.children[0]->format) == "c");
+  REQUIRE(std::string(Schema.children[1]->format) == "i");
+  REQUIRE(buffer<std::int8_t>(*Array.children[0], 1)[0] == -5);
+  REQUIRE(buffer<std::int32_t>(*Array.children[1], 1)[0] == -300000);
+  Array.release(&Array);
+  Schema.release(&Schema);
+
+  using E = BitField<Color, RefByEnum::Field<Tag::A, 2>,
+                     RefByEnum::Field<Tag::B, 4>>;
+  std::vector<E> Records(10);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    get<Tag::A>(Records[I]) = static_cast<Color>(I % 4);
+    get<Tag::B>(Records[I]) = static_cast<Color>(I);
+  }
+  exportArrow(Records.data(), Records.size(), &Array, &Schema);
+  const ArrowSchema &AS = *Schema.children[0];
+  const ArrowArray &A = *Array.children[0];
+  REQUIRE(std::string(AS.format) == "c");
+  REQUIRE(AS.flags == ARROW_FLAG_NULLABLE);
+  REQUIRE(std::string(AS.dictionary->format) == "u");
+  REQUIRE(A.dictionary->length == 3);
+  const auto *Offsets = buffer<std::int32_t>(*A.dictionary, 1);
+  const auto *Chars = buffer<char>(*A.dictionary, 2);
+  REQUIRE(std::string(Chars + Offsets[2], Chars + Offsets[3]) == "blue");
+  // values without names are nulls
+  REQUIRE(A.null_count == 2);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    REQUIRE(bit(A, 0, I) == (I % 4 != 3));
+    if (I % 4 != 3) {
+      REQUIRE(buffer<std::int8_t>(A, 1)[I] == static_cast<int>(I % 4));
+    }
+  }
+  REQUIRE(std::string(Schema.children[1]->format) == "c");
+  REQUIRE(Array.children[1]->null_count == 7);
+  Array.release(&Array);
+  Schema.release(&Schema);
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Arrow export test (RefByStr)", "[Arrow][RefByStr]") {
+  using R = BitField<std::uint64_t, RefByStr::Field<"id", 40>,
+                     RefByStr::Padding<7>, RefByStr::Field<"ok", 1, 1>>;
+  std::vector<R> Records(3);
+  get<"id">(Records[2]) = 1ull << 39;
+  ArrowArray Array;
+  ArrowSchema Schema;
+  exportArrow(Records.data(), Records.size(), &Array, &Schema);
+  REQUIRE(Schema.n_children == 2);
+  REQUIRE(std::string(Schema.children[0]->name) == "id");
+  REQUIRE(std::string(Schema.children[0]->format) == "L");
+  REQUIRE(std::string(Schema.children[1]->name) == "ok");
+  REQUIRE(std::string(Schema.children[1]->format) == "b");
+  REQUIRE(buffer<std::uint64_t>(*Array.children[0], 1)[2] == 1ull << 39);
+  REQUIRE(buffer<unsigned char>(*Array.children[1], 1)[0] == 7);
+  Array.release(&Array);
+  Schema.release(&Schema);
+}
+#endif
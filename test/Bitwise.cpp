@@ -0,0 +1,234 @@
+//===-- test/Bitwise.cpp - Test for bitwise operations on records -*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of bitwise operations on whole records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Bitwise.hpp"
+#include "OrderedBitField/Checksum.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, D, Sum };
+
+// fill the storage with garbage, including bits out of the fields
+template <class T> static void scramble(T &BF, std::uint64_t &Seed) {
+  for (auto &U : BF.Data) {
+    Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+    U = static_cast<std::remove_reference_t<decltype(U)>>(Seed >> 17);
+  }
+}
+
+TEMPLATE_TEST_CASE("Bitwise record operator test", "[Bitwise][RefByEnum]",
+                   std::uint8_t, std::uint16_t, std::uint32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5, 3>,
+                     RefByEnum::ConstField<Tag::C, 3, 5>,
+                     RefByEnum::Padding<Tag, 2>,
+                     RefByEnum::Field<Tag::B, 7, 0x41>,
+                     RefByEnum::Field<Tag::D, 8, 0xc3>>;
+  auto fields = [](TestType A, TestType B, TestType D) {
+    R E;
+    get<Tag::A>(E) = A;
+    get<Tag::B>(E) = B;
+    get<Tag::D>(E) = D;
+    return E;
+  };
+
+  std::uint64_t Seed = 7;
+  for (int K = 0; K < 200; ++K) {
+    R X;
+    R Y;
+    scramble(X, Seed);
+    scramble(Y, Seed);
+    const TestType XA = get<Tag::A>(X), XB = get<Tag::B>(X),
+                   XD = get<Tag::D>(X);
+    const TestType YA = get<Tag::A>(Y), YB = get<Tag::B>(Y),
+                   YD = get<Tag::D>(Y);
+    REQUIRE((X & Y).Data == fields(XA & YA, XB & YB, XD & YD).Data);
+    REQUIRE((X | Y).Data == fields(XA | YA, XB | YB, XD | YD).Data);
+    REQUIRE((X ^ Y).Data == fields(XA ^ YA, XB ^ YB, XD ^ YD).Data);
+    REQUIRE((~X).Data == fields(static_cast<TestType>(~XA),
+                                static_cast<TestType>(~XB),
+                                static_cast<TestType>(~XD))
+                             .Data);
+    REQUIRE(andNot(X, Y).Data ==
+            fields(XA & ~YA, XB & ~YB, static_cast<TestType>(XD & ~YD)).Data);
+    const R NotX = ~X;
+    REQUIRE(get<Tag::C>(NotX) == 5);
+
+    R Z = X;
+    Z |= Y;
+    REQUIRE(Z.Data == (X | Y).Data);
+    Z &= X;
+    REQUIRE(Z.Data == (X & (X | Y)).Data);
+    Z ^= Y;
+    REQUIRE(Z.Data == ((X & (X | Y)) ^ Y).Data);
+  }
+}
+
+TEMPLATE_TEST_CASE("Bitwise array operation test", "[Bitwise][RefByEnum]",
+                   std::uint8_t, std::uint16_t, std::uint32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5>,
+                     RefByEnum::ConstField<Tag::C, 3, 6>,
+                     RefByEnum::Field<Tag::B, 7>, RefByEnum::Padding<Tag, 3>,
+                     RefByEnum::Field<Tag::D, 8>>;
+  constexpr std::size_t N = 203;
+  std::vector<R> X(N);
+  std::vector<R> Y(N);
+  std::uint64_t Seed = 11;
+  for (std::size_t I = 0; I < N; ++I) {
+    scramble(X[I], Seed);
+    scramble(Y[I], Seed);
+  }
+
+  for (std::size_t Offset : {0, 1, 5}) {
+    const std::size_t M = N - Offset;
+    std::vector<R> Out(N);
+    bitwiseAnd(X.data() + Offset, Y.data(), Out.data(), M);
+    for (std::size_t I = 0; I < M; ++I) {
+      REQUIRE(Out[I].Data == (X[I + Offset] & Y[I]).Data);
+    }
+    bitwiseOr(X.data() + Offset, Y.data(), Out.data(), M);
+    for (std::size_t I = 0; I < M; ++I) {
+      REQUIRE(Out[I].Data == (X[I + Offset] | Y[I]).Data);
+    }
+    bitwiseXor(X.data() + Offset, Y.data(), Out.data(), M);
+    for (std::size_t I = 0; I < M; ++I) {
+      REQUIRE(Out[I].Data == (X[I + Offset] ^ Y[I]).Data);
+    }
+    bitwiseNot(X.data() + Offset, Out.data(), M);
+    for (std::size_t I = 0; I < M; ++I) {
+      REQUIRE(Out[I].Data == (~X[I + Offset]).Data);
+    }
+    andNot(X.data() + Offset, Y.data(), Out.data(), M);
+    for (std::size_t I = 0; I < M; ++I) {
+      REQUIRE(Out[I].Data == andNot(X[I + Offset], Y[I]).Data);
+    }
+  }
+
+  // in place
+  std::vector<R> Z = X;
+  bitwiseOr(Z.data(), Y.data(), Z.data(), N);
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(Z[I].Data == (X[I] | Y[I]).Data);
+  }
+}
+
+TEST_CASE("Bitwise operation test for guarded records", "[Bitwise][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 16>,
+                     RefByEnum::ChecksumField<Tag::Sum>,
+                     RefByEnum::Field<Tag::B, 20>>;
+  std::vector<R> X(37);
+  std::vector<R> Y(37);
+  for (std::size_t I = 0; I < X.size(); ++I) {
+    get<Tag::A>(X[I]) = static_cast<std::uint32_t>(I * 77);
+    get<Tag::B>(X[I]) = static_cast<std::uint32_t>(I * 12345);
+    get<Tag::A>(Y[I]) = static_cast<std::uint32_t>(I * 31);
+    get<Tag::B>(Y[I]) = static_cast<std::uint32_t>(I * 999);
+  }
+  std::vector<R> Out(X.size());
+  bitwiseXor(X.data(), Y.data(), Out.data(), X.size());
+  for (std::size_t I = 0; I < X.size(); ++I) {
+    REQUIRE(verifyChecksum(Out[I]));
+    REQUIRE(get<Tag::A>(Out[I]) == ((I * 77) ^ (I * 31)) % 65536);
+    REQUIRE(verifyChecksum(~X[I]));
+  }
+}
+
+TEMPLATE_TEST_CASE("Canonicalization test", "[Bitwise][RefByEnum]",
+                   std::uint8_t, std::uint16_t, std::uint32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5, 3>,
+                     RefByEnum::ConstField<Tag::C, 3, 5>,
+                     RefByEnum::Padding<Tag, 2>,
+                     RefByEnum::Field<Tag::B, 7, 0x41>,
+                     RefByEnum::Field<Tag::D, 8, 0xc3>>;
+  REQUIRE(isCanonical(R{}));
+
+  constexpr std::size_t N = 301;
+  std::vector<R> X(N);
+  std::uint64_t Seed = 5;
+  for (std::size_t I = 0; I < N; ++I) {
+    scramble(X[I], Seed);
+  }
+  REQUIRE(!isCanonical(X.data(), N));
+
+  std::vector<R> Y = X;
+  canonicalize(Y.data(), N);
+  REQUIRE(isCanonical(Y.data(), N));
+  for (std::size_t I = 0; I < N; ++I) {
+    R E;
+    get<Tag::A>(E) = static_cast<TestType>(get<Tag::A>(X[I]));
+    get<Tag::B>(E) = static_cast<TestType>(get<Tag::B>(X[I]));
+    get<Tag::D>(E) = static_cast<TestType>(get<Tag::D>(X[I]));
+    REQUIRE(Y[I].Data == E.Data);
+    REQUIRE(isCanonical(Y[I]));
+
+    R Z = X[I];
+    canonicalize(Z);
+    REQUIRE(Z.Data == E.Data);
+  }
+
+  // a single stray bit is found anywhere
+  for (std::size_t I : {std::size_t{0}, N / 2, N - 1}) {
+    std::vector<R> W = Y;
+    W[I].Data.back() =
+        static_cast<TestType>(W[I].Data.back() | (TestType{1} << 7));
+    REQUIRE(isCanonical(W.data(), N) == isCanonical(W[I]));
+  }
+  std::vector<R> W = Y;
+  W[N - 1].Data[0] = static_cast<TestType>(W[N - 1].Data[0] ^ (1 << 5));
+  REQUIRE(!isCanonical(W.data(), N));
+  REQUIRE(isCanonical(W.data(), N - 1));
+}
+
+TEST_CASE("Canonicalization test for guarded records", "[Bitwise][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 16>,
+                     RefByEnum::ChecksumField<Tag::Sum>,
+                     RefByEnum::Field<Tag::B, 20>>;
+  R X;
+  get<Tag::A>(X) = 1234;
+  get<Tag::B>(X) = 5678;
+  R Y = X;
+  Y.Data[1] |= 0xfff00000u;
+  REQUIRE(!isCanonical(Y));
+  canonicalize(Y);
+  REQUIRE(isCanonical(Y));
+  REQUIRE(Y.Data == X.Data);
+  REQUIRE(verifyChecksum(Y));
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Bitwise record operator test (RefByStr)", "[Bitwise][RefByStr]") {
+  using R = BitField<std::uint16_t, RefByStr::Field<"r", 1>,
+                     RefByStr::Field<"w", 1>, RefByStr::Padding<2>,
+                     RefByStr::Field<"x", 1>>;
+  R A;
+  R B;
+  get<"r">(A) = 1;
+  get<"w">(A) = 1;
+  get<"w">(B) = 1;
+  get<"x">(B) = 1;
+  A.Data[0] |= 0xffec;
+  REQUIRE((A & B).Data[0] == 0x2);
+  REQUIRE((A | B).Data[0] == 0x13);
+  REQUIRE(andNot(A, B).Data[0] == 0x1);
+  REQUIRE((~A).Data[0] == 0x10);
+}
+#endif
@@ -0,0 +1,156 @@
+//===-- test/Checksum.cpp - Test for checksum fields ------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of incremental ones' complement checksum
+/// fields.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Checksum.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, Sum };
+
+// checksum over the 16-bit words in memory, as RFC 1071
+template <class T> static std::uint16_t memoryChecksum(const T &BF) {
+  std::uint16_t W[sizeof(T) / 2];
+  std::memcpy(W, &BF, sizeof(T));
+  std::uint32_t S = 0;
+  for (auto V : W) {
+    S += V;
+  }
+  while (S >> 16) {
+    S = (S & 0xffff) + (S >> 16);
+  }
+  return static_cast<std::uint16_t>(S);
+}
+
+TEMPLATE_TEST_CASE("Checksum field test", "[Checksum][RefByEnum]",
+                   std::uint16_t, std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 4, 3>,
+                     RefByEnum::Field<Tag::B, 12, 100>,
+                     RefByEnum::ChecksumField<Tag::Sum>,
+                     RefByEnum::Field<Tag::C, 13, 7>>;
+  R BF;
+  REQUIRE(verifyChecksum(BF));
+  REQUIRE(memoryChecksum(BF) == 0xffff);
+
+  std::uint64_t Seed = 1;
+  for (int I = 0; I < 1000; ++I) {
+    Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+    switch (Seed >> 62) {
+    case 0:
+      get<Tag::A>(BF) = static_cast<TestType>(Seed >> 20);
+      break;
+    case 1:
+      get<Tag::B>(BF) += static_cast<TestType>(Seed >> 40);
+      break;
+    case 2:
+      get<Tag::C>(BF) ^= static_cast<TestType>(Seed >> 30);
+      break;
+    default:
+      ++get<Tag::C>(BF);
+      break;
+    }
+    REQUIRE(verifyChecksum(BF));
+    REQUIRE(memoryChecksum(BF) == 0xffff);
+  }
+
+  R Copy = BF;
+  updateChecksum(Copy);
+  REQUIRE(verifyChecksum(Copy));
+  get<Tag::A>(Copy) = 1;
+  Copy.Data[0] = static_cast<TestType>(Copy.Data[0] ^ 0x10);
+  REQUIRE(!verifyChecksum(Copy));
+}
+
+TEST_CASE("Bulk checksum verification", "[Checksum][RefByEnum]") {
+  using R = BitField<std::uint16_t, RefByEnum::Field<Tag::A, 16>,
+                     RefByEnum::ChecksumField<Tag::Sum>,
+                     RefByEnum::Field<Tag::B, 16>, RefByEnum::Field<Tag::C, 8>>;
+  std::vector<R> Records(103);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    get<Tag::A>(Records[I]) = static_cast<std::uint16_t>(I * 1234);
+    get<Tag::B>(Records[I]) = static_cast<std::uint16_t>(I * 77);
+  }
+  REQUIRE(verifyChecksums(Records.data(), Records.size()) == 0);
+
+  Records[5].Data[2] ^= 1;
+  Records[64].Data[0] ^= 0x100;
+  Records[102].Data[3] ^= 0x8;
+  bool OkBuf[103];
+  REQUIRE(verifyChecksums(Records.data(), Records.size(), OkBuf) == 3);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    REQUIRE(OkBuf[I] == (I != 5 && I != 64 && I != 102));
+  }
+}
+
+// records of 1, 3, 4, 8 and 16 words of 32 bits
+using Words1 = BitField<std::uint32_t, RefByEnum::ChecksumField<Tag::Sum>,
+                        RefByEnum::Field<Tag::A, 16>>;
+using Words3 = BitField<std::uint32_t, RefByEnum::ChecksumField<Tag::Sum>,
+                        RefByEnum::Field<Tag::A, 16>,
+                        RefByEnum::Field<Tag::B, 32>,
+                        RefByEnum::Field<Tag::C, 32>>;
+using Words4 = BitField<std::uint32_t, RefByEnum::ChecksumField<Tag::Sum>,
+                        RefByEnum::Field<Tag::A, 16>,
+                        RefByEnum::Field<Tag::B, 32>,
+                        RefByEnum::Field<Tag::C, 32>,
+                        RefByEnum::Padding<Tag, 32>>;
+using Words8 = BitField<std::uint32_t, RefByEnum::ChecksumField<Tag::Sum>,
+                        RefByEnum::Field<Tag::A, 16>,
+                        RefByEnum::Field<Tag::B, 32>,
+                        RefByEnum::Padding<Tag, 192>>;
+using Words16 = BitField<std::uint32_t, RefByEnum::ChecksumField<Tag::Sum>,
+                         RefByEnum::Field<Tag::A, 16>,
+                         RefByEnum::Field<Tag::B, 32>,
+                         RefByEnum::Padding<Tag, 448>>;
+
+TEMPLATE_TEST_CASE("Bulk checksum verification for record sizes",
+                   "[Checksum][RefByEnum]", Words1, Words3, Words4, Words8,
+                   Words16) {
+  static_assert(sizeof(TestType) % 4 == 0);
+  std::vector<TestType> Records(37);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    get<Tag::A>(Records[I]) = static_cast<std::uint32_t>(I * 40503u);
+  }
+  REQUIRE(verifyChecksums(Records.data(), Records.size()) == 0);
+
+  // every lane of a block of eight records, and the tail
+  for (std::size_t I : {0, 1, 10, 19, 28, 29, 30, 31, 36}) {
+    auto &Last = Records[I].Data[TestType::dataSize() - 1];
+    Last ^= static_cast<std::uint32_t>(I + 1) << 20;
+  }
+  bool OkBuf[37];
+  REQUIRE(verifyChecksums(Records.data(), Records.size(), OkBuf) == 9);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    REQUIRE(OkBuf[I] == verifyChecksum(Records[I]));
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Checksum field test (RefByStr)", "[Checksum][RefByStr]") {
+  using R = BitField<std::uint32_t, RefByStr::ChecksumField<"sum">,
+                     RefByStr::Field<"ttl", 8, 64>, RefByStr::Field<"p", 8>>;
+  R BF;
+  REQUIRE(verifyChecksum(BF));
+  --get<"ttl">(BF);
+  get<"p">(BF) = 17;
+  REQUIRE(verifyChecksum(BF));
+  REQUIRE(get<"sum">(BF) ==
+          static_cast<std::uint16_t>(~(63 + (17 << 8)) & 0xffff));
+}
+#endif
@@ -0,0 +1,147 @@
+//===-- test/Compressed.cpp - Test for compressed chunks --------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of compressed chunks of records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Checksum.hpp"
+#include "OrderedBitField/Compressed.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, D, Sum };
+
+TEMPLATE_TEST_CASE("Compressed chunk test", "[Compressed][RefByEnum]",
+                   std::byte, std::uint8_t, std::uint16_t, std::uint32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 8>,
+                     RefByEnum::ConstField<Tag::B, 3, 5>,
+                     RefByEnum::Padding<Tag, 2>, RefByEnum::Field<Tag::C, 7>,
+                     RefByEnum::Field<Tag::D, 1>>;
+  for (std::size_t N : {0, 1, 5, 1000, 4099}) {
+    std::vector<R> Records(N);
+    for (std::size_t I = 0; I < N; ++I) {
+      // A in [200, 215], C constant, D alternating
+      get<Tag::A>(Records[I]) = static_cast<TestType>(200 + I * 7 % 16);
+      get<Tag::C>(Records[I]) = static_cast<TestType>(99);
+      get<Tag::D>(Records[I]) = static_cast<TestType>(I % 2);
+    }
+    const CompressedChunk<R> Chunk(Records.data(), N);
+    REQUIRE(Chunk.size() == N);
+    REQUIRE(Chunk.empty() == (N == 0));
+    if (N > 16) {
+      REQUIRE(Chunk.packedBits(0) == 4);
+      REQUIRE(Chunk.packedBits(1) == 0);
+      REQUIRE(Chunk.packedBits(3) == 0);
+      REQUIRE(Chunk.packedBits(4) == 1);
+      REQUIRE(Chunk.bytes() * 3 < N * sizeof(R));
+    }
+    std::vector<R> Out(N + 2);
+    Chunk.decompress(Out.data());
+    for (std::size_t I = 0; I < N; ++I) {
+      REQUIRE(Out[I].Data == Records[I].Data);
+      REQUIRE(Chunk.load(I).Data == Records[I].Data);
+    }
+    if (N > 10) {
+      Chunk.decompress(3, N - 5, Out.data() + 1);
+      for (std::size_t I = 3; I < N - 2; ++I) {
+        REQUIRE(Out[I - 2].Data == Records[I].Data);
+      }
+    }
+  }
+}
+
+TEST_CASE("Compressed chunk test for wide and signed fields",
+          "[Compressed][RefByEnum]") {
+  using W = BitField<std::uint64_t, RefByEnum::Field<Tag::A, 64>,
+                     RefByEnum::Field<Tag::B, 40>, RefByEnum::Field<Tag::C, 3>>;
+  constexpr std::size_t N = 777;
+  std::vector<W> Records(N);
+  std::uint64_t Seed = 1;
+  for (std::size_t I = 0; I < N; ++I) {
+    Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+    get<Tag::A>(Records[I]) = Seed;
+    get<Tag::B>(Records[I]) = (Seed >> 20) | (std::uint64_t{1} << 39);
+    get<Tag::C>(Records[I]) = 6;
+  }
+  const CompressedChunk<W> Chunk(Records.data(), N);
+  REQUIRE(Chunk.packedBits(0) == 64);
+  REQUIRE(Chunk.packedBits(1) == 39);
+  REQUIRE(Chunk.packedBits(2) == 0);
+  std::vector<W> Out(N);
+  Chunk.decompress(Out.data());
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(Out[I].Data == Records[I].Data);
+    REQUIRE(Chunk.load(I).Data == Records[I].Data);
+  }
+
+  using S = BitField<std::int32_t, RefByEnum::Field<Tag::A, 12>,
+                     RefByEnum::Field<Tag::B, 16>>;
+  std::vector<S> Signed(300);
+  for (std::size_t I = 0; I < Signed.size(); ++I) {
+    get<Tag::A>(Signed[I]) = static_cast<std::int32_t>(I % 9) - 4;
+    get<Tag::B>(Signed[I]) = static_cast<std::int32_t>(I) - 150;
+  }
+  const CompressedChunk<S> SChunk(Signed.data(), Signed.size());
+  // differences from the signed minimum
+  REQUIRE(SChunk.packedBits(0) == 4);
+  REQUIRE(SChunk.packedBits(1) == 9);
+  for (std::size_t I = 0; I < Signed.size(); ++I) {
+    const S Rec = SChunk.load(I);
+    REQUIRE(get<Tag::A>(Rec) == get<Tag::A>(Signed[I]));
+    REQUIRE(Rec.Data == Signed[I].Data);
+  }
+}
+
+TEST_CASE("Compressed chunk test for canonical form",
+          "[Compressed][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 10>,
+                     RefByEnum::ConstField<Tag::B, 6, 33>,
+                     RefByEnum::ChecksumField<Tag::Sum>>;
+  std::vector<R> Records(50);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    get<Tag::A>(Records[I]) = static_cast<std::uint32_t>(I * 13);
+  }
+  std::vector<R> Dirty = Records;
+  Dirty[7].Data[0] ^= 1u << 12;
+  const CompressedChunk<R> Chunk(Dirty.data(), Dirty.size());
+  std::vector<R> Out(Records.size());
+  Chunk.decompress(Out.data());
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    REQUIRE(Out[I].Data == Records[I].Data);
+    REQUIRE(verifyChecksum(Out[I]));
+    const R Rec = Chunk.load(I);
+    REQUIRE(get<Tag::B>(Rec) == 33);
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Compressed chunk test (RefByStr)", "[Compressed][RefByStr]") {
+  using R = BitField<std::uint16_t, RefByStr::Field<"len", 11>,
+                     RefByStr::Field<"kind", 5>>;
+  std::vector<R> Records(100);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    get<"len">(Records[I]) = static_cast<std::uint16_t>(1400 + I);
+    get<"kind">(Records[I]) = 3;
+  }
+  const CompressedChunk<R> Chunk(Records.data(), Records.size());
+  REQUIRE(Chunk.packedBits(0) == 7);
+  const R Rec = Chunk.load(42);
+  REQUIRE(get<"len">(Rec) == 1442);
+  REQUIRE(get<"kind">(Rec) == 3);
+}
+#endif
@@ -0,0 +1,200 @@
+//===-- test/Convert.cpp - Test for conversion between layouts --*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of conversion between record layouts.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Checksum.hpp"
+#include "OrderedBitField/Convert.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, D, E, Sum };
+
+// storage of the records filled with garbage, including bits out of the
+// fields, from the LCG seeded by Seed
+template <class T>
+static void fillStorage(std::vector<T> &Records, std::uint64_t Seed) {
+  for (auto &R : Records) {
+    for (auto &U : R.Data) {
+      Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+      U = static_cast<std::remove_reference_t<decltype(U)>>(Seed >> 17);
+    }
+  }
+}
+
+TEMPLATE_TEST_CASE("Convert test", "[Convert][RefByEnum]", std::uint8_t,
+                   std::uint16_t, std::uint32_t, std::uint64_t) {
+  using Old = BitField<std::uint16_t, RefByEnum::Field<Tag::A, 5>,
+                       RefByEnum::Field<Tag::B, 7>, RefByEnum::Field<Tag::C, 4>,
+                       RefByEnum::Field<Tag::D, 8>>;
+  // reordered, widened, narrowed, removed and added fields
+  using New = BitField<TestType, RefByEnum::Field<Tag::C, 2>,
+                       RefByEnum::Field<Tag::A, 5>, RefByEnum::Padding<Tag, 3>,
+                       RefByEnum::Field<Tag::E, 6, 33>,
+                       RefByEnum::Field<Tag::B, 8>>;
+  std::vector<Old> In(1000);
+  fillStorage(In, 1);
+  std::vector<New> Out(In.size());
+  convert(In.data(), In.size(), Out.data());
+  for (std::size_t I = 0; I < In.size(); ++I) {
+    New Ref;
+    get<Tag::A>(Ref) = static_cast<TestType>(get<Tag::A>(In[I]));
+    get<Tag::B>(Ref) = static_cast<TestType>(get<Tag::B>(In[I]));
+    get<Tag::C>(Ref) = static_cast<TestType>(get<Tag::C>(In[I]));
+    REQUIRE(convert<New>(In[I]).Data == Ref.Data);
+    REQUIRE(Out[I].Data == Ref.Data);
+    REQUIRE(get<Tag::E>(Out[I]) == 33);
+  }
+}
+
+TEST_CASE("Convert test for signed fields", "[Convert][RefByEnum]") {
+  using Old = BitField<std::int32_t, RefByEnum::Field<Tag::A, 7>,
+                       RefByEnum::Field<Tag::B, 20>,
+                       RefByEnum::Field<Tag::C, 4>>;
+  using New = BitField<std::int32_t, RefByEnum::Field<Tag::B, 30>,
+                       RefByEnum::Field<Tag::A, 12>,
+                       RefByEnum::Field<Tag::C, 3>>;
+  Old O;
+  for (std::int32_t A : {-64, -5, -1, 0, 1, 63}) {
+    get<Tag::A>(O) = A;
+    get<Tag::B>(O) = A * 1000;
+    get<Tag::C>(O) = A / 8;
+    const New N = convert<New>(O);
+    REQUIRE(get<Tag::A>(N) == A);
+    REQUIRE(get<Tag::B>(N) == A * 1000);
+    New Ref;
+    get<Tag::C>(Ref) = A / 8;
+    REQUIRE(get<Tag::C>(N) == get<Tag::C>(Ref));
+  }
+}
+
+TEST_CASE("Convert test for const and guarded fields", "[Convert][RefByEnum]") {
+  using Old = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 16>,
+                       RefByEnum::ConstField<Tag::B, 4, 3>,
+                       RefByEnum::ChecksumField<Tag::Sum>>;
+  using New = BitField<std::uint32_t, RefByEnum::Field<Tag::B, 4>,
+                       RefByEnum::ConstField<Tag::C, 4, 9>,
+                       RefByEnum::Field<Tag::A, 16>,
+                       RefByEnum::ChecksumField<Tag::Sum>>;
+  using Back = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 16>,
+                        RefByEnum::ConstField<Tag::B, 4, 7>>;
+  Old O;
+  get<Tag::A>(O) = 0xbeef;
+  const New N = convert<New>(O);
+  REQUIRE(get<Tag::A>(N) == 0xbeef);
+  REQUIRE(get<Tag::B>(N) == 3);
+  REQUIRE(get<Tag::C>(N) == 9);
+  REQUIRE(verifyChecksum(N));
+  // const-qualified fields keep their values
+  const Back B = convert<Back>(N);
+  REQUIRE(get<Tag::A>(B) == 0xbeef);
+  REQUIRE(get<Tag::B>(B) == 7);
+}
+
+TEST_CASE("Convert program test", "[Convert][RefByEnum]") {
+  using V1 = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 8>,
+                      RefByEnum::Field<Tag::B, 8>, RefByEnum::Field<Tag::C, 8>>;
+  using V2 = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 8>,
+                      RefByEnum::Field<Tag::B, 8>, RefByEnum::Field<Tag::C, 8>,
+                      RefByEnum::Field<Tag::D, 8, 5>>;
+  using V3 = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 8>,
+                      RefByEnum::Field<Tag::C, 8>>;
+  using V4 = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 8>,
+                      RefByEnum::Padding<Tag, 4>, RefByEnum::Field<Tag::C, 8>>;
+  // appending a field is a single mask
+  static_assert(Util::Conversion<V2, V1>::Prog.NOps == 1);
+  static_assert(Util::Conversion<V1, V2>::Prog.NOps == 1);
+  V2 X;
+  get<Tag::A>(X) = 1;
+  get<Tag::B>(X) = 2;
+  get<Tag::C>(X) = 3;
+  const V3 Y = convert<V3>(X);
+  REQUIRE(get<Tag::A>(Y) == 1);
+  REQUIRE(get<Tag::C>(Y) == 3);
+  const V4 W = convert<V4>(X);
+  REQUIRE(get<Tag::A>(W) == 1);
+  REQUIRE(get<Tag::C>(W) == 3);
+  const V2 Z = convert<V2>(Y);
+  REQUIRE(get<Tag::A>(Z) == 1);
+  REQUIRE(get<Tag::B>(Z) == 0);
+  REQUIRE(get<Tag::C>(Z) == 3);
+  REQUIRE(get<Tag::D>(Z) == 5);
+}
+
+TEST_CASE("Convert array test", "[Convert][RefByEnum]") {
+  using Old =
+      BitField<std::uint64_t, RefByEnum::Field<Tag::A, 40>,
+               RefByEnum::Field<Tag::B, 24>, RefByEnum::Field<Tag::C, 9>>;
+  using New = BitField<std::uint32_t, RefByEnum::Field<Tag::C, 9>,
+                       RefByEnum::Field<Tag::B, 20>,
+                       RefByEnum::Field<Tag::A, 32>>;
+  constexpr std::size_t N = 200000;
+  std::vector<Old> In(N);
+  fillStorage(In, 2);
+  std::vector<New> Out(N);
+  convert(In.data(), N, Out.data(), 2);
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(Out[I].Data == convert<New>(In[I]).Data);
+    REQUIRE(get<Tag::A>(Out[I]) ==
+            static_cast<std::uint32_t>(get<Tag::A>(In[I])));
+  }
+}
+
+TEMPLATE_TEST_CASE("Convert array test for single-unit records",
+                   "[Convert][RefByEnum]", std::uint32_t, std::int32_t,
+                   std::uint64_t) {
+  using Old =
+      BitField<TestType, RefByEnum::Field<Tag::A, 6>,
+               RefByEnum::Field<Tag::B, 11>, RefByEnum::Field<Tag::C, 9>,
+               RefByEnum::Field<Tag::D, 5>>;
+  using New =
+      BitField<TestType, RefByEnum::Field<Tag::B, 9>,
+               RefByEnum::Field<Tag::E, 3, 5>, RefByEnum::Field<Tag::C, 12>,
+               RefByEnum::Field<Tag::A, 6>>;
+  // large enough for non-temporal stores, at an odd offset
+  const std::size_t N = (std::size_t{1} << 24) / sizeof(New) + 7;
+  std::vector<Old> In(N);
+  fillStorage(In, 3);
+  for (std::size_t Len : {std::size_t{37}, N - 1}) {
+    std::vector<New> Out(Len + 1);
+    convert(In.data(), Len, Out.data() + 1);
+    std::size_t Mismatches = 0;
+    for (std::size_t I = 0; I < Len; ++I) {
+      Mismatches += Out[I + 1].Data != convert<New>(In[I]).Data;
+    }
+    REQUIRE(Mismatches == 0);
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Convert test (RefByStr)", "[Convert][RefByStr]") {
+  using Old = BitField<std::uint16_t, RefByStr::Field<"len", 11>,
+                       RefByStr::Field<"kind", 5>>;
+  using New = BitField<std::uint32_t, RefByStr::Field<"kind", 8>,
+                       RefByStr::Field<"len", 16>,
+                       RefByStr::Field<"ttl", 8, 64>>;
+  Old O;
+  get<"len">(O) = 1500;
+  get<"kind">(O) = 17;
+  const New N = convert<New>(O);
+  REQUIRE(get<"len">(N) == 1500);
+  REQUIRE(get<"kind">(N) == 17);
+  REQUIRE(get<"ttl">(N) == 64);
+}
+#endif
@@ -0,0 +1,266 @@
+//===-- test/Dispatch.cpp - Test for runtime kernel selection ---*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of detection of SIMD levels and of the
+/// compiled kernels against the scalar ones.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Checksum.hpp"
+#include "OrderedBitField/Dispatch.hpp"
+#include "OrderedBitField/Memory.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+
+TEST_CASE("SIMD level detection test", "[Dispatch]") {
+  const SimdLevel Level = simdLevel();
+  REQUIRE(simdLevel() == Level);
+  REQUIRE(Level <= Util::detectSimdLevel());
+#if defined(__AVX512F__)
+  REQUIRE(Util::detectSimdLevel() == SimdLevel::Avx512);
+#elif defined(__AVX2__)
+  REQUIRE(Util::detectSimdLevel() >= SimdLevel::Avx2);
+#endif
+}
+
+#if ORDERED_BIT_FIELD_KERNELS
+TEST_CASE("Compiled kernels test", "[Dispatch]") {
+  REQUIRE(Util::kernels().Level == simdLevel());
+  const Util::KernelTable &Scalar = Util::kernelsFor(SimdLevel::Scalar);
+  for (SimdLevel Level : {SimdLevel::Scalar, SimdLevel::Avx2,
+                          SimdLevel::Avx512}) {
+    if (Level > Util::detectSimdLevel()) {
+      continue;
+    }
+    const Util::KernelTable &Table = Util::kernelsFor(Level);
+    REQUIRE(Table.Level == Level);
+
+    std::uint64_t State = 0x9e3779b97f4a7c15u;
+    auto next = [&State] {
+      State ^= State << 13;
+      State ^= State >> 7;
+      State ^= State << 17;
+      return State;
+    };
+
+    for (std::size_t P : {32, 64, 96, 256}) {
+      const std::size_t Bytes = P * 37;
+      std::vector<unsigned char> X(Bytes), Y(Bytes), Keep(P), Set(P);
+      for (auto &C : X) {
+        C = static_cast<unsigned char>(next());
+      }
+      for (auto &C : Y) {
+        C = static_cast<unsigned char>(next());
+      }
+      for (std::size_t J = 0; J < P; ++J) {
+        Keep[J] = static_cast<unsigned char>(next());
+        Set[J] = static_cast<unsigned char>(next() & ~Keep[J]);
+      }
+      for (auto Op : {Util::BitwiseKind::And, Util::BitwiseKind::Or,
+                      Util::BitwiseKind::Xor, Util::BitwiseKind::AndNot,
+                      Util::BitwiseKind::First, Util::BitwiseKind::Not}) {
+        std::vector<unsigned char> Expected(Bytes), Actual(Bytes);
+        Scalar.MaskedBytes(Op, X.data(), Y.data(), Expected.data(), Bytes, P,
+                           Keep.data(), Set.data());
+        Table.MaskedBytes(Op, X.data(), Y.data(), Actual.data(), Bytes, P,
+                          Keep.data(), Set.data());
+        REQUIRE(Actual == Expected);
+      }
+    }
+
+    alignas(64) unsigned char Pattern[128];
+    for (auto &C : Pattern) {
+      C = static_cast<unsigned char>(next());
+    }
+    for (std::size_t Bytes : {std::size_t{0}, std::size_t{100},
+                              std::size_t{128 * 9 + 17},
+                              Util::NonTemporalBytes + 77}) {
+      auto Buffer = std::make_unique<std::uint64_t[]>(Bytes / 8 + 8);
+      auto *Dst = reinterpret_cast<unsigned char *>(
+          (reinterpret_cast<std::uintptr_t>(Buffer.get()) + 63) / 64 * 64);
+      Table.FillPattern(Dst, Bytes, Pattern, sizeof(Pattern));
+      std::size_t Mismatches = 0;
+      for (std::size_t K = 0; K < Bytes; ++K) {
+        Mismatches += Dst[K] != Pattern[K % sizeof(Pattern)];
+      }
+      REQUIRE(Mismatches == 0);
+    }
+
+    std::vector<std::uint64_t> Stream(1024);
+    for (auto &W : Stream) {
+      W = next();
+    }
+    for (std::size_t B = 0; B <= 64; ++B) {
+      const std::size_t N = (Stream.size() - 1) * 64 / (B == 0 ? 64 : B) - 3;
+      std::vector<std::uint64_t> Expected(N), Actual(N);
+      Scalar.UnpackBits(Stream.data(), B, 3, N, Expected.data());
+      Table.UnpackBits(Stream.data(), B, 3, N, Actual.data());
+      REQUIRE(Actual == Expected);
+    }
+
+    for (std::size_t P : {32, 96, 256}) {
+      const std::size_t Bytes = P * 11;
+      std::vector<unsigned char> X(Bytes), Ignore(P), Expect(P);
+      for (std::size_t J = 0; J < P; ++J) {
+        Ignore[J] = static_cast<unsigned char>(next());
+        Expect[J] = static_cast<unsigned char>(next() & ~Ignore[J]);
+      }
+      for (std::size_t K = 0; K < Bytes; ++K) {
+        X[K] = static_cast<unsigned char>((next() & Ignore[K % P]) |
+                                          Expect[K % P]);
+      }
+      REQUIRE(Table.MatchBytes(X.data(), Bytes, P, Ignore.data(),
+                               Expect.data()));
+      X[Bytes - 1] ^= static_cast<unsigned char>(~Ignore[P - 1] | 1);
+      REQUIRE(!Table.MatchBytes(X.data(), Bytes, P, Ignore.data(),
+                                Expect.data()));
+    }
+
+    std::vector<unsigned char> Records(4096);
+    for (auto &C : Records) {
+      C = static_cast<unsigned char>(next());
+    }
+    std::vector<std::uint64_t> Indices(100);
+    for (auto &I : Indices) {
+      I = next() % 150;
+    }
+    for (std::size_t Width : {4, 8}) {
+      for (std::size_t Stride : {Width, Width * 3, std::size_t{20}}) {
+        for (unsigned Shift : {0u, 5u, 31u}) {
+          const std::uint64_t Mask = Width == 8 ? 0x7ffffffffull : 0x1fffu;
+          for (bool Indexed : {true, false}) {
+            const std::uint64_t *I = Indexed ? Indices.data() : nullptr;
+            std::vector<unsigned char> Expected(100 * Width),
+                Actual(100 * Width);
+            Scalar.GatherBits(Records.data(), Stride, Width, I, 100, Shift,
+                              Mask, Expected.data());
+            Table.GatherBits(Records.data(), Stride, Width, I, 100, Shift,
+                             Mask, Actual.data());
+            REQUIRE(Actual == Expected);
+          }
+        }
+      }
+    }
+
+    for (std::size_t Size : {2, 4, 8, 12, 16, 20, 32, 64}) {
+      const std::size_t N = 4096 / Size - 3;
+      // every other record has a matching sum
+      for (std::size_t K = 0; K < N; K += 2) {
+        unsigned char *R = Records.data() + K * Size;
+        R[0] = R[1] = 0;
+        std::uint64_t S = 0;
+        for (std::size_t B = 0; B < Size; B += 2) {
+          std::uint16_t W;
+          std::memcpy(&W, R + B, 2);
+          S += W;
+        }
+        const auto W = static_cast<std::uint16_t>(0xffff - Util::foldSum(S));
+        std::memcpy(R, &W, 2);
+      }
+      std::vector<char> Expected(N), Actual(N);
+      auto Ok = std::make_unique<bool[]>(N);
+      const std::size_t ExpectedBad =
+          Scalar.VerifySums(Records.data(), Size, N, Ok.get());
+      std::copy(Ok.get(), Ok.get() + N, Expected.begin());
+      REQUIRE(ExpectedBad <= N / 2);
+      REQUIRE(Table.VerifySums(Records.data(), Size, N, Ok.get()) ==
+              ExpectedBad);
+      std::copy(Ok.get(), Ok.get() + N, Actual.begin());
+      REQUIRE(Actual == Expected);
+      REQUIRE(Table.VerifySums(Records.data(), Size, N, nullptr) ==
+              ExpectedBad);
+    }
+
+    for (std::size_t Width : {4, 8}) {
+      constexpr std::size_t Units = 3;
+      constexpr std::size_t E = 4;
+      std::uint64_t Equation[E * Units];
+      for (auto &M : Equation) {
+        M = next() & (Width == 8 ? ~std::uint64_t{0} : 0xffffffffu);
+      }
+      Equation[1] = 0;
+      for (std::size_t N : {0, 7, 33, 64}) {
+        const std::uint64_t Expected = Scalar.OddParity(
+            Records.data(), Units * Width + 4, Width, Units, N, Equation, E);
+        REQUIRE(Table.OddParity(Records.data(), Units * Width + 4, Width,
+                                Units, N, Equation, E) == Expected);
+      }
+    }
+
+    std::vector<std::uint32_t> Bits(1 << 16);
+    for (std::size_t K = 0; K < Bits.size(); ++K) {
+      Bits[K] = static_cast<std::uint32_t>(K);
+    }
+    std::vector<float> Values(Bits.size());
+    for (std::size_t K = 0; K < Values.size(); ++K) {
+      const auto F = static_cast<std::uint32_t>(next());
+      std::memcpy(&Values[K], &F, 4);
+    }
+    for (auto Decode : {&Util::KernelTable::DecodeHalf,
+                         &Util::KernelTable::DecodeBFloat16}) {
+      std::vector<float> Expected(Bits.size() - 3), Actual(Bits.size() - 3);
+      (Scalar.*Decode)(Bits.data(), Expected.size(), Expected.data());
+      (Table.*Decode)(Bits.data(), Actual.size(), Actual.data());
+      REQUIRE(std::memcmp(Actual.data(), Expected.data(),
+                          Actual.size() * 4) == 0);
+    }
+    for (auto Encode : {&Util::KernelTable::EncodeHalf,
+                         &Util::KernelTable::EncodeBFloat16}) {
+      std::vector<std::uint32_t> Expected(Values.size() - 3),
+          Actual(Values.size() - 3);
+      (Scalar.*Encode)(Values.data(), Expected.size(), Expected.data());
+      (Table.*Encode)(Values.data(), Actual.size(), Actual.data());
+      REQUIRE(Actual == Expected);
+    }
+
+    // signed 12 bits and unsigned 20 bits
+    for (int Ext : {20, 0}) {
+      const std::uint32_t Mask = Ext != 0 ? 0xfff : 0xfffff;
+      const std::size_t N = 1001;
+      std::vector<float> Expected(N), Actual(N);
+      Scalar.DecodeFixed(Bits.data() + 7, N, Mask, Ext, -5, 0.0625,
+                         Expected.data());
+      Table.DecodeFixed(Bits.data() + 7, N, Mask, Ext, -5, 0.0625,
+                        Actual.data());
+      REQUIRE(Actual == Expected);
+      std::vector<double> ExpectedDouble(N), ActualDouble(N);
+      Scalar.DecodeFixedDouble(Bits.data() + 7, N, Mask, Ext, -5, 0.0625,
+                               ExpectedDouble.data());
+      Table.DecodeFixedDouble(Bits.data() + 7, N, Mask, Ext, -5, 0.0625,
+                              ActualDouble.data());
+      REQUIRE(ActualDouble == ExpectedDouble);
+
+      std::vector<float> In(N);
+      for (std::size_t K = 0; K < N; ++K) {
+        In[K] = static_cast<float>(static_cast<std::int32_t>(next())) /
+                (1 << 20);
+      }
+      In[3] = In[3] / 0.0f - In[3] / 0.0f;
+      const float Lo = Ext != 0 ? -2048.0f : 0.0f;
+      const float Hi = Ext != 0 ? 2047.0f : 1048575.0f;
+      std::vector<std::uint32_t> ExpectedBits(N), ActualBits(N);
+      Scalar.EncodeFixed(In.data(), N, 16.0f, -5.0f, Lo, Hi, Mask,
+                         ExpectedBits.data());
+      Table.EncodeFixed(In.data(), N, 16.0f, -5.0f, Lo, Hi, Mask,
+                        ActualBits.data());
+      REQUIRE(ActualBits == ExpectedBits);
+    }
+  }
+}
+#endif
@@ -0,0 +1,126 @@
+//===-- test/Ecc.cpp - Test for parity and SECDED fields --------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of parity and SECDED protection fields.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Ecc.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, Check };
+
+TEMPLATE_TEST_CASE("Parity field test", "[Ecc][RefByEnum]", std::uint8_t,
+                   std::uint16_t, std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5, 21>,
+                     RefByEnum::ParityField<Tag::Check, 3>,
+                     RefByEnum::Field<Tag::B, 7, 5>,
+                     RefByEnum::Field<Tag::C, 6, 1>>;
+  R BF;
+  REQUIRE(verifyEcc(BF));
+  for (int I = 0; I < 200; ++I) {
+    get<Tag::A>(BF) += static_cast<TestType>(I);
+    get<Tag::B>(BF) ^= static_cast<TestType>(I * 3);
+    get<Tag::C>(BF) = static_cast<TestType>(I * 5);
+    REQUIRE(verifyEcc(BF));
+  }
+  R Copy = BF;
+  updateEcc(Copy);
+  REQUIRE(Copy.Data == BF.Data);
+
+  BF.Data[BF.dataSize() - 1] =
+      static_cast<TestType>(BF.Data[BF.dataSize() - 1] ^ 1);
+  REQUIRE(!verifyEcc(BF));
+  REQUIRE(repairEcc(BF) == EccStatus::Uncorrectable);
+}
+
+TEMPLATE_TEST_CASE("SECDED field test", "[Ecc][RefByEnum]", std::uint8_t,
+                   std::uint16_t, std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 8, 0x5a>,
+                     RefByEnum::Field<Tag::B, 8>,
+                     RefByEnum::SecdedField<Tag::Check, 8>,
+                     RefByEnum::Field<Tag::C, 8, 0xc3>>;
+  R BF;
+  get<Tag::B>(BF) = 0x7e;
+  REQUIRE(verifyEcc(BF));
+
+  const R Good = BF;
+  constexpr std::size_t Bits = sizeof(R) * 8;
+  for (std::size_t I = 0; I < Bits; ++I) {
+    R Bad = Good;
+    auto *Bytes = reinterpret_cast<unsigned char *>(Bad.Data.data());
+    Bytes[I / 8] ^= static_cast<unsigned char>(1 << I % 8);
+    REQUIRE(!verifyEcc(Bad));
+    REQUIRE(repairEcc(Bad) == EccStatus::Corrected);
+    REQUIRE(Bad.Data == Good.Data);
+
+    for (std::size_t J = I + 1; J < Bits; J += 3) {
+      R Bad2 = Good;
+      auto *Bytes2 = reinterpret_cast<unsigned char *>(Bad2.Data.data());
+      Bytes2[J / 8] ^= static_cast<unsigned char>(1 << J % 8);
+      Bytes2[I / 8] ^= static_cast<unsigned char>(1 << I % 8);
+      REQUIRE(repairEcc(Bad2) == EccStatus::Uncorrectable);
+    }
+  }
+}
+
+TEMPLATE_TEST_CASE("Scrubbing test", "[Ecc][RefByEnum]", std::uint8_t,
+                   std::uint16_t, std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 20>,
+                     RefByEnum::SecdedField<Tag::Check, 7>,
+                     RefByEnum::Field<Tag::B, 30>>;
+  std::vector<R> Records(37);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    get<Tag::A>(Records[I]) = static_cast<TestType>(I * 7919);
+    get<Tag::B>(Records[I]) = static_cast<TestType>(I * 104729);
+  }
+  const auto Good = Records;
+  REQUIRE(scrub(Records.data(), Records.size()).Corrected == 0);
+
+  // flip the Bit-th bit of the storage of a record
+  auto flip = [](R &BF, std::size_t Bit) {
+    constexpr std::size_t UnitBits = sizeof(TestType) * 8;
+    BF.Data[Bit / UnitBits] ^= static_cast<TestType>(TestType{1}
+                                                     << Bit % UnitBits);
+  };
+  flip(Records[3], 5);
+  flip(Records[9], 63);
+  flip(Records[20], 0);
+  flip(Records[20], 1);
+  flip(Records[36], 34);
+  const auto Result = scrub(Records.data(), Records.size());
+  REQUIRE(Result.Corrected == 3);
+  REQUIRE(Result.Uncorrectable == 1);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    if (I != 20) {
+      REQUIRE(Records[I].Data == Good[I].Data);
+    }
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("SECDED field test (RefByStr)", "[Ecc][RefByStr]") {
+  using R = BitField<std::uint64_t, RefByStr::Field<"a", 32>,
+                     RefByStr::SecdedField<"ecc", 7>, RefByStr::Field<"b", 25>>;
+  R BF;
+  get<"a">(BF) = 0xdeadbeef;
+  get<"b">(BF) = 12345;
+  REQUIRE(verifyEcc(BF));
+  BF.Data[0] ^= std::uint64_t{1} << 40;
+  REQUIRE(repairEcc(BF) == EccStatus::Corrected);
+  REQUIRE(get<"a">(BF) == 0xdeadbeef);
+  REQUIRE(get<"b">(BF) == 12345);
+}
+#endif
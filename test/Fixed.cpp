@@ -0,0 +1,123 @@
+//===-- test/Fixed.cpp - Test for fixed-point fields ------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of fixed-point number fields.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Fixed.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { Temp, Delta, Id };
+
+TEMPLATE_TEST_CASE("Fixed-point field test", "[Fixed][RefByEnum]",
+                   std::uint16_t, std::uint32_t, std::int32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::FixedField<Tag::Temp, 11, 4, -640>,
+                     RefByEnum::SignedFixedField<Tag::Delta, 10, 6>,
+                     RefByEnum::Field<Tag::Id, 5, 3>>;
+  R BF;
+  REQUIRE(get<Tag::Temp>(BF) == -40.0);
+  REQUIRE(get<Tag::Delta>(BF) == 0.0);
+
+  get<Tag::Temp>(BF) = 21.5;
+  REQUIRE(get<Tag::Temp>(BF) == 21.5);
+  REQUIRE(get<Tag::Temp>(BF).raw() == 21.5 * 16 + 640);
+  get<Tag::Temp>(BF) += 0.25;
+  REQUIRE(get<Tag::Temp>(BF) == 21.75);
+
+  // saturation
+  get<Tag::Temp>(BF) = 1000.0;
+  REQUIRE(get<Tag::Temp>(BF) == 87.9375);
+  get<Tag::Temp>(BF) = -1000.0;
+  REQUIRE(get<Tag::Temp>(BF) == -40.0);
+
+  // rounding to the nearest even
+  get<Tag::Temp>(BF) = 0.03125;
+  REQUIRE(get<Tag::Temp>(BF) == 0.0);
+  get<Tag::Temp>(BF) = 0.09375;
+  REQUIRE(get<Tag::Temp>(BF) == 0.125);
+  get<Tag::Temp>(BF) = 0.1;
+  REQUIRE(get<Tag::Temp>(BF) == 0.125);
+
+  get<Tag::Delta>(BF) = -1.5;
+  REQUIRE(get<Tag::Delta>(BF) == -1.5);
+  get<Tag::Delta>(BF) = -100.0;
+  REQUIRE(get<Tag::Delta>(BF) == -8.0);
+  get<Tag::Delta>(BF) = 100.0;
+  REQUIRE(get<Tag::Delta>(BF) == 8.0 - 1.0 / 64);
+  get<Tag::Delta>(BF) = get<Tag::Temp>(BF);
+  REQUIRE(get<Tag::Delta>(BF) == 0.125);
+
+  REQUIRE(get<Tag::Temp>(BF) == 0.125);
+  REQUIRE(get<Tag::Id>(BF) == 3);
+  const float F = get<Tag::Delta>(BF);
+  REQUIRE(F == 0.125f);
+}
+
+TEMPLATE_TEST_CASE("Fixed-point column test", "[Fixed][RefByEnum]",
+                   std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::FixedField<Tag::Temp, 11, 4, -640>,
+                     RefByEnum::SignedFixedField<Tag::Delta, 10, 6>,
+                     RefByEnum::Field<Tag::Id, 5>>;
+  constexpr std::size_t N = 1003;
+  std::vector<R> Records(N);
+  std::vector<float> In(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    In[I] = static_cast<float>(static_cast<int>(I) - 500) / 32.0f;
+  }
+  In[7] = std::numeric_limits<float>::quiet_NaN();
+  In[8] = std::numeric_limits<float>::infinity();
+  In[9] = -std::numeric_limits<float>::infinity();
+
+  encodeColumn<Tag::Delta>(Records.data(), N, In.data());
+  std::vector<R> Expected(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::Id>(Records[I]) = static_cast<TestType>(I);
+    get<Tag::Id>(Expected[I]) = static_cast<TestType>(I);
+    get<Tag::Delta>(Expected[I]) = In[I];
+    get<Tag::Temp>(Records[I]) = In[I] * 3;
+    get<Tag::Temp>(Expected[I]) = In[I] * 3;
+  }
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(Records[I].Data == Expected[I].Data);
+  }
+
+  std::vector<float> OutF(N);
+  std::vector<double> OutD(N);
+  decodeColumn<Tag::Delta>(Records.data(), N, OutF.data());
+  decodeColumn<Tag::Temp>(Records.data(), N, OutD.data());
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(OutF[I] == static_cast<float>(get<Tag::Delta>(Records[I])));
+    REQUIRE(OutD[I] == get<Tag::Temp>(Records[I]));
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Fixed-point field test (RefByStr)", "[Fixed][RefByStr]") {
+  using R = BitField<std::uint16_t, RefByStr::SignedFixedField<"x", 12, 8>,
+                     RefByStr::Field<"y", 4>>;
+  R BF;
+  get<"x">(BF) = -3.25;
+  get<"y">(BF) = 5;
+  REQUIRE(get<"x">(BF) == -3.25);
+  REQUIRE(get<"y">(BF) == 5);
+  get<"x">(BF) *= 2;
+  REQUIRE(get<"x">(BF) == -6.5);
+}
+#endif
@@ -0,0 +1,88 @@
+//===-- test/Flags.cpp - Test for flag groups -------------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of flag groups.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Checksum.hpp"
+#include "OrderedBitField/Flags.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { Owner, Perm, Mode, Sum };
+enum class Perm { Read, Write, Exec, Sticky, Hidden };
+
+TEMPLATE_TEST_CASE("Flag group test", "[Flags][RefByEnum]", std::uint8_t,
+                   std::uint16_t, std::int32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::Owner, 3, 3>,
+                     RefByEnum::FlagGroup<Tag::Perm, Perm::Read, Perm::Write,
+                                          Perm::Exec, Perm::Sticky,
+                                          Perm::Hidden>,
+                     RefByEnum::Field<Tag::Mode, 7, 0x35>>;
+  R BF;
+  REQUIRE(!testAny<Tag::Perm, Perm::Read, Perm::Write>(BF));
+  REQUIRE(testAll<Tag::Perm>(BF));
+
+  setFlags<Tag::Perm, Perm::Read, Perm::Exec>(BF);
+  REQUIRE((get<Tag::Perm>(BF) & 0x1f) == 0b00101);
+  REQUIRE(testAny<Tag::Perm, Perm::Write, Perm::Exec>(BF));
+  REQUIRE(!testAll<Tag::Perm, Perm::Write, Perm::Exec>(BF));
+  REQUIRE(testAll<Tag::Perm, Perm::Read, Perm::Exec>(BF));
+
+  toggleFlags<Tag::Perm, Perm::Read, Perm::Hidden>(BF);
+  REQUIRE((get<Tag::Perm>(BF) & 0x1f) == 0b10100);
+  clearFlags<Tag::Perm, Perm::Exec, Perm::Write>(BF);
+  REQUIRE((get<Tag::Perm>(BF) & 0x1f) == 0b10000);
+  setFlags<Tag::Perm, Perm::Write, Perm::Sticky>(BF);
+
+  std::vector<Perm> Set;
+  forEachSet<Tag::Perm>(BF, [&Set](Perm P) { Set.push_back(P); });
+  REQUIRE(Set == std::vector<Perm>{Perm::Write, Perm::Sticky, Perm::Hidden});
+
+  REQUIRE(get<Tag::Owner>(BF) == 3);
+  REQUIRE(get<Tag::Mode>(BF) == 0x35);
+}
+
+TEST_CASE("Flag group with checksum test", "[Flags][RefByEnum]") {
+  using R = BitField<std::uint16_t, RefByEnum::ChecksumField<Tag::Sum>,
+                     RefByEnum::FlagGroup<Tag::Perm, Perm::Read, Perm::Write,
+                                          Perm::Exec>,
+                     RefByEnum::Field<Tag::Owner, 13, 77>>;
+  R BF;
+  setFlags<Tag::Perm, Perm::Read, Perm::Write>(BF);
+  REQUIRE(verifyChecksum(BF));
+  toggleFlags<Tag::Perm, Perm::Write, Perm::Exec>(BF);
+  REQUIRE(verifyChecksum(BF));
+  clearFlags<Tag::Perm, Perm::Read>(BF);
+  REQUIRE(verifyChecksum(BF));
+  REQUIRE((get<Tag::Perm>(BF) & 0x1f) == 0b100);
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Flag group test (RefByStr)", "[Flags][RefByStr]") {
+  using R = BitField<std::uint32_t, RefByStr::Field<"uid", 20>,
+                     RefByStr::FlagGroup<"perm", "r", "w", "x">>;
+  R BF;
+  setFlags<"perm", "r", "x">(BF);
+  REQUIRE(testAll<"perm", "r", "x">(BF));
+  REQUIRE(!testAny<"perm", "w">(BF));
+  toggleFlags<"perm", "w", "x">(BF);
+  clearFlags<"perm", "r">(BF);
+  std::vector<std::string_view> Set;
+  forEachSet<"perm">(BF, [&Set](std::string_view S) { Set.push_back(S); });
+  REQUIRE(Set == std::vector<std::string_view>{"w"});
+}
+#endif
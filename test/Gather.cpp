@@ -0,0 +1,113 @@
+//===-- test/Gather.cpp - Test for batched random-access reads --*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of batched random-access reads of records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Gather.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, D };
+
+TEMPLATE_TEST_CASE("Gather field test", "[Gather][RefByEnum]", std::uint8_t,
+                   std::uint16_t, std::uint32_t, std::int32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5, 3>,
+                     RefByEnum::Field<Tag::B, 7>, RefByEnum::Padding<Tag, 4>,
+                     RefByEnum::Field<Tag::C, 8>, RefByEnum::Field<Tag::D, 6>>;
+  constexpr std::size_t M = 1000;
+  std::vector<R> Records(M);
+  for (std::size_t I = 0; I < M; ++I) {
+    get<Tag::B>(Records[I]) = static_cast<TestType>(I * 5);
+    get<Tag::C>(Records[I]) = static_cast<TestType>(I * 3);
+    get<Tag::D>(Records[I]) = static_cast<TestType>(I);
+  }
+  constexpr std::size_t N = 777;
+  std::mt19937 Rng(1);
+  std::vector<std::uint32_t> Idx32(N);
+  std::vector<std::size_t> Idx64(N);
+  for (std::size_t K = 0; K < N; ++K) {
+    Idx32[K] = static_cast<std::uint32_t>(Rng() % M);
+    Idx64[K] = Idx32[K];
+  }
+
+  for (std::size_t Distance : {std::size_t{0}, std::size_t{3},
+                               Util::PrefetchDistance, std::size_t{1000}}) {
+    std::vector<TestType> B(N);
+    std::vector<long long> C(N);
+    std::vector<TestType> D(N);
+    gatherField<Tag::B>(Records.data(), Idx32.data(), N, B.data(), Distance);
+    gatherField<Tag::C>(Records.data(), Idx64.data(), N, C.data(), Distance);
+    gatherField<Tag::D>(Records.data(), Idx64.data(), N, D.data(), Distance);
+    for (std::size_t K = 0; K < N; ++K) {
+      REQUIRE(B[K] == get<Tag::B>(Records[Idx32[K]]));
+      REQUIRE(C[K] ==
+              static_cast<long long>(get<Tag::C>(Records[Idx32[K]])));
+      REQUIRE(D[K] == get<Tag::D>(Records[Idx32[K]]));
+    }
+  }
+
+  // fields in the last storage unit of the record
+  std::vector<TestType> A(N);
+  gatherField<Tag::A>(Records.data(), Idx32.data(), N, A.data());
+  for (std::size_t K = 0; K < N; ++K) {
+    REQUIRE(A[K] == 3);
+  }
+
+  // an empty batch touches no record
+  const R *None = nullptr;
+  gatherField<Tag::C>(None, Idx64.data(), 0, A.data());
+  typename Util::Layout<R>::RawType Raw[1];
+  gatherField<Tag::C>(None, Idx64.data(), 0, Raw);
+}
+
+TEST_CASE("Gather record test", "[Gather][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 32>,
+                     RefByEnum::Field<Tag::B, 32>, RefByEnum::Field<Tag::C, 32>,
+                     RefByEnum::Field<Tag::D, 32>, RefByEnum::Padding<Tag, 480>>;
+  constexpr std::size_t M = 100;
+  std::vector<R> Records(M);
+  for (std::size_t I = 0; I < M; ++I) {
+    get<Tag::A>(Records[I]) = static_cast<std::uint32_t>(I);
+    get<Tag::D>(Records[I]) = static_cast<std::uint32_t>(I * 7);
+  }
+  std::vector<std::uint16_t> Idx = {5, 99, 0, 5, 42, 17, 17, 63, 1};
+  std::vector<R> Out(Idx.size());
+  gatherRecords(Records.data(), Idx.data(), Idx.size(), Out.data(), 2);
+  for (std::size_t K = 0; K < Idx.size(); ++K) {
+    REQUIRE(Out[K].Data == Records[Idx[K]].Data);
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Gather field test (RefByStr)", "[Gather][RefByStr]") {
+  using R = BitField<std::uint32_t, RefByStr::Field<"key", 20>,
+                     RefByStr::Field<"val", 12>>;
+  std::vector<R> Records(64);
+  for (std::size_t I = 0; I < Records.size(); ++I) {
+    get<"val">(Records[I]) = static_cast<std::uint32_t>(I + 100);
+  }
+  const std::size_t Idx[] = {63, 2, 7, 7, 31, 0, 1, 9, 10, 11};
+  std::uint32_t Out[10];
+  gatherField<"val">(Records.data(), Idx, 10, Out);
+  for (std::size_t K = 0; K < 10; ++K) {
+    REQUIRE(Out[K] == Idx[K] + 100);
+  }
+}
+#endif
@@ -0,0 +1,139 @@
+//===-- test/Half.cpp - Test for half-precision fields ----------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of half-precision and bfloat16 fields.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Half.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { X, Y, Z, W };
+
+TEMPLATE_TEST_CASE("Half-precision field test", "[Half][RefByEnum]",
+                   std::uint16_t, std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::HalfField<Tag::X, 0x3c00>,
+                     RefByEnum::HalfField<Tag::Y>,
+                     RefByEnum::BFloat16Field<Tag::Z>,
+                     RefByEnum::BFloat16Field<Tag::W, 0x3f80>>;
+  R BF;
+  REQUIRE(get<Tag::X>(BF) == 1.0f);
+  REQUIRE(get<Tag::Y>(BF) == 0.0f);
+  REQUIRE(get<Tag::W>(BF) == 1.0f);
+
+  get<Tag::X>(BF) = 65504.0f;
+  REQUIRE(get<Tag::X>(BF).raw() == 0x7bff);
+  get<Tag::X>(BF) = 65520.0f;
+  REQUIRE(get<Tag::X>(BF) == std::numeric_limits<float>::infinity());
+  get<Tag::Y>(BF) = 1.0f / (1 << 24);
+  REQUIRE(get<Tag::Y>(BF).raw() == 0x0001);
+  get<Tag::Y>(BF) = -0.333333f;
+  REQUIRE(get<Tag::Y>(BF).raw() == 0xb555);
+  get<Tag::Y>(BF) += 1.0f;
+  REQUIRE(get<Tag::Y>(BF) == 0.6669921875f); // tie to even
+
+  get<Tag::Z>(BF) = 3.14159265f;
+  REQUIRE(get<Tag::Z>(BF).raw() == 0x4049);
+  get<Tag::Z>(BF) = 1.00390625f; // tie to even
+  REQUIRE(get<Tag::Z>(BF).raw() == 0x3f80);
+  get<Tag::Z>(BF) = 1.01171875f; // tie to even
+  REQUIRE(get<Tag::Z>(BF).raw() == 0x3f82);
+  REQUIRE(get<Tag::W>(BF) == 1.0f);
+}
+
+TEST_CASE("Half-precision conversion test", "[Half]") {
+  // binary16 -> binary32 -> binary16 is an identity except for NaNs
+  std::vector<std::uint32_t> Bits(1 << 16);
+  std::vector<float> Values(1 << 16);
+  for (std::uint32_t H = 0; H < (1 << 16); ++H) {
+    Bits[H] = H;
+    const float F = Util::bitCast<float>(
+        Util::halfToFloatBits(static_cast<std::uint16_t>(H)));
+    if ((H & 0x7c00) != 0x7c00 || (H & 0x3ff) == 0) {
+      REQUIRE(Util::floatBitsToHalf(Util::bitCast<std::uint32_t>(F)) == H);
+    }
+    REQUIRE(Util::bitCast<std::uint32_t>(Util::Half::decode(H)) ==
+            Util::bitCast<std::uint32_t>(F));
+  }
+
+  // bulk conversion agrees with the scalar one bit by bit
+  Util::Half::decode(Bits.data(), Bits.size(), Values.data());
+  for (std::uint32_t H = 0; H < (1 << 16); ++H) {
+    REQUIRE(Util::bitCast<std::uint32_t>(Values[H]) ==
+            Util::halfToFloatBits(static_cast<std::uint16_t>(H)));
+  }
+
+  std::vector<float> In;
+  for (std::uint64_t F = 0; F < (std::uint64_t{1} << 32); F += 65521) {
+    In.push_back(Util::bitCast<float>(static_cast<std::uint32_t>(F)));
+  }
+  for (std::uint32_t F : {0x477fefffu, 0x477ff000u, 0x33000000u, 0x33000001u,
+                          0x387fc000u, 0x7f800001u, 0xffc00000u}) {
+    In.push_back(Util::bitCast<float>(F));
+  }
+  std::vector<std::uint32_t> HalfBits(In.size());
+  std::vector<std::uint32_t> BFloatBits(In.size());
+  Util::Half::encode(In.data(), In.size(), HalfBits.data());
+  Util::BFloat16::encode(In.data(), In.size(), BFloatBits.data());
+  for (std::size_t I = 0; I < In.size(); ++I) {
+    REQUIRE(HalfBits[I] ==
+            Util::floatBitsToHalf(Util::bitCast<std::uint32_t>(In[I])));
+    REQUIRE(HalfBits[I] == Util::Half::encode(In[I]));
+    REQUIRE(BFloatBits[I] == Util::BFloat16::encode(In[I]));
+  }
+}
+
+TEMPLATE_TEST_CASE("Half-precision column test", "[Half][RefByEnum]",
+                   std::uint16_t, std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::HalfField<Tag::X>,
+                     RefByEnum::BFloat16Field<Tag::Y>>;
+  constexpr std::size_t N = 517;
+  std::vector<R> Records(N);
+  std::vector<float> In(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    In[I] = static_cast<float>(I) * 0.37f - 90.0f;
+  }
+  encodeColumn<Tag::X>(Records.data(), N, In.data());
+  encodeColumn<Tag::Y>(Records.data(), N, In.data());
+
+  std::vector<float> X(N);
+  std::vector<float> Y(N);
+  decodeColumn<Tag::X>(Records.data(), N, X.data());
+  decodeColumn<Tag::Y>(Records.data(), N, Y.data());
+  for (std::size_t I = 0; I < N; ++I) {
+    R Expected;
+    get<Tag::X>(Expected) = In[I];
+    get<Tag::Y>(Expected) = In[I];
+    REQUIRE(Records[I].Data == Expected.Data);
+    REQUIRE(X[I] == get<Tag::X>(Expected));
+    REQUIRE(Y[I] == get<Tag::Y>(Expected));
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Half-precision field test (RefByStr)", "[Half][RefByStr]") {
+  using R = BitField<std::uint32_t, RefByStr::HalfField<"h">,
+                     RefByStr::BFloat16Field<"b">>;
+  R BF;
+  get<"h">(BF) = -2.5f;
+  get<"b">(BF) = 1.5f;
+  REQUIRE(get<"h">(BF) == -2.5f);
+  REQUIRE(get<"b">(BF) == 1.5f);
+  REQUIRE(BF.Data[0] == 0x3fc0c100u);
+}
+#endif
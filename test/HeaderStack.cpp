@@ -0,0 +1,225 @@
+//===-- test/HeaderStack.cpp - Test for stacks of headers -------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of overlays of protocol header stacks.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/HeaderStack.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Hdr {
+  Dst0, Dst1, Dst2, Src0, Src1, Src2, Type,
+  Tci,
+  Ihl, Ver, Tos, TotalLen, Id, Frag, Ttl, Proto, Sum,
+  Addr0, Addr1, Addr2, Addr3,
+  SrcPort, DstPort, Len
+};
+
+using Ethernet =
+    BitField<std::uint16_t, RefByEnum::Field<Hdr::Dst0, 16>,
+             RefByEnum::Field<Hdr::Dst1, 16>, RefByEnum::Field<Hdr::Dst2, 16>,
+             RefByEnum::Field<Hdr::Src0, 16>, RefByEnum::Field<Hdr::Src1, 16>,
+             RefByEnum::Field<Hdr::Src2, 16>, RefByEnum::Field<Hdr::Type, 16>>;
+// the 16-bit units hold the bytes of the wire format in host order, and the
+// pairs of byte fields (e.g. TTL and protocol) are for little-endian hosts
+using Vlan = BitField<std::uint16_t, RefByEnum::Field<Hdr::Tci, 16>,
+                      RefByEnum::Field<Hdr::Type, 16>>;
+using Ipv4 =
+    BitField<std::uint16_t, RefByEnum::Field<Hdr::Ihl, 4, 5>,
+             RefByEnum::Field<Hdr::Ver, 4, 4>, RefByEnum::Field<Hdr::Tos, 8>,
+             RefByEnum::Field<Hdr::TotalLen, 16>, RefByEnum::Field<Hdr::Id, 16>,
+             RefByEnum::Field<Hdr::Frag, 16>, RefByEnum::Field<Hdr::Ttl, 8, 64>,
+             RefByEnum::Field<Hdr::Proto, 8>, RefByEnum::Field<Hdr::Sum, 16>,
+             RefByEnum::Field<Hdr::Addr0, 16>, RefByEnum::Field<Hdr::Addr1, 16>,
+             RefByEnum::Field<Hdr::Addr2, 16>,
+             RefByEnum::Field<Hdr::Addr3, 16>>;
+using Udp = BitField<std::uint16_t, RefByEnum::Field<Hdr::SrcPort, 16>,
+                     RefByEnum::Field<Hdr::DstPort, 16>,
+                     RefByEnum::Field<Hdr::Len, 16>,
+                     RefByEnum::Field<Hdr::Sum, 16>>;
+
+constexpr std::uint16_t VlanType = 0x8100;
+constexpr std::uint16_t Ipv4Type = 0x0800;
+constexpr auto Big = ByteOrder::Big;
+using SizedIpv4 = RefByEnum::SizedLayer<Ipv4, Hdr::Ihl, 4>;
+using Stack =
+    HeaderStack<Ethernet,
+                RefByEnum::OptionalLayer<Vlan, Hdr::Type, VlanType, Big>,
+                RefByEnum::OptionalLayer<SizedIpv4, Hdr::Type, Ipv4Type, Big>,
+                RefByEnum::OptionalLayer<Udp, Hdr::Proto, 17>>;
+
+// value of a 16-bit unit holding V in network byte order
+static std::uint16_t wire16(std::uint16_t V) {
+  const unsigned char B[2] = {static_cast<unsigned char>(V >> 8),
+                              static_cast<unsigned char>(V)};
+  std::uint16_t R;
+  std::memcpy(&R, B, 2);
+  return R;
+}
+
+static_assert(Stack::FullOffsets[2] == 18 && Stack::FullOffsets[4] == 46);
+
+// write records one after another
+struct Packet {
+  alignas(8) unsigned char Data[128] = {};
+  std::size_t Len = 0;
+  template <class T> Packet &operator<<(const T &Header) {
+    std::memcpy(Data + Len, &Header, sizeof(T));
+    Len += sizeof(T);
+    return *this;
+  }
+};
+
+TEST_CASE("Header stack test", "[HeaderStack][RefByEnum]") {
+  Ethernet E;
+  get<Hdr::Type>(E) = wire16(Ipv4Type);
+  get<Hdr::Src2>(E) = 0xbeef;
+  Ipv4 I;
+  get<Hdr::Proto>(I) = 17;
+  Udp U;
+  get<Hdr::DstPort>(U) = wire16(4789);
+
+  // EtherType, version and IHL, protocol and port are at their offsets on
+  // the wire
+  const auto *Raw = reinterpret_cast<const unsigned char *>(&E);
+  REQUIRE((Raw[12] == 0x08 && Raw[13] == 0x00));
+  REQUIRE(reinterpret_cast<const unsigned char *>(&I)[0] == 0x45);
+  REQUIRE(reinterpret_cast<const unsigned char *>(&I)[9] == 17);
+  REQUIRE(reinterpret_cast<const unsigned char *>(&U)[3] == (4789 & 0xff));
+
+  Packet P;
+  P << E << I << U;
+  const Stack S(P.Data, P.Len);
+  REQUIRE(S.get<0>() != nullptr);
+  REQUIRE(get<Hdr::Src2>(*S.get<0>()) == 0xbeef);
+  REQUIRE(!S.has<1>());
+  REQUIRE(S.get<1>() == nullptr);
+  REQUIRE(S.offset<2>() == 14);
+  REQUIRE(S.offset<3>() == 34);
+  REQUIRE(get<Hdr::DstPort>(*S.get<Udp>()) == wire16(4789));
+  REQUIRE(S.size() == 42);
+  REQUIRE(S.payload() == P.Data + 42);
+  REQUIRE(!S.truncated());
+
+  // with a VLAN tag
+  Ethernet Tagged = E;
+  get<Hdr::Type>(Tagged) = wire16(VlanType);
+  Vlan V;
+  get<Hdr::Tci>(V) = wire16(42);
+  get<Hdr::Type>(V) = wire16(Ipv4Type);
+  Packet Q;
+  Q << Tagged << V << I << U;
+  const Stack T(Q.Data, Q.Len);
+  REQUIRE((get<Hdr::Tci>(*T.get<1>()) & wire16(0x0fff)) == wire16(42));
+  REQUIRE(T.offset<2>() == 18);
+  REQUIRE(T.offset<3>() == 38);
+  REQUIRE(get<Hdr::DstPort>(*T.get<3>()) == wire16(4789));
+  REQUIRE(T.size() == 46);
+
+  // VLAN tag with another protocol inside
+  get<Hdr::Type>(V) = wire16(0x86dd);
+  Packet R;
+  R << Tagged << V << I << U;
+  const Stack X(R.Data, R.Len);
+  REQUIRE(X.has<1>());
+  REQUIRE(!X.has<2>());
+  REQUIRE(!X.has<3>());
+  REQUIRE(X.size() == 18);
+
+  // not UDP
+  get<Hdr::Proto>(I) = 6;
+  Packet Tcp;
+  Tcp << E << I << U;
+  const Stack Y(Tcp.Data, Tcp.Len);
+  REQUIRE(Y.has<2>());
+  REQUIRE(!Y.has<3>());
+  REQUIRE(!Y.truncated());
+
+  // IPv4 with 8 bytes of options, whose IHL moves UDP
+  get<Hdr::Proto>(I) = 17;
+  get<Hdr::Ihl>(I) = 7;
+  const unsigned char Options[8] = {0x94, 0x04, 0, 0, 1, 1, 1, 0};
+  Packet O;
+  O << E << I;
+  std::memcpy(O.Data + O.Len, Options, sizeof(Options));
+  O.Len += sizeof(Options);
+  O << U;
+  const Stack W(O.Data, O.Len);
+  REQUIRE(W.offset<2>() == 14);
+  REQUIRE(W.offset<3>() == 42);
+  REQUIRE(get<Hdr::DstPort>(*W.get<3>()) == wire16(4789));
+  REQUIRE(W.size() == 50);
+  REQUIRE(!W.truncated());
+
+  // options cut off by the end of the buffer
+  const Stack WShort(O.Data, 40);
+  REQUIRE(!WShort.has<2>());
+  REQUIRE(WShort.truncated());
+  REQUIRE(WShort.size() == 14);
+
+  // IHL shorter than the fixed header
+  get<Hdr::Ihl>(I) = 4;
+  Packet Bad;
+  Bad << E << I << U;
+  const Stack B(Bad.Data, Bad.Len);
+  REQUIRE(!B.has<2>());
+  REQUIRE(!B.has<3>());
+  REQUIRE(B.truncated());
+  get<Hdr::Ihl>(I) = 5;
+
+  // truncated
+  const Stack Z(P.Data, 30);
+  REQUIRE(Z.has<0>());
+  REQUIRE(!Z.has<2>());
+  REQUIRE(!Z.has<3>());
+  REQUIRE(Z.truncated());
+  REQUIRE(Z.size() == 14);
+
+  // mutable view
+  MutableHeaderStack<Ethernet,
+                     RefByEnum::OptionalLayer<Ipv4, Hdr::Type, Ipv4Type, Big>,
+                     RefByEnum::OptionalLayer<Udp, Hdr::Proto, 17>>
+      M(P.Data, P.Len);
+  get<Hdr::DstPort>(*M.get<2>()) = wire16(53);
+  REQUIRE(get<Hdr::DstPort>(*S.get<3>()) == wire16(53));
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Header stack test (RefByStr)", "[HeaderStack][RefByStr]") {
+  using Outer = BitField<std::uint8_t, RefByStr::Field<"kind", 8>,
+                         RefByStr::Field<"len", 8>>;
+  using Inner = BitField<std::uint8_t, RefByStr::Field<"kind", 8>,
+                         RefByStr::Field<"value", 8>>;
+  using S = HeaderStack<Outer, RefByStr::OptionalLayer<Inner, "kind", 1>,
+                        RefByStr::OptionalLayer<Inner, "kind", 2>,
+                        RefByStr::OptionalLayer<Outer, "kind", 3>>;
+  const unsigned char Buf[] = {1, 9, 2, 7, 3, 5, 0, 0};
+  const S Stack(Buf, sizeof(Buf));
+  REQUIRE(Stack.size() == 8);
+  REQUIRE(get<"value">(*Stack.get<1>()) == 7);
+  REQUIRE(get<"value">(*Stack.get<2>()) == 5);
+  REQUIRE(get<"len">(*Stack.get<3>()) == 0);
+
+  // the first layer is followed by its payload of "len" bytes
+  using V = HeaderStack<RefByStr::SizedLayer<Outer, "len">,
+                        RefByStr::OptionalLayer<Inner, "kind", 1>>;
+  const unsigned char Var[] = {1, 4, 0xaa, 0xbb, 1, 6};
+  const V VarStack(Var, sizeof(Var));
+  REQUIRE(VarStack.offset<1>() == 4);
+  REQUIRE(get<"value">(*VarStack.get<1>()) == 6);
+}
+#endif
@@ -0,0 +1,154 @@
+//===-- test/Memory.cpp - Test for allocation of record arrays --*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of uninitialized construction of records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Memory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C };
+
+TEMPLATE_TEST_CASE("Uninitialized construction test", "[Memory][RefByEnum]",
+                   std::uint8_t, std::uint16_t, std::uint32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 3, 5>,
+                     RefByEnum::Field<Tag::B, 7, 100>,
+                     RefByEnum::Field<Tag::C, 6, 9, true>>;
+  static_assert(std::is_trivially_copyable_v<R>);
+  static_assert(std::is_nothrow_default_constructible_v<R>);
+  static_assert(std::is_aggregate_v<R>);
+
+  constexpr R Default;
+  static_assert(get<Tag::B>(Default) == 100);
+
+  // aggregate initialization from an image of the storage
+  constexpr R Image = {{TestType{0b101}}};
+  static_assert(get<Tag::A>(Image) == 5 && get<Tag::B>(Image) == 0);
+  constexpr R Listed = {Image.Data};
+  static_assert(get<Tag::A>(Listed) == 5);
+
+  // units one by one by brace elision
+  constexpr R Unit = {0b101};
+  static_assert(get<Tag::A>(Unit) == 5 && get<Tag::B>(Unit) == 0);
+  using Units = BitField<TestType, RefByEnum::Field<Tag::A, 3>,
+                         RefByEnum::Padding<Tag, sizeof(TestType) * 8 - 3>,
+                         RefByEnum::Field<Tag::B, 3>>;
+  constexpr Units Both = {1, 2};
+  static_assert(get<Tag::A>(Both) == 1 && get<Tag::B>(Both) == 2);
+#if __cpp_designated_initializers
+  constexpr Units Designated = {.Data = {3, 4}};
+  static_assert(get<Tag::A>(Designated) == 3 && get<Tag::B>(Designated) == 4);
+#endif
+
+  constexpr std::size_t N = 1000;
+  auto Records = makeForOverwrite<R>(N);
+  std::vector<R> Expected(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::A>(Expected[I]) = static_cast<TestType>(I);
+    get<Tag::B>(Expected[I]) = static_cast<TestType>(I * 7);
+  }
+  std::memcpy(Records.get(), Expected.data(), N * sizeof(R));
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(Records[I].Data == Expected[I].Data);
+  }
+
+  std::vector<R, OverwriteAllocator<R>> Buffer(N);
+  std::memcpy(Buffer.data(), Expected.data(), N * sizeof(R));
+  Buffer.resize(2 * N);
+  std::memcpy(Buffer.data() + N, Expected.data(), N * sizeof(R));
+  Buffer.push_back(R{});
+  for (std::size_t I = 0; I < 2 * N; ++I) {
+    REQUIRE(Buffer[I].Data == Expected[I % N].Data);
+  }
+  REQUIRE(Buffer.back().Data == Default.Data);
+}
+
+TEMPLATE_TEST_CASE("Default fill test", "[Memory][RefByEnum]", std::uint8_t,
+                   std::uint16_t, std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 8, 0xa5>,
+                     RefByEnum::Field<Tag::B, 11, 0x3c3>,
+                     RefByEnum::Field<Tag::C, 5, 0x11, true>>;
+  const R Default;
+  std::vector<R, OverwriteAllocator<R>> Records(3000);
+  for (std::size_t Offset : {0, 1, 3, 13}) {
+    for (std::size_t N : {0, 1, 7, 64, 1000, 2987}) {
+      std::memset(static_cast<void *>(Records.data()), 0xff,
+                  Records.size() * sizeof(R));
+      fillDefault(Records.data() + Offset, N, 1);
+      for (std::size_t I = 0; I < Records.size(); ++I) {
+        const bool Filled = I >= Offset && I < Offset + N;
+        REQUIRE((Records[I].Data == Default.Data) == Filled);
+      }
+    }
+  }
+
+  // non-temporal stores on several threads
+  constexpr std::size_t Huge = (std::size_t{1} << 25) / sizeof(R) + 5;
+  std::vector<R, OverwriteAllocator<R>> Large(Huge);
+  fillDefault(Large.data() + 1, Huge - 1, 4);
+  for (std::size_t I = 1; I < Huge; ++I) {
+    REQUIRE(Large[I].Data == Default.Data);
+  }
+
+  auto Array = makeDefaultArray<R>(1234);
+  for (std::size_t I = 0; I < 1234; ++I) {
+    REQUIRE(Array[I].Data == Default.Data);
+  }
+}
+
+TEST_CASE("Default fill test for large and zero records", "[Memory][RefByEnum]") {
+  // 65-byte records repeat every 4160 bytes and are copied one by one
+  using Large = BitField<std::uint8_t, RefByEnum::Field<Tag::A, 512, 7>,
+                         RefByEnum::Field<Tag::B, 8, 0x81>>;
+  const Large LargeDefault;
+  REQUIRE(sizeof(Large) == 65);
+  auto L = makeDefaultArray<Large>(100);
+  for (std::size_t I = 0; I < 100; ++I) {
+    REQUIRE(L[I].Data == LargeDefault.Data);
+  }
+
+  using Zero = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 12>,
+                        RefByEnum::Field<Tag::B, 30>>;
+  static_assert(Util::isZeroDefault<Zero>());
+  static_assert(!Util::isZeroDefault<Large>());
+  auto Z = makeDefaultArray<Zero>(std::size_t{1} << 20);
+  for (std::size_t I = 0; I < (std::size_t{1} << 20); I += 4093) {
+    REQUIRE(Z[I].Data == Zero{}.Data);
+  }
+  get<Tag::B>(Z[5]) = 3;
+  fillDefault(Z.get(), 10);
+  REQUIRE(get<Tag::B>(Z[5]) == 0);
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Uninitialized construction test (RefByStr)", "[Memory][RefByStr]") {
+  using R = BitField<std::uint32_t, RefByStr::Field<"a", 12, 34>,
+                     RefByStr::Field<"b", 20>>;
+  static_assert(std::is_trivially_copyable_v<R>);
+  auto Records = makeForOverwrite<R>(3);
+  for (std::size_t I = 0; I < 3; ++I) {
+    Records[I] = R{};
+    get<"b">(Records[I]) = static_cast<std::uint32_t>(I);
+  }
+  REQUIRE(get<"a">(Records[2]) == 34);
+  REQUIRE(get<"b">(Records[2]) == 2);
+}
+#endif
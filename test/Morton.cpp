@@ -0,0 +1,115 @@
+//===-- test/Morton.cpp - Test for Morton keys ------------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of Morton (Z-order) key construction.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Morton.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { X, Y, Z, T };
+
+// reference implementation: interleave bit by bit
+static std::uint64_t naiveKey(const std::vector<std::uint64_t> &Values,
+                              const std::vector<std::size_t> &Widths) {
+  std::uint64_t Key = 0;
+  std::size_t Pos = 0;
+  for (std::size_t B = 0; B < 64; ++B) {
+    for (std::size_t I = 0; I < Values.size(); ++I) {
+      if (B < Widths[I]) {
+        Key |= (Values[I] >> B & 1) << Pos++;
+      }
+    }
+  }
+  return Key;
+}
+
+TEST_CASE("Bit spreading helpers", "[Morton]") {
+  for (std::uint64_t V : {0ull, 1ull, 0x12345ull, 0x1fffffull}) {
+    REQUIRE(Util::compactBits2(Util::spreadBits2(V)) == V);
+    REQUIRE(Util::compactBits3(Util::spreadBits3(V)) == V);
+    REQUIRE(Util::spreadBits2(V) == Util::depositBits(V, 0x5555555555555555));
+    REQUIRE(Util::spreadBits3(V) == Util::depositBits(V, 0x1249249249249249));
+    REQUIRE(Util::extractBits(Util::spreadBits3(V), 0x1249249249249249) == V);
+  }
+}
+
+TEST_CASE("Morton key test", "[Morton][RefByEnum]") {
+  using P = BitField<std::uint32_t, RefByEnum::Field<Tag::X, 10>,
+                     RefByEnum::Field<Tag::Y, 10>, RefByEnum::Field<Tag::Z, 10>,
+                     RefByEnum::Field<Tag::T, 5>>;
+  std::vector<P> Points(64);
+  std::uint64_t Seed = 12345;
+  for (auto &Pt : Points) {
+    Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+    get<Tag::X>(Pt) = static_cast<std::uint32_t>(Seed >> 20);
+    get<Tag::Y>(Pt) = static_cast<std::uint32_t>(Seed >> 30);
+    get<Tag::Z>(Pt) = static_cast<std::uint32_t>(Seed >> 40);
+    get<Tag::T>(Pt) = static_cast<std::uint32_t>(Seed >> 50);
+  }
+
+  SECTION("uniform widths") {
+    for (const auto &Pt : Points) {
+      const std::uint64_t Key = mortonKey<Tag::X, Tag::Y, Tag::Z>(Pt);
+      REQUIRE(Key == naiveKey({get<Tag::X>(Pt), get<Tag::Y>(Pt),
+                               get<Tag::Z>(Pt)},
+                              {10, 10, 10}));
+      P Q;
+      fromMortonKey<Tag::X, Tag::Y, Tag::Z>(Q, Key);
+      REQUIRE(get<Tag::X>(Q) == get<Tag::X>(Pt));
+      REQUIRE(get<Tag::Y>(Q) == get<Tag::Y>(Pt));
+      REQUIRE(get<Tag::Z>(Q) == get<Tag::Z>(Pt));
+      REQUIRE(get<Tag::T>(Q) == 0);
+    }
+  }
+
+  SECTION("mixed widths") {
+    for (const auto &Pt : Points) {
+      const std::uint64_t Key = mortonKey<Tag::T, Tag::X, Tag::Y>(Pt);
+      REQUIRE(Key == naiveKey({get<Tag::T>(Pt), get<Tag::X>(Pt),
+                               get<Tag::Y>(Pt)},
+                              {5, 10, 10}));
+      P Q;
+      fromMortonKey<Tag::T, Tag::X, Tag::Y>(Q, Key);
+      REQUIRE(get<Tag::T>(Q) == get<Tag::T>(Pt));
+      REQUIRE(get<Tag::X>(Q) == get<Tag::X>(Pt));
+      REQUIRE(get<Tag::Y>(Q) == get<Tag::Y>(Pt));
+    }
+  }
+
+  SECTION("bulk") {
+    std::vector<std::uint64_t> Keys(Points.size());
+    mortonKeys<Tag::X, Tag::Y>(Points.data(), Points.size(), Keys.data());
+    for (std::size_t I = 0; I < Points.size(); ++I) {
+      REQUIRE(Keys[I] == mortonKey<Tag::X, Tag::Y>(Points[I]));
+    }
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Morton key test (RefByStr)", "[Morton][RefByStr]") {
+  using P = BitField<std::uint16_t, RefByStr::Field<"x", 8>,
+                     RefByStr::Field<"y", 8>>;
+  P Pt;
+  get<"x">(Pt) = 0b1111;
+  get<"y">(Pt) = 0b0000;
+  REQUIRE(mortonKey<"x", "y">(Pt) == 0b01010101);
+  REQUIRE(mortonKey<"y", "x">(Pt) == 0b10101010);
+  fromMortonKey<"y", "x">(Pt, 0b0011);
+  REQUIRE(get<"y">(Pt) == 0b01);
+  REQUIRE(get<"x">(Pt) == 0b01);
+}
+#endif
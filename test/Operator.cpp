@@ -15,6 +15,7 @@
 #include "OrderedBitField/OrderedBitField.hpp"
 
 #include <cstddef>
+#include <cstdint>
 
 #include <catch2/catch_template_test_macros.hpp>
 #include <catch2/generators/catch_generators_range.hpp>
@@ -220,3 +221,47 @@ TEMPLATE_TEST_CASE("Arithmetic operators test", "[Operator]", std::byte,
     }
   }
 }
+
+TEST_CASE("Operators in constant expressions test", "[Operator]") {
+  // the same operations on fields at different positions, evaluated at
+  // compile time and at run time
+  using R1 = BitField<std::uint16_t, RefByEnum::Field<Tag::A, 4>,
+                      RefByEnum::Field<Tag::B, 4>>;
+  using R2 = BitField<std::uint16_t, RefByEnum::Field<Tag::A, 4, 3>,
+                      RefByEnum::Field<Tag::B, 12>>;
+  constexpr auto Apply = [](auto BF) {
+    get<Tag::A>(BF) = 9;
+    get<Tag::A>(BF) += 8;
+    get<Tag::A>(BF) *= 3;
+    get<Tag::A>(BF) |= 8;
+    get<Tag::A>(BF) ^= 5;
+    get<Tag::A>(BF) <<= 1;
+    get<Tag::A>(BF) >>= 2;
+    ++get<Tag::A>(BF);
+    return static_cast<std::uint16_t>(get<Tag::A>(BF));
+  };
+  // 9, 1, 3, 11, 14, 12, 3, 4
+  constexpr std::uint16_t Expected = 4;
+  STATIC_REQUIRE(Apply(R1()) == Expected);
+  STATIC_REQUIRE(Apply(R2()) == Expected);
+  REQUIRE(Apply(R1()) == Apply(R2()));
+}
+
+TEST_CASE("Signed 64-bit base test", "[Operator]") {
+  using R = BitField<std::int64_t, RefByEnum::Field<Tag::A, 40>,
+                     RefByEnum::Field<Tag::B, 20>>;
+  R BF;
+  get<Tag::A>(BF) = -5;
+  get<Tag::B>(BF) = -3;
+  REQUIRE(get<Tag::A>(BF) == -5);
+  REQUIRE(get<Tag::B>(BF) == -3);
+
+  get<Tag::A>(BF) = (std::int64_t{1} << 39) - 1;
+  get<Tag::B>(BF) >>= 1;
+  REQUIRE(get<Tag::A>(BF) == (std::int64_t{1} << 39) - 1);
+  REQUIRE(get<Tag::B>(BF) == -2);
+
+  get<Tag::A>(BF) += 1;
+  REQUIRE(get<Tag::A>(BF) == -(std::int64_t{1} << 39));
+  REQUIRE(get<Tag::B>(BF) == -2);
+}
@@ -0,0 +1,134 @@
+//===-- test/RecordFile.cpp - Test for bulk file I/O ------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of bulk file I/O of record arrays.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/RecordFile.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C };
+
+// unlinked temporary file on the disk, which supports direct I/O
+struct TempFile {
+  TempFile() {
+    char Path[] = "/tmp/OrderedBitFieldXXXXXX";
+    Fd = ::mkstemp(Path);
+    ::unlink(Path);
+  }
+  ~TempFile() { ::close(Fd); }
+  int Fd;
+};
+
+TEMPLATE_TEST_CASE("Record file test", "[RecordFile][RefByEnum]",
+                   std::uint8_t, std::uint16_t, std::uint32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5, 3>,
+                     RefByEnum::Field<Tag::B, 17>, RefByEnum::Field<Tag::C, 9>>;
+  // not a multiple of the chunks or the blocks
+  const std::size_t N = 100003 / sizeof(R);
+  std::vector<R> Ref(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::B>(Ref[I]) = static_cast<TestType>(I * 7);
+    get<Tag::C>(Ref[I]) = static_cast<TestType>(I);
+  }
+
+  std::vector<RecordFileBackend> Backends = {RecordFileBackend::Auto,
+                                             RecordFileBackend::Threads};
+  if (Util::uringAvailable()) {
+    Backends.push_back(RecordFileBackend::Uring);
+  }
+  for (RecordFileBackend Backend : Backends) {
+    for (bool Direct : {false, true}) {
+      for (std::uint64_t Offset : {std::uint64_t{0}, std::uint64_t{8192},
+                                   std::uint64_t{5}}) {
+        RecordFileOptions Options;
+        Options.Backend = Backend;
+        Options.ChunkBytes = 10000;
+        Options.QueueDepth = 3;
+        Options.Direct = Direct;
+        TempFile F;
+        REQUIRE(F.Fd >= 0);
+        writeRecords(F.Fd, Ref.data(), N, Offset, Options);
+        REQUIRE(::lseek(F.Fd, 0, SEEK_END) ==
+                static_cast<off_t>(Offset + N * sizeof(R)));
+        std::vector<R> Out(N);
+        readRecords(F.Fd, Out.data(), N, Offset, Options);
+        for (std::size_t I = 0; I < N; ++I) {
+          REQUIRE(Out[I].Data == Ref[I].Data);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Record file test for errors", "[RecordFile][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 20>,
+                     RefByEnum::Field<Tag::B, 12>>;
+  std::vector<R> Records(5000);
+  for (RecordFileBackend Backend :
+       {RecordFileBackend::Auto, RecordFileBackend::Threads}) {
+    RecordFileOptions Options;
+    Options.Backend = Backend;
+    Options.ChunkBytes = 4096;
+    TempFile F;
+    writeRecords(F.Fd, Records.data(), 3000, 0, Options);
+    // beyond the end of the file
+    REQUIRE_THROWS_AS(readRecords(F.Fd, Records.data(), 5000, 0, Options),
+                      std::system_error);
+    // not a file
+    REQUIRE_THROWS_AS(writeRecords(-1, Records.data(), 5000, 0, Options),
+                      std::system_error);
+    readRecords(F.Fd, Records.data(), 0, 1 << 20, Options);
+  }
+
+  std::vector<RecordFileBackend> Backends = {RecordFileBackend::Auto,
+                                             RecordFileBackend::Threads};
+  if (Util::uringAvailable()) {
+    Backends.push_back(RecordFileBackend::Uring);
+  }
+  for (RecordFileBackend Backend : Backends) {
+    RecordFileOptions Options;
+    Options.Backend = Backend;
+    Options.ChunkBytes = 4096 * 3;
+    Options.Direct = true;
+    TempFile F;
+    writeRecords(F.Fd, Records.data(), 3000, 0, Options);
+    // direct reads ending short of the blocks at the end of the file
+    try {
+      readRecords(F.Fd, Records.data(), 5000, 0, Options);
+      FAIL("no error beyond the end of the file");
+    } catch (const std::system_error &E) {
+      REQUIRE(E.code().value() == EIO);
+    }
+  }
+
+  // deeper than io_uring allows, which falls back to threads
+  RecordFileOptions Deep;
+  Deep.QueueDepth = 1u << 20;
+  TempFile F;
+  writeRecords(F.Fd, Records.data(), 5000, 0, Deep);
+  std::vector<R> Out(5000);
+  readRecords(F.Fd, Out.data(), 5000, 0, Deep);
+  REQUIRE(Out.size() == Records.size());
+}
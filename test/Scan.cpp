@@ -0,0 +1,110 @@
+//===-- test/Scan.cpp - Test for prefix sum over records --------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of column extraction and prefix sum over an
+/// array of BitField records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Scan.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { Len, Offset, Flag };
+
+TEMPLATE_TEST_CASE("Column extraction test", "[Column][RefByEnum]",
+                   std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t,
+                   std::int32_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::Flag, 1>,
+                     RefByEnum::Field<Tag::Len, 5>,
+                     RefByEnum::Field<Tag::Offset, 7>>;
+  const std::size_t N = 1000;
+  std::vector<R> Records(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::Len>(Records[I]) = static_cast<TestType>(I % 13);
+    get<Tag::Flag>(Records[I]) = static_cast<TestType>(I % 2);
+  }
+
+  std::vector<long> Len(N);
+  extractColumn<Tag::Len>(Records.data(), N, Len.data());
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(Len[I] == static_cast<long>(get<Tag::Len>(Records[I])));
+  }
+
+  std::vector<int> Offset(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    Offset[I] = static_cast<int>(I % 50);
+  }
+  storeColumn<Tag::Offset>(Records.data(), N, Offset.data());
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(get<Tag::Offset>(Records[I]) == static_cast<TestType>(I % 50));
+    REQUIRE(get<Tag::Len>(Records[I]) == static_cast<TestType>(I % 13));
+  }
+}
+
+TEST_CASE("Exclusive scan test", "[Scan][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::Len, 12>,
+                     RefByEnum::Field<Tag::Offset, 20>>;
+  const std::size_t N = GENERATE(0, 1, 300, 200000);
+  const unsigned NThreads = GENERATE(1u, 3u);
+  std::vector<R> Records(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::Len>(Records[I]) = static_cast<std::uint32_t>(I * 7 % 4096);
+  }
+
+  std::vector<std::uint64_t> Expected(N);
+  std::uint64_t Sum = 0;
+  for (std::size_t I = 0; I < N; ++I) {
+    Expected[I] = Sum;
+    Sum += I * 7 % 4096;
+  }
+
+  SECTION("into a column") {
+    std::vector<std::uint64_t> Out(N);
+    REQUIRE(exclusiveScan<Tag::Len>(Records.data(), N, Out.data(),
+                                    NThreads) == Sum);
+    REQUIRE(Out == Expected);
+  }
+
+  SECTION("into a field") {
+    REQUIRE(exclusiveScanInto<Tag::Len, Tag::Offset>(Records.data(), N,
+                                                     NThreads) == Sum);
+    for (std::size_t I = 0; I < N; ++I) {
+      REQUIRE(get<Tag::Offset>(Records[I]) == (Expected[I] & 0xfffff));
+      REQUIRE(get<Tag::Len>(Records[I]) == I * 7 % 4096);
+    }
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Exclusive scan test (RefByStr)", "[Scan][RefByStr]") {
+  using R = BitField<std::uint64_t, RefByStr::Field<"len", 12>,
+                     RefByStr::Padding<4>, RefByStr::Field<"offset", 40>>;
+  const std::size_t N = 1000;
+  std::vector<R> Records(N);
+  std::uint64_t Sum = 0;
+  for (std::size_t I = 0; I < N; ++I) {
+    get<"len">(Records[I]) = I;
+    Sum += I;
+  }
+  std::vector<std::uint64_t> Out(N);
+  REQUIRE(exclusiveScan<"len">(Records.data(), N, Out.data()) == Sum);
+  REQUIRE(exclusiveScanInto<"len", "offset">(Records.data(), N) == Sum);
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(Out[I] == I * (I - 1) / 2);
+    REQUIRE(get<"offset">(Records[I]) == Out[I]);
+  }
+}
+#endif
@@ -0,0 +1,110 @@
+//===-- test/Scatter.cpp - Test for batched random-access updates -*- C++ -*-=//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of batched random-access updates of records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Checksum.hpp"
+#include "OrderedBitField/Scatter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, Sum };
+
+template <class ValueT>
+std::vector<FieldUpdate<ValueT>> randomUpdates(std::size_t N, std::size_t M,
+                                               unsigned Seed) {
+  std::mt19937 Rng(Seed);
+  std::vector<FieldUpdate<ValueT>> Updates(N);
+  for (auto &U : Updates) {
+    // a small hot set makes many duplicates
+    U.Index = Rng() % 4 == 0 ? Rng() % 16 : Rng() % M;
+    U.Value = static_cast<ValueT>(Rng());
+  }
+  return Updates;
+}
+
+TEMPLATE_TEST_CASE("Scatter update test", "[Scatter][RefByEnum]",
+                   std::uint8_t, std::uint16_t, std::int32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5, 3>,
+                     RefByEnum::Field<Tag::B, 7>, RefByEnum::Field<Tag::C, 6>>;
+  // 600000 updates fill the buffer of each partition several times
+  for (std::size_t N :
+       {std::size_t{100}, std::size_t{150000}, std::size_t{600000}}) {
+    constexpr std::size_t M = 300000;
+    const auto Updates = randomUpdates<TestType>(N, M, 7);
+    for (unsigned NThreads : {1u, 4u}) {
+      std::vector<R> Last(M), Sum(M), Max(M);
+      std::vector<R> RefLast(M), RefSum(M), RefMax(M);
+      for (const auto &U : Updates) {
+        get<Tag::B>(RefLast[U.Index]) = U.Value;
+        get<Tag::B>(RefSum[U.Index]) += U.Value;
+        R V;
+        get<Tag::B>(V) = U.Value;
+        if (get<Tag::B>(V) > get<Tag::B>(RefMax[U.Index])) {
+          get<Tag::B>(RefMax[U.Index]) = U.Value;
+        }
+      }
+      scatterUpdate<Tag::B>(Last.data(), Updates.data(), N, NThreads);
+      scatterUpdate<Tag::B, Duplicate::Sum>(Sum.data(), Updates.data(), N,
+                                            NThreads);
+      scatterUpdate<Tag::B, Duplicate::Max>(Max.data(), Updates.data(), N,
+                                            NThreads, 0);
+      for (std::size_t I = 0; I < M; ++I) {
+        REQUIRE(Last[I].Data == RefLast[I].Data);
+        REQUIRE(Sum[I].Data == RefSum[I].Data);
+        REQUIRE(Max[I].Data == RefMax[I].Data);
+      }
+    }
+  }
+}
+
+TEST_CASE("Scatter update test for guarded records", "[Scatter][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 16>,
+                     RefByEnum::ChecksumField<Tag::Sum>,
+                     RefByEnum::Field<Tag::B, 20>>;
+  constexpr std::size_t M = 50000;
+  constexpr std::size_t N = 100000;
+  const auto Updates = randomUpdates<std::uint32_t>(N, M, 3);
+  std::vector<R> Records(M);
+  scatterUpdate<Tag::B, Duplicate::Sum>(Records.data(), Updates.data(), N, 2);
+  std::vector<std::uint32_t> Ref(M);
+  for (const auto &U : Updates) {
+    Ref[U.Index] += U.Value;
+  }
+  for (std::size_t I = 0; I < M; ++I) {
+    REQUIRE(verifyChecksum(Records[I]));
+    REQUIRE(get<Tag::B>(Records[I]) == Ref[I] % (1u << 20));
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Scatter update test (RefByStr)", "[Scatter][RefByStr]") {
+  using R = BitField<std::uint16_t, RefByStr::Field<"hits", 10>,
+                     RefByStr::Field<"seen", 1>>;
+  std::vector<R> Records(32);
+  const FieldUpdate<int> Updates[] = {{3, 1}, {5, 1}, {3, 1}, {31, 1}};
+  scatterUpdate<"hits", Duplicate::Sum>(Records.data(), Updates, 4);
+  scatterUpdate<"seen">(Records.data(), Updates, 4);
+  REQUIRE(get<"hits">(Records[3]) == 2);
+  REQUIRE(get<"hits">(Records[31]) == 1);
+  REQUIRE(get<"seen">(Records[5]) == 1);
+  REQUIRE(get<"seen">(Records[4]) == 0);
+}
+#endif
@@ -0,0 +1,147 @@
+//===-- test/Segmented.cpp - Test for segmented buffers ---------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of records in segmented buffers.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Checksum.hpp"
+#include "OrderedBitField/Segmented.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { A, B, C, D, Sum };
+
+// split Bytes into segments of 1, 2, ..., 13 bytes with empty ones between
+std::vector<Segment> split(unsigned char *Bytes, std::size_t Len) {
+  std::vector<Segment> Segs;
+  for (std::size_t Off = 0, K = 0; Off < Len; ++K) {
+    const std::size_t N = std::min(K % 13 + 1, Len - Off);
+    Segs.push_back({Bytes + Off, N});
+    Segs.push_back({nullptr, 0});
+    Off += N;
+  }
+  return Segs;
+}
+
+TEMPLATE_TEST_CASE("Segmented view test", "[Segmented][RefByEnum]",
+                   std::uint8_t, std::uint16_t, std::int32_t,
+                   std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5, 3>,
+                     RefByEnum::ConstField<Tag::B, 3, 5>,
+                     RefByEnum::Field<Tag::C, 7>,
+                     RefByEnum::Field<Tag::D, 6, 0x21>>;
+  constexpr std::size_t N = 61;
+  std::vector<R> Ref(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::A>(Ref[I]) = static_cast<TestType>(I);
+    get<Tag::C>(Ref[I]) = static_cast<TestType>(I * 7);
+  }
+  std::vector<unsigned char> Bytes(N * sizeof(R));
+  std::memcpy(Bytes.data(), static_cast<const void *>(Ref.data()),
+              Bytes.size());
+  const std::vector<Segment> Segs = split(Bytes.data(), Bytes.size());
+
+  SegmentedView<R> View(Segs.data(), Segs.size());
+  REQUIRE(View.bytes() == Bytes.size());
+  REQUIRE(View.size() == N);
+  std::size_t Split = 0;
+  for (std::size_t I = 0; I < N; ++I) {
+    const auto Rec = View[I];
+    Split += !Rec.contiguous();
+    REQUIRE(get<Tag::A>(Rec) == get<Tag::A>(Ref[I]));
+    REQUIRE(get<Tag::B>(Rec) == get<Tag::B>(Ref[I]));
+    REQUIRE(get<Tag::C>(Rec) == get<Tag::C>(Ref[I]));
+    REQUIRE(get<Tag::D>(Rec) == get<Tag::D>(Ref[I]));
+    REQUIRE(Rec.load().Data == Ref[I].Data);
+    if (Rec.contiguous()) {
+      REQUIRE(Rec.direct() ==
+              reinterpret_cast<R *>(Bytes.data() + I * sizeof(R)));
+    } else {
+      REQUIRE(Rec.direct() == nullptr);
+    }
+  }
+  REQUIRE(Split > 0);
+
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::C>(View[I]) = static_cast<TestType>(I * 3 + 1);
+    get<Tag::D>(View[I]) = get<Tag::A>(View[I]);
+    get<Tag::C>(Ref[I]) = static_cast<TestType>(I * 3 + 1);
+    get<Tag::D>(Ref[I]) = static_cast<TestType>(get<Tag::A>(Ref[I]));
+  }
+  REQUIRE(std::memcmp(Bytes.data(), static_cast<const void *>(Ref.data()),
+                      Bytes.size()) == 0);
+
+  // whole records, at unaligned offsets
+  R X;
+  get<Tag::A>(X) = 17;
+  get<Tag::C>(X) = 33;
+  View.at(3).store(X);
+  REQUIRE(View.at(3).load().Data == X.Data);
+  REQUIRE(get<Tag::C>(View.at(3)) == 33);
+
+  // read-only view
+  SegmentedView<const R> ConstView(Segs.data(), Segs.size());
+  REQUIRE(get<Tag::C>(ConstView.at(3)) == 33);
+}
+
+TEST_CASE("Segmented view test for guarded records",
+          "[Segmented][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 16>,
+                     RefByEnum::ChecksumField<Tag::Sum>,
+                     RefByEnum::Field<Tag::B, 20>>;
+  constexpr std::size_t N = 23;
+  std::vector<R> Ref(N);
+  std::vector<unsigned char> Bytes(N * sizeof(R));
+  std::memcpy(Bytes.data(), static_cast<const void *>(Ref.data()),
+              Bytes.size());
+  const std::vector<Segment> Segs = split(Bytes.data(), Bytes.size());
+  SegmentedView<R> View(Segs.data(), Segs.size());
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::B>(View[I]) = static_cast<std::uint32_t>(I * 12345);
+    REQUIRE(verifyChecksum(View[I].load()));
+    REQUIRE(get<Tag::B>(View[I]) == I * 12345);
+  }
+
+  // segments laid out as iovec
+  struct IoVec {
+    void *iov_base;
+    std::size_t iov_len;
+  };
+  std::vector<IoVec> Vecs;
+  for (const Segment &S : Segs) {
+    Vecs.push_back({S.Base, S.Len});
+  }
+  SegmentedView<const R, IoVec> VecView(Vecs.data(), Vecs.size());
+  for (std::size_t I = 0; I < N; ++I) {
+    REQUIRE(get<Tag::B>(VecView[I]) == I * 12345);
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Segmented view test (RefByStr)", "[Segmented][RefByStr]") {
+  using R = BitField<std::uint16_t, RefByStr::Field<"a", 9>,
+                     RefByStr::Field<"b", 9>>;
+  unsigned char Bytes[3 * sizeof(R)] = {};
+  Segment Segs[] = {{Bytes, 5}, {Bytes + 5, sizeof(Bytes) - 5}};
+  SegmentedView<R> View(Segs, 2);
+  get<"b">(View[1]) = 300;
+  REQUIRE(!View[1].contiguous());
+  REQUIRE(get<"b">(View[1]) == 300);
+  REQUIRE(get<"a">(View[1]) == 0);
+}
+#endif
@@ -0,0 +1,159 @@
+//===-- test/SlotAllocator.cpp - Test for slot allocator --------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of the lock-free slot allocator.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/SlotAllocator.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace OrderedBitField;
+enum class Tag { Owner, Free };
+
+TEMPLATE_TEST_CASE("Slot allocator test", "[SlotAllocator][RefByEnum]",
+                   std::uint8_t, std::uint32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::Owner, 5>,
+                     RefByEnum::Field<Tag::Free, 1, 1>>;
+  constexpr std::size_t N = 150;
+  std::vector<R> Slots(N);
+  get<Tag::Free>(Slots[3]) = 0;
+  auto Alloc = makeSlotAllocator<Tag::Free>(Slots.data(), N);
+  REQUIRE(Alloc.size() == N);
+  REQUIRE(!Alloc.isFree(3));
+
+  std::set<std::size_t> Claimed;
+  for (std::size_t I = 0; I + 1 < N; ++I) {
+    const std::size_t S = Alloc.allocate(I * 37);
+    REQUIRE(S < N);
+    REQUIRE(S != 3);
+    REQUIRE(get<Tag::Free>(Slots[S]) == 0);
+    REQUIRE(Claimed.insert(S).second);
+  }
+  REQUIRE(Alloc.allocate() == N);
+
+  Alloc.release(100);
+  Alloc.release(7);
+  REQUIRE(get<Tag::Free>(Slots[7]) == 1);
+  REQUIRE(Alloc.allocate(50) == 100);
+  REQUIRE(Alloc.allocate(50) == 7);
+  REQUIRE(Alloc.allocate(50) == N);
+}
+
+TEST_CASE("Concurrent slot allocator test", "[SlotAllocator][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::Owner, 31>,
+                     RefByEnum::Field<Tag::Free, 1, 1>>;
+  constexpr std::size_t N = 1000;
+  constexpr unsigned NThreads = 8;
+  std::vector<R> Slots(N);
+  auto Alloc = makeSlotAllocator<Tag::Free>(Slots.data(), N);
+  std::vector<std::atomic<int>> Users(N);
+  std::atomic<bool> Overlap{false};
+
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T < NThreads; ++T) {
+    Threads.emplace_back([&] {
+      std::vector<std::size_t> Mine;
+      for (int Round = 0; Round < 2000; ++Round) {
+        if (Mine.size() < 200 && Round % 3 != 2) {
+          const std::size_t S = Alloc.allocate();
+          if (S < N) {
+            if (Users[S].fetch_add(1) != 0) {
+              Overlap = true;
+            }
+            Mine.push_back(S);
+          }
+        } else if (!Mine.empty()) {
+          const std::size_t S = Mine.back();
+          Mine.pop_back();
+          Users[S].fetch_sub(1);
+          Alloc.release(S);
+        }
+      }
+      for (std::size_t S : Mine) {
+        Users[S].fetch_sub(1);
+        Alloc.release(S);
+      }
+    });
+  }
+  for (auto &Th : Threads) {
+    Th.join();
+  }
+  REQUIRE(!Overlap);
+
+  // all slots are free again and can be claimed exactly once
+  std::set<std::size_t> Claimed;
+  for (std::size_t I = 0; I < N; ++I) {
+    const std::size_t S = Alloc.allocate(I);
+    REQUIRE(S < N);
+    REQUIRE(Claimed.insert(S).second);
+  }
+  REQUIRE(Alloc.allocate() == N);
+}
+
+TEST_CASE("Concurrent slot allocator test with a neighbouring field",
+          "[SlotAllocator][RefByEnum]") {
+  // the owner field shares the storage unit with the free field
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::Owner, 31>,
+                     RefByEnum::Field<Tag::Free, 1, 1>>;
+  constexpr std::size_t N = 64;
+  constexpr unsigned NThreads = 4;
+  std::vector<R> Slots(N);
+  auto Alloc = makeSlotAllocator<Tag::Free>(Slots.data(), N);
+  std::atomic<bool> Lost{false};
+
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T < NThreads; ++T) {
+    Threads.emplace_back([&, T] {
+      for (std::uint32_t Round = 0; Round < 5000; ++Round) {
+        const std::size_t S = Alloc.allocate(0);
+        if (S == N) {
+          continue;
+        }
+        const std::uint32_t Id = T << 16 | (Round & 0xffff);
+        Alloc.modify(S, [&](R &Rec) { get<Tag::Owner>(Rec) = Id; });
+        const R Mine = Alloc.load(S);
+        if (get<Tag::Owner>(Mine) != Id || get<Tag::Free>(Mine) != 0) {
+          Lost = true;
+        }
+        Alloc.release(S);
+      }
+    });
+  }
+  for (auto &Th : Threads) {
+    Th.join();
+  }
+  REQUIRE(!Lost);
+  for (std::size_t S = 0; S < N; ++S) {
+    REQUIRE(Alloc.isFree(S));
+  }
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Slot allocator test (RefByStr)", "[SlotAllocator][RefByStr]") {
+  using R = BitField<std::uint16_t, RefByStr::Field<"free", 1, 1>,
+                     RefByStr::Field<"id", 15>>;
+  std::vector<R> Slots(70);
+  auto Alloc = makeSlotAllocator<"free">(Slots.data(), Slots.size());
+  REQUIRE(Alloc.allocate(69) == 69);
+  REQUIRE(Alloc.allocate(69) == 0);
+  Alloc.release(69);
+  REQUIRE(Alloc.isFree(69));
+}
+#endif
@@ -0,0 +1,177 @@
+//===-- test/Stream.cpp - Test for streaming decoder ------------*- C++ -*-===//
+//
+// Under the Apache License v2.0 and MIT License.
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains unit test of streaming decoder of records.
+///
+/// \author Haru-T <htgeek.with.insight+com.github@googlemail.com>
+///
+//===----------------------------------------------------------------------===//
+
+#include "OrderedBitField/Stream.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+using namespace OrderedBitField;
+enum class Tag { A, B, C };
+
+// coroutine started eagerly and destroyed at its end
+struct Task {
+  struct promise_type {
+    Task get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+// push the bytes in chunks of 1, 2, ..., 3 * Size + 4 bytes, copied into a
+// ring of NBufs buffers which are refilled when push() resumes
+template <class BitFieldT>
+Task produce(StreamDecoder<BitFieldT> &D, const std::vector<unsigned char> &In,
+             std::size_t NBufs, std::size_t &MaxHeld) {
+  constexpr std::size_t Limit = 3 * sizeof(BitFieldT) + 4;
+  std::vector<std::vector<unsigned char>> Bufs(NBufs,
+                                               std::vector<unsigned char>(
+                                                   Limit));
+  for (std::size_t Off = 0, K = 0; Off < In.size(); ++K) {
+    const std::size_t Len = std::min(K % Limit + 1, In.size() - Off);
+    auto &Buf = Bufs[K % NBufs];
+    std::memcpy(Buf.data(), In.data() + Off, Len);
+    co_await D.push(Buf.data(), Len);
+    MaxHeld = std::max(MaxHeld, D.heldChunks());
+    Off += Len;
+    // scribble over the buffer if the decoder released it early
+    std::memset(Bufs[(K + 1) % NBufs].data(), 0xa5, Limit);
+  }
+  // the buffers go away with the coroutine
+  co_await D.close();
+}
+
+template <class BitFieldT>
+Task consume(StreamDecoder<BitFieldT> &D, std::vector<BitFieldT> &Out,
+             std::size_t &NBatches) {
+  for (;;) {
+    const RecordBatch<BitFieldT> Batch = co_await D.next();
+    if (Batch.empty()) {
+      break;
+    }
+    ++NBatches;
+    for (std::size_t K = 0; K < Batch.size(); ++K) {
+      Out.push_back(Batch[K].load());
+    }
+  }
+}
+
+TEMPLATE_TEST_CASE("Stream decoder test", "[Stream][RefByEnum]", std::uint8_t,
+                   std::uint16_t, std::int32_t, std::uint64_t) {
+  using R = BitField<TestType, RefByEnum::Field<Tag::A, 5, 3>,
+                     RefByEnum::Field<Tag::B, 17>, RefByEnum::Field<Tag::C, 9>>;
+  constexpr std::size_t N = 500;
+  std::vector<R> Ref(N);
+  for (std::size_t I = 0; I < N; ++I) {
+    get<Tag::B>(Ref[I]) = static_cast<TestType>(I * 7);
+    get<Tag::C>(Ref[I]) = static_cast<TestType>(I);
+  }
+  std::vector<unsigned char> In(N * sizeof(R));
+  std::memcpy(In.data(), static_cast<const void *>(Ref.data()), In.size());
+
+  for (std::size_t NBufs : {std::size_t{1}, std::size_t{3}}) {
+    for (bool ConsumerFirst : {true, false}) {
+      StreamDecoder<R> D(NBufs, 3);
+      std::vector<R> Out;
+      std::size_t NBatches = 0;
+      std::size_t MaxHeld = 0;
+      if (ConsumerFirst) {
+        consume(D, Out, NBatches);
+        produce(D, In, NBufs, MaxHeld);
+      } else {
+        produce(D, In, NBufs, MaxHeld);
+        consume(D, Out, NBatches);
+      }
+      REQUIRE(MaxHeld < NBufs);
+      REQUIRE(Out.size() == N);
+      REQUIRE(NBatches > N / 3);
+      for (std::size_t I = 0; I < N; ++I) {
+        REQUIRE(Out[I].Data == Ref[I].Data);
+      }
+      REQUIRE(D.pendingBytes() == 0);
+    }
+  }
+}
+
+TEST_CASE("Stream decoder test for incomplete record", "[Stream][RefByEnum]") {
+  using R = BitField<std::uint32_t, RefByEnum::Field<Tag::A, 20>,
+                     RefByEnum::Field<Tag::B, 12>,
+                     RefByEnum::Field<Tag::C, 32>>;
+  R Recs[3];
+  get<Tag::A>(Recs[0]) = 11;
+  get<Tag::A>(Recs[1]) = 22;
+  alignas(R) unsigned char In[sizeof(Recs)];
+  std::memcpy(In, static_cast<const void *>(Recs), sizeof(In));
+
+  // producer which is not a coroutine
+  StreamDecoder<R> D(2);
+  std::vector<R> Out;
+  std::size_t NBatches = 0;
+  consume(D, Out, NBatches);
+  D.push(In, 2);
+  REQUIRE(Out.empty());
+  D.push(In + 2, sizeof(R) + 4);
+  REQUIRE(Out.size() == 1);
+  REQUIRE(get<Tag::A>(Out[0]) == 11);
+  D.push(In + sizeof(R) + 6, 3);
+  REQUIRE(Out.size() == 2);
+  REQUIRE(get<Tag::A>(Out[1]) == 22);
+  REQUIRE(!D.full());
+  D.close();
+  REQUIRE(D.pendingBytes() == 1);
+  REQUIRE(D.heldChunks() == 0);
+
+  // records in place in an aligned chunk
+  StreamDecoder<R> E;
+  E.push(In, sizeof(In));
+  RecordBatch<R> Batch;
+  [](StreamDecoder<R> &E, RecordBatch<R> &Batch) -> Task {
+    Batch = co_await E.next();
+  }(E, Batch);
+  REQUIRE(Batch.size() == 3);
+  REQUIRE(Batch.records() == reinterpret_cast<const R *>(In));
+  REQUIRE(get<Tag::A>(Batch[1]) == 22);
+}
+
+#if ORDERED_BIT_FIELD_REF_BY_STR
+TEST_CASE("Stream decoder test (RefByStr)", "[Stream][RefByStr]") {
+  using R = BitField<std::uint16_t, RefByStr::Field<"len", 12>,
+                     RefByStr::Field<"kind", 4>>;
+  R Rec;
+  get<"len">(Rec) = 1500;
+  get<"kind">(Rec) = 6;
+  unsigned char In[sizeof(R)];
+  std::memcpy(In, static_cast<const void *>(&Rec), sizeof(R));
+  StreamDecoder<R> D;
+  std::vector<R> Out;
+  std::size_t NBatches = 0;
+  consume(D, Out, NBatches);
+  D.push(In, 1);
+  D.push(In + 1, 1);
+  D.close();
+  REQUIRE(Out.size() == 1);
+  REQUIRE(get<"len">(Out[0]) == 1500);
+  REQUIRE(get<"kind">(Out[0]) == 6);
+}
+#endif
+#endif